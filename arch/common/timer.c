@@ -8,13 +8,6 @@
 
 #include "timer.h"
 
-static enum ZIP_CMP
-cmpDateTime(const UA_DateTime *a, const UA_DateTime *b) {
-    if(*a == *b)
-        return ZIP_CMP_EQ;
-    return (*a < *b) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
-}
-
 static enum ZIP_CMP
 cmpId(const UA_UInt64 *a, const UA_UInt64 *b) {
     if(*a == *b)
@@ -22,7 +15,6 @@ cmpId(const UA_UInt64 *a, const UA_UInt64 *b) {
     return (*a < *b) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
 }
 
-ZIP_FUNCTIONS(UA_TimerTree, UA_TimerEntry, treeEntry, UA_DateTime, nextTime, cmpDateTime)
 ZIP_FUNCTIONS(UA_TimerIdTree, UA_TimerEntry, idTreeEntry, UA_UInt64, id, cmpId)
 
 static UA_DateTime
@@ -43,9 +35,377 @@ calculateNextTime(UA_DateTime currentTime, UA_DateTime baseTime,
     return currentTime + interval - cycleDelay;
 }
 
+static void
+processEntry(UA_Timer *t, UA_TimerEntry *te, UA_DateTime now);
+
+#ifndef UA_ENABLE_TIMERWHEEL
+
+/*****************/
+/* Timer Backend */
+/*****************/
+
+/* The entries are kept in a tree sorted by their nextTime */
+
+static enum ZIP_CMP
+cmpDateTime(const UA_DateTime *a, const UA_DateTime *b) {
+    if(*a == *b)
+        return ZIP_CMP_EQ;
+    return (*a < *b) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+}
+
+ZIP_FUNCTIONS(UA_TimerTree, UA_TimerEntry, treeEntry, UA_DateTime, nextTime, cmpDateTime)
+
+static void
+timerInit(UA_Timer *t) {
+    ZIP_INIT(&t->tree);
+}
+
+static void
+timerInsert(UA_Timer *t, UA_TimerEntry *te) {
+    ZIP_INSERT(UA_TimerTree, &t->tree, te);
+}
+
+/* Returns false if the entry is currently processed */
+static UA_Boolean
+timerRemove(UA_Timer *t, UA_TimerEntry *te) {
+    return (ZIP_REMOVE(UA_TimerTree, &t->tree, te) != NULL);
+}
+
+static UA_DateTime
+timerNext(UA_Timer *t) {
+    UA_TimerEntry *first = ZIP_MIN(UA_TimerTree, &t->tree);
+    return (first) ? first->nextTime : UA_INT64_MAX;
+}
+
+struct TimerProcessContext {
+    UA_Timer *t;
+    UA_DateTime now;
+};
+
+static void *
+processEntryCallback(void *context, UA_TimerEntry *te) {
+    struct TimerProcessContext *tpc = (struct TimerProcessContext*)context;
+    processEntry(tpc->t, te, tpc->now);
+    return NULL;
+}
+
+static void
+timerProcess(UA_Timer *t, UA_DateTime now) {
+    /* Move all entries <= now to the processTree */
+    UA_TimerTree processTree;
+    ZIP_INIT(&processTree);
+    ZIP_UNZIP(UA_TimerTree, &t->tree, &now, &processTree, &t->tree);
+
+    /* Consistency check. The smallest not-processed entry isn't ready. */
+    UA_assert(!ZIP_MIN(UA_TimerTree, &t->tree) ||
+              ZIP_MIN(UA_TimerTree, &t->tree)->nextTime > now);
+
+    /* Iterate over the entries that need processing in-order. This also
+     * moves them back to the regular time-ordered tree. */
+    struct TimerProcessContext ctx;
+    ctx.t = t;
+    ctx.now = now;
+    ZIP_ITER(UA_TimerTree, &processTree, processEntryCallback, &ctx);
+}
+
+#else /* UA_ENABLE_TIMERWHEEL */
+
+/*****************/
+/* Timer Backend */
+/*****************/
+
+/* The entries are kept in a hierarchical timing wheel (see timer.h) */
+
+#define WHEEL_TICK(dt) ((dt) >> UA_TIMERWHEEL_TICKBITS)
+#define WHEEL_SHIFT(level) ((level) * UA_TIMERWHEEL_SLOTBITS)
+#define WHEEL_SLOTMASK (UA_TIMERWHEEL_SLOTS - 1)
+
+/* Index of the lowest set bit. The mask must not be zero. */
+static UA_UInt16
+lowestBit(UA_UInt64 mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (UA_UInt16)__builtin_ctzll(mask);
+#else
+    UA_UInt16 i = 0;
+    while(!(mask & 1)) {
+        mask >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+static void
+timerInit(UA_Timer *t) {
+    t->tick = 0;
+    memset(t->occupied, 0, sizeof(t->occupied));
+    for(size_t i = 0; i <= UA_TIMERWHEEL_OVERFLOW; i++)
+        TAILQ_INIT(&t->slots[i]);
+}
+
+static void
+timerInsert(UA_Timer *t, UA_TimerEntry *te) {
+    UA_Int64 tick = WHEEL_TICK(te->nextTime);
+    UA_UInt16 slot;
+    if(tick <= t->tick) {
+        /* Already due. Add to the current slot of level 0. */
+        slot = (UA_UInt16)(t->tick & WHEEL_SLOTMASK);
+    } else {
+        /* Find the lowest level whose range covers the distance */
+        UA_UInt64 delta = (UA_UInt64)(tick - t->tick);
+        UA_UInt16 level = 0;
+        while(level < UA_TIMERWHEEL_LEVELS &&
+              delta >= ((UA_UInt64)1 << WHEEL_SHIFT(level + 1)))
+            level++;
+        slot = (level == UA_TIMERWHEEL_LEVELS) ? UA_TIMERWHEEL_OVERFLOW :
+            (UA_UInt16)(level * UA_TIMERWHEEL_SLOTS +
+                        ((tick >> WHEEL_SHIFT(level)) & WHEEL_SLOTMASK));
+    }
+    te->slot = slot;
+    TAILQ_INSERT_TAIL(&t->slots[slot], te, slotEntry);
+    if(slot < UA_TIMERWHEEL_OVERFLOW)
+        t->occupied[slot / UA_TIMERWHEEL_SLOTS] |=
+            (UA_UInt64)1 << (slot % UA_TIMERWHEEL_SLOTS);
+}
+
+static void
+unlinkEntry(UA_Timer *t, UA_TimerEntry *te) {
+    UA_TimerSlot *s = &t->slots[te->slot];
+    TAILQ_REMOVE(s, te, slotEntry);
+    if(te->slot < UA_TIMERWHEEL_OVERFLOW && TAILQ_EMPTY(s))
+        t->occupied[te->slot / UA_TIMERWHEEL_SLOTS] &=
+            ~((UA_UInt64)1 << (te->slot % UA_TIMERWHEEL_SLOTS));
+}
+
+/* Returns false if the entry is currently processed */
+static UA_Boolean
+timerRemove(UA_Timer *t, UA_TimerEntry *te) {
+    if(te->slot == UA_TIMERWHEEL_PROCESSING)
+        return false;
+    unlinkEntry(t, te);
+    return true;
+}
+
+/* Reinsert the entries of a slot relative to the current tick. They end up on
+ * the levels below (or again in the overflow slot). The slot is detached as a
+ * whole first. */
+static void
+cascadeSlot(UA_Timer *t, UA_UInt16 slot) {
+    UA_TimerEntry *te = TAILQ_FIRST(&t->slots[slot]);
+    TAILQ_INIT(&t->slots[slot]);
+    if(slot < UA_TIMERWHEEL_OVERFLOW)
+        t->occupied[slot / UA_TIMERWHEEL_SLOTS] &=
+            ~((UA_UInt64)1 << (slot % UA_TIMERWHEEL_SLOTS));
+    while(te) {
+        UA_TimerEntry *next = TAILQ_NEXT(te, slotEntry);
+        timerInsert(t, te);
+        te = next;
+    }
+}
+
+/* Cascade down the higher-level slots that begin at the current tick. Start
+ * with the highest level, so that the entries can trickle down. */
+static void
+cascade(UA_Timer *t) {
+    UA_UInt64 topMask = ((UA_UInt64)1 << WHEEL_SHIFT(UA_TIMERWHEEL_LEVELS - 1)) - 1;
+    if(((UA_UInt64)t->tick & topMask) == 0 &&
+       !TAILQ_EMPTY(&t->slots[UA_TIMERWHEEL_OVERFLOW]))
+        cascadeSlot(t, UA_TIMERWHEEL_OVERFLOW);
+    for(UA_UInt16 level = UA_TIMERWHEEL_LEVELS - 1; level > 0; level--) {
+        UA_UInt64 mask = ((UA_UInt64)1 << WHEEL_SHIFT(level)) - 1;
+        if(((UA_UInt64)t->tick & mask) != 0)
+            continue;
+        UA_UInt16 idx = (UA_UInt16)((t->tick >> WHEEL_SHIFT(level)) & WHEEL_SLOTMASK);
+        if(t->occupied[level] & ((UA_UInt64)1 << idx))
+            cascadeSlot(t, (UA_UInt16)(level * UA_TIMERWHEEL_SLOTS + idx));
+    }
+}
+
+/* The first tick after the current slot where a non-empty slot of the level
+ * begins. Slots of the current position are considered to be in the next
+ * rotation. */
+static UA_Int64
+nextSlotTick(const UA_Timer *t, UA_UInt16 level) {
+    UA_UInt64 occ = t->occupied[level];
+    if(!occ)
+        return UA_INT64_MAX;
+    UA_Int64 pos = t->tick >> WHEEL_SHIFT(level);
+    UA_UInt16 idx = (UA_UInt16)(pos & WHEEL_SLOTMASK);
+    UA_UInt64 after = (idx == WHEEL_SLOTMASK) ? 0 : occ & (~(UA_UInt64)0 << (idx + 1));
+    UA_Int64 base = pos - idx;
+    UA_Int64 next = (after) ? base + lowestBit(after) :
+        base + UA_TIMERWHEEL_SLOTS + lowestBit(occ);
+    return next << WHEEL_SHIFT(level);
+}
+
+/* The next tick where something happens in the wheel. Either a slot of level 0
+ * is due or higher-level slots (and the overflow slot) need to be cascaded. */
+static UA_Int64
+nextTick(const UA_Timer *t) {
+    UA_Int64 next = UA_INT64_MAX;
+    for(UA_UInt16 level = 0; level < UA_TIMERWHEEL_LEVELS; level++) {
+        UA_Int64 n = nextSlotTick(t, level);
+        if(n < next)
+            next = n;
+    }
+    if(!TAILQ_EMPTY(&t->slots[UA_TIMERWHEEL_OVERFLOW])) {
+        UA_UInt16 shift = WHEEL_SHIFT(UA_TIMERWHEEL_LEVELS - 1);
+        UA_Int64 n = ((t->tick >> shift) + 1) << shift;
+        if(n < next)
+            next = n;
+    }
+    return next;
+}
+
+static UA_DateTime
+timerNext(UA_Timer *t) {
+    UA_DateTime next = UA_INT64_MAX;
+    UA_TimerEntry *te;
+
+    /* Exact time from the first non-empty slot of level 0 */
+    UA_UInt64 occ = t->occupied[0];
+    if(occ) {
+        UA_UInt16 idx = (UA_UInt16)(t->tick & WHEEL_SLOTMASK);
+        UA_UInt64 rotated = (idx == 0) ? occ :
+            (occ >> idx) | (occ << (UA_TIMERWHEEL_SLOTS - idx));
+        UA_UInt16 slot = (UA_UInt16)((idx + lowestBit(rotated)) & WHEEL_SLOTMASK);
+        TAILQ_FOREACH(te, &t->slots[slot], slotEntry) {
+            if(te->nextTime < next)
+                next = te->nextTime;
+        }
+    }
+
+    /* The higher levels are cascaded when their next slot begins */
+    for(UA_UInt16 level = 1; level < UA_TIMERWHEEL_LEVELS; level++) {
+        UA_Int64 n = nextSlotTick(t, level);
+        if(n == UA_INT64_MAX)
+            continue;
+        n = n << UA_TIMERWHEEL_TICKBITS;
+        if(n < next)
+            next = n;
+    }
+
+    /* Entries beyond the range of the wheel */
+    TAILQ_FOREACH(te, &t->slots[UA_TIMERWHEEL_OVERFLOW], slotEntry) {
+        if(te->nextTime < next)
+            next = te->nextTime;
+    }
+    return next;
+}
+
+/* Stable merge sort of a NULL-terminated list by nextTime */
+static UA_TimerEntry *
+sortEntries(UA_TimerEntry *list, size_t len) {
+    if(len < 2)
+        return list;
+    size_t half = len / 2;
+    UA_TimerEntry *second = list;
+    for(size_t i = 1; i < half; i++)
+        second = TAILQ_NEXT(second, slotEntry);
+    UA_TimerEntry *tmp = TAILQ_NEXT(second, slotEntry);
+    TAILQ_NEXT(second, slotEntry) = NULL;
+    UA_TimerEntry *a = sortEntries(list, half);
+    UA_TimerEntry *b = sortEntries(tmp, len - half);
+
+    UA_TimerEntry *head = NULL;
+    UA_TimerEntry **tail = &head;
+    while(a && b) {
+        if(b->nextTime < a->nextTime) {
+            *tail = b;
+            b = TAILQ_NEXT(b, slotEntry);
+        } else {
+            *tail = a;
+            a = TAILQ_NEXT(a, slotEntry);
+        }
+        tail = &TAILQ_NEXT(*tail, slotEntry);
+    }
+    *tail = (a) ? a : b;
+    return head;
+}
+
+static void
+timerProcess(UA_Timer *t, UA_DateTime now) {
+    UA_TimerSlot due;
+    TAILQ_INIT(&due);
+    size_t dueSize = 0;
+    UA_Boolean sorted = true;
+    UA_DateTime last = UA_INT64_MIN;
+
+    /* Advance the wheel up to the current tick. Jump directly to the next
+     * slot that is either due or needs to be cascaded. Move the due entries
+     * to the local list. They are marked as "processing". */
+    UA_Int64 target = WHEEL_TICK(now);
+    UA_TimerEntry *te, *te_tmp;
+    while(true) {
+        UA_UInt16 idx = (UA_UInt16)(t->tick & WHEEL_SLOTMASK);
+        UA_TimerSlot *s = &t->slots[idx];
+        if(t->tick < target) {
+            /* All entries of the slot are due. Move the slot as a whole. */
+            TAILQ_FOREACH(te, s, slotEntry) {
+                te->slot = UA_TIMERWHEEL_PROCESSING;
+                if(te->nextTime < last)
+                    sorted = false;
+                last = te->nextTime;
+                dueSize++;
+            }
+            if(!TAILQ_EMPTY(s)) {
+                te = TAILQ_FIRST(s);
+                *due.tqh_last = te;
+                te->slotEntry.tqe_prev = due.tqh_last;
+                due.tqh_last = s->tqh_last;
+                TAILQ_INIT(s);
+                t->occupied[0] &= ~((UA_UInt64)1 << idx);
+            }
+        } else {
+            /* The current tick is reached. Take only the entries <= now. */
+            TAILQ_FOREACH_SAFE(te, s, slotEntry, te_tmp) {
+                if(te->nextTime > now)
+                    continue;
+                unlinkEntry(t, te);
+                te->slot = UA_TIMERWHEEL_PROCESSING;
+                TAILQ_INSERT_TAIL(&due, te, slotEntry);
+                if(te->nextTime < last)
+                    sorted = false;
+                last = te->nextTime;
+                dueSize++;
+            }
+            break;
+        }
+        UA_Int64 next = nextTick(t);
+        if(next > target) {
+            t->tick = target;
+            break;
+        }
+        t->tick = next;
+        cascade(t);
+    }
+
+    /* Entries within a slot are not ordered. Sort the due entries (only if
+     * required) so they are processed in the order of their nextTime. */
+    if(!sorted) {
+        te = sortEntries(TAILQ_FIRST(&due), dueSize);
+        TAILQ_INIT(&due);
+        while(te) {
+            te_tmp = TAILQ_NEXT(te, slotEntry);
+            TAILQ_INSERT_TAIL(&due, te, slotEntry);
+            te = te_tmp;
+        }
+    }
+
+    /* Process the entries in-order. This also moves them back into the
+     * wheel. */
+    while((te = TAILQ_FIRST(&due))) {
+        TAILQ_REMOVE(&due, te, slotEntry);
+        processEntry(t, te, now);
+    }
+}
+
+#endif /* UA_ENABLE_TIMERWHEEL */
+
 void
 UA_Timer_init(UA_Timer *t) {
     memset(t, 0, sizeof(UA_Timer));
+    timerInit(t);
     UA_LOCK_INIT(&t->timerMutex);
 }
 
@@ -137,10 +497,15 @@ UA_Timer_add(UA_Timer *t, UA_ApplicationCallback callback,
 
     /* Insert into the timer */
     UA_LOCK(&t->timerMutex);
+#ifdef UA_ENABLE_TIMERWHEEL
+    /* Start the empty wheel at the current time */
+    if(!t->idTree.root)
+        t->tick = now >> UA_TIMERWHEEL_TICKBITS;
+#endif
     te->id = ++t->idCounter;
     if(callbackId)
         *callbackId = te->id;
-    ZIP_INSERT(UA_TimerTree, &t->tree, te);
+    timerInsert(t, te);
     ZIP_INSERT(UA_TimerIdTree, &t->idTree, te);
     UA_UNLOCK(&t->timerMutex);
 
@@ -174,11 +539,11 @@ UA_Timer_modify(UA_Timer *t, UA_UInt64 callbackId,
         return UA_STATUSCODE_BADNOTFOUND;
     }
 
-    /* The entry is either in the timer tree or current processed. If
-     * in-process, the entry is re-added to the timer-tree right after. */
-    UA_Boolean processing = (ZIP_REMOVE(UA_TimerTree, &t->tree, te) == NULL);
+    /* The entry is either in the timer or currently processed. If
+     * in-process, the entry is re-added to the timer right after. */
+    UA_Boolean processing = !timerRemove(t, te);
 
-    /* The nextTime must only be modified after ZIP_REMOVE. The logic is
+    /* The nextTime must only be modified after the removal. The logic is
      * identical to the creation of a new timer. */
     te->nextTime = (baseTime == NULL) ?
         now + interval : calculateNextTime(now, *baseTime, interval);
@@ -191,7 +556,7 @@ UA_Timer_modify(UA_Timer *t, UA_UInt64 callbackId,
     if(processing)
         te->nextTime -= interval; /* adjust for re-adding after processing */
     else
-        ZIP_INSERT(UA_TimerTree, &t->tree, te);
+        timerInsert(t, te);
 
     UA_UNLOCK(&t->timerMutex);
     return UA_STATUSCODE_GOOD;
@@ -206,10 +571,10 @@ UA_Timer_remove(UA_Timer *t, UA_UInt64 callbackId) {
         return;
     }
 
-    /* The entry is either in the timer tree or in the process tree. If in the
-     * process tree, leave a sentinel (callback == NULL) to delete it during
-     * processing. Do not edit the process tree while iterating over it. */
-    UA_Boolean processing = (ZIP_REMOVE(UA_TimerTree, &t->tree, te) == NULL);
+    /* The entry is either in the timer or currently processed. If processed,
+     * leave a sentinel (callback == NULL) to delete it during processing. Do
+     * not edit the processed entries while iterating over them. */
+    UA_Boolean processing = !timerRemove(t, te);
     if(!processing) {
         ZIP_REMOVE(UA_TimerIdTree, &t->idTree, te);
         UA_free(te);
@@ -220,16 +585,8 @@ UA_Timer_remove(UA_Timer *t, UA_UInt64 callbackId) {
     UA_UNLOCK(&t->timerMutex);
 }
 
-struct TimerProcessContext {
-    UA_Timer *t;
-    UA_DateTime now;
-};
-
-static void *
-processEntryCallback(void *context, UA_TimerEntry *te) {
-    struct TimerProcessContext *tpc = (struct TimerProcessContext*)context;
-    UA_Timer *t = tpc->t;
-
+static void
+processEntry(UA_Timer *t, UA_TimerEntry *te, UA_DateTime now) {
     /* Execute the callback */
     if(te->callback) {
         te->callback(te->application, te->data);
@@ -239,7 +596,7 @@ processEntryCallback(void *context, UA_TimerEntry *te) {
     if(!te->callback || te->timerPolicy == UA_TIMERPOLICY_ONCE) {
         ZIP_REMOVE(UA_TimerIdTree, &t->idTree, te);
         UA_free(te);
-        return NULL;
+        return;
     }
 
     /* Set the time for the next regular execution */
@@ -256,40 +613,25 @@ processEntryCallback(void *context, UA_TimerEntry *te) {
      *
      * Otherwise calculate the next execution time based on the original base
      * time. */
-    if(te->nextTime < tpc->now) {
+    if(te->nextTime < now) {
         te->nextTime = (te->timerPolicy == UA_TIMERPOLICY_CURRENTTIME) ?
-            tpc->now + te->interval :
-            calculateNextTime(tpc->now, te->nextTime, te->interval);
+            now + te->interval :
+            calculateNextTime(now, te->nextTime, te->interval);
     }
 
-    /* Insert back into the time-sorted tree */
-    ZIP_INSERT(UA_TimerTree, &t->tree, te);
-    return NULL;
+    /* Insert back into the timer */
+    timerInsert(t, te);
 }
 
 UA_DateTime
 UA_Timer_process(UA_Timer *t, UA_DateTime now) {
     UA_LOCK(&t->timerMutex);
 
-    /* Move all entries <= now to the processTree */
-    UA_TimerTree processTree;
-    ZIP_INIT(&processTree);
-    ZIP_UNZIP(UA_TimerTree, &t->tree, &now, &processTree, &t->tree);
+    /* Execute the due entries in-order */
+    timerProcess(t, now);
 
-    /* Consistency check. The smallest not-processed entry isn't ready. */
-    UA_assert(!ZIP_MIN(UA_TimerTree, &t->tree) ||
-              ZIP_MIN(UA_TimerTree, &t->tree)->nextTime > now);
-        
-    /* Iterate over the entries that need processing in-order. This also
-     * moves them back to the regular time-ordered tree. */
-    struct TimerProcessContext ctx;
-    ctx.t = t;
-    ctx.now = now;
-    ZIP_ITER(UA_TimerTree, &processTree, processEntryCallback, &ctx);
-        
     /* Compute the timestamp of the earliest next callback */
-    UA_TimerEntry *first = ZIP_MIN(UA_TimerTree, &t->tree);
-    UA_DateTime next = (first) ? first->nextTime : UA_INT64_MAX;
+    UA_DateTime next = timerNext(t);
     UA_UNLOCK(&t->timerMutex);
     return next;
 }
@@ -297,8 +639,7 @@ UA_Timer_process(UA_Timer *t, UA_DateTime now) {
 UA_DateTime
 UA_Timer_next(UA_Timer *t) {
     UA_LOCK(&t->timerMutex);
-    UA_TimerEntry *first = ZIP_MIN(UA_TimerTree, &t->tree);
-    UA_DateTime next = (first) ? first->nextTime : UA_INT64_MAX;
+    UA_DateTime next = timerNext(t);
     UA_UNLOCK(&t->timerMutex);
     return next;
 }
@@ -314,7 +655,7 @@ UA_Timer_clear(UA_Timer *t) {
     UA_LOCK(&t->timerMutex);
 
     ZIP_ITER(UA_TimerIdTree, &t->idTree, freeEntryCallback, NULL);
-    t->tree.root = NULL;
+    timerInit(t);
     t->idTree.root = NULL;
     t->idCounter = 0;
 
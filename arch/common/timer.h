@@ -13,6 +13,10 @@
 #include <open62541/plugin/eventloop.h>
 #include "ziptree.h"
 
+#if defined(UA_ENABLE_TIMERWHEEL) && !defined(__QNX__)
+# include "open62541_queue.h"
+#endif
+
 _UA_BEGIN_DECLS
 
 /* The timer is protected by its own mutex. The mutex is released before calling
@@ -26,8 +30,32 @@ _UA_BEGIN_DECLS
 /* Callback where the application is either a client or a server */
 typedef void (*UA_ApplicationCallback)(void *application, void *data);
 
+/* With UA_ENABLE_TIMERWHEEL, the entries are kept in a hierarchical timing
+ * wheel instead of the time-sorted tree. Every level of the wheel has 64 slots.
+ * A slot of level 0 covers one tick (2^10 * 100ns, about 0.1ms). A slot on the
+ * next level covers all slots of the level below. Entries are inserted into
+ * the slot of the lowest level that covers their nextTime relative to the
+ * current tick. When the current tick reaches the start of a slot on a higher
+ * level, its entries are moved ("cascaded") to the levels below. Inserting and
+ * expiring an entry is then O(1), independent of the number of entries. The
+ * last slot holds the entries beyond the range of the wheel (about 81 days). */
+#ifdef UA_ENABLE_TIMERWHEEL
+#define UA_TIMERWHEEL_TICKBITS 10
+#define UA_TIMERWHEEL_SLOTBITS 6
+#define UA_TIMERWHEEL_SLOTS (1 << UA_TIMERWHEEL_SLOTBITS)
+#define UA_TIMERWHEEL_LEVELS 6
+#define UA_TIMERWHEEL_OVERFLOW (UA_TIMERWHEEL_LEVELS * UA_TIMERWHEEL_SLOTS)
+#define UA_TIMERWHEEL_PROCESSING (UA_TIMERWHEEL_OVERFLOW + 1)
+#endif
+
 typedef struct UA_TimerEntry {
+#ifdef UA_ENABLE_TIMERWHEEL
+    TAILQ_ENTRY(UA_TimerEntry) slotEntry;
+    UA_UInt16 slot;                  /* Index of the slot in the wheel or
+                                      * UA_TIMERWHEEL_PROCESSING */
+#else
     ZIP_ENTRY(UA_TimerEntry) treeEntry;
+#endif
     UA_TimerPolicy timerPolicy;      /* Timer policy to handle cycle misses */
     UA_DateTime nextTime;            /* The next time when the callback is to be
                                       * executed */
@@ -44,11 +72,21 @@ typedef struct UA_TimerEntry {
     UA_UInt64 id;                            /* Id of the entry */
 } UA_TimerEntry;
 
-typedef ZIP_HEAD(UA_TimerTree, UA_TimerEntry) UA_TimerTree;
 typedef ZIP_HEAD(UA_TimerIdTree, UA_TimerEntry) UA_TimerIdTree;
+#ifdef UA_ENABLE_TIMERWHEEL
+typedef TAILQ_HEAD(UA_TimerSlot, UA_TimerEntry) UA_TimerSlot;
+#else
+typedef ZIP_HEAD(UA_TimerTree, UA_TimerEntry) UA_TimerTree;
+#endif
 
 typedef struct {
+#ifdef UA_ENABLE_TIMERWHEEL
+    UA_Int64 tick; /* The current tick of the wheel */
+    UA_UInt64 occupied[UA_TIMERWHEEL_LEVELS]; /* Bitmask of non-empty slots */
+    UA_TimerSlot slots[UA_TIMERWHEEL_OVERFLOW + 1];
+#else
     UA_TimerTree tree;     /* The root of the time-sorted tree */
+#endif
     UA_TimerIdTree idTree; /* The root of the id-sorted tree */
     UA_UInt64 idCounter;   /* Generate unique identifiers. Identifiers are
                             * always above zero. */
@@ -60,6 +98,10 @@ typedef struct {
 void
 UA_Timer_init(UA_Timer *t);
 
+/* Returns the time of the next callback (or UA_INT64_MAX if the timer is
+ * empty). The timing wheel can return an earlier time when it needs to move
+ * entries between its levels. Then the next processing does not execute a
+ * callback. */
 UA_DateTime
 UA_Timer_next(UA_Timer *t);
 
@@ -77,6 +119,7 @@ UA_Timer_modify(UA_Timer *t, UA_UInt64 callbackId,
 void
 UA_Timer_remove(UA_Timer *t, UA_UInt64 callbackId);
 
+/* Returns the time of the next callback (same as UA_Timer_next) */
 UA_DateTime
 UA_Timer_process(UA_Timer *t, UA_DateTime now);
 
@@ -157,6 +157,13 @@ processDelayed(UA_EventLoopPOSIX *el) {
 /* EventLoop Lifecycle */
 /***********************/
 
+#ifdef UA_HAVE_EPOLL_WORKERS
+static UA_StatusCode
+startWorkers(UA_EventLoopPOSIX *el, UA_UInt16 workersSize);
+static void
+stopWorkers(UA_EventLoopPOSIX *el, size_t started);
+#endif
+
 static UA_StatusCode
 UA_EventLoopPOSIX_start(UA_EventLoopPOSIX *el) {
     UA_LOCK(&el->elMutex);
@@ -242,6 +249,24 @@ UA_EventLoopPOSIX_start(UA_EventLoopPOSIX *el) {
     }
 #endif
 
+    /* Start the worker threads */
+    const UA_UInt16 *workers = (const UA_UInt16*)
+        UA_KeyValueMap_getScalar(&el->eventLoop.params,
+                                 UA_QUALIFIEDNAME(0, "worker-threads"),
+                                 &UA_TYPES[UA_TYPES_UINT16]);
+    if(workers && *workers > 0) {
+#ifdef UA_HAVE_EPOLL_WORKERS
+        if(startWorkers(el, *workers) != UA_STATUSCODE_GOOD)
+            UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                           "Eventloop\t| Could not start the worker threads, "
+                           "continue without");
+#else
+        UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                       "Eventloop\t| Worker threads are not supported "
+                       "in this build");
+#endif
+    }
+
     /* Start the EventSources */
     UA_StatusCode res = UA_STATUSCODE_GOOD;
     UA_EventSource *es = el->eventLoop.eventSources;
@@ -281,6 +306,12 @@ checkClosed(UA_EventLoopPOSIX *el) {
     *(UA_EventLoopState*)(uintptr_t)&el->eventLoop.state =
         UA_EVENTLOOPSTATE_STOPPED;
 
+    /* Stop the worker threads. All fds assigned to them are released, so they
+     * are idle. */
+#ifdef UA_HAVE_EPOLL_WORKERS
+    stopWorkers(el, el->workersSize);
+#endif
+
     /* Close the epoll/IOCP socket once all EventSources have shut down */
 #ifdef UA_HAVE_EPOLL
     UA_close(el->epollfd);
@@ -904,8 +935,42 @@ UA_EventLoopPOSIX_pollFDs(UA_EventLoopPOSIX *el, UA_DateTime listenTimeout) {
 
 #else /* defined(UA_HAVE_EPOLL) */
 
+#ifdef UA_HAVE_EPOLL_WORKERS
+
+/* The worker of the current thread and the fd it is processing */
+static UA_THREAD_LOCAL UA_EventLoopPOSIXWorker *currentWorker;
+static UA_THREAD_LOCAL UA_RegisteredFD *currentFD;
+
+/* Worker fds are registered with EPOLLONESHOT. They are disarmed once an event
+ * is returned and need to be rearmed after processing. */
+static int
+workerCtl(UA_RegisteredFD *rfd, int op) {
+    struct epoll_event event;
+    memset(&event, 0, sizeof(struct epoll_event));
+    event.data.ptr = rfd;
+    event.events = EPOLLONESHOT;
+    if(rfd->listenEvents & UA_FDEVENT_IN)
+        event.events |= EPOLLIN;
+    if(rfd->listenEvents & UA_FDEVENT_OUT)
+        event.events |= EPOLLOUT;
+    return epoll_ctl(rfd->worker->epollfd, op, rfd->fd, &event);
+}
+
+static void
+wakeWorker(UA_EventLoopPOSIXWorker *w) {
+    ssize_t err = write(w->selfpipe[1], ".", 1);
+    (void)err; /* The pipe is full and the worker wakes up anyway */
+}
+
+#endif
+
 UA_StatusCode
 UA_EventLoopPOSIX_registerFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
+#ifdef UA_HAVE_EPOLL_WORKERS
+    rfd->worker = NULL;
+    rfd->epoch = 0;
+#endif
+
     struct epoll_event event;
     memset(&event, 0, sizeof(struct epoll_event));
     event.data.ptr = rfd;
@@ -928,6 +993,21 @@ UA_EventLoopPOSIX_registerFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
 
 UA_StatusCode
 UA_EventLoopPOSIX_modifyFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
+    int err;
+#ifdef UA_HAVE_EPOLL_WORKERS
+    if(rfd->worker) {
+        /* Called from the callback. The fd is rearmed with the new events once
+         * the callback returns. */
+        if(rfd == currentFD)
+            return UA_STATUSCODE_GOOD;
+        /* The first call adds the fd to the epoll instance of the worker */
+        err = workerCtl(rfd, EPOLL_CTL_MOD);
+        if(err != 0 && errno == ENOENT)
+            err = workerCtl(rfd, EPOLL_CTL_ADD);
+        goto finish;
+    }
+#endif
+
     struct epoll_event event;
     memset(&event, 0, sizeof(struct epoll_event));
     event.data.ptr = rfd;
@@ -937,7 +1017,11 @@ UA_EventLoopPOSIX_modifyFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
     if(rfd->listenEvents & UA_FDEVENT_OUT)
         event.events |= EPOLLOUT;
 
-    int err = epoll_ctl(el->epollfd, EPOLL_CTL_MOD, rfd->fd, &event);
+    err = epoll_ctl(el->epollfd, EPOLL_CTL_MOD, rfd->fd, &event);
+
+#ifdef UA_HAVE_EPOLL_WORKERS
+ finish:
+#endif
     if(err != 0) {
         UA_LOG_SOCKET_ERRNO_WRAP(
            UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
@@ -950,6 +1034,34 @@ UA_EventLoopPOSIX_modifyFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
 
 void
 UA_EventLoopPOSIX_deregisterFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
+#ifdef UA_HAVE_EPOLL_WORKERS
+    if(rfd->worker) {
+        UA_LOCK_ASSERT(&el->elMutex);
+
+        /* ENOENT if the fd was never armed */
+        int res = epoll_ctl(rfd->worker->epollfd, EPOLL_CTL_DEL, rfd->fd, NULL);
+        if(res != 0 && errno != ENOENT) {
+            UA_LOG_SOCKET_ERRNO_WRAP(
+               UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                              "TCP %u\t| Could not deregister from epoll (%s)",
+                              rfd->fd, errno_str));
+        }
+        UA_assert(rfd->worker->fdsSize > 0);
+        rfd->worker->fdsSize--;
+
+        /* Begin a new epoch. The fd is released once every worker has passed a
+         * quiescent point in the new epoch. Wake up the workers for this. The
+         * epoch zero is reserved for fds that are not deregistered. */
+        UA_UInt32 epoch = UA_atomic_addUInt32(&el->workersEpoch, 1);
+        if(epoch == 0)
+            epoch = UA_atomic_addUInt32(&el->workersEpoch, 1);
+        rfd->epoch = epoch;
+        for(size_t i = 0; i < el->workersSize; i++)
+            wakeWorker(&el->workers[i]);
+        return;
+    }
+#endif
+
     int res = epoll_ctl(el->epollfd, EPOLL_CTL_DEL, rfd->fd, NULL);
     if(res != 0) {
         UA_LOG_SOCKET_ERRNO_WRAP(
@@ -1033,8 +1145,258 @@ UA_EventLoopPOSIX_pollFDs(UA_EventLoopPOSIX *el, UA_DateTime listenTimeout) {
     return UA_STATUSCODE_GOOD;
 }
 
+#ifdef UA_HAVE_EPOLL_WORKERS
+
+/******************/
+/* Worker Threads */
+/******************/
+
+static void
+workerQuiescent(UA_EventLoopPOSIXWorker *w) {
+    UA_atomic_storeUInt32(&w->epoch, UA_atomic_loadUInt32(&w->el->workersEpoch));
+}
+
+static void
+processWorkerEvent(struct epoll_event *event) {
+    UA_RegisteredFD *rfd = (UA_RegisteredFD*)event->data.ptr;
+
+    /* The rfd is already registered for removal. Don't process incoming
+     * events any longer. */
+    if(rfd->dc.callback)
+        return;
+
+    /* Get the event */
+    short revent = 0;
+    if((event->events & EPOLLIN) == EPOLLIN) {
+        revent = UA_FDEVENT_IN;
+    } else if((event->events & EPOLLOUT) == EPOLLOUT) {
+        revent = UA_FDEVENT_OUT;
+    } else {
+        revent = UA_FDEVENT_ERR;
+    }
+
+    /* Call the EventSource callback */
+    currentFD = rfd;
+    rfd->eventSourceCB(rfd->es, rfd, revent);
+    currentFD = NULL;
+
+    /* Rearm the fd. Fails with ENOENT if the fd was deregistered. */
+    if(!rfd->dc.callback)
+        workerCtl(rfd, EPOLL_CTL_MOD);
+}
+
+static void *
+workerLoop(void *data) {
+    UA_EventLoopPOSIXWorker *w = (UA_EventLoopPOSIXWorker*)data;
+    UA_EventLoopPOSIX *el = w->el;
+    currentWorker = w;
+
+    struct epoll_event event;
+    while(UA_atomic_loadUInt32(&w->running)) {
+        /* Quiescent point. No rfd is used by the worker. */
+        workerQuiescent(w);
+
+        /* Wait on the own fds, the other workers and the self-pipe */
+        int res = epoll_wait(w->waitfd, &event, 1, -1);
+        if(res == -1) {
+            if(errno == EINTR)
+                continue;
+            UA_LOG_SOCKET_ERRNO_WRAP(
+               UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                            "Eventloop\t| Worker thread stopped with error %s",
+                            errno_str));
+            break;
+        }
+        if(res == 1 && !event.data.ptr)
+            flushSelfPipe(w->selfpipe[0]);
+
+        /* Process the own fds. Take one event at a time. So that the other
+         * events remain in the epoll instance and can be stolen by idle
+         * workers. */
+        UA_atomic_storeUInt32(&w->busy, 1);
+        while(epoll_wait(w->epollfd, &event, 1, 0) == 1) {
+            processWorkerEvent(&event);
+            workerQuiescent(w);
+        }
+
+        /* Steal events from the workers that are busy processing */
+        for(size_t i = 0; i < el->workersSize; i++) {
+            UA_EventLoopPOSIXWorker *v = &el->workers[i];
+            while(v != w && UA_atomic_loadUInt32(&v->busy) &&
+                  epoll_wait(v->epollfd, &event, 1, 0) == 1) {
+                processWorkerEvent(&event);
+                workerQuiescent(w);
+            }
+        }
+        UA_atomic_storeUInt32(&w->busy, 0);
+    }
+
+    /* Don't wait for this worker to release fds */
+    UA_atomic_storeUInt32(&w->running, 0);
+    return NULL;
+}
+
+static UA_StatusCode
+startWorkers(UA_EventLoopPOSIX *el, UA_UInt16 workersSize) {
+    UA_LOCK_ASSERT(&el->elMutex);
+    UA_assert(el->workersSize == 0);
+
+    if(workersSize > UA_MAXWORKERS)
+        workersSize = UA_MAXWORKERS;
+    el->workers = (UA_EventLoopPOSIXWorker*)
+        UA_calloc(workersSize, sizeof(UA_EventLoopPOSIXWorker));
+    if(!el->workers)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    el->workersSize = workersSize;
+    el->workersEpoch = 1;
+
+    /* Create the epoll instances, self-pipes and receive buffers */
+    int err = 0;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < workersSize; i++) {
+        UA_EventLoopPOSIXWorker *w = &el->workers[i];
+        w->el = el;
+        w->epollfd = epoll_create1(0);
+        w->waitfd = epoll_create1(0);
+        if(w->epollfd == UA_INVALID_FD || w->waitfd == UA_INVALID_FD)
+            err = -1;
+        if(UA_EventLoopPOSIX_pipe(w->selfpipe) != 0) {
+            w->selfpipe[0] = w->selfpipe[1] = UA_INVALID_FD;
+            err = -1;
+        }
+        res |= UA_ByteString_allocBuffer(&w->rxBuffer, 1 << 16); /* 64kB */
+    }
+
+    /* Every worker waits on its own epoll instance (level-triggered), on the
+     * epoll instances of the other workers (edge-triggered, to steal from
+     * them) and on its self-pipe (NULL data pointer) */
+    for(size_t i = 0; i < workersSize && err == 0; i++) {
+        UA_EventLoopPOSIXWorker *w = &el->workers[i];
+        struct epoll_event event;
+        memset(&event, 0, sizeof(struct epoll_event));
+        event.events = EPOLLIN;
+        err |= epoll_ctl(w->waitfd, EPOLL_CTL_ADD, w->selfpipe[0], &event);
+        for(size_t j = 0; j < workersSize; j++) {
+            event.data.ptr = &el->workers[j];
+            event.events = (i == j) ? EPOLLIN : (EPOLLIN | EPOLLET);
+            err |= epoll_ctl(w->waitfd, EPOLL_CTL_ADD,
+                             el->workers[j].epollfd, &event);
+        }
+    }
+    if(err != 0 || res != UA_STATUSCODE_GOOD) {
+        stopWorkers(el, 0);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Start the threads */
+    for(size_t i = 0; i < workersSize; i++) {
+        UA_EventLoopPOSIXWorker *w = &el->workers[i];
+        w->running = 1;
+        w->epoch = el->workersEpoch;
+        if(pthread_create(&w->thread, NULL, workerLoop, w) != 0) {
+            w->running = 0;
+            stopWorkers(el, i);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+    }
+
+    UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                "Eventloop\t| Started %u worker threads", (unsigned)workersSize);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Stop the first n started worker threads and clean up all workers */
+static void
+stopWorkers(UA_EventLoopPOSIX *el, size_t started) {
+    for(size_t i = 0; i < started; i++) {
+        UA_EventLoopPOSIXWorker *w = &el->workers[i];
+        UA_atomic_storeUInt32(&w->running, 0);
+        wakeWorker(w);
+        pthread_join(w->thread, NULL);
+    }
+
+    for(size_t i = 0; i < el->workersSize; i++) {
+        UA_EventLoopPOSIXWorker *w = &el->workers[i];
+        UA_assert(w->fdsSize == 0);
+        if(w->selfpipe[0] != UA_INVALID_FD) {
+            UA_close(w->selfpipe[0]);
+            UA_close(w->selfpipe[1]);
+        }
+        if(w->epollfd != UA_INVALID_FD)
+            UA_close(w->epollfd);
+        if(w->waitfd != UA_INVALID_FD)
+            UA_close(w->waitfd);
+        UA_ByteString_clear(&w->rxBuffer);
+    }
+
+    UA_free(el->workers);
+    el->workers = NULL;
+    el->workersSize = 0;
+}
+
+#endif /* UA_HAVE_EPOLL_WORKERS */
+
 #endif /* defined(UA_HAVE_EPOLL) */
 
+UA_StatusCode
+UA_EventLoopPOSIX_registerWorkerFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
+    UA_LOCK_ASSERT(&el->elMutex);
+#ifdef UA_HAVE_EPOLL_WORKERS
+    if(el->workersSize > 0) {
+        /* Assign to the worker with the fewest fds. The fd is added to the
+         * epoll instance when it is armed with _modifyFD. */
+        UA_EventLoopPOSIXWorker *w = &el->workers[0];
+        for(size_t i = 1; i < el->workersSize; i++) {
+            if(el->workers[i].fdsSize < w->fdsSize)
+                w = &el->workers[i];
+        }
+        w->fdsSize++;
+        rfd->worker = w;
+        rfd->epoch = 0;
+        return UA_STATUSCODE_GOOD;
+    }
+#endif
+    return UA_EventLoopPOSIX_registerFD(el, rfd);
+}
+
+UA_Boolean
+UA_EventLoopPOSIX_releasedFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
+    UA_LOCK_ASSERT(&el->elMutex);
+#ifdef UA_HAVE_EPOLL_WORKERS
+    if(!rfd->worker || rfd->epoch == 0)
+        return true;
+    for(size_t i = 0; i < el->workersSize; i++) {
+        UA_EventLoopPOSIXWorker *w = &el->workers[i];
+        if(!UA_atomic_loadUInt32(&w->running))
+            continue;
+        /* Compare with wrap-around of the epoch counter */
+        if((UA_Int32)(UA_atomic_loadUInt32(&w->epoch) - rfd->epoch) < 0)
+            return false;
+    }
+#endif
+    return true;
+}
+
+UA_ByteString *
+UA_EventLoopPOSIX_getWorkerBuffer(size_t length) {
+#ifdef UA_HAVE_EPOLL_WORKERS
+    UA_EventLoopPOSIXWorker *w = currentWorker;
+    if(!w)
+        return NULL;
+    if(w->rxBuffer.length < length) {
+        /* Keep the old buffer if the allocation fails */
+        UA_ByteString tmp;
+        if(UA_ByteString_allocBuffer(&tmp, length) == UA_STATUSCODE_GOOD) {
+            UA_ByteString_clear(&w->rxBuffer);
+            w->rxBuffer = tmp;
+        }
+    }
+    return &w->rxBuffer;
+#else
+    return NULL;
+#endif
+}
+
 #if defined(UA_ARCHITECTURE_WIN32) || defined(__APPLE__)
 int UA_EventLoopPOSIX_pipe(SOCKET fds[2]) {
     struct sockaddr_in inaddr;
@@ -179,6 +179,7 @@ _UA_END_DECLS
 /*---------------------*/
 
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/select.h>
 #include <sys/ioctl.h>
 #include <arpa/inet.h>
@@ -260,6 +261,24 @@ typedef int SOCKET;
 # include <sys/epoll.h>
 #endif
 
+/* Worker threads that poll connections on their own epoll instance */
+#if defined(UA_HAVE_EPOLL) && UA_MULTITHREADING >= 100
+# define UA_HAVE_EPOLL_WORKERS
+# include <pthread.h>
+#endif
+
+/* ConnectionManagers that receive and send via io_uring */
+#if defined(UA_HAVE_EPOLL) && defined(UA_ENABLE_IOURING)
+# define UA_HAVE_IOURING
+# include <linux/io_uring.h>
+#endif
+
+/* Batched sending and receiving of datagrams with sendmmsg/recvmmsg */
+#if defined(__linux__)
+# define UA_HAVE_MMSG
+# include <netinet/udp.h>
+#endif
+
 /*---------------------------*/
 /* File Handling Definitions */
 /*---------------------------*/
@@ -337,6 +356,18 @@ typedef int SOCKET;
 struct UA_RegisteredFD;
 typedef struct UA_RegisteredFD UA_RegisteredFD;
 
+#ifdef UA_HAVE_EPOLL_WORKERS
+struct UA_EventLoopPOSIXWorker;
+typedef struct UA_EventLoopPOSIXWorker UA_EventLoopPOSIXWorker;
+#endif
+
+#ifdef UA_HAVE_IOURING
+struct UA_IOUring;
+typedef struct UA_IOUring UA_IOUring;
+struct UA_IOUringTx;
+typedef struct UA_IOUringTx UA_IOUringTx;
+#endif
+
 /* Bitmask to be used for the UA_FDCallback event argument */
 #define UA_FDEVENT_IN 1
 #define UA_FDEVENT_OUT 2
@@ -355,6 +386,20 @@ struct UA_RegisteredFD {
 
     UA_EventSource *es; /* Backpointer to the EventSource */
     UA_FDCallback eventSourceCB;
+
+#ifdef UA_HAVE_EPOLL_WORKERS
+    UA_EventLoopPOSIXWorker *worker; /* Worker polling the fd (or NULL) */
+    UA_UInt32 epoch; /* Worker epoch when the fd was deregistered */
+#endif
+
+#ifdef UA_HAVE_IOURING
+    UA_UInt32 uringOps;      /* Pending io_uring operations using the rfd */
+    UA_Boolean uringSending; /* A stream send is in flight */
+    UA_Boolean uringQueued;  /* In the send queue of the ring */
+    UA_RegisteredFD *uringNext; /* Next in the send queue of the ring */
+    UA_IOUringTx *txHead;    /* Buffers waiting to be sent */
+    UA_IOUringTx **txTail;
+#endif
 };
 
 enum ZIP_CMP cmpFD(const UA_FD *a, const UA_FD *b);
@@ -374,9 +419,51 @@ typedef struct {
     /* Sorted tree of the FDs */
     size_t fdsSize;
     UA_FDTree fds;
+
+#ifdef UA_HAVE_IOURING
+    UA_Boolean useUring; /* Created as an io_uring ConnectionManager */
+    UA_IOUring *uring;   /* Set while the ConnectionManager is started */
+#endif
+
+#ifdef UA_HAVE_MMSG
+    UA_UInt32 rxBatch; /* Datagrams received with one call. The rxBuffer holds
+                        * rxBatch slots of the configured recv-bufsize. */
+#endif
 } UA_POSIXConnectionManager;
 
-typedef struct {
+#ifdef UA_HAVE_EPOLL_WORKERS
+
+/* With the "worker-threads" parameter the EventLoop starts worker threads for
+ * polling and processing connections. Connections are sharded across the
+ * workers. Each worker has its own epoll instance. The fds of the workers are
+ * registered with EPOLLONESHOT. So every fd is processed by only one thread at
+ * a time and rearmed afterwards. Idle workers also wait on the epoll instances
+ * of the other workers. They "steal" ready events from workers that are busy
+ * processing.
+ *
+ * The EventSource callback is called from the worker thread without the
+ * EventLoop lock. Deregistered fds can still be used by a worker until all
+ * workers have passed a quiescent point (the top of their loop) in a later
+ * epoch. Then the fd is "released". */
+
+#define UA_MAXWORKERS 64
+
+struct UA_EventLoopPOSIXWorker {
+    struct UA_EventLoopPOSIX *el;
+    pthread_t thread;
+    UA_FD epollfd; /* The fds assigned to this worker */
+    UA_FD waitfd;  /* Waits on the own and the other epollfds */
+    UA_FD selfpipe[2]; /* Wake up the worker */
+    size_t fdsSize; /* Number of assigned fds (changed with the EventLoop lock) */
+    UA_ByteString rxBuffer; /* Receive buffer used by the worker thread */
+    volatile UA_UInt32 running;
+    volatile UA_UInt32 busy;  /* Processing events, allow stealing */
+    volatile UA_UInt32 epoch; /* The epoch seen at the last quiescent point */
+};
+
+#endif
+
+typedef struct UA_EventLoopPOSIX {
     UA_EventLoop eventLoop;
 
     /* Timer */
@@ -408,6 +495,11 @@ typedef struct {
 
 #if defined(UA_HAVE_EPOLL)
     UA_FD epollfd;
+#ifdef UA_HAVE_EPOLL_WORKERS
+    UA_EventLoopPOSIXWorker *workers;
+    size_t workersSize;
+    volatile UA_UInt32 workersEpoch;
+#endif
 #else
     UA_RegisteredFD **fds;
     size_t fdsSize;
@@ -427,6 +519,15 @@ typedef struct {
 UA_StatusCode
 UA_EventLoopPOSIX_registerFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd);
 
+/* Assign the fd to the worker thread that has the fewest fds. Falls back to
+ * _registerFD if the EventLoop has no workers. A worker fd receives events only
+ * after _modifyFD was called for it the first time. The EventSource callback is
+ * then called from the worker thread without holding the EventLoop lock. The fd
+ * is released (no longer used by any worker) only some time after
+ * _deregisterFD. See _releasedFD. */
+UA_StatusCode
+UA_EventLoopPOSIX_registerWorkerFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd);
+
 /* Modify the events that the fd listens on */
 UA_StatusCode
 UA_EventLoopPOSIX_modifyFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd);
@@ -435,6 +536,17 @@ UA_EventLoopPOSIX_modifyFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd);
 void
 UA_EventLoopPOSIX_deregisterFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd);
 
+/* Returns true if the deregistered fd is no longer used by a worker thread.
+ * Always true for fds that were not registered with a worker. */
+UA_Boolean
+UA_EventLoopPOSIX_releasedFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd);
+
+/* Returns the receive buffer of the current worker thread, or NULL if not
+ * called from a worker thread. The buffer is grown to the requested length if
+ * possible. */
+UA_ByteString *
+UA_EventLoopPOSIX_getWorkerBuffer(size_t length);
+
 UA_StatusCode
 UA_EventLoopPOSIX_pollFDs(UA_EventLoopPOSIX *el, UA_DateTime listenTimeout);
 
@@ -454,6 +566,59 @@ UA_EventLoopPOSIX_freeNetworkBuffer(UA_ConnectionManager *cm,
                                     uintptr_t connectionId,
                                     UA_ByteString *buf);
 
+#ifdef UA_HAVE_IOURING
+
+/* io_uring backend of the TCP and UDP ConnectionManagers. Every started
+ * io_uring ConnectionManager has its own ring. The ring fd is registered in the
+ * EventLoop and signals when completions are ready.
+ *
+ * Sockets receive with a multishot recv (stream) or recvmsg (datagram) from a
+ * ring of provided buffers. Sends are queued and submitted together when the
+ * completions of the ring have been processed, or right away if sending from
+ * outside of the ring callback. Stream sockets have one (gathering) send in
+ * flight at a time to keep the order. Only the thread running the EventLoop
+ * enters the ring. Sends from other threads are submitted from a delayed
+ * callback.
+ *
+ * The callback receives the received data. Or a result <= 0 if the socket was
+ * closed (0) or an error occurred (-errno). Then the ConnectionManager should
+ * close the socket.
+ *
+ * A socket is closed with _cancel. The rfd must not be freed before all
+ * pending operations have completed. See _released. */
+
+typedef void
+(*UA_IOUringCallback)(UA_POSIXConnectionManager *pcm, UA_RegisteredFD *rfd,
+                      int res, UA_ByteString msg, const struct sockaddr *source);
+
+UA_StatusCode
+UA_IOUring_start(UA_POSIXConnectionManager *pcm, UA_Boolean datagram,
+                 UA_IOUringCallback callback);
+
+/* Call only when no socket has pending operations */
+void
+UA_IOUring_stop(UA_POSIXConnectionManager *pcm);
+
+/* Start receiving on the socket */
+UA_StatusCode
+UA_IOUring_recv(UA_POSIXConnectionManager *pcm, UA_RegisteredFD *rfd);
+
+/* Takes ownership of the buffer. The destination address is used for datagram
+ * sockets. */
+UA_StatusCode
+UA_IOUring_send(UA_POSIXConnectionManager *pcm, UA_RegisteredFD *rfd,
+                UA_ByteString *buf, const struct sockaddr *dest,
+                socklen_t destLength);
+
+/* Cancel the pending operations and drop the buffers waiting to be sent. The
+ * ready completions (also of other sockets) are processed right away. */
+void
+UA_IOUring_cancel(UA_POSIXConnectionManager *pcm, UA_RegisteredFD *rfd);
+
+#define UA_IOUring_released(rfd) ((rfd)->uringOps == 0)
+
+#endif
+
 /* Set the socket non-blocking. If the listen-socket is nonblocking, incoming
  * connections inherit this state. */
 UA_StatusCode
@@ -0,0 +1,762 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "eventloop_posix.h"
+
+#ifdef UA_HAVE_IOURING
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/* The user_data of a submission points to the rfd (recv) or the send operation.
+ * The lower bits tag the operation type. Zero is used for operations whose
+ * completion is ignored. */
+#define UA_IOURING_TAG_MASK 3
+#define UA_IOURING_TAG_RECV 1
+#define UA_IOURING_TAG_SEND 2
+
+#define UA_IOURING_BUFGROUP 0
+#define UA_IOURING_MAXIOV 16
+
+struct UA_IOUringTx {
+    UA_IOUringTx *next;
+    UA_ByteString buf;
+    size_t sent;
+    const struct sockaddr *dest; /* For datagrams */
+    socklen_t destLength;
+};
+
+/* A submitted send. Streams gather the first buffers of the queue. A datagram
+ * send owns the buffer. */
+typedef struct UA_IOUringSend {
+    struct UA_IOUringSend *next; /* In the list of unused operations */
+    UA_RegisteredFD *rfd;
+    UA_IOUringTx *tx; /* For datagrams */
+    struct msghdr msg;
+    struct iovec iov[UA_IOURING_MAXIOV];
+} UA_IOUringSend;
+
+struct UA_IOUring {
+    UA_RegisteredFD rfd; /* The ring fd, registered in the EventLoop */
+    UA_POSIXConnectionManager *pcm;
+    UA_IOUringCallback callback;
+    UA_Boolean datagram;
+    UA_Boolean processing; /* Processing the completions */
+
+    /* Shared ring memory */
+    void *ringMem;
+    size_t ringMemSize;
+    struct io_uring_sqe *sqes;
+    size_t sqesSize;
+
+    /* Submission queue */
+    unsigned *sqHead;
+    unsigned *sqTail;
+    unsigned *sqArray;
+    unsigned sqMask;
+    unsigned sqEntries;
+    unsigned sqLocalTail;
+
+    /* Completion queue */
+    unsigned *cqHead;
+    unsigned *cqTail;
+    struct io_uring_cqe *cqes;
+    unsigned cqMask;
+    unsigned cqEntries;
+
+    /* Ring of provided receive buffers */
+    struct io_uring_buf_ring *bufRing;
+    size_t bufRingSize;
+    UA_Byte *bufs;
+    size_t bufSize;
+    UA_UInt16 bufCount;
+    UA_UInt16 bufTail;
+
+    /* Template for the multishot recvmsg of datagram sockets */
+    struct msghdr recvMsg;
+
+    /* Sockets with buffers waiting to be submitted */
+    UA_RegisteredFD *sendQueue;
+
+    /* Unused send operations and tx queue entries are kept for reuse */
+    struct UA_IOUringSend *unusedOps;
+    UA_IOUringTx *unusedTx;
+    size_t unusedOpsSize;
+    size_t unusedTxSize;
+};
+
+#define UA_IOURING_MAXUNUSED 256
+
+static int
+uringSetup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int
+uringEnter(int fd, unsigned toSubmit) {
+    return (int)syscall(__NR_io_uring_enter, fd, toSubmit, 0, 0, NULL, 0);
+}
+
+static int
+uringRegister(int fd, unsigned opcode, void *arg, unsigned nrArgs) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs);
+}
+
+static void
+submitSqes(UA_IOUring *ring) {
+    __atomic_store_n(ring->sqTail, ring->sqLocalTail, __ATOMIC_RELEASE);
+    unsigned pending = ring->sqLocalTail -
+        __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+    if(pending == 0)
+        return;
+
+    int ret;
+    do {
+        ret = uringEnter(ring->rfd.fd, pending);
+    } while(ret < 0 && errno == EINTR);
+
+    /* With EBUSY/EAGAIN the remaining entries stay in the queue and are
+     * submitted with the next call */
+    if(ret < 0 && errno != EBUSY && errno != EAGAIN) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_WARNING(ring->pcm->cm.eventSource.eventLoop->logger,
+                          UA_LOGCATEGORY_NETWORK,
+                          "io_uring\t| Could not submit (%s)", errno_str));
+    }
+}
+
+static struct io_uring_sqe *
+getSqe(UA_IOUring *ring) {
+    unsigned head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+    if(ring->sqLocalTail - head >= ring->sqEntries) {
+        /* The queue is full. Submit to make room. */
+        submitSqes(ring);
+        head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+        if(ring->sqLocalTail - head >= ring->sqEntries)
+            return NULL;
+    }
+    unsigned index = ring->sqLocalTail & ring->sqMask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    ring->sqArray[index] = index;
+    ring->sqLocalTail++;
+    return sqe;
+}
+
+/* Hand the buffer back to the kernel */
+static void
+recycleBuffer(UA_IOUring *ring, UA_UInt16 bid) {
+    struct io_uring_buf *buf =
+        &ring->bufRing->bufs[ring->bufTail & (ring->bufCount - 1)];
+    buf->addr = (UA_UInt64)(uintptr_t)&ring->bufs[(size_t)bid * ring->bufSize];
+    buf->len = (UA_UInt32)ring->bufSize;
+    buf->bid = bid;
+    ring->bufTail++;
+    __atomic_store_n(&ring->bufRing->tail, ring->bufTail, __ATOMIC_RELEASE);
+}
+
+static UA_IOUringSend *
+newOp(UA_IOUring *ring) {
+    UA_IOUringSend *op = ring->unusedOps;
+    if(!op)
+        return (UA_IOUringSend*)UA_malloc(sizeof(UA_IOUringSend));
+    ring->unusedOps = op->next;
+    ring->unusedOpsSize--;
+    return op;
+}
+
+static void
+releaseOp(UA_IOUring *ring, UA_IOUringSend *op) {
+    if(ring->unusedOpsSize >= UA_IOURING_MAXUNUSED) {
+        UA_free(op);
+        return;
+    }
+    op->next = ring->unusedOps;
+    ring->unusedOps = op;
+    ring->unusedOpsSize++;
+}
+
+static void
+freeTx(UA_POSIXConnectionManager *pcm, UA_RegisteredFD *rfd, UA_IOUringTx *tx) {
+    UA_IOUring *ring = pcm->uring;
+    UA_EventLoopPOSIX_freeNetworkBuffer(&pcm->cm, (uintptr_t)rfd->fd, &tx->buf);
+    if(!ring || ring->unusedTxSize >= UA_IOURING_MAXUNUSED) {
+        UA_free(tx);
+        return;
+    }
+    tx->next = ring->unusedTx;
+    ring->unusedTx = tx;
+    ring->unusedTxSize++;
+}
+
+static void
+dropTx(UA_POSIXConnectionManager *pcm, UA_RegisteredFD *rfd) {
+    UA_IOUringTx *tx, *next;
+    for(tx = rfd->txHead; tx; tx = next) {
+        next = tx->next;
+        freeTx(pcm, rfd, tx);
+    }
+    rfd->txHead = NULL;
+    rfd->txTail = &rfd->txHead;
+}
+
+static void
+enqueueSend(UA_IOUring *ring, UA_RegisteredFD *rfd) {
+    if(rfd->uringQueued)
+        return;
+    rfd->uringQueued = true;
+    rfd->uringNext = ring->sendQueue;
+    ring->sendQueue = rfd;
+    rfd->uringOps++;
+}
+
+/* Gather the first buffers of the queue in one sendmsg */
+static UA_StatusCode
+submitStream(UA_IOUring *ring, UA_RegisteredFD *rfd) {
+    UA_IOUringSend *op = newOp(ring);
+    if(!op)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    struct io_uring_sqe *sqe = getSqe(ring);
+    if(!sqe) {
+        releaseOp(ring, op);
+        return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+    }
+    memset(op, 0, sizeof(UA_IOUringSend));
+
+    size_t iovSize = 0;
+    for(UA_IOUringTx *tx = rfd->txHead; tx && iovSize < UA_IOURING_MAXIOV;
+        tx = tx->next, iovSize++) {
+        op->iov[iovSize].iov_base = tx->buf.data + tx->sent;
+        op->iov[iovSize].iov_len = tx->buf.length - tx->sent;
+    }
+    op->rfd = rfd;
+    op->msg.msg_iov = op->iov;
+    op->msg.msg_iovlen = iovSize;
+
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = rfd->fd;
+    sqe->addr = (UA_UInt64)(uintptr_t)&op->msg;
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = (UA_UInt64)(uintptr_t)op | UA_IOURING_TAG_SEND;
+    rfd->uringSending = true;
+    rfd->uringOps++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Every datagram is sent with its own sendmsg */
+static UA_StatusCode
+submitDatagrams(UA_IOUring *ring, UA_RegisteredFD *rfd) {
+    while(rfd->txHead) {
+        UA_IOUringSend *op = newOp(ring);
+        if(!op)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        struct io_uring_sqe *sqe = getSqe(ring);
+        if(!sqe) {
+            releaseOp(ring, op);
+            return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+        }
+        memset(op, 0, sizeof(UA_IOUringSend));
+
+        UA_IOUringTx *tx = rfd->txHead;
+        rfd->txHead = tx->next;
+        if(!rfd->txHead)
+            rfd->txTail = &rfd->txHead;
+
+        op->rfd = rfd;
+        op->tx = tx;
+        op->iov[0].iov_base = tx->buf.data;
+        op->iov[0].iov_len = tx->buf.length;
+        op->msg.msg_name = (void*)(uintptr_t)tx->dest;
+        op->msg.msg_namelen = tx->destLength;
+        op->msg.msg_iov = op->iov;
+        op->msg.msg_iovlen = 1;
+
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = rfd->fd;
+        sqe->addr = (UA_UInt64)(uintptr_t)&op->msg;
+        sqe->len = 1;
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = (UA_UInt64)(uintptr_t)op | UA_IOURING_TAG_SEND;
+        rfd->uringOps++;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Submit the queued sends and everything else in the submission queue */
+static void
+flushRing(UA_IOUring *ring) {
+    while(ring->sendQueue) {
+        UA_RegisteredFD *rfd = ring->sendQueue;
+        ring->sendQueue = rfd->uringNext;
+        rfd->uringNext = NULL;
+        rfd->uringQueued = false;
+        rfd->uringOps--;
+
+        /* Closing. The buffers were dropped in _cancel. */
+        if(rfd->dc.callback)
+            continue;
+
+        UA_StatusCode res = (ring->datagram) ?
+            submitDatagrams(ring, rfd) : submitStream(ring, rfd);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING(ring->pcm->cm.eventSource.eventLoop->logger,
+                           UA_LOGCATEGORY_NETWORK,
+                           "io_uring %u\t| Could not submit the send (%s)",
+                           (unsigned)rfd->fd, UA_StatusCode_name(res));
+            if(!ring->datagram && !rfd->uringSending)
+                dropTx(ring->pcm, rfd);
+            ring->callback(ring->pcm, rfd, -ENOMEM, UA_BYTESTRING_NULL, NULL);
+        }
+    }
+    submitSqes(ring);
+}
+
+/* Submit right away or after processing the completions. The requests are
+ * submitted under the EventLoop lock from any thread. If the submitting thread
+ * exits, its pending requests are cancelled by the kernel and resubmitted when
+ * the cancellation completes. */
+static void
+kickRing(UA_IOUring *ring) {
+    if(!ring->processing)
+        flushRing(ring);
+}
+
+static void
+completeRecv(UA_IOUring *ring, UA_RegisteredFD *rfd, int res, unsigned flags) {
+    UA_POSIXConnectionManager *pcm = ring->pcm;
+    UA_Boolean closing = (rfd->dc.callback != NULL);
+
+    /* Forward the received data */
+    if(flags & IORING_CQE_F_BUFFER) {
+        UA_UInt16 bid = (UA_UInt16)(flags >> IORING_CQE_BUFFER_SHIFT);
+        UA_Byte *data = &ring->bufs[(size_t)bid * ring->bufSize];
+        if(res > 0 && !closing && !ring->datagram) {
+            UA_ByteString msg = {(size_t)res, data};
+            ring->callback(pcm, rfd, res, msg, NULL);
+        } else if(res > 0 && !closing) {
+            /* The buffer contains the recvmsg header, the source address and
+             * the payload */
+            struct io_uring_recvmsg_out *out = (struct io_uring_recvmsg_out*)data;
+            size_t offset = sizeof(struct io_uring_recvmsg_out) +
+                ring->recvMsg.msg_namelen + ring->recvMsg.msg_controllen;
+            if((size_t)res < offset || out->payloadlen > (size_t)res - offset) {
+                UA_LOG_WARNING(pcm->cm.eventSource.eventLoop->logger,
+                               UA_LOGCATEGORY_NETWORK,
+                               "io_uring %u\t| Discard a truncated datagram",
+                               (unsigned)rfd->fd);
+            } else {
+                struct sockaddr_storage source;
+                memset(&source, 0, sizeof(source));
+                size_t namelen = out->namelen;
+                if(namelen > sizeof(source))
+                    namelen = sizeof(source);
+                memcpy(&source, data + sizeof(struct io_uring_recvmsg_out), namelen);
+                UA_ByteString msg = {out->payloadlen, data + offset};
+                ring->callback(pcm, rfd, (int)out->payloadlen, msg,
+                               (struct sockaddr*)&source);
+            }
+        }
+        recycleBuffer(ring, bid);
+    }
+
+    /* The multishot receive continues */
+    if(flags & IORING_CQE_F_MORE)
+        return;
+
+    /* Rearm if the receive stopped for lack of buffers or was cancelled
+     * because the submitting thread exited. Otherwise signal the closed
+     * socket. */
+    closing = (rfd->dc.callback != NULL);
+    if(!closing) {
+        if(res > 0 || res == -ENOBUFS || res == -ECANCELED) {
+            if(UA_IOUring_recv(pcm, rfd) != UA_STATUSCODE_GOOD)
+                ring->callback(pcm, rfd, -ENOMEM, UA_BYTESTRING_NULL, NULL);
+        } else {
+            ring->callback(pcm, rfd, res, UA_BYTESTRING_NULL, NULL);
+        }
+    }
+    rfd->uringOps--;
+}
+
+static void
+completeSend(UA_IOUring *ring, UA_IOUringSend *op, int res) {
+    UA_POSIXConnectionManager *pcm = ring->pcm;
+    UA_RegisteredFD *rfd = op->rfd;
+
+    if(op->tx) {
+        /* Datagram */
+        freeTx(pcm, rfd, op->tx);
+    } else {
+        /* Stream. Remove the sent buffers from the queue. The last buffer can
+         * be sent partially. */
+        rfd->uringSending = false;
+        size_t sent = (res > 0) ? (size_t)res : 0;
+        while(sent > 0 && rfd->txHead) {
+            UA_IOUringTx *tx = rfd->txHead;
+            size_t remaining = tx->buf.length - tx->sent;
+            if(sent < remaining) {
+                tx->sent += sent;
+                break;
+            }
+            sent -= remaining;
+            rfd->txHead = tx->next;
+            if(!rfd->txHead)
+                rfd->txTail = &rfd->txHead;
+            freeTx(pcm, rfd, tx);
+        }
+    }
+    releaseOp(ring, op);
+
+    /* A stream send that was cancelled because the submitting thread exited
+     * is retried. A cancelled datagram is lost. */
+    UA_Boolean closing = (rfd->dc.callback != NULL);
+    if(!closing && res == -ECANCELED) {
+        if(!ring->datagram)
+            enqueueSend(ring, rfd);
+    } else if(closing || res < 0) {
+        if(!rfd->uringSending)
+            dropTx(pcm, rfd);
+        if(!closing) {
+            UA_LOG_WARNING(pcm->cm.eventSource.eventLoop->logger,
+                           UA_LOGCATEGORY_NETWORK,
+                           "io_uring %u\t| Send failed with error %s",
+                           (unsigned)rfd->fd, strerror(-res));
+            ring->callback(pcm, rfd, res, UA_BYTESTRING_NULL, NULL);
+        }
+    } else if(!ring->datagram && rfd->txHead) {
+        enqueueSend(ring, rfd); /* Continue with the next buffers */
+    }
+    rfd->uringOps--;
+}
+
+static void
+processCompletions(UA_IOUring *ring) {
+    /* Process a bounded number of completions. The ring fd stays readable if
+     * more completions are ready. The new requests from the callbacks are
+     * submitted in one go. Requests that complete right away during the
+     * submission (e.g. a rearmed receive with data already waiting) are
+     * processed in the same round. */
+    unsigned budget = ring->cqEntries;
+    unsigned head = *ring->cqHead;
+    unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+    while(head != tail && budget > 0) {
+        ring->processing = true;
+        for(; head != tail && budget > 0; budget--) {
+            struct io_uring_cqe *cqe = &ring->cqes[head & ring->cqMask];
+            UA_UInt64 userData = cqe->user_data;
+            int res = cqe->res;
+            unsigned flags = cqe->flags;
+            head++;
+            __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+
+            void *ptr = (void*)(uintptr_t)(userData & ~(UA_UInt64)UA_IOURING_TAG_MASK);
+            switch(userData & UA_IOURING_TAG_MASK) {
+            case UA_IOURING_TAG_RECV:
+                completeRecv(ring, (UA_RegisteredFD*)ptr, res, flags);
+                break;
+            case UA_IOURING_TAG_SEND:
+                completeSend(ring, (UA_IOUringSend*)ptr, res);
+                break;
+            default:
+                break; /* Ignored completion */
+            }
+
+            if(head == tail)
+                tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+        }
+        ring->processing = false;
+        flushRing(ring);
+        tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+    }
+}
+
+/* The ring fd signals that completions are ready */
+static void
+UA_IOUring_callback(UA_EventSource *es, UA_RegisteredFD *rfd, short event) {
+    UA_LOCK_ASSERT(&((UA_EventLoopPOSIX*)es->eventLoop)->elMutex);
+    processCompletions((UA_IOUring*)rfd);
+}
+
+static void
+freeRing(UA_IOUring *ring) {
+    while(ring->unusedOps) {
+        UA_IOUringSend *op = ring->unusedOps;
+        ring->unusedOps = op->next;
+        UA_free(op);
+    }
+    while(ring->unusedTx) {
+        UA_IOUringTx *tx = ring->unusedTx;
+        ring->unusedTx = tx->next;
+        UA_free(tx);
+    }
+    if(ring->bufRing)
+        munmap(ring->bufRing, ring->bufRingSize);
+    UA_free(ring->bufs);
+    if(ring->sqes)
+        munmap(ring->sqes, ring->sqesSize);
+    if(ring->ringMem)
+        munmap(ring->ringMem, ring->ringMemSize);
+    if(ring->rfd.fd != UA_INVALID_FD)
+        UA_close(ring->rfd.fd);
+    UA_free(ring);
+}
+
+static UA_UInt32
+getUInt32Param(UA_POSIXConnectionManager *pcm, const char *name,
+               UA_UInt32 defaultValue) {
+    const UA_UInt32 *val = (const UA_UInt32*)
+        UA_KeyValueMap_getScalar(&pcm->cm.eventSource.params,
+                                 UA_QUALIFIEDNAME(0, (char*)(uintptr_t)name),
+                                 &UA_TYPES[UA_TYPES_UINT32]);
+    return (val) ? *val : defaultValue;
+}
+
+UA_StatusCode
+UA_IOUring_start(UA_POSIXConnectionManager *pcm, UA_Boolean datagram,
+                 UA_IOUringCallback callback) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex);
+
+    UA_IOUring *ring = (UA_IOUring*)UA_calloc(1, sizeof(UA_IOUring));
+    if(!ring)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    ring->rfd.fd = UA_INVALID_FD;
+    ring->pcm = pcm;
+    ring->callback = callback;
+    ring->datagram = datagram;
+
+    /* Get the parameters. Stream sockets can receive in smaller pieces.
+     * Datagrams need to fit into a single buffer. */
+    UA_UInt32 ringSize = getUInt32Param(pcm, "ring-size", 256);
+    UA_UInt32 bufSize = getUInt32Param(pcm, "recv-bufsize", (datagram) ? 65536 : 16384);
+    UA_UInt32 bufCount = getUInt32Param(pcm, "recv-buffers", (datagram) ? 64 : 256);
+    if(bufCount > 32768)
+        bufCount = 32768;
+    UA_UInt32 pow2 = 1;
+    while(pow2 < bufCount)
+        pow2 <<= 1;
+    bufCount = pow2;
+    if(bufSize == 0 || ringSize == 0) {
+        UA_free(ring);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Set up the ring. The completion queue holds the results of the multishot
+     * receives for many sockets. */
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(struct io_uring_params));
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = ringSize * 4;
+    UA_RESET_ERRNO;
+    ring->rfd.fd = uringSetup(ringSize, &p);
+    if(ring->rfd.fd < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                          "io_uring\t| Could not set up the ring (%s)", errno_str));
+        ring->rfd.fd = UA_INVALID_FD;
+        goto error;
+    }
+    if(!(p.features & IORING_FEAT_SINGLE_MMAP) || !(p.features & IORING_FEAT_NODROP)) {
+        UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                       "io_uring\t| The kernel does not support the required features");
+        goto error;
+    }
+
+    /* Map the rings */
+    size_t sqSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    size_t cqSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    ring->ringMemSize = (sqSize > cqSize) ? sqSize : cqSize;
+    void *mem = mmap(NULL, ring->ringMemSize, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ring->rfd.fd, IORING_OFF_SQ_RING);
+    if(mem == MAP_FAILED)
+        goto error;
+    ring->ringMem = mem;
+    ring->sqesSize = p.sq_entries * sizeof(struct io_uring_sqe);
+    mem = mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, ring->rfd.fd, IORING_OFF_SQES);
+    if(mem == MAP_FAILED)
+        goto error;
+    ring->sqes = (struct io_uring_sqe*)mem;
+
+    UA_Byte *rm = (UA_Byte*)ring->ringMem;
+    ring->sqHead = (unsigned*)(rm + p.sq_off.head);
+    ring->sqTail = (unsigned*)(rm + p.sq_off.tail);
+    ring->sqArray = (unsigned*)(rm + p.sq_off.array);
+    ring->sqMask = *(unsigned*)(rm + p.sq_off.ring_mask);
+    ring->sqEntries = p.sq_entries;
+    ring->sqLocalTail = *ring->sqTail;
+    ring->cqHead = (unsigned*)(rm + p.cq_off.head);
+    ring->cqTail = (unsigned*)(rm + p.cq_off.tail);
+    ring->cqes = (struct io_uring_cqe*)(rm + p.cq_off.cqes);
+    ring->cqMask = *(unsigned*)(rm + p.cq_off.ring_mask);
+    ring->cqEntries = p.cq_entries;
+
+    /* Register the ring of provided receive buffers */
+    ring->bufSize = bufSize;
+    ring->bufCount = (UA_UInt16)bufCount;
+    ring->bufRingSize = bufCount * sizeof(struct io_uring_buf);
+    mem = mmap(NULL, ring->bufRingSize, PROT_READ | PROT_WRITE,
+               MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if(mem == MAP_FAILED)
+        goto error;
+    ring->bufRing = (struct io_uring_buf_ring*)mem;
+    ring->bufs = (UA_Byte*)UA_malloc((size_t)bufSize * bufCount);
+    if(!ring->bufs)
+        goto error;
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(struct io_uring_buf_reg));
+    reg.ring_addr = (UA_UInt64)(uintptr_t)ring->bufRing;
+    reg.ring_entries = bufCount;
+    reg.bgid = UA_IOURING_BUFGROUP;
+    UA_RESET_ERRNO;
+    if(uringRegister(ring->rfd.fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                          "io_uring\t| Could not register the receive "
+                          "buffers (%s)", errno_str));
+        goto error;
+    }
+    for(UA_UInt32 i = 0; i < bufCount; i++)
+        recycleBuffer(ring, (UA_UInt16)i);
+
+    /* Multishot recvmsg writes the source address into the buffer */
+    ring->recvMsg.msg_namelen = sizeof(struct sockaddr_storage);
+
+    /* Register the ring fd in the EventLoop */
+    ring->rfd.listenEvents = UA_FDEVENT_IN;
+    ring->rfd.es = &pcm->cm.eventSource;
+    ring->rfd.eventSourceCB = UA_IOUring_callback;
+    if(UA_EventLoopPOSIX_registerFD(el, &ring->rfd) != UA_STATUSCODE_GOOD)
+        goto error;
+
+    pcm->uring = ring;
+
+    UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                "io_uring %u\t| Ring with %u entries and %u receive "
+                "buffers of %u bytes", (unsigned)ring->rfd.fd,
+                (unsigned)ring->sqEntries, (unsigned)bufCount, (unsigned)bufSize);
+    return UA_STATUSCODE_GOOD;
+
+ error:
+    freeRing(ring);
+    return UA_STATUSCODE_BADINTERNALERROR;
+}
+
+void
+UA_IOUring_stop(UA_POSIXConnectionManager *pcm) {
+    UA_IOUring *ring = pcm->uring;
+    if(!ring)
+        return;
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex);
+    UA_assert(!ring->processing);
+    UA_assert(!ring->sendQueue);
+    UA_EventLoopPOSIX_deregisterFD(el, &ring->rfd);
+    pcm->uring = NULL;
+    freeRing(ring);
+}
+
+UA_StatusCode
+UA_IOUring_recv(UA_POSIXConnectionManager *pcm, UA_RegisteredFD *rfd) {
+    UA_IOUring *ring = pcm->uring;
+    if(!ring)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    struct io_uring_sqe *sqe = getSqe(ring);
+    if(!sqe)
+        return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+
+    if(!rfd->txTail)
+        rfd->txTail = &rfd->txHead;
+
+    if(ring->datagram) {
+        sqe->opcode = IORING_OP_RECVMSG;
+        sqe->addr = (UA_UInt64)(uintptr_t)&ring->recvMsg;
+        sqe->len = 1;
+    } else {
+        sqe->opcode = IORING_OP_RECV;
+    }
+    sqe->fd = rfd->fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = UA_IOURING_BUFGROUP;
+    sqe->user_data = (UA_UInt64)(uintptr_t)rfd | UA_IOURING_TAG_RECV;
+    rfd->uringOps++;
+
+    kickRing(ring);
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_IOUring_send(UA_POSIXConnectionManager *pcm, UA_RegisteredFD *rfd,
+                UA_ByteString *buf, const struct sockaddr *dest,
+                socklen_t destLength) {
+    UA_IOUring *ring = pcm->uring;
+    if(!ring || rfd->dc.callback) {
+        UA_EventLoopPOSIX_freeNetworkBuffer(&pcm->cm, (uintptr_t)rfd->fd, buf);
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+    }
+
+    UA_IOUringTx *tx = ring->unusedTx;
+    if(tx) {
+        ring->unusedTx = tx->next;
+        ring->unusedTxSize--;
+    } else {
+        tx = (UA_IOUringTx*)UA_malloc(sizeof(UA_IOUringTx));
+    }
+    if(!tx) {
+        UA_EventLoopPOSIX_freeNetworkBuffer(&pcm->cm, (uintptr_t)rfd->fd, buf);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    tx->next = NULL;
+    tx->buf = *buf;
+    tx->sent = 0;
+    tx->dest = dest;
+    tx->destLength = destLength;
+    UA_ByteString_init(buf);
+
+    if(!rfd->txTail)
+        rfd->txTail = &rfd->txHead;
+    *rfd->txTail = tx;
+    rfd->txTail = &tx->next;
+
+    /* Streams wait for the send in flight to complete */
+    if(ring->datagram || !rfd->uringSending)
+        enqueueSend(ring, rfd);
+
+    kickRing(ring);
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_IOUring_cancel(UA_POSIXConnectionManager *pcm, UA_RegisteredFD *rfd) {
+    UA_IOUring *ring = pcm->uring;
+    if(!ring)
+        return;
+
+    /* Drop the buffers that are not in flight */
+    if(!rfd->uringSending)
+        dropTx(pcm, rfd);
+
+    /* Cancel all operations on the socket */
+    struct io_uring_sqe *sqe = getSqe(ring);
+    if(sqe) {
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = rfd->fd;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+        sqe->user_data = 0;
+    }
+
+    /* Cancelling a pending receive completes during the submission. Process
+     * the completions right away so that the socket can be closed in the same
+     * EventLoop iteration. */
+    if(!ring->processing) {
+        flushRing(ring);
+        processCompletions(ring);
+    }
+}
+
+#endif /* UA_HAVE_IOURING */
@@ -19,19 +19,21 @@ static UA_KeyValueRestriction tcpManagerParams[TCP_MANAGERPARAMS] = {
     {{0, UA_STRING_STATIC("send-bufsize")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false}
 };
 
-#define TCP_PARAMETERSSIZE 5
+#define TCP_PARAMETERSSIZE 6
 #define TCP_PARAMINDEX_ADDR 0
 #define TCP_PARAMINDEX_PORT 1
 #define TCP_PARAMINDEX_LISTEN 2
 #define TCP_PARAMINDEX_VALIDATE 3
 #define TCP_PARAMINDEX_REUSE 4
+#define TCP_PARAMINDEX_WORKERS 5
 
 static UA_KeyValueRestriction tcpConnectionParams[TCP_PARAMETERSSIZE] = {
     {{0, UA_STRING_STATIC("address")}, &UA_TYPES[UA_TYPES_STRING], false, true, true},
     {{0, UA_STRING_STATIC("port")}, &UA_TYPES[UA_TYPES_UINT16], true, true, false},
     {{0, UA_STRING_STATIC("listen")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
     {{0, UA_STRING_STATIC("validate")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
-    {{0, UA_STRING_STATIC("reuse")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false}
+    {{0, UA_STRING_STATIC("reuse")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
+    {{0, UA_STRING_STATIC("workers")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false}
 };
 
 typedef struct {
@@ -40,6 +42,12 @@ typedef struct {
     UA_ConnectionManager_connectionCallback applicationCB;
     void *application;
     void *context;
+
+    UA_Boolean workers; /* Listen socket: Accepted connections use the
+                         * worker threads of the EventLoop */
+#ifdef UA_HAVE_IOURING
+    UA_Boolean uring; /* Receives and sends via the io_uring */
+#endif
 } TCP_FD;
 
 static void
@@ -64,30 +72,19 @@ TCP_checkStopped(UA_POSIXConnectionManager *pcm) {
        pcm->cm.eventSource.state == UA_EVENTSOURCESTATE_STOPPING) {
         UA_LOG_DEBUG(pcm->cm.eventSource.eventLoop->logger, UA_LOGCATEGORY_NETWORK,
                      "TCP\t| All sockets closed, the EventLoop has stopped");
+#ifdef UA_HAVE_IOURING
+        UA_IOUring_stop(pcm);
+#endif
         pcm->cm.eventSource.state = UA_EVENTSOURCESTATE_STOPPED;
     }
 }
 
+/* Close the connection once it is deregistered and released */
 static void
-TCP_delayedClose(void *application, void *context) {
-    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)application;
+TCP_close(UA_POSIXConnectionManager *pcm, TCP_FD *conn) {
     UA_ConnectionManager *cm = &pcm->cm;
     UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
-    TCP_FD *conn = (TCP_FD*)context;
-
-    UA_LOCK(&el->elMutex);
-
-    UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
-                 "TCP %u\t| Delayed closing of the connection",
-                 (unsigned)conn->rfd.fd);
-
-    /* Ensure reuse is possible right away. Port-stealing is no longer an issue
-     * as the socket gets closed anyway. And we do not want to wait for the
-     * timeout to open a new socket for the same address and port. */
-    UA_EventLoopPOSIX_setReusable(conn->rfd.fd);
-
-    /* Deregister from the EventLoop */
-    UA_EventLoopPOSIX_deregisterFD(el, &conn->rfd);
+    UA_LOCK_ASSERT(&el->elMutex);
 
     /* Deregister internally */
     ZIP_REMOVE(UA_FDTree, &pcm->fds, &conn->rfd);
@@ -117,6 +114,67 @@ TCP_delayedClose(void *application, void *context) {
 
     /* Check if this was the last connection for a closing ConnectionManager */
     TCP_checkStopped(pcm);
+}
+
+/* Not used by a worker thread or by pending io_uring operations */
+static UA_Boolean
+TCP_released(UA_EventLoopPOSIX *el, TCP_FD *conn) {
+#ifdef UA_HAVE_IOURING
+    if(conn->uring)
+        return UA_IOUring_released(&conn->rfd);
+#endif
+    return UA_EventLoopPOSIX_releasedFD(el, &conn->rfd);
+}
+
+/* A worker thread or the io_uring might still use the deregistered connection.
+ * Wait until it is released. */
+static void
+TCP_delayedRelease(void *application, void *context) {
+    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)application;
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    TCP_FD *conn = (TCP_FD*)context;
+
+    UA_LOCK(&el->elMutex);
+    if(TCP_released(el, conn))
+        TCP_close(pcm, conn);
+    else
+        UA_EventLoopPOSIX_addDelayedCallback((UA_EventLoop*)el, &conn->rfd.dc);
+    UA_UNLOCK(&el->elMutex);
+}
+
+static void
+TCP_delayedClose(void *application, void *context) {
+    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)application;
+    UA_ConnectionManager *cm = &pcm->cm;
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    TCP_FD *conn = (TCP_FD*)context;
+
+    UA_LOCK(&el->elMutex);
+
+    UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                 "TCP %u\t| Delayed closing of the connection",
+                 (unsigned)conn->rfd.fd);
+
+    /* Ensure reuse is possible right away. Port-stealing is no longer an issue
+     * as the socket gets closed anyway. And we do not want to wait for the
+     * timeout to open a new socket for the same address and port. */
+    UA_EventLoopPOSIX_setReusable(conn->rfd.fd);
+
+    /* Deregister from the EventLoop. Or cancel the io_uring operations. */
+#ifdef UA_HAVE_IOURING
+    if(conn->uring)
+        UA_IOUring_cancel(pcm, &conn->rfd);
+    else
+#endif
+    UA_EventLoopPOSIX_deregisterFD(el, &conn->rfd);
+
+    /* Close right away or wait for the fd to be released */
+    if(TCP_released(el, conn)) {
+        TCP_close(pcm, conn);
+    } else {
+        conn->rfd.dc.callback = TCP_delayedRelease;
+        UA_EventLoopPOSIX_addDelayedCallback((UA_EventLoop*)el, &conn->rfd.dc);
+    }
 
     UA_UNLOCK(&el->elMutex);
 }
@@ -135,12 +193,22 @@ getSockError(TCP_FD *conn) {
     return (err == 0) ? error : err;
 }
 
-/* Gets called when a connection socket opens, receives data or closes */
+/* Shutdown from the connection callback. Which can run in a worker thread
+ * without the EventLoop lock. */
+static void
+TCP_shutdownLocked(UA_ConnectionManager *cm, TCP_FD *conn) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    UA_LOCK(&el->elMutex);
+    TCP_shutdown(cm, conn);
+    UA_UNLOCK(&el->elMutex);
+}
+
+/* Gets called when a connection socket opens, receives data or closes. Called
+ * without the EventLoop lock for connections of a worker thread. */
 static void
 TCP_connectionSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn,
                              short event) {
     UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
-    UA_LOCK_ASSERT(&el->elMutex);
 
     UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
                  "TCP %u\t| Activity on the socket",
@@ -151,7 +219,7 @@ TCP_connectionSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn,
         UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
                     "TCP %u\t| The connection closes with error %i",
                     (unsigned)conn->rfd.fd, getSockError(conn));
-        TCP_shutdown(cm, conn);
+        TCP_shutdownLocked(cm, conn);
         return;
     }
 
@@ -165,7 +233,7 @@ TCP_connectionSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn,
             UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
                         "TCP %u\t| The connection closes with error %i",
                         (unsigned)conn->rfd.fd, error);
-            TCP_shutdown(cm, conn);
+            TCP_shutdownLocked(cm, conn);
             return;
         }
 
@@ -173,9 +241,23 @@ TCP_connectionSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn,
                      "TCP %u\t| Opening a new connection",
                      (unsigned)conn->rfd.fd);
 
-        /* Now we are interested in read-events. */
-        conn->rfd.listenEvents = UA_FDEVENT_IN;
-        UA_EventLoopPOSIX_modifyFD(el, &conn->rfd);
+        /* Now we are interested in read-events. With io_uring the socket
+         * receives via the ring from now on. */
+#ifdef UA_HAVE_IOURING
+        UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
+        if(pcm->uring) {
+            UA_EventLoopPOSIX_deregisterFD(el, &conn->rfd);
+            conn->uring = true;
+            if(UA_IOUring_recv(pcm, &conn->rfd) != UA_STATUSCODE_GOOD) {
+                TCP_shutdown(cm, conn);
+                return;
+            }
+        } else
+#endif
+        {
+            conn->rfd.listenEvents = UA_FDEVENT_IN;
+            UA_EventLoopPOSIX_modifyFD(el, &conn->rfd);
+        }
 
         /* A new socket has opened. Signal it to the application. */
         conn->applicationCB(cm, (uintptr_t)conn->rfd.fd,
@@ -189,9 +271,14 @@ TCP_connectionSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn,
                  "TCP %u\t| Allocate receive buffer",
                  (unsigned)conn->rfd.fd);
 
-    /* Use the already allocated receive-buffer */
+    /* Use the already allocated receive-buffer. Worker threads have their own
+     * receive-buffer. */
     UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
     UA_ByteString response = pcm->rxBuffer;
+    UA_ByteString *workerBuffer =
+        UA_EventLoopPOSIX_getWorkerBuffer(pcm->rxBuffer.length);
+    if(workerBuffer)
+        response = *workerBuffer;
 
     /* Receive */
     UA_RESET_ERRNO;
@@ -215,7 +302,7 @@ TCP_connectionSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn,
            UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
                         "TCP %u\t| recv signaled the socket was shutdown (%s)",
                         (unsigned)conn->rfd.fd, errno_str));
-        TCP_shutdown(cm, conn);
+        TCP_shutdownLocked(cm, conn);
         return;
     }
 
@@ -231,6 +318,39 @@ TCP_connectionSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn,
                         &UA_KEYVALUEMAP_NULL, response);
 }
 
+#ifdef UA_HAVE_IOURING
+/* Gets called from the io_uring when the connection receives data or closes */
+static void
+TCP_uringCallback(UA_POSIXConnectionManager *pcm, UA_RegisteredFD *rfd,
+                  int res, UA_ByteString msg, const struct sockaddr *source) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    TCP_FD *conn = (TCP_FD*)rfd;
+
+    if(res <= 0) {
+        if(res == 0) {
+            UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                         "TCP %u\t| recv signaled the socket was shutdown",
+                         (unsigned)rfd->fd);
+        } else {
+            UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                        "TCP %u\t| The connection closes with error %s",
+                        (unsigned)rfd->fd, strerror(-res));
+        }
+        TCP_shutdown(&pcm->cm, conn);
+        return;
+    }
+
+    UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                 "TCP %u\t| Received message of size %u",
+                 (unsigned)rfd->fd, (unsigned)msg.length);
+
+    conn->applicationCB(&pcm->cm, (uintptr_t)rfd->fd,
+                        conn->application, &conn->context,
+                        UA_CONNECTIONSTATE_ESTABLISHED,
+                        &UA_KEYVALUEMAP_NULL, msg);
+}
+#endif
+
 /* Gets called when a new connection opens or if the listenSocket is closed */
 static void
 TCP_listenSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn, short event) {
@@ -314,8 +434,20 @@ TCP_listenSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn, short event) {
     newConn->application = conn->application;
     newConn->context = conn->context;
 
-    /* Register in the EventLoop. Signal to the user if registering failed. */
-    res = UA_EventLoopPOSIX_registerFD(el, &newConn->rfd);
+    /* Register in the EventLoop (or receive via the io_uring). Signal to the
+     * user if registering failed. */
+    UA_Boolean workers = conn->workers;
+#ifdef UA_HAVE_IOURING
+    if(pcm->uring) {
+        newConn->uring = true;
+        workers = false;
+        res = UA_IOUring_recv(pcm, &newConn->rfd);
+    } else
+#endif
+    if(workers)
+        res = UA_EventLoopPOSIX_registerWorkerFD(el, &newConn->rfd);
+    else
+        res = UA_EventLoopPOSIX_registerFD(el, &newConn->rfd);
     if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
                        "TCP %u\t| Error registering the socket",
@@ -344,6 +476,11 @@ TCP_listenSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn, short event) {
                            newConn->application, &newConn->context,
                            UA_CONNECTIONSTATE_ESTABLISHED,
                            &kvm, UA_BYTESTRING_NULL);
+
+    /* Arm the socket in the worker thread after the application has set up the
+     * connection context */
+    if(workers && !newConn->rfd.dc.callback)
+        UA_EventLoopPOSIX_modifyFD(el, &newConn->rfd);
 }
 
 static UA_StatusCode
@@ -351,7 +488,8 @@ TCP_registerListenSocket(UA_POSIXConnectionManager *pcm, struct addrinfo *ai,
                          const char *hostname, UA_UInt16 port,
                          void *application, void *context,
                          UA_ConnectionManager_connectionCallback connectionCallback,
-                         UA_Boolean validate, UA_Boolean reuseaddr) {
+                         UA_Boolean validate, UA_Boolean reuseaddr,
+                         UA_Boolean workers) {
     UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
     UA_LOCK_ASSERT(&el->elMutex);
 
@@ -503,6 +641,7 @@ TCP_registerListenSocket(UA_POSIXConnectionManager *pcm, struct addrinfo *ai,
     newConn->applicationCB = connectionCallback;
     newConn->application = application;
     newConn->context = context;
+    newConn->workers = workers;
 
     /* Register in the EventLoop */
     UA_StatusCode res = UA_EventLoopPOSIX_registerFD(el, &newConn->rfd);
@@ -542,7 +681,8 @@ static UA_StatusCode
 TCP_registerListenSockets(UA_POSIXConnectionManager *pcm, const char *hostname,
                           UA_UInt16 port, void *application, void *context,
                           UA_ConnectionManager_connectionCallback connectionCallback,
-                          UA_Boolean validate, UA_Boolean reuseaddr) {
+                          UA_Boolean validate, UA_Boolean reuseaddr,
+                          UA_Boolean workers) {
     UA_LOCK_ASSERT(&((UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop)->elMutex);
 
     /* Create a string for the port */
@@ -577,7 +717,8 @@ TCP_registerListenSockets(UA_POSIXConnectionManager *pcm, const char *hostname,
     struct addrinfo *ai = res;
     while(ai) {
         total_result &= TCP_registerListenSocket(pcm, ai, hostname, port, application, context,
-                                                 connectionCallback, validate, reuseaddr);
+                                                 connectionCallback, validate, reuseaddr,
+                                                 workers);
         ai = ai->ai_next;
     }
     UA_freeaddrinfo(res);
@@ -639,9 +780,40 @@ TCP_shutdownConnection(UA_ConnectionManager *cm, uintptr_t connectionId) {
     return UA_STATUSCODE_GOOD;
 }
 
+#ifdef UA_HAVE_IOURING
+/* Queue the buffer in the io_uring. Returns UA_STATUSCODE_BADNOTSUPPORTED if
+ * the connection does not use the io_uring (e.g. while connecting). */
+static UA_StatusCode
+TCP_sendWithRing(UA_ConnectionManager *cm, uintptr_t connectionId,
+                 UA_ByteString *buf) {
+    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    UA_LOCK(&el->elMutex);
+    UA_FD fd = (UA_FD)connectionId;
+    TCP_FD *conn = (TCP_FD*)ZIP_FIND(UA_FDTree, &pcm->fds, &fd);
+    UA_StatusCode res = UA_STATUSCODE_BADNOTSUPPORTED;
+    if(!conn) {
+        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+        res = UA_STATUSCODE_BADCONNECTIONCLOSED;
+    } else if(conn->uring) {
+        res = UA_IOUring_send(pcm, &conn->rfd, buf, NULL, 0);
+    }
+    UA_UNLOCK(&el->elMutex);
+    return res;
+}
+#endif
+
 static UA_StatusCode
 TCP_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                        const UA_KeyValueMap *params, UA_ByteString *buf) {
+#ifdef UA_HAVE_IOURING
+    if(((UA_POSIXConnectionManager*)cm)->uring) {
+        UA_StatusCode res = TCP_sendWithRing(cm, connectionId, buf);
+        if(res != UA_STATUSCODE_BADNOTSUPPORTED)
+            return res;
+    }
+#endif
+
     /* We may not have a lock. But we need not take it. As the connectionId is
      * the fd, no need to do a lookup and access internal data strucures. */
 
@@ -699,6 +871,115 @@ TCP_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
     return UA_STATUSCODE_BADCONNECTIONCLOSED;
 }
 
+#ifndef UA_ARCHITECTURE_WIN32
+
+#define TCP_MAXIOV 8
+
+/* Merge the buffers and send them as one. Used if the borrowed buffers might
+ * still be referenced after the call returns. */
+static UA_StatusCode
+TCP_sendMerged(UA_ConnectionManager *cm, uintptr_t connectionId,
+               const UA_KeyValueMap *params, UA_ByteString *bufs,
+               size_t bufsSize) {
+    size_t total = 0;
+    for(size_t i = 0; i < bufsSize; i++)
+        total += bufs[i].length;
+    UA_ByteString buf;
+    UA_StatusCode res = UA_ByteString_allocBuffer(&buf, total);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, &bufs[0]);
+        return res;
+    }
+    size_t pos = 0;
+    for(size_t i = 0; i < bufsSize; i++) {
+        memcpy(&buf.data[pos], bufs[i].data, bufs[i].length);
+        pos += bufs[i].length;
+    }
+    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, &bufs[0]);
+    return TCP_sendWithConnection(cm, connectionId, params, &buf);
+}
+
+static UA_StatusCode
+TCP_sendWithConnectionVec(UA_ConnectionManager *cm, uintptr_t connectionId,
+                          const UA_KeyValueMap *params, UA_ByteString *bufs,
+                          size_t bufsSize) {
+    if(bufsSize == 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    /* Sends via the io_uring complete asynchronously */
+#ifdef UA_HAVE_IOURING
+    if(((UA_POSIXConnectionManager*)cm)->uring)
+        return TCP_sendMerged(cm, connectionId, params, bufs, bufsSize);
+#endif
+    if(bufsSize > TCP_MAXIOV)
+        return TCP_sendMerged(cm, connectionId, params, bufs, bufsSize);
+
+    struct iovec iov[TCP_MAXIOV];
+    for(size_t i = 0; i < bufsSize; i++) {
+        iov[i].iov_base = bufs[i].data;
+        iov[i].iov_len = bufs[i].length;
+    }
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(struct msghdr));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = bufsSize;
+
+    struct pollfd tmp_poll_fd;
+    tmp_poll_fd.fd = (UA_FD)connectionId;
+    tmp_poll_fd.events = UA_POLLOUT;
+
+    /* Send all buffers. Advance the iovecs after a partial write. */
+    while(msg.msg_iovlen > 0) {
+        UA_RESET_ERRNO;
+        ssize_t n = sendmsg((UA_FD)connectionId, &msg, MSG_NOSIGNAL);
+        if(n < 0) {
+            /* An error we cannot recover from? */
+            if(UA_ERRNO != UA_INTERRUPTED && UA_ERRNO != UA_WOULDBLOCK &&
+               UA_ERRNO != UA_AGAIN)
+                goto shutdown;
+
+            /* Poll for the socket resources to become available and retry
+             * (blocking) */
+            int poll_ret;
+            do {
+                UA_RESET_ERRNO;
+                poll_ret = UA_poll(&tmp_poll_fd, 1, 100);
+                if(poll_ret < 0 && UA_ERRNO != UA_INTERRUPTED)
+                    goto shutdown;
+            } while(poll_ret <= 0);
+            continue;
+        }
+
+        size_t written = (size_t)n;
+        while(msg.msg_iovlen > 0 && written >= msg.msg_iov->iov_len) {
+            written -= msg.msg_iov->iov_len;
+            msg.msg_iov++;
+            msg.msg_iovlen--;
+        }
+        if(msg.msg_iovlen > 0) {
+            msg.msg_iov->iov_base = (char*)msg.msg_iov->iov_base + written;
+            msg.msg_iov->iov_len -= written;
+        }
+    }
+
+    /* Clean up and return */
+    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, &bufs[0]);
+    return UA_STATUSCODE_GOOD;
+
+ shutdown:
+    /* Error -> shutdown the connection  */
+    UA_LOG_SOCKET_ERRNO_WRAP(
+       UA_LOG_ERROR(cm->eventSource.eventLoop->logger, UA_LOGCATEGORY_NETWORK,
+                    "TCP %u\t| Send failed with error %s",
+                    (unsigned)connectionId, errno_str));
+    TCP_shutdownConnection(cm, connectionId);
+    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, &bufs[0]);
+    return UA_STATUSCODE_BADCONNECTIONCLOSED;
+}
+
+#endif
+
 /* Create a listen-socket that waits for incoming connections */
 static UA_StatusCode
 TCP_openPassiveConnection(UA_POSIXConnectionManager *pcm, const UA_KeyValueMap *params,
@@ -734,12 +1015,21 @@ TCP_openPassiveConnection(UA_POSIXConnectionManager *pcm, const UA_KeyValueMap *
     if(reuseaddrTmp)
         reuseaddr = *reuseaddrTmp;
 
+    /* Get the workers parameter */
+    UA_Boolean workers = false;
+    const UA_Boolean *workersTmp = (const UA_Boolean*)
+        UA_KeyValueMap_getScalar(params, tcpConnectionParams[TCP_PARAMINDEX_WORKERS].name,
+                                 &UA_TYPES[UA_TYPES_BOOLEAN]);
+    if(workersTmp)
+        workers = *workersTmp;
+
     /* Undefined or empty addresses array -> listen on all interfaces */
     if(addrsSize == 0) {
         UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
                     "TCP\t| Listening on all interfaces");
         return TCP_registerListenSockets(pcm, NULL, *port, application,
-                                         context, connectionCallback, validate, reuseaddr);
+                                         context, connectionCallback, validate,
+                                         reuseaddr, workers);
     }
 
     /* Iterate over the configured hostnames */
@@ -752,7 +1042,8 @@ TCP_openPassiveConnection(UA_POSIXConnectionManager *pcm, const UA_KeyValueMap *
         memcpy(hostname, hostStrings[i].data, hostStrings->length);
         hostname[hostStrings->length] = '\0';
         if(TCP_registerListenSockets(pcm, hostname, *port, application,
-                                     context, connectionCallback, validate, reuseaddr) == UA_STATUSCODE_GOOD)
+                                     context, connectionCallback, validate,
+                                     reuseaddr, workers) == UA_STATUSCODE_GOOD)
             retval = UA_STATUSCODE_GOOD;
     }
     return retval;
@@ -996,6 +1287,21 @@ TCP_eventSourceStart(UA_ConnectionManager *cm) {
     if(res != UA_STATUSCODE_GOOD)
         goto finish;
 
+    /* Set up the io_uring. Fall back to polling the sockets in the EventLoop
+     * if the kernel does not support it. The io_uring sends asynchronously.
+     * So every send needs its own buffer. */
+#ifdef UA_HAVE_IOURING
+    if(pcm->useUring) {
+        if(UA_IOUring_start(pcm, false, TCP_uringCallback) == UA_STATUSCODE_GOOD) {
+            UA_ByteString_clear(&pcm->txBuffer);
+        } else {
+            UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                           "TCP\t| Could not set up the io_uring, "
+                           "polling the sockets instead");
+        }
+    }
+#endif
+
     /* Set the EventSource to the started state */
     cm->eventSource.state = UA_EVENTSOURCESTATE_STARTED;
 
@@ -1071,8 +1377,22 @@ UA_ConnectionManager_new_POSIX_TCP(const UA_String eventSourceName) {
     cm->cm.allocNetworkBuffer = UA_EventLoopPOSIX_allocNetworkBuffer;
     cm->cm.freeNetworkBuffer = UA_EventLoopPOSIX_freeNetworkBuffer;
     cm->cm.sendWithConnection = TCP_sendWithConnection;
+#ifndef UA_ARCHITECTURE_WIN32
+    cm->cm.sendWithConnectionVec = TCP_sendWithConnectionVec;
+#endif
     cm->cm.closeConnection = TCP_shutdownConnection;
     return &cm->cm;
 }
 
+#ifdef UA_HAVE_IOURING
+UA_ConnectionManager *
+UA_ConnectionManager_new_IOURING_TCP(const UA_String eventSourceName) {
+    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)
+        UA_ConnectionManager_new_POSIX_TCP(eventSourceName);
+    if(pcm)
+        pcm->useUring = true;
+    return (UA_ConnectionManager*)pcm;
+}
+#endif
+
 #endif
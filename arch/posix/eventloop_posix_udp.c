@@ -19,14 +19,15 @@
 
 /* Configuration parameters */
 
-#define UDP_MANAGERPARAMS 2
+#define UDP_MANAGERPARAMS 3
 
 static UA_KeyValueRestriction udpManagerParams[UDP_MANAGERPARAMS] = {
     {{0, UA_STRING_STATIC("recv-bufsize")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false},
-    {{0, UA_STRING_STATIC("send-bufsize")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false}
+    {{0, UA_STRING_STATIC("send-bufsize")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false},
+    {{0, UA_STRING_STATIC("recv-batch")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false}
 };
 
-#define UDP_PARAMETERSSIZE 9
+#define UDP_PARAMETERSSIZE 10
 #define UDP_PARAMINDEX_LISTEN 0
 #define UDP_PARAMINDEX_ADDR 1
 #define UDP_PARAMINDEX_PORT 2
@@ -36,6 +37,7 @@ static UA_KeyValueRestriction udpManagerParams[UDP_MANAGERPARAMS] = {
 #define UDP_PARAMINDEX_REUSE 6
 #define UDP_PARAMINDEX_SOCKPRIO 7
 #define UDP_PARAMINDEX_VALIDATE 8
+#define UDP_PARAMINDEX_BATCH 9
 
 static UA_KeyValueRestriction udpConnectionParams[UDP_PARAMETERSSIZE] = {
     {{0, UA_STRING_STATIC("listen")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
@@ -46,9 +48,17 @@ static UA_KeyValueRestriction udpConnectionParams[UDP_PARAMETERSSIZE] = {
     {{0, UA_STRING_STATIC("loopback")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
     {{0, UA_STRING_STATIC("reuse")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
     {{0, UA_STRING_STATIC("sockpriority")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false},
-    {{0, UA_STRING_STATIC("validate")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false}
+    {{0, UA_STRING_STATIC("validate")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
+    {{0, UA_STRING_STATIC("batch")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false}
 };
 
+#ifdef UA_HAVE_MMSG
+#define UDP_MAXBATCH 32          /* Datagrams per sendmmsg/recvmmsg call */
+#define UDP_MAXPAYLOAD 65507     /* Largest UDP payload (IPv4) */
+#define UDP_MAXGSOSEGMENTS 64    /* Datagrams per GSO "super-datagram" */
+#define UDP_MAXGSOSEGMENTSIZE 1452 /* Fits into an Ethernet frame (also IPv6) */
+#endif
+
 /* A registered file descriptor with an additional method pointer */
 typedef struct {
     UA_RegisteredFD rfd;
@@ -63,6 +73,25 @@ typedef struct {
 #else
     socklen_t sendAddrLength;
 #endif
+
+#ifdef UA_HAVE_IOURING
+    UA_Boolean uring; /* Receives and sends via the io_uring */
+#endif
+
+#ifdef UA_HAVE_MMSG
+    /* With the "batch" parameter, messages are queued and sent together with
+     * one sendmmsg from a delayed callback at the end of the EventLoop
+     * iteration. With GSO, consecutive messages of the same size are sent as
+     * a single "super-datagram" that is segmented by the kernel. */
+    UA_Boolean batch;
+    UA_Boolean gso;
+    UA_Boolean gro; /* Received datagrams can be coalesced by the kernel */
+    UA_Boolean sendScheduled; /* The sendDC is in the delayed queue */
+    UA_Boolean closed; /* Freed in the sendDC */
+    UA_DelayedCallback sendDC;
+    UA_ByteString *sendQueue; /* Array of UDP_MAXBATCH entries */
+    size_t sendQueueSize;
+#endif
 } UDP_FD;
 
 typedef enum {
@@ -583,6 +612,13 @@ setupSendMultiCast(UA_FD fd, struct addrinfo *info, const UA_KeyValueMap *params
     return UA_STATUSCODE_GOOD;
 }
 
+static void
+UDP_deliver(UA_POSIXConnectionManager *pcm, UDP_FD *conn,
+            const struct sockaddr *source, UA_ByteString msg);
+
+static void
+UDP_shutdown(UA_ConnectionManager *cm, UA_RegisteredFD *rfd);
+
 /* Test if the ConnectionManager can be stopped */
 static void
 UDP_checkStopped(UA_POSIXConnectionManager *pcm) {
@@ -592,10 +628,24 @@ UDP_checkStopped(UA_POSIXConnectionManager *pcm) {
        pcm->cm.eventSource.state == UA_EVENTSOURCESTATE_STOPPING) {
         UA_LOG_DEBUG(pcm->cm.eventSource.eventLoop->logger, UA_LOGCATEGORY_NETWORK,
                      "UDP\t| All sockets closed, the EventLoop has stopped");
+#ifdef UA_HAVE_IOURING
+        UA_IOUring_stop(pcm);
+#endif
         pcm->cm.eventSource.state = UA_EVENTSOURCESTATE_STOPPED;
     }
 }
 
+#ifdef UA_HAVE_MMSG
+static void
+UDP_clearSendQueue(UA_POSIXConnectionManager *pcm, UDP_FD *conn) {
+    for(size_t i = 0; i < conn->sendQueueSize; i++)
+        UA_EventLoopPOSIX_freeNetworkBuffer(&pcm->cm, (uintptr_t)conn->rfd.fd,
+                                            &conn->sendQueue[i]);
+    conn->sendQueueSize = 0;
+}
+
+#endif
+
 /* This method must not be called from the application directly, but from within
  * the EventLoop. Otherwise we cannot be sure whether the file descriptor is
  * still used after calling close. */
@@ -609,6 +659,9 @@ UDP_close(UA_POSIXConnectionManager *pcm, UDP_FD *conn) {
                  (unsigned)conn->rfd.fd);
 
     /* Deregister from the EventLoop */
+#ifdef UA_HAVE_IOURING
+    if(!conn->uring)
+#endif
     UA_EventLoopPOSIX_deregisterFD(el, &conn->rfd);
 
     /* Deregister internally */
@@ -622,6 +675,11 @@ UDP_close(UA_POSIXConnectionManager *pcm, UDP_FD *conn) {
                         UA_CONNECTIONSTATE_CLOSING,
                         &UA_KEYVALUEMAP_NULL, UA_BYTESTRING_NULL);
 
+    /* Drop the messages that were not sent */
+#ifdef UA_HAVE_MMSG
+    UDP_clearSendQueue(pcm, conn);
+#endif
+
     /* Close the socket */
     UA_RESET_ERRNO;
     int ret = UA_close(conn->rfd.fd);
@@ -635,12 +693,36 @@ UDP_close(UA_POSIXConnectionManager *pcm, UDP_FD *conn) {
                           (unsigned)conn->rfd.fd, errno_str));
     }
 
+    /* Free the connection in the pending delayed send callback if required */
+#ifdef UA_HAVE_MMSG
+    if(conn->sendScheduled)
+        conn->closed = true;
+    else
+        UA_free(conn->sendQueue);
+    if(!conn->closed)
+#endif
     UA_free(conn);
 
     /* Stop if the ucm is stopping and this was the last open socket */
     UDP_checkStopped(pcm);
 }
 
+#ifdef UA_HAVE_IOURING
+/* Wait until the io_uring operations of the socket have completed */
+static void
+UDP_delayedRelease(void *application, void *context) {
+    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)application;
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    UDP_FD *conn = (UDP_FD*)context;
+    UA_LOCK(&el->elMutex);
+    if(UA_IOUring_released(&conn->rfd))
+        UDP_close(pcm, conn);
+    else
+        UA_EventLoopPOSIX_addDelayedCallback((UA_EventLoop*)el, &conn->rfd.dc);
+    UA_UNLOCK(&el->elMutex);
+}
+#endif
+
 static void
 UDP_delayedClose(void *application, void *context) {
     UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)application;
@@ -650,10 +732,94 @@ UDP_delayedClose(void *application, void *context) {
                  "UDP %u\t| Delayed closing of the connection",
                  (unsigned)conn->rfd.fd);
     UA_LOCK(&el->elMutex);
+#ifdef UA_HAVE_IOURING
+    if(conn->uring) {
+        UA_IOUring_cancel(pcm, &conn->rfd);
+        if(!UA_IOUring_released(&conn->rfd)) {
+            conn->rfd.dc.callback = UDP_delayedRelease;
+            UA_EventLoopPOSIX_addDelayedCallback((UA_EventLoop*)el, &conn->rfd.dc);
+            UA_UNLOCK(&el->elMutex);
+            return;
+        }
+    }
+#endif
     UDP_close(pcm, conn);
     UA_UNLOCK(&el->elMutex);
 }
 
+#ifdef UA_HAVE_MMSG
+/* Receive up to rxBatch datagrams with a single call. Datagrams that were
+ * coalesced by the kernel (UDP GRO) are split into the original datagrams
+ * before they are forwarded. */
+static void
+UDP_receiveBatch(UA_POSIXConnectionManager *pcm, UDP_FD *conn) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    struct mmsghdr msgs[UDP_MAXBATCH];
+    struct iovec iovs[UDP_MAXBATCH];
+    struct sockaddr_storage sources[UDP_MAXBATCH];
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        size_t align; /* cmsghdr alignment */
+    } ctrl[UDP_MAXBATCH];
+
+    size_t slotSize = pcm->rxBuffer.length / pcm->rxBatch;
+    memset(msgs, 0, sizeof(struct mmsghdr) * pcm->rxBatch);
+    for(size_t i = 0; i < pcm->rxBatch; i++) {
+        iovs[i].iov_base = pcm->rxBuffer.data + (i * slotSize);
+        iovs[i].iov_len = slotSize;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &sources[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+        if(conn->gro) {
+            msgs[i].msg_hdr.msg_control = ctrl[i].buf;
+            msgs[i].msg_hdr.msg_controllen = sizeof(ctrl[i].buf);
+        }
+    }
+
+    UA_RESET_ERRNO;
+    int ret = recvmmsg(conn->rfd.fd, msgs, (unsigned)pcm->rxBatch, MSG_DONTWAIT, NULL);
+    if(ret <= 0) {
+        if(UA_ERRNO == UA_INTERRUPTED || UA_ERRNO == UA_AGAIN)
+            return;
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                        "UDP %u\t| recv signaled the socket was shutdown (%s)",
+                        (unsigned)conn->rfd.fd, errno_str));
+        UDP_close(pcm, conn);
+        return;
+    }
+
+    for(int i = 0; i < ret; i++) {
+        UA_ByteString msg = {msgs[i].msg_len, (UA_Byte*)iovs[i].iov_base};
+        if(msg.length == 0)
+            continue;
+        size_t segmentSize = msg.length;
+#ifdef UDP_GRO
+        struct cmsghdr *cmsg = (conn->gro) ? CMSG_FIRSTHDR(&msgs[i].msg_hdr) : NULL;
+        for(; cmsg; cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+            if(cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                int gs;
+                memcpy(&gs, CMSG_DATA(cmsg), sizeof(int));
+                if(gs > 0)
+                    segmentSize = (size_t)gs;
+                break;
+            }
+        }
+#endif
+        /* Forward the (segments of the) datagram */
+        do {
+            UA_ByteString segment = msg;
+            if(segment.length > segmentSize)
+                segment.length = segmentSize;
+            UDP_deliver(pcm, conn, (struct sockaddr*)&sources[i], segment);
+            msg.data += segment.length;
+            msg.length -= segment.length;
+        } while(msg.length > 0);
+    }
+}
+#endif
+
 /* Gets called when a socket receives data or closes */
 static void
 UDP_connectionSocketCallback(UA_POSIXConnectionManager *pcm, UDP_FD *conn,
@@ -674,6 +840,13 @@ UDP_connectionSocketCallback(UA_POSIXConnectionManager *pcm, UDP_FD *conn,
         return;
     }
 
+#ifdef UA_HAVE_MMSG
+    if(pcm->rxBatch > 1 || conn->gro) {
+        UDP_receiveBatch(pcm, conn);
+        return;
+    }
+#endif
+
     UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
                  "UDP %u\t| Allocate receive buffer", (unsigned)conn->rfd.fd);
 
@@ -710,20 +883,28 @@ UDP_connectionSocketCallback(UA_POSIXConnectionManager *pcm, UDP_FD *conn,
     }
 
     response.length = (size_t)ret; /* Set the length of the received buffer */
+    UDP_deliver(pcm, conn, (struct sockaddr*)&source, response);
+}
+
+/* Forward a received message together with its source to the application */
+static void
+UDP_deliver(UA_POSIXConnectionManager *pcm, UDP_FD *conn,
+            const struct sockaddr *source, UA_ByteString msg) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
 
     /* Extract message source and port */
     char sourceAddr[64];
     UA_UInt16 sourcePort;
-    switch(source.ss_family) {
+    switch(source->sa_family) {
         case AF_INET:
-            UA_inet_ntop(AF_INET, &((struct sockaddr_in *)&source)->sin_addr,
+            UA_inet_ntop(AF_INET, &((const struct sockaddr_in *)source)->sin_addr,
                     sourceAddr, 64);
-            sourcePort = htons(((struct sockaddr_in *)&source)->sin_port);
+            sourcePort = htons(((const struct sockaddr_in *)source)->sin_port);
             break;
         case AF_INET6:
-            UA_inet_ntop(AF_INET6, &(((struct sockaddr_in6 *)&source)->sin6_addr),
+            UA_inet_ntop(AF_INET6, &(((const struct sockaddr_in6 *)source)->sin6_addr),
                     sourceAddr, 64);
-            sourcePort = htons(((struct sockaddr_in6 *)&source)->sin6_port);
+            sourcePort = htons(((const struct sockaddr_in6 *)source)->sin6_port);
             break;
         default:
             sourceAddr[0] = 0;
@@ -740,16 +921,32 @@ UDP_connectionSocketCallback(UA_POSIXConnectionManager *pcm, UDP_FD *conn,
 
     UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
                  "UDP %u\t| Received message of size %u from %s on port %u",
-                 (unsigned)conn->rfd.fd, (unsigned)ret,
+                 (unsigned)conn->rfd.fd, (unsigned)msg.length,
                  sourceAddr, sourcePort);
 
     /* Callback to the application layer */
     conn->applicationCB(&pcm->cm, (uintptr_t)conn->rfd.fd,
                         conn->application, &conn->context,
                         UA_CONNECTIONSTATE_ESTABLISHED,
-                        &kvm, response);
+                        &kvm, msg);
 }
 
+#ifdef UA_HAVE_IOURING
+/* Gets called from the io_uring when a socket receives data or closes */
+static void
+UDP_uringCallback(UA_POSIXConnectionManager *pcm, UA_RegisteredFD *rfd,
+                  int res, UA_ByteString msg, const struct sockaddr *source) {
+    if(res <= 0) {
+        UA_LOG_DEBUG(pcm->cm.eventSource.eventLoop->logger, UA_LOGCATEGORY_NETWORK,
+                     "UDP %u\t| recv signaled the socket was shutdown (%s)",
+                     (unsigned)rfd->fd, (res < 0) ? strerror(-res) : "None");
+        UDP_shutdown(&pcm->cm, rfd);
+        return;
+    }
+    UDP_deliver(pcm, (UDP_FD*)rfd, source, msg);
+}
+#endif
+
 static UA_StatusCode
 UDP_registerListenSocket(UA_POSIXConnectionManager *pcm, UA_UInt16 port,
                          struct addrinfo *info, const UA_KeyValueMap *params,
@@ -900,7 +1097,13 @@ UDP_registerListenSocket(UA_POSIXConnectionManager *pcm, UA_UInt16 port,
     newudpfd->application = application;
     newudpfd->context = context;
 
-    /* Register in the EventLoop */
+    /* Register in the EventLoop (or receive via the io_uring) */
+#ifdef UA_HAVE_IOURING
+    if(pcm->uring) {
+        newudpfd->uring = true;
+        res = UA_IOUring_recv(pcm, &newudpfd->rfd);
+    } else
+#endif
     res = UA_EventLoopPOSIX_registerFD(el, &newudpfd->rfd);
     if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
@@ -911,6 +1114,19 @@ UDP_registerListenSocket(UA_POSIXConnectionManager *pcm, UA_UInt16 port,
         return res;
     }
 
+    /* Let the kernel coalesce received datagrams (UDP GRO) if a receive slot
+     * can hold the largest coalesced datagram */
+#if defined(UA_HAVE_MMSG) && defined(UDP_GRO)
+# ifdef UA_HAVE_IOURING
+    if(!newudpfd->uring)
+# endif
+    if(pcm->rxBuffer.length / pcm->rxBatch >= UA_UINT16_MAX) {
+        int enable = 1;
+        newudpfd->gro = (UA_setsockopt(listenSocket, SOL_UDP, UDP_GRO,
+                                       (const char *)&enable, sizeof(int)) == 0);
+    }
+#endif
+
     /* Register internally in the EventSource */
     ZIP_INSERT(UA_FDTree, &pcm->fds, &newudpfd->rfd);
     pcm->fdsSize++;
@@ -1026,6 +1242,200 @@ UDP_shutdownConnection(UA_ConnectionManager *cm, uintptr_t connectionId) {
     return UA_STATUSCODE_GOOD;
 }
 
+#ifdef UA_HAVE_MMSG
+/* Prepare the msghdr for the queued messages starting at pos. Returns the
+ * number of queued messages that are covered. */
+static size_t
+UDP_prepareMsg(UDP_FD *conn, size_t pos, struct msghdr *msg, struct iovec *iov,
+               void *ctrl, size_t ctrlSize) {
+    memset(msg, 0, sizeof(struct msghdr));
+    msg->msg_name = &conn->sendAddr;
+    msg->msg_namelen = conn->sendAddrLength;
+    msg->msg_iov = iov;
+    iov[0].iov_base = conn->sendQueue[pos].data;
+    iov[0].iov_len = conn->sendQueue[pos].length;
+    size_t n = 1;
+
+#ifdef UDP_SEGMENT
+    /* Segments of a GSO send have the same size. Only the last segment may be
+     * shorter. */
+    size_t segmentSize = conn->sendQueue[pos].length;
+    size_t total = segmentSize;
+    if(conn->gso && segmentSize > 0 && segmentSize <= UDP_MAXGSOSEGMENTSIZE) {
+        while(pos + n < conn->sendQueueSize && n < UDP_MAXGSOSEGMENTS) {
+            size_t len = conn->sendQueue[pos + n].length;
+            if(len == 0 || len > segmentSize || total + len > UDP_MAXPAYLOAD)
+                break;
+            iov[n].iov_base = conn->sendQueue[pos + n].data;
+            iov[n].iov_len = len;
+            total += len;
+            n++;
+            if(len < segmentSize)
+                break;
+        }
+    }
+    if(n > 1) {
+        msg->msg_control = ctrl;
+        msg->msg_controllen = ctrlSize;
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg);
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        uint16_t gsoSize = (uint16_t)segmentSize;
+        memcpy(CMSG_DATA(cmsg), &gsoSize, sizeof(uint16_t));
+    }
+#endif
+
+    msg->msg_iovlen = n;
+    return n;
+}
+
+/* Send all queued messages. Blocks (with a poll) when the socket buffer is
+ * full. Errors we cannot recover from close the connection. */
+static void
+UDP_flush(UA_POSIXConnectionManager *pcm, UDP_FD *conn) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex);
+
+    struct mmsghdr msgs[UDP_MAXBATCH];
+    struct iovec iovs[UDP_MAXBATCH];
+    size_t covered[UDP_MAXBATCH];
+    union {
+        char buf[CMSG_SPACE(sizeof(uint16_t))];
+        size_t align; /* cmsghdr alignment */
+    } ctrl[UDP_MAXBATCH];
+
+    size_t pos = 0;
+    while(pos < conn->sendQueueSize) {
+        /* Prepare the messages. The iovs are shared among all messages. */
+        size_t msgsSize = 0, iovPos = 0;
+        for(size_t p = pos; p < conn->sendQueueSize; msgsSize++) {
+            covered[msgsSize] =
+                UDP_prepareMsg(conn, p, &msgs[msgsSize].msg_hdr, &iovs[iovPos],
+                               ctrl[msgsSize].buf, sizeof(ctrl[msgsSize].buf));
+            p += covered[msgsSize];
+            iovPos += covered[msgsSize];
+        }
+
+        UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "UDP %u\t| Sending %u queued messages in %u datagrams",
+                     (unsigned)conn->rfd.fd, (unsigned)(conn->sendQueueSize - pos),
+                     (unsigned)msgsSize);
+
+        UA_RESET_ERRNO;
+        int ret = sendmmsg(conn->rfd.fd, msgs, (unsigned)msgsSize, MSG_NOSIGNAL);
+        if(ret > 0) {
+            for(int i = 0; i < ret; i++)
+                pos += covered[i];
+            continue;
+        }
+
+        if(UA_ERRNO == UA_INTERRUPTED)
+            continue;
+
+#ifdef UDP_SEGMENT
+        /* GSO is not supported by the outgoing interface. Send the messages
+         * individually from here on. */
+        if(covered[0] > 1 && (UA_ERRNO == EINVAL || UA_ERRNO == EIO)) {
+            UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                         "UDP %u\t| GSO not supported, disable",
+                         (unsigned)conn->rfd.fd);
+            conn->gso = false;
+            continue;
+        }
+#endif
+
+        /* An error we cannot recover from? */
+        if(UA_ERRNO != UA_WOULDBLOCK && UA_ERRNO != UA_AGAIN) {
+            UA_LOG_SOCKET_ERRNO_WRAP(
+               UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                            "UDP %u\t| Send failed with error %s",
+                            (unsigned)conn->rfd.fd, errno_str));
+            UDP_shutdown(&pcm->cm, &conn->rfd);
+            break;
+        }
+
+        /* Poll for the socket resources to become available and retry */
+        struct pollfd tmp_poll_fd;
+        tmp_poll_fd.fd = conn->rfd.fd;
+        tmp_poll_fd.events = UA_POLLOUT;
+        UA_poll(&tmp_poll_fd, 1, 100);
+    }
+
+    UDP_clearSendQueue(pcm, conn);
+}
+
+/* Flush the send queue at the end of the EventLoop iteration */
+static void
+UDP_delayedSend(void *application, void *context) {
+    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)application;
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    UDP_FD *conn = (UDP_FD*)context;
+    UA_LOCK(&el->elMutex);
+    conn->sendScheduled = false;
+    if(conn->closed) {
+        /* The connection was closed while the delayed callback was pending */
+        UA_free(conn->sendQueue);
+        UA_free(conn);
+    } else {
+        UDP_flush(pcm, conn);
+    }
+    UA_UNLOCK(&el->elMutex);
+}
+
+static UA_StatusCode
+UDP_enqueue(UA_POSIXConnectionManager *pcm, UDP_FD *conn, UA_ByteString *buf) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex);
+
+    /* The connection is closing */
+    if(conn->rfd.dc.callback) {
+        UA_EventLoopPOSIX_freeNetworkBuffer(&pcm->cm, (uintptr_t)conn->rfd.fd, buf);
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+    }
+
+    if(!conn->sendQueue) {
+        conn->sendQueue = (UA_ByteString*)
+            UA_malloc(sizeof(UA_ByteString) * UDP_MAXBATCH);
+        if(!conn->sendQueue) {
+            UA_EventLoopPOSIX_freeNetworkBuffer(&pcm->cm, (uintptr_t)conn->rfd.fd, buf);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+    }
+
+    /* Flush right away if the queue is full */
+    if(conn->sendQueueSize == UDP_MAXBATCH) {
+        UDP_flush(pcm, conn);
+        if(conn->rfd.dc.callback) {
+            UA_EventLoopPOSIX_freeNetworkBuffer(&pcm->cm, (uintptr_t)conn->rfd.fd, buf);
+            return UA_STATUSCODE_BADCONNECTIONCLOSED;
+        }
+    }
+
+    /* Take ownership of the buffer. The static send buffer is reused for the
+     * next message and has to be copied. */
+    if(buf->data == pcm->txBuffer.data) {
+        UA_StatusCode res = UA_ByteString_copy(buf, &conn->sendQueue[conn->sendQueueSize]);
+        UA_EventLoopPOSIX_freeNetworkBuffer(&pcm->cm, (uintptr_t)conn->rfd.fd, buf);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    } else {
+        conn->sendQueue[conn->sendQueueSize] = *buf;
+        UA_ByteString_init(buf);
+    }
+    conn->sendQueueSize++;
+
+    if(!conn->sendScheduled) {
+        conn->sendScheduled = true;
+        conn->sendDC.callback = UDP_delayedSend;
+        conn->sendDC.application = pcm;
+        conn->sendDC.context = conn;
+        UA_EventLoopPOSIX_addDelayedCallback((UA_EventLoop*)el, &conn->sendDC);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+#endif
+
 static UA_StatusCode
 UDP_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                        const UA_KeyValueMap *params,
@@ -1044,6 +1454,26 @@ UDP_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
+    /* Queue the datagram in the io_uring */
+#ifdef UA_HAVE_IOURING
+    if(conn->uring) {
+        UA_StatusCode res =
+            UA_IOUring_send(pcm, &conn->rfd, buf, (struct sockaddr*)&conn->sendAddr,
+                            conn->sendAddrLength);
+        UA_UNLOCK(&el->elMutex);
+        return res;
+    }
+#endif
+
+    /* Queue the message to be sent in a batch */
+#ifdef UA_HAVE_MMSG
+    if(conn->batch) {
+        UA_StatusCode res = UDP_enqueue(pcm, conn, buf);
+        UA_UNLOCK(&el->elMutex);
+        return res;
+    }
+#endif
+
     /* Send the full buffer. This may require several calls to send */
     size_t nWritten = 0;
     do {
@@ -1217,7 +1647,33 @@ UDP_openSendConnection(UA_POSIXConnectionManager *pcm, const UA_KeyValueMap *par
     conn->application = application;
     conn->context = context;
 
-    /* Register the fd to trigger when output is possible (the connection is open) */
+    /* Queue the messages and send them in batches. The kernel supports GSO if
+     * the socket option is known. */
+#ifdef UA_HAVE_MMSG
+    const UA_Boolean *batch = (const UA_Boolean*)
+        UA_KeyValueMap_getScalar(params, udpConnectionParams[UDP_PARAMINDEX_BATCH].name,
+                                 &UA_TYPES[UA_TYPES_BOOLEAN]);
+# ifdef UA_HAVE_IOURING
+    if(!pcm->uring)
+# endif
+    if(batch && *batch) {
+        conn->batch = true;
+# ifdef UDP_SEGMENT
+        int gsoSize = 0;
+        socklen_t gsoSizeLen = sizeof(int);
+        conn->gso = (UA_getsockopt(newSock, SOL_UDP, UDP_SEGMENT,
+                                   &gsoSize, &gsoSizeLen) == 0);
+# endif
+    }
+#endif
+
+    /* Register the fd to trigger when output is possible (the connection is
+     * open). With io_uring, send errors are reported by the ring. */
+#ifdef UA_HAVE_IOURING
+    if(pcm->uring)
+        conn->uring = true;
+    else
+#endif
     res = UA_EventLoopPOSIX_registerFD(el, &conn->rfd);
     if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
@@ -1378,6 +1834,40 @@ UDP_eventSourceStart(UA_ConnectionManager *cm) {
     if(res != UA_STATUSCODE_GOOD)
         goto finish;
 
+    /* Set up the io_uring. Fall back to polling the sockets in the EventLoop
+     * if the kernel does not support it. */
+#ifdef UA_HAVE_IOURING
+    if(pcm->useUring) {
+        if(UA_IOUring_start(pcm, true, UDP_uringCallback) == UA_STATUSCODE_GOOD) {
+            UA_ByteString_clear(&pcm->txBuffer);
+        } else {
+            UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                           "UDP\t| Could not set up the io_uring, "
+                           "polling the sockets instead");
+        }
+    }
+#endif
+
+    /* Receive several datagrams with one call. Every datagram gets a slot of
+     * recv-bufsize in the rx buffer. */
+#ifdef UA_HAVE_MMSG
+    pcm->rxBatch = 1;
+    const UA_UInt32 *rxBatch = (const UA_UInt32*)
+        UA_KeyValueMap_getScalar(&cm->eventSource.params, udpManagerParams[2].name,
+                                 &UA_TYPES[UA_TYPES_UINT32]);
+# ifdef UA_HAVE_IOURING
+    if(!pcm->uring)
+# endif
+    if(rxBatch && *rxBatch > 1) {
+        pcm->rxBatch = (*rxBatch < UDP_MAXBATCH) ? *rxBatch : UDP_MAXBATCH;
+        size_t slotSize = pcm->rxBuffer.length;
+        UA_ByteString_clear(&pcm->rxBuffer);
+        res = UA_ByteString_allocBuffer(&pcm->rxBuffer, slotSize * pcm->rxBatch);
+        if(res != UA_STATUSCODE_GOOD)
+            goto finish;
+    }
+#endif
+
     /* Set the EventSource to the started state */
     cm->eventSource.state = UA_EVENTSOURCESTATE_STARTED;
 
@@ -1457,4 +1947,15 @@ UA_ConnectionManager_new_POSIX_UDP(const UA_String eventSourceName) {
     return &cm->cm;
 }
 
+#ifdef UA_HAVE_IOURING
+UA_ConnectionManager *
+UA_ConnectionManager_new_IOURING_UDP(const UA_String eventSourceName) {
+    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)
+        UA_ConnectionManager_new_POSIX_UDP(eventSourceName);
+    if(pcm)
+        pcm->useUring = true;
+    return (UA_ConnectionManager*)pcm;
+}
+#endif
+
 #endif
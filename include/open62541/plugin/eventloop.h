@@ -403,6 +403,19 @@ struct UA_ConnectionManager {
     void
     (*freeNetworkBuffer)(UA_ConnectionManager *cm, uintptr_t connectionId,
                          UA_ByteString *buf);
+
+    /* Scatter-gather Sending
+     * ~~~~~~~~~~~~~~~~~~~~~~
+     * Optional variant of sendWithConnection (can be NULL). The buffers are
+     * sent in order as one contiguous message. Only the first buffer is
+     * allocated with allocNetworkBuffer and released internally. The following
+     * buffers are owned by the caller and are not accessed after the method
+     * returns. This allows to send large payloads without copying them into a
+     * network buffer first. */
+    UA_StatusCode
+    (*sendWithConnectionVec)(UA_ConnectionManager *cm, uintptr_t connectionId,
+                             const UA_KeyValueMap *params, UA_ByteString *bufs,
+                             size_t bufsSize);
 };
 
 /**
@@ -472,7 +485,16 @@ struct UA_InterruptManager {
  *   well. But expect accordingly longer sleep-times for timed events when the
  *   clock is set to the past. See the man-page of "clock_gettime" on how to get
  *   a clock source id for a character-device such as /dev/ptp0. (default:
- *   CLOCK_MONOTONIC_RAW) */
+ *   CLOCK_MONOTONIC_RAW)
+ *
+ * **Worker threads (Linux only, requires multithreading)**
+ *
+ * 0:worker-threads [uint16]
+ *    Number of worker threads that poll and process the connections opened
+ *    with the "workers" parameter (default: 0, no workers). The connections
+ *    are sharded across the workers and idle workers take over events from
+ *    busy ones. The connection callbacks are then called from the worker
+ *    threads without holding the EventLoop lock. */
 
 UA_EXPORT UA_EventLoop *
 UA_EventLoop_new_POSIX(const UA_Logger *logger);
@@ -519,6 +541,11 @@ UA_EventLoop_new_POSIX(const UA_Logger *logger);
  * 0:listen [boolean]
  *    Listen-connection or active-connection (default: false)
  *
+ * 0:workers [boolean]
+ *    For listen-connections: Process the accepted connections in the worker
+ *    threads of the EventLoop (if configured). The connection callback must
+ *    then be safe to call without the EventLoop lock (default: false)
+ *
  * 0:validate [boolean]
  *    If true, the connection setup will act as a dry-run without actually
  *    creating any connection but solely validating the provided parameters
@@ -561,6 +588,13 @@ UA_ConnectionManager_new_POSIX_TCP(const UA_String eventSourceName);
  *    becomes an upper bound for the message size. If undefined a fresh buffer
  *    is allocated for every `allocNetworkBuffer` (default: no buffer).
  *
+ * 0:recv-batch [uint32]
+ *    Number of datagrams received with a single system call (recvmmsg) on
+ *    Linux. Every datagram gets a buffer of recv-bufsize. So the memory for
+ *    receiving grows accordingly (default: 1, max: 32). If a buffer can hold
+ *    64kB, the kernel may additionally coalesce datagrams from the same sender
+ *    (UDP GRO). They are split up again before they are forwarded.
+ *
  * **Open Connection Parameters:**
  *
  * 0:listen [boolean]
@@ -602,6 +636,14 @@ UA_ConnectionManager_new_POSIX_TCP(const UA_String eventSourceName);
  *    creating any connection but solely validating the provided parameters
  *    (default: false)
  *
+ * 0:batch [boolean]
+ *    Queue the messages of a sending connection and send them together at the
+ *    end of the EventLoop iteration with a single system call (sendmmsg) on
+ *    Linux. Consecutive messages of the same size are then handed to the
+ *    kernel as one large datagram that is segmented on the way out (UDP GSO),
+ *    if supported. Errors during sending are not returned from
+ *    `sendWithConnection` but close the connection (default: false).
+ *
  * **Connection Callback Parameters:**
  *
  * 0:remote-address [string]
@@ -616,6 +658,56 @@ UA_ConnectionManager_new_POSIX_TCP(const UA_String eventSourceName);
 UA_EXPORT UA_ConnectionManager *
 UA_ConnectionManager_new_POSIX_UDP(const UA_String eventSourceName);
 
+#if defined(UA_ENABLE_IOURING)
+
+/**
+ * io_uring Connection Managers
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Drop-in replacements for the TCP and UDP ConnectionManagers on Linux (6.0 or
+ * later). The sockets are set up in the same way and take the same parameters.
+ * But the data is received and sent via an io_uring. Every socket receives with
+ * a multishot receive from a shared ring of registered buffers. Sends are
+ * queued and submitted together after the completions of the ring have been
+ * processed. Many messages across many sockets are then handled with a few
+ * syscalls per iteration of the EventLoop. Sends are asynchronous and every
+ * buffer from `allocNetworkBuffer` is freshly allocated. So send errors are
+ * not returned from `sendWithConnection` but close the connection later on.
+ * The "0:workers" parameter of TCP listen-connections has no effect.
+ *
+ * The kernel binds the pending receives to the thread that submitted them.
+ * Hence the EventLoop should be run from the same thread throughout. If that
+ * thread exits, the receives are cancelled and rearmed only once the ring is
+ * processed again.
+ *
+ * To use the io_uring in the server, register the ConnectionManager in a new
+ * EventLoop and set it in the UA_ServerConfig before the default
+ * configuration is applied. The default configuration sets up its own
+ * EventLoop and ConnectionManagers only if no EventLoop is configured.
+ *
+ * If the io_uring cannot be set up when the ConnectionManager is started (e.g.
+ * an older kernel), then the sockets are polled in the EventLoop instead.
+ *
+ * **Configuration parameters for the ConnectionManager (set before start)**
+ *
+ * 0:recv-bufsize [uint32]
+ *    Size of each registered receive buffer (default: 16kB for TCP, 64kB for
+ *    UDP). A UDP datagram must fit into one buffer.
+ *
+ * 0:recv-buffers [uint32]
+ *    Number of registered receive buffers. Rounded up to a power of two
+ *    (default: 256 for TCP, 64 for UDP).
+ *
+ * 0:ring-size [uint32]
+ *    Number of entries in the submission queue (default: 256). The completion
+ *    queue is four times as large. */
+UA_EXPORT UA_ConnectionManager *
+UA_ConnectionManager_new_IOURING_TCP(const UA_String eventSourceName);
+
+UA_EXPORT UA_ConnectionManager *
+UA_ConnectionManager_new_IOURING_UDP(const UA_String eventSourceName);
+
+#endif
+
 #if defined(__linux__) /* Linux only so far */
 
 /**
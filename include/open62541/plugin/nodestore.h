@@ -302,6 +302,16 @@ UA_NodePointer_toExpandedNodeId(UA_NodePointer np);
 UA_NodeId UA_EXPORT
 UA_NodePointer_toNodeId(UA_NodePointer np);
 
+/* Direct pointer to a node that was retrieved from the Nodestore. The caller
+ * has to hold a reference on the node (see ``getNode`` and ``releaseNode``)
+ * for as long as the NodePointer is in use. */
+UA_NodePointer UA_EXPORT
+UA_NodePointer_fromNode(const UA_NodeHead *head);
+
+/* Returns the node if the NodePointer is a direct pointer. NULL otherwise. */
+const UA_NodeHead UA_EXPORT *
+UA_NodePointer_toNode(UA_NodePointer np);
+
 /**
  * Base Node Attributes
  * --------------------
@@ -215,6 +215,30 @@ struct UA_ServerConfig {
      * ModellingRule of their InstanceDeclaration */
     UA_Boolean modellingRulesOnInstances;
 
+#if UA_MULTITHREADING >= 100
+    /* Execute the read-only services (Read, Browse, BrowseNext,
+     * TranslateBrowsePathsToNodeIds) and UA_Server_read / UA_Server_browse /
+     * UA_Server_browseNext / UA_Server_translateBrowsePathToNodeIds without
+     * the service lock. This requires a nodestore that allows concurrent
+     * readers during modifications, such as UA_Nodestore_HashMapConcurrent.
+     * The AccessControl plugin is then also called from several threads in
+     * parallel. Value callbacks and DataSources are still executed with the
+     * service lock held. Disabled by default. */
+    UA_Boolean concurrentReads;
+
+    /* Execute the asymmetric crypto operations of the handshake without the
+     * service lock. These are the decryption and signature verification of
+     * the OpenSecureChannel request, the signing and encryption of the
+     * response and the signature of the CreateSession response. Public-key
+     * operations take milliseconds for large keys. With the worker threads of
+     * the EventLoop, the established SecureChannels are then not blocked by
+     * the handshakes of new connections. The SecurityPolicies are then used
+     * from several threads in parallel. The OpenSSL SecurityPolicies are
+     * thread-safe. The mbedTLS SecurityPolicies require MBEDTLS_THREADING_C.
+     * Disabled by default. */
+    UA_Boolean concurrentHandshakes;
+#endif
+
     /* Limits
      * ~~~~~~ */
     /* Limits for SecureChannels */
@@ -1380,6 +1404,26 @@ UA_Server_triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
                        const UA_NodeId originId, UA_ByteString *outEventId,
                        const UA_Boolean deleteEventNode);
 
+/* Triggers an event that is not represented as a node. The event fields are
+ * given as a key/value map with the BrowseName of the field as the key. Nested
+ * fields join the BrowseNames along the path with a slash, e.g.
+ * "EnabledState/Id". The server sets the fields EventId, EventType, SourceNode
+ * and ReceiveTime. The Time defaults to the ReceiveTime. The EventFilters of
+ * the MonitoredItems are evaluated directly against the fields. Only the Value
+ * attribute of the fields can be selected.
+ *
+ * @param server The server object
+ * @param eventType The type of the event. Must be a subtype of BaseEventType.
+ * @param originId The NodeId of the node where the event originates
+ * @param eventFields The fields of the event (can be NULL)
+ * @param outEventId The EventId of the new event (can be NULL)
+ * @return The StatusCode of the UA_Server_triggerTransientEvent method */
+UA_StatusCode UA_EXPORT UA_THREADSAFE
+UA_Server_triggerTransientEvent(UA_Server *server, const UA_NodeId eventType,
+                                const UA_NodeId originId,
+                                const UA_KeyValueMap *eventFields,
+                                UA_ByteString *outEventId);
+
 #endif /* UA_ENABLE_SUBSCRIPTIONS_EVENTS */
 
 /**
@@ -31,9 +31,10 @@
 
 /* Configuration parameters */
 
-#define MEMORYCERTSTORE_PARAMETERSSIZE 2
+#define MEMORYCERTSTORE_PARAMETERSSIZE 3
 #define MEMORYCERTSTORE_PARAMINDEX_MAXTRUSTLISTSIZE 0
 #define MEMORYCERTSTORE_PARAMINDEX_MAXREJECTEDLISTSIZE 1
+#define MEMORYCERTSTORE_PARAMINDEX_MAXVERIFYCACHESIZE 2
 
 static const struct {
     UA_QualifiedName name;
@@ -41,9 +42,28 @@ static const struct {
     UA_Boolean required;
 } MemoryCertStoreParameters[MEMORYCERTSTORE_PARAMETERSSIZE] = {
     {{0, UA_STRING_STATIC("max-trust-listsize")}, &UA_TYPES[UA_TYPES_UINT16], false},
-    {{0, UA_STRING_STATIC("max-rejected-listsize")}, &UA_TYPES[UA_TYPES_STRING], false}
+    {{0, UA_STRING_STATIC("max-rejected-listsize")}, &UA_TYPES[UA_TYPES_STRING], false},
+    {{0, UA_STRING_STATIC("max-verify-cachesize")}, &UA_TYPES[UA_TYPES_UINT32], false}
 };
 
+/* Verification results are cached for repeated connections with the same
+ * certificate. An entry is keyed by the SHA-256 digest of the encoded
+ * certificate (chain) and the generation of the loaded trust list. The
+ * generation is incremented with every reload. So results based on an outdated
+ * trust list or CRL set are never returned. Entries expire after a maximum age,
+ * as the validity periods are checked against the current time. */
+#define MEMORYCERTSTORE_VERIFYCACHE_DEFAULTSIZE 128
+#define MEMORYCERTSTORE_VERIFYCACHE_MAXAGE (60 * UA_DATETIME_SEC)
+#define MEMORYCERTSTORE_VERIFYCACHE_DIGESTLENGTH 32 /* SHA-256 */
+
+typedef struct {
+    UA_Byte digest[MEMORYCERTSTORE_VERIFYCACHE_DIGESTLENGTH];
+    UA_UInt64 generation;
+    UA_UInt64 lastUsed;
+    UA_DateTime expires; /* Monotonic time */
+    UA_StatusCode result;
+} VerifyCacheEntry;
+
 typedef struct {
     UA_TrustListDataType trustList;
     size_t rejectedCertificatesSize;
@@ -53,11 +73,17 @@ typedef struct {
     UA_UInt32 maxRejectedListSize;
 
     UA_Boolean reloadRequired;
+    UA_UInt64 generation; /* Incremented for every reload */
 
     mbedtls_x509_crt trustedCertificates;
     mbedtls_x509_crt issuerCertificates;
     mbedtls_x509_crl trustedCrls;
     mbedtls_x509_crl issuerCrls;
+
+    /* Verification result cache with LRU replacement */
+    size_t verifyCacheSize;
+    VerifyCacheEntry *verifyCache;
+    UA_UInt64 verifyCacheClock;
 } MemoryCertStore;
 
 static UA_Boolean mbedtlsCheckCA(mbedtls_x509_crt *cert);
@@ -276,6 +302,7 @@ MemoryCertStore_clear(UA_CertificateGroup *certGroup) {
         mbedtls_x509_crl_free(&context->trustedCrls);
         mbedtls_x509_crl_free(&context->issuerCrls);
 
+        UA_free(context->verifyCache);
         UA_free(context);
         certGroup->context = NULL;
     }
@@ -293,6 +320,9 @@ reloadCertificates(UA_CertificateGroup *certGroup) {
     UA_ByteString_init(&data);
     int err = 0;
 
+    /* Invalidate all cached verification results */
+    context->generation++;
+
     mbedtls_x509_crt_free(&context->trustedCertificates);
     mbedtls_x509_crt_init(&context->trustedCertificates);
     for(size_t i = 0; i < context->trustList.trustedCertificatesSize; ++i) {
@@ -563,24 +593,52 @@ mbedtlsVerifyChain(UA_CertificateGroup *cg, MemoryCertStore *ctx, mbedtls_x509_c
     return ret;
 }
 
-/* This follows Part 6, 6.1.3 Determining if a Certificate is trusted.
- * It defines a sequence of steps for certificate verification. */
-static UA_StatusCode
-verifyCertificate(UA_CertificateGroup *certGroup, const UA_ByteString *certificate) {
-    /* Check parameter */
-    if (certGroup == NULL || certGroup->context == NULL) {
-        return UA_STATUSCODE_BADINTERNALERROR;
+static VerifyCacheEntry *
+verifyCacheLookup(MemoryCertStore *ctx, const UA_Byte *digest, UA_DateTime now) {
+    for(size_t i = 0; i < ctx->verifyCacheSize; i++) {
+        VerifyCacheEntry *e = &ctx->verifyCache[i];
+        if(e->generation != ctx->generation || e->expires <= now ||
+           memcmp(e->digest, digest, MEMORYCERTSTORE_VERIFYCACHE_DIGESTLENGTH) != 0)
+            continue;
+        e->lastUsed = ++ctx->verifyCacheClock;
+        return e;
     }
+    return NULL;
+}
 
-    MemoryCertStore *context = (MemoryCertStore *)certGroup->context;
-    if(context->reloadRequired) {
-        UA_StatusCode retval = reloadCertificates(certGroup);
-        if(retval != UA_STATUSCODE_GOOD) {
-            return retval;
+static void
+verifyCacheStore(MemoryCertStore *ctx, const UA_Byte *digest,
+                 UA_DateTime now, UA_StatusCode result) {
+    /* Don't cache results of transient failures */
+    if(result == UA_STATUSCODE_BADOUTOFMEMORY ||
+       result == UA_STATUSCODE_BADINTERNALERROR)
+        return;
+
+    /* Replace an outdated or else the least recently used entry */
+    VerifyCacheEntry *e = &ctx->verifyCache[0];
+    for(size_t i = 0; i < ctx->verifyCacheSize; i++) {
+        VerifyCacheEntry *c = &ctx->verifyCache[i];
+        if(c->generation != ctx->generation || c->expires <= now) {
+            e = c;
+            break;
         }
-        context->reloadRequired = false;
+        if(c->lastUsed < e->lastUsed)
+            e = c;
     }
 
+    memcpy(e->digest, digest, MEMORYCERTSTORE_VERIFYCACHE_DIGESTLENGTH);
+    e->generation = ctx->generation;
+    e->lastUsed = ++ctx->verifyCacheClock;
+    e->expires = now + MEMORYCERTSTORE_VERIFYCACHE_MAXAGE;
+    e->result = result;
+}
+
+/* This follows Part 6, 6.1.3 Determining if a Certificate is trusted.
+ * It defines a sequence of steps for certificate verification. */
+static UA_StatusCode
+verifyCertificateUncached(UA_CertificateGroup *certGroup, const UA_ByteString *certificate) {
+    MemoryCertStore *context = (MemoryCertStore *)certGroup->context;
+
     /* Verification Step: Certificate Structure
      * This parses the entire certificate chain contained in the bytestring. */
     mbedtls_x509_crt cert;
@@ -613,6 +671,49 @@ verifyCertificate(UA_CertificateGroup *certGroup, const UA_ByteString *certifica
     return ret;
 }
 
+static UA_StatusCode
+verifyCertificate(UA_CertificateGroup *certGroup, const UA_ByteString *certificate) {
+    /* Check parameter */
+    if (certGroup == NULL || certGroup->context == NULL) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Reload after a trust list change. This also invalidates the cache. */
+    MemoryCertStore *context = (MemoryCertStore *)certGroup->context;
+    if(context->reloadRequired) {
+        UA_StatusCode retval = reloadCertificates(certGroup);
+        if(retval != UA_STATUSCODE_GOOD) {
+            return retval;
+        }
+        context->reloadRequired = false;
+    }
+
+    if(context->verifyCacheSize == 0)
+        return verifyCertificateUncached(certGroup, certificate);
+
+    /* Look up the cached result */
+    UA_Byte digest[MEMORYCERTSTORE_VERIFYCACHE_DIGESTLENGTH];
+#if !defined(MBEDTLS_USE_PSA_CRYPTO)
+    if(mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), certificate->data,
+                  certificate->length, digest) != 0)
+        return verifyCertificateUncached(certGroup, certificate);
+#else
+    size_t digestLength = 0;
+    if(psa_hash_compute(PSA_ALG_SHA_256, certificate->data, certificate->length,
+                        digest, sizeof(digest), &digestLength) != PSA_SUCCESS)
+        return verifyCertificateUncached(certGroup, certificate);
+#endif
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    VerifyCacheEntry *e = verifyCacheLookup(context, digest, now);
+    if(e)
+        return e->result;
+
+    /* Verify and cache the result */
+    UA_StatusCode ret = verifyCertificateUncached(certGroup, certificate);
+    verifyCacheStore(context, digest, now, ret);
+    return ret;
+}
+
 static UA_StatusCode
 MemoryCertStore_verifyCertificate(UA_CertificateGroup *certGroup,
                                   const UA_ByteString *certificate) {
@@ -670,6 +771,7 @@ UA_CertificateGroup_Memorystore(UA_CertificateGroup *certGroup,
     /* Default values */
     context->maxTrustListSize = 65535;
     context->maxRejectedListSize = 100;
+    context->verifyCacheSize = MEMORYCERTSTORE_VERIFYCACHE_DEFAULTSIZE;
 
     if(params) {
         const UA_UInt32 *maxTrustListSize = (const UA_UInt32*)
@@ -687,6 +789,22 @@ UA_CertificateGroup_Memorystore(UA_CertificateGroup *certGroup,
         if(maxRejectedListSize) {
             context->maxRejectedListSize = *maxRejectedListSize;
         }
+
+        const UA_UInt32 *maxVerifyCacheSize = (const UA_UInt32*)
+        UA_KeyValueMap_getScalar(params, MemoryCertStoreParameters[MEMORYCERTSTORE_PARAMINDEX_MAXVERIFYCACHESIZE].name,
+                                 &UA_TYPES[UA_TYPES_UINT32]);
+        if(maxVerifyCacheSize) {
+            context->verifyCacheSize = *maxVerifyCacheSize;
+        }
+    }
+
+    if(context->verifyCacheSize > 0) {
+        context->verifyCache = (VerifyCacheEntry*)
+            UA_calloc(context->verifyCacheSize, sizeof(VerifyCacheEntry));
+        if(!context->verifyCache) {
+            retval = UA_STATUSCODE_BADOUTOFMEMORY;
+            goto cleanup;
+        }
     }
 
     UA_TrustListDataType_add(trustList, &context->trustList);
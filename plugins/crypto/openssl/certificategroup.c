@@ -15,6 +15,7 @@
 #include <openssl/x509_vfy.h>
 #include <openssl/x509v3.h>
 #include <openssl/pem.h>
+#include <openssl/sha.h>
 
 #include "libc_time.h"
 #include "securitypolicy_common.h"
@@ -23,9 +24,10 @@
 
 /* Configuration parameters */
 
-#define MEMORYCERTSTORE_PARAMETERSSIZE 2
+#define MEMORYCERTSTORE_PARAMETERSSIZE 3
 #define MEMORYCERTSTORE_PARAMINDEX_MAXTRUSTLISTSIZE 0
 #define MEMORYCERTSTORE_PARAMINDEX_MAXREJECTEDLISTSIZE 1
+#define MEMORYCERTSTORE_PARAMINDEX_MAXVERIFYCACHESIZE 2
 
 static const struct {
     UA_QualifiedName name;
@@ -33,9 +35,27 @@ static const struct {
     UA_Boolean required;
 } MemoryCertStoreParameters[MEMORYCERTSTORE_PARAMETERSSIZE] = {
     {{0, UA_STRING_STATIC("maxTrustListSize")}, &UA_TYPES[UA_TYPES_UINT16], false},
-    {{0, UA_STRING_STATIC("maxRejectedListSize")}, &UA_TYPES[UA_TYPES_STRING], false}
+    {{0, UA_STRING_STATIC("maxRejectedListSize")}, &UA_TYPES[UA_TYPES_STRING], false},
+    {{0, UA_STRING_STATIC("max-verify-cachesize")}, &UA_TYPES[UA_TYPES_UINT32], false}
 };
 
+/* Verification results are cached for repeated connections with the same
+ * certificate. An entry is keyed by the SHA-256 digest of the encoded
+ * certificate (chain) and the generation of the loaded trust list. The
+ * generation is incremented with every reload. So results based on an outdated
+ * trust list or CRL set are never returned. Entries expire after a maximum age,
+ * as the validity periods are checked against the current time. */
+#define MEMORYCERTSTORE_VERIFYCACHE_DEFAULTSIZE 128
+#define MEMORYCERTSTORE_VERIFYCACHE_MAXAGE (60 * UA_DATETIME_SEC)
+
+typedef struct {
+    UA_Byte digest[SHA256_DIGEST_LENGTH];
+    UA_UInt64 generation;
+    UA_UInt64 lastUsed;
+    UA_DateTime expires; /* Monotonic time */
+    UA_StatusCode result;
+} VerifyCacheEntry;
+
 struct MemoryCertStore;
 typedef struct MemoryCertStore MemoryCertStore;
 
@@ -48,10 +68,16 @@ struct MemoryCertStore {
     UA_UInt32 maxRejectedListSize;
 
     UA_Boolean reloadRequired;
+    UA_UInt64 generation; /* Incremented for every reload */
 
     STACK_OF(X509) *trustedCertificates;
     STACK_OF(X509) *issuerCertificates;
     STACK_OF(X509_CRL) *crls;
+
+    /* Verification result cache with LRU replacement */
+    size_t verifyCacheSize;
+    VerifyCacheEntry *verifyCache;
+    UA_UInt64 verifyCacheClock;
 };
 
 static UA_Boolean
@@ -265,6 +291,7 @@ MemoryCertStore_clear(UA_CertificateGroup *certGroup) {
         sk_X509_pop_free (context->issuerCertificates, X509_free);
         sk_X509_CRL_pop_free (context->crls, X509_CRL_free);
 
+        UA_free(context->verifyCache);
         UA_free(context);
         certGroup->context = NULL;
     }
@@ -279,6 +306,9 @@ reloadCertificates(UA_CertificateGroup *certGroup) {
 
     MemoryCertStore *context = (MemoryCertStore *)certGroup->context;
 
+    /* Invalidate all cached verification results */
+    context->generation++;
+
     sk_X509_pop_free(context->trustedCertificates, X509_free);
     context->trustedCertificates = sk_X509_new_null();
     if(context->trustedCertificates == NULL) {
@@ -622,23 +652,52 @@ openSSL_verifyChain(UA_CertificateGroup *cg, MemoryCertStore *ctx, STACK_OF(X509
     return ret;
 }
 
+static VerifyCacheEntry *
+verifyCacheLookup(MemoryCertStore *ctx, const UA_Byte *digest, UA_DateTime now) {
+    for(size_t i = 0; i < ctx->verifyCacheSize; i++) {
+        VerifyCacheEntry *e = &ctx->verifyCache[i];
+        if(e->generation != ctx->generation || e->expires <= now ||
+           memcmp(e->digest, digest, SHA256_DIGEST_LENGTH) != 0)
+            continue;
+        e->lastUsed = ++ctx->verifyCacheClock;
+        return e;
+    }
+    return NULL;
+}
+
+static void
+verifyCacheStore(MemoryCertStore *ctx, const UA_Byte *digest,
+                 UA_DateTime now, UA_StatusCode result) {
+    /* Don't cache results of transient failures */
+    if(result == UA_STATUSCODE_BADOUTOFMEMORY ||
+       result == UA_STATUSCODE_BADINTERNALERROR)
+        return;
+
+    /* Replace an outdated or else the least recently used entry */
+    VerifyCacheEntry *e = &ctx->verifyCache[0];
+    for(size_t i = 0; i < ctx->verifyCacheSize; i++) {
+        VerifyCacheEntry *c = &ctx->verifyCache[i];
+        if(c->generation != ctx->generation || c->expires <= now) {
+            e = c;
+            break;
+        }
+        if(c->lastUsed < e->lastUsed)
+            e = c;
+    }
+
+    memcpy(e->digest, digest, SHA256_DIGEST_LENGTH);
+    e->generation = ctx->generation;
+    e->lastUsed = ++ctx->verifyCacheClock;
+    e->expires = now + MEMORYCERTSTORE_VERIFYCACHE_MAXAGE;
+    e->result = result;
+}
+
 /* This follows Part 6, 6.1.3 Determining if a Certificate is trusted.
  * It defines a sequence of steps for certificate verification. */
 static UA_StatusCode
-verifyCertificate(UA_CertificateGroup *certGroup, const UA_ByteString *certificate) {
-    /* Check parameter */
-    if (certGroup == NULL || certGroup->context == NULL) {
-        return UA_STATUSCODE_BADINTERNALERROR;
-    }
-
+verifyCertificateUncached(UA_CertificateGroup *certGroup, const UA_ByteString *certificate) {
     UA_StatusCode ret = UA_STATUSCODE_GOOD;
     MemoryCertStore *context = (MemoryCertStore *)certGroup->context;
-    if(context->reloadRequired) {
-        ret = reloadCertificates(certGroup);
-        if(ret != UA_STATUSCODE_GOOD)
-            return ret;
-        context->reloadRequired = false;
-    }
 
     /* Verification Step: Certificate Structure */
     STACK_OF(X509) *stack = openSSLLoadCertificateStack(*certificate);
@@ -671,6 +730,41 @@ verifyCertificate(UA_CertificateGroup *certGroup, const UA_ByteString *certifica
     return ret;
 }
 
+static UA_StatusCode
+verifyCertificate(UA_CertificateGroup *certGroup, const UA_ByteString *certificate) {
+    /* Check parameter */
+    if (certGroup == NULL || certGroup->context == NULL) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Reload after a trust list change. This also invalidates the cache. */
+    MemoryCertStore *context = (MemoryCertStore *)certGroup->context;
+    if(context->reloadRequired) {
+        UA_StatusCode ret = reloadCertificates(certGroup);
+        if(ret != UA_STATUSCODE_GOOD)
+            return ret;
+        context->reloadRequired = false;
+    }
+
+    if(context->verifyCacheSize == 0)
+        return verifyCertificateUncached(certGroup, certificate);
+
+    /* Look up the cached result */
+    UA_Byte digest[SHA256_DIGEST_LENGTH];
+    if(EVP_Digest(certificate->data, certificate->length, digest,
+                  NULL, EVP_sha256(), NULL) != 1)
+        return verifyCertificateUncached(certGroup, certificate);
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    VerifyCacheEntry *e = verifyCacheLookup(context, digest, now);
+    if(e)
+        return e->result;
+
+    /* Verify and cache the result */
+    UA_StatusCode ret = verifyCertificateUncached(certGroup, certificate);
+    verifyCacheStore(context, digest, now, ret);
+    return ret;
+}
+
 static UA_StatusCode
 MemoryCertStore_verifyCertificate(UA_CertificateGroup *certGroup,
                                   const UA_ByteString *certificate) {
@@ -728,6 +822,7 @@ UA_CertificateGroup_Memorystore(UA_CertificateGroup *certGroup,
     /* Default values */
     context->maxTrustListSize = 65535;
     context->maxRejectedListSize = 100;
+    context->verifyCacheSize = MEMORYCERTSTORE_VERIFYCACHE_DEFAULTSIZE;
 
     if(params) {
         const UA_UInt32 *maxTrustListSize = (const UA_UInt32*)
@@ -745,6 +840,22 @@ UA_CertificateGroup_Memorystore(UA_CertificateGroup *certGroup,
         if(maxRejectedListSize) {
             context->maxRejectedListSize = *maxRejectedListSize;
         }
+
+        const UA_UInt32 *maxVerifyCacheSize = (const UA_UInt32*)
+        UA_KeyValueMap_getScalar(params, MemoryCertStoreParameters[MEMORYCERTSTORE_PARAMINDEX_MAXVERIFYCACHESIZE].name,
+                                 &UA_TYPES[UA_TYPES_UINT32]);
+        if(maxVerifyCacheSize) {
+            context->verifyCacheSize = *maxVerifyCacheSize;
+        }
+    }
+
+    if(context->verifyCacheSize > 0) {
+        context->verifyCache = (VerifyCacheEntry*)
+            UA_calloc(context->verifyCacheSize, sizeof(VerifyCacheEntry));
+        if(!context->verifyCache) {
+            retval = UA_STATUSCODE_BADOUTOFMEMORY;
+            goto cleanup;
+        }
     }
 
     UA_TrustListDataType_add(trustList, &context->trustList);
@@ -42,6 +42,8 @@ typedef struct {
     UA_ByteString remoteSymSigningKey;
     UA_ByteString remoteSymEncryptingKey;
     UA_ByteString remoteSymIv;
+    UA_OpenSSL_SymContext localSymCtx;
+    UA_OpenSSL_SymContext remoteSymCtx;
 
     Policy_Context_Aes128Sha256RsaOaep *policyContext;
     UA_ByteString remoteCertificate;
@@ -215,6 +217,8 @@ UA_ChannelModule_Aes128Sha256RsaOaep_New_Context(const UA_SecurityPolicy *securi
     UA_ByteString_init(&context->remoteSymSigningKey);
     UA_ByteString_init(&context->remoteSymEncryptingKey);
     UA_ByteString_init(&context->remoteSymIv);
+    memset(&context->localSymCtx, 0, sizeof(UA_OpenSSL_SymContext));
+    memset(&context->remoteSymCtx, 0, sizeof(UA_OpenSSL_SymContext));
 
     UA_StatusCode retval =
         UA_copyCertificate(&context->remoteCertificate, remoteCertificate);
@@ -258,6 +262,8 @@ UA_ChannelModule_Aes128Sha256RsaOaep_Delete_Context(void *channelContext) {
         UA_ByteString_clear(&cc->remoteSymSigningKey);
         UA_ByteString_clear(&cc->remoteSymEncryptingKey);
         UA_ByteString_clear(&cc->remoteSymIv);
+        UA_OpenSSL_SymContext_clear(&cc->localSymCtx);
+        UA_OpenSSL_SymContext_clear(&cc->remoteSymCtx);
 
         UA_LOG_INFO(
             cc->policyContext->logger, UA_LOGCATEGORY_SECURITYPOLICY,
@@ -417,6 +423,7 @@ UA_ChannelModule_Aes128Sha256RsaOaep_setLocalSymSigningKey(void *channelContext,
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
     UA_ByteString_clear(&cc->localSymSigningKey);
+    cc->localSymCtx.macKeyed = false;
     return UA_ByteString_copy(key, &cc->localSymSigningKey);
 }
 
@@ -428,6 +435,7 @@ UA_ChannelM_Aes128Sha256RsaOaep_setLocalSymEncryptingKey(void *channelContext,
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
     UA_ByteString_clear(&cc->localSymEncryptingKey);
+    cc->localSymCtx.cipherKeyed = false;
     return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
 }
 
@@ -467,6 +475,7 @@ UA_ChannelM_Aes128Sha256RsaOaep_setRemoteSymSigningKey(void *channelContext,
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
     UA_ByteString_clear(&cc->remoteSymSigningKey);
+    cc->remoteSymCtx.macKeyed = false;
     return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
 }
 
@@ -478,6 +487,7 @@ UA_ChannelM_Aes128Sha256RsaOaep_setRemoteSymEncryptingKey(void *channelContext,
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
     UA_ByteString_clear(&cc->remoteSymEncryptingKey);
+    cc->remoteSymCtx.cipherKeyed = false;
     return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
 }
 
@@ -527,7 +537,8 @@ UA_SymSig_Aes128Sha256RsaOaep_verify(void *channelContext, const UA_ByteString *
 
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Verify(message, &cc->remoteSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA256_Verify(&cc->remoteSymCtx,
+                                         message, &cc->remoteSymSigningKey, signature);
 }
 
 static UA_StatusCode
@@ -539,7 +550,8 @@ UA_SymSig_Aes128Sha256RsaOaep_sign(void *channelContext, const UA_ByteString *me
 
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Sign(message, &cc->localSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA256_Sign(&cc->localSymCtx,
+                                       message, &cc->localSymSigningKey, signature);
 }
 
 static size_t
@@ -553,7 +565,8 @@ UA_SymEn_Aes128Sha256RsaOaep_decrypt(void *channelContext, UA_ByteString *data)
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
-    return UA_OpenSSL_AES_128_CBC_Decrypt(&cc->remoteSymIv, &cc->remoteSymEncryptingKey,
+    return UA_OpenSSL_AES_128_CBC_Decrypt(&cc->remoteSymCtx,
+                                          &cc->remoteSymIv, &cc->remoteSymEncryptingKey,
                                           data);
 }
 
@@ -564,7 +577,8 @@ UA_SymEn_Aes128Sha256RsaOaep_encrypt(void *channelContext, UA_ByteString *data)
 
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
-    return UA_OpenSSL_AES_128_CBC_Encrypt(&cc->localSymIv, &cc->localSymEncryptingKey,
+    return UA_OpenSSL_AES_128_CBC_Encrypt(&cc->localSymCtx,
+                                          &cc->localSymIv, &cc->localSymEncryptingKey,
                                           data);
 }
 
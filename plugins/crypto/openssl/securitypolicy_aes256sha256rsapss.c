@@ -42,6 +42,8 @@ typedef struct {
     UA_ByteString remoteSymSigningKey;
     UA_ByteString remoteSymEncryptingKey;
     UA_ByteString remoteSymIv;
+    UA_OpenSSL_SymContext localSymCtx;
+    UA_OpenSSL_SymContext remoteSymCtx;
 
     Policy_Context_Aes256Sha256RsaPss *policyContext;
     UA_ByteString remoteCertificate;
@@ -212,6 +214,8 @@ UA_ChannelModule_Aes256Sha256RsaPss_New_Context(const UA_SecurityPolicy *securit
     UA_ByteString_init(&context->remoteSymSigningKey);
     UA_ByteString_init(&context->remoteSymEncryptingKey);
     UA_ByteString_init(&context->remoteSymIv);
+    memset(&context->localSymCtx, 0, sizeof(UA_OpenSSL_SymContext));
+    memset(&context->remoteSymCtx, 0, sizeof(UA_OpenSSL_SymContext));
 
     UA_StatusCode retval =
         UA_copyCertificate(&context->remoteCertificate, remoteCertificate);
@@ -255,6 +259,8 @@ UA_ChannelModule_Aes256Sha256RsaPss_Delete_Context(void *channelContext) {
         UA_ByteString_clear(&cc->remoteSymSigningKey);
         UA_ByteString_clear(&cc->remoteSymEncryptingKey);
         UA_ByteString_clear(&cc->remoteSymIv);
+        UA_OpenSSL_SymContext_clear(&cc->localSymCtx);
+        UA_OpenSSL_SymContext_clear(&cc->remoteSymCtx);
 
         UA_LOG_INFO(
             cc->policyContext->logger, UA_LOGCATEGORY_SECURITYPOLICY,
@@ -463,6 +469,7 @@ UA_ChannelModule_Aes256Sha256RsaPss_setLocalSymSigningKey(void *channelContext,
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
     UA_ByteString_clear(&cc->localSymSigningKey);
+    cc->localSymCtx.macKeyed = false;
     return UA_ByteString_copy(key, &cc->localSymSigningKey);
 }
 
@@ -474,6 +481,7 @@ UA_ChannelM_Aes256Sha256RsaPss_setLocalSymEncryptingKey(void *channelContext,
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
     UA_ByteString_clear(&cc->localSymEncryptingKey);
+    cc->localSymCtx.cipherKeyed = false;
     return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
 }
 
@@ -513,6 +521,7 @@ UA_ChannelM_Aes256Sha256RsaPss_setRemoteSymSigningKey(void *channelContext,
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
     UA_ByteString_clear(&cc->remoteSymSigningKey);
+    cc->remoteSymCtx.macKeyed = false;
     return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
 }
 
@@ -524,6 +533,7 @@ UA_ChannelM_Aes256Sha256RsaPss_setRemoteSymEncryptingKey(void *channelContext,
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
     UA_ByteString_clear(&cc->remoteSymEncryptingKey);
+    cc->remoteSymCtx.cipherKeyed = false;
     return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
 }
 
@@ -575,7 +585,8 @@ UA_SymSig_Aes256Sha256RsaPss_verify(void *channelContext, const UA_ByteString *m
 
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Verify(message, &cc->remoteSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA256_Verify(&cc->remoteSymCtx,
+                                         message, &cc->remoteSymSigningKey, signature);
 }
 
 static UA_StatusCode
@@ -587,7 +598,8 @@ UA_SymSig_Aes256Sha256RsaPss_sign(void *channelContext, const UA_ByteString *mes
 
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Sign(message, &cc->localSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA256_Sign(&cc->localSymCtx,
+                                       message, &cc->localSymSigningKey, signature);
 }
 
 static size_t
@@ -601,7 +613,8 @@ UA_SymEn_Aes256Sha256RsaPss_decrypt(void *channelContext, UA_ByteString *data) {
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
-    return UA_OpenSSL_AES_256_CBC_Decrypt(&cc->remoteSymIv, &cc->remoteSymEncryptingKey,
+    return UA_OpenSSL_AES_256_CBC_Decrypt(&cc->remoteSymCtx,
+                                          &cc->remoteSymIv, &cc->remoteSymEncryptingKey,
                                           data);
 }
 
@@ -612,7 +625,8 @@ UA_SymEn_Aes256Sha256RsaPss_encrypt(void *channelContext, UA_ByteString *data) {
 
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
-    return UA_OpenSSL_AES_256_CBC_Encrypt(&cc->localSymIv, &cc->localSymEncryptingKey,
+    return UA_OpenSSL_AES_256_CBC_Encrypt(&cc->localSymCtx,
+                                          &cc->localSymIv, &cc->localSymEncryptingKey,
                                           data);
 }
 
@@ -38,6 +38,8 @@ typedef struct {
     UA_ByteString             remoteSymSigningKey;
     UA_ByteString             remoteSymEncryptingKey;
     UA_ByteString             remoteSymIv;
+    UA_OpenSSL_SymContext     localSymCtx;
+    UA_OpenSSL_SymContext     remoteSymCtx;
 
     Policy_Context_Basic128Rsa15 * policyContext;
     UA_ByteString             remoteCertificate;
@@ -207,6 +209,8 @@ UA_ChannelModule_Basic128Rsa15_New_Context (const UA_SecurityPolicy * securityPo
     UA_ByteString_init(&context->remoteSymSigningKey);
     UA_ByteString_init(&context->remoteSymEncryptingKey);
     UA_ByteString_init(&context->remoteSymIv);
+    memset(&context->localSymCtx, 0, sizeof(UA_OpenSSL_SymContext));
+    memset(&context->remoteSymCtx, 0, sizeof(UA_OpenSSL_SymContext));
 
     UA_StatusCode retval = UA_copyCertificate (&context->remoteCertificate,
                                                remoteCertificate);
@@ -250,6 +254,8 @@ UA_ChannelModule_Basic128Rsa15_Delete_Context (void * channelContext) {
         UA_ByteString_clear (&cc->remoteSymSigningKey);
         UA_ByteString_clear (&cc->remoteSymEncryptingKey);
         UA_ByteString_clear (&cc->remoteSymIv);
+        UA_OpenSSL_SymContext_clear (&cc->localSymCtx);
+        UA_OpenSSL_SymContext_clear (&cc->remoteSymCtx);
         UA_LOG_INFO (cc->policyContext->logger,
                  UA_LOGCATEGORY_SECURITYPOLICY,
                  "The Basic128Rsa15 security policy channel with openssl is deleted.");
@@ -267,6 +273,7 @@ UA_ChannelModule_Basic128Rsa15_setLocalSymSigningKey (void *                chan
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
     UA_ByteString_clear(&cc->localSymSigningKey);
+    cc->localSymCtx.macKeyed = false;
     return UA_ByteString_copy(key, &cc->localSymSigningKey);
 }
 
@@ -279,6 +286,7 @@ UA_ChannelModule_Basic128Rsa15_setLocalSymEncryptingKey (void *                c
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
     UA_ByteString_clear(&cc->localSymEncryptingKey);
+    cc->localSymCtx.cipherKeyed = false;
     return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
 }
 
@@ -303,6 +311,7 @@ UA_ChannelModule_Basic128Rsa15_setRemoteSymSigningKey (void *                cha
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
     UA_ByteString_clear(&cc->remoteSymSigningKey);
+    cc->remoteSymCtx.macKeyed = false;
     return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
 }
 
@@ -315,6 +324,7 @@ UA_ChannelModule_Basic128Rsa15_setRemoteSymEncryptingKey (void *
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
     UA_ByteString_clear(&cc->remoteSymEncryptingKey);
+    cc->remoteSymCtx.cipherKeyed = false;
     return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
 }
 
@@ -534,7 +544,8 @@ UA_SymEn_Basic128Rsa15_Encrypt (void *channelContext,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
-    return UA_OpenSSL_AES_128_CBC_Encrypt (&cc->localSymIv, &cc->localSymEncryptingKey, data);
+    return UA_OpenSSL_AES_128_CBC_Encrypt (&cc->localSymCtx,
+                                           &cc->localSymIv, &cc->localSymEncryptingKey, data);
 }
 
 static UA_StatusCode
@@ -543,7 +554,8 @@ UA_SymEn_Basic128Rsa15_Decrypt (void *                    channelContext,
     if(channelContext == NULL || data == NULL)
         return UA_STATUSCODE_BADINVALIDARGUMENT;
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
-    return UA_OpenSSL_AES_128_CBC_Decrypt (&cc->remoteSymIv, &cc->remoteSymEncryptingKey, data);
+    return UA_OpenSSL_AES_128_CBC_Decrypt (&cc->remoteSymCtx,
+                                           &cc->remoteSymIv, &cc->remoteSymEncryptingKey, data);
 }
 
 static size_t
@@ -564,7 +576,7 @@ UA_SymSig_Basic128Rsa15_Verify (void *                    channelContext,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
-    return UA_OpenSSL_HMAC_SHA1_Verify (message,
+    return UA_OpenSSL_HMAC_SHA1_Verify (&cc->remoteSymCtx, message,
                                         &cc->remoteSymSigningKey,
                                         signature);
 }
@@ -577,7 +589,8 @@ UA_SymSig_Basic128Rsa15_Sign (void *                    channelContext,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
-    return UA_OpenSSL_HMAC_SHA1_Sign (message, &cc->localSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA1_Sign (&cc->localSymCtx,
+                                      message, &cc->localSymSigningKey, signature);
 }
 
 /* the main entry of Basic128Rsa15 */
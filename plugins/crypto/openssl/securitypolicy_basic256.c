@@ -36,6 +36,8 @@ typedef struct {
     UA_ByteString             remoteSymSigningKey;
     UA_ByteString             remoteSymEncryptingKey;
     UA_ByteString             remoteSymIv;
+    UA_OpenSSL_SymContext     localSymCtx;
+    UA_OpenSSL_SymContext     remoteSymCtx;
 
     Policy_Context_Basic256 * policyContext;
     UA_ByteString             remoteCertificate;
@@ -205,6 +207,8 @@ UA_ChannelModule_Basic256_New_Context (const UA_SecurityPolicy * securityPolicy,
     UA_ByteString_init(&context->remoteSymSigningKey);
     UA_ByteString_init(&context->remoteSymEncryptingKey);
     UA_ByteString_init(&context->remoteSymIv);
+    memset(&context->localSymCtx, 0, sizeof(UA_OpenSSL_SymContext));
+    memset(&context->remoteSymCtx, 0, sizeof(UA_OpenSSL_SymContext));
 
     UA_StatusCode retval = UA_copyCertificate (&context->remoteCertificate,
                                                remoteCertificate);
@@ -248,6 +252,8 @@ UA_ChannelModule_Basic256_Delete_Context (void * channelContext) {
         UA_ByteString_clear (&cc->remoteSymSigningKey);
         UA_ByteString_clear (&cc->remoteSymEncryptingKey);
         UA_ByteString_clear (&cc->remoteSymIv);
+        UA_OpenSSL_SymContext_clear (&cc->localSymCtx);
+        UA_OpenSSL_SymContext_clear (&cc->remoteSymCtx);
         UA_LOG_INFO (cc->policyContext->logger,
                  UA_LOGCATEGORY_SECURITYPOLICY,
                  "The basic256 security policy channel with openssl is deleted.");
@@ -293,6 +299,7 @@ UA_ChannelModule_Basic256_setLocalSymSigningKey (void *                channelCo
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
     UA_ByteString_clear(&cc->localSymSigningKey);
+    cc->localSymCtx.macKeyed = false;
     return UA_ByteString_copy(key, &cc->localSymSigningKey);
 }
 
@@ -305,6 +312,7 @@ UA_ChannelModule_Basic256_setLocalSymEncryptingKey (void *                channe
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
     UA_ByteString_clear(&cc->localSymEncryptingKey);
+    cc->localSymCtx.cipherKeyed = false;
     return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
 }
 
@@ -329,6 +337,7 @@ UA_ChannelModule_Basic256_setRemoteSymSigningKey (void *                channelC
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
     UA_ByteString_clear(&cc->remoteSymSigningKey);
+    cc->remoteSymCtx.macKeyed = false;
     return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
 }
 
@@ -341,6 +350,7 @@ UA_ChannelModule_Basic256_setRemoteSymEncryptingKey (void *                chann
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
     UA_ByteString_clear(&cc->remoteSymEncryptingKey);
+    cc->remoteSymCtx.cipherKeyed = false;
     return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
 }
 
@@ -535,7 +545,8 @@ UA_SymEn_Basic256_Encrypt (void *                    channelContext,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
-    return UA_OpenSSL_AES_256_CBC_Encrypt (&cc->localSymIv, &cc->localSymEncryptingKey, data);
+    return UA_OpenSSL_AES_256_CBC_Encrypt (&cc->localSymCtx,
+                                           &cc->localSymIv, &cc->localSymEncryptingKey, data);
 }
 
 static UA_StatusCode
@@ -544,7 +555,8 @@ UA_SymEn_Basic256_Decrypt (void *                    channelContext,
     if(channelContext == NULL || data == NULL)
         return UA_STATUSCODE_BADINVALIDARGUMENT;
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
-    return UA_OpenSSL_AES_256_CBC_Decrypt (&cc->remoteSymIv, &cc->remoteSymEncryptingKey, data);
+    return UA_OpenSSL_AES_256_CBC_Decrypt (&cc->remoteSymCtx,
+                                           &cc->remoteSymIv, &cc->remoteSymEncryptingKey, data);
 }
 
 static size_t
@@ -566,7 +578,7 @@ UA_SymSig_Basic256_Verify (void *                    channelContext,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
-    return UA_OpenSSL_HMAC_SHA1_Verify (message,
+    return UA_OpenSSL_HMAC_SHA1_Verify (&cc->remoteSymCtx, message,
                                         &cc->remoteSymSigningKey,
                                         signature);
 }
@@ -579,7 +591,8 @@ UA_SymSig_Basic256_Sign (void *                    channelContext,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
-    return UA_OpenSSL_HMAC_SHA1_Sign (message, &cc->localSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA1_Sign (&cc->localSymCtx,
+                                      message, &cc->localSymSigningKey, signature);
 }
 
 /* the main entry of Basic256 */
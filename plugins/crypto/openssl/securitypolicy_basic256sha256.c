@@ -43,6 +43,8 @@ typedef struct {
     UA_ByteString remoteSymSigningKey;
     UA_ByteString remoteSymEncryptingKey;
     UA_ByteString remoteSymIv;
+    UA_OpenSSL_SymContext localSymCtx;
+    UA_OpenSSL_SymContext remoteSymCtx;
 
     Policy_Context_Basic256Sha256 *policyContext;
     UA_ByteString remoteCertificate;
@@ -204,6 +206,8 @@ UA_ChannelModule_New_Context(const UA_SecurityPolicy * securityPolicy,
     UA_ByteString_init(&context->remoteSymSigningKey);
     UA_ByteString_init(&context->remoteSymEncryptingKey);
     UA_ByteString_init(&context->remoteSymIv);
+    memset(&context->localSymCtx, 0, sizeof(UA_OpenSSL_SymContext));
+    memset(&context->remoteSymCtx, 0, sizeof(UA_OpenSSL_SymContext));
 
     UA_StatusCode retval =
         UA_copyCertificate(&context->remoteCertificate, remoteCertificate);
@@ -246,6 +250,8 @@ UA_ChannelModule_Delete_Context(void * channelContext) {
     UA_ByteString_clear(&cc->remoteSymSigningKey);
     UA_ByteString_clear(&cc->remoteSymEncryptingKey);
     UA_ByteString_clear(&cc->remoteSymIv);
+    UA_OpenSSL_SymContext_clear(&cc->localSymCtx);
+    UA_OpenSSL_SymContext_clear(&cc->remoteSymCtx);
 
     UA_LOG_INFO(cc->policyContext->logger, UA_LOGCATEGORY_SECURITYPOLICY,
                 "The basic256sha256 security policy channel with openssl is deleted.");
@@ -399,6 +405,7 @@ UA_ChannelModule_Basic256Sha256_setLocalSymSigningKey(void * channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
     UA_ByteString_clear(&cc->localSymSigningKey);
+    cc->localSymCtx.macKeyed = false;
     return UA_ByteString_copy(key, &cc->localSymSigningKey);
 }
 
@@ -409,6 +416,7 @@ UA_ChannelM_Basic256Sha256_setLocalSymEncryptingKey(void * channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
     UA_ByteString_clear(&cc->localSymEncryptingKey);
+    cc->localSymCtx.cipherKeyed = false;
     return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
 }
 
@@ -446,6 +454,7 @@ UA_ChannelM_Basic256Sha256_setRemoteSymSigningKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
     UA_ByteString_clear(&cc->remoteSymSigningKey);
+    cc->remoteSymCtx.macKeyed = false;
     return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
 }
 
@@ -456,6 +465,7 @@ UA_ChannelM_Basic256Sha256_setRemoteSymEncryptingKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
     UA_ByteString_clear(&cc->remoteSymEncryptingKey);
+    cc->remoteSymCtx.cipherKeyed = false;
     return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
 }
 
@@ -501,7 +511,8 @@ UA_SymSig_Basic256Sha256_verify(void *channelContext, const UA_ByteString *messa
         return UA_STATUSCODE_BADINTERNALERROR;
 
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Verify(message, &cc->remoteSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA256_Verify(&cc->remoteSymCtx,
+                                         message, &cc->remoteSymSigningKey, signature);
 }
 
 static UA_StatusCode
@@ -511,7 +522,8 @@ UA_SymSig_Basic256Sha256_sign(void *channelContext, const UA_ByteString *message
         return UA_STATUSCODE_BADINTERNALERROR;
 
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Sign(message, &cc->localSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA256_Sign(&cc->localSymCtx,
+                                       message, &cc->localSymSigningKey, signature);
 }
 
 static size_t
@@ -524,7 +536,7 @@ UA_SymEn_Basic256Sha256_decrypt(void *channelContext, UA_ByteString *data) {
     if(channelContext == NULL || data == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
-    return UA_OpenSSL_AES_256_CBC_Decrypt(&cc->remoteSymIv,
+    return UA_OpenSSL_AES_256_CBC_Decrypt(&cc->remoteSymCtx, &cc->remoteSymIv,
                                           &cc->remoteSymEncryptingKey, data);
 }
 
@@ -534,7 +546,8 @@ UA_SymEn_Basic256Sha256_encrypt(void *channelContext, UA_ByteString *data) {
         return UA_STATUSCODE_BADINTERNALERROR;
 
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
-    return UA_OpenSSL_AES_256_CBC_Encrypt(&cc->localSymIv, &cc->localSymEncryptingKey, data);
+    return UA_OpenSSL_AES_256_CBC_Encrypt(&cc->localSymCtx,
+                                          &cc->localSymIv, &cc->localSymEncryptingKey, data);
 }
 
 static UA_StatusCode
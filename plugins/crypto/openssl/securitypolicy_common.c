@@ -33,6 +33,8 @@ modification history
 #include <openssl/ecdsa.h>
 #include <openssl/kdf.h>
 
+#include <limits.h>
+
 #if (OPENSSL_VERSION_NUMBER >= 0x30000000L)
 #include <openssl/core_names.h>
 #endif
@@ -641,199 +643,181 @@ UA_Openssl_RSA_PSS_SHA256_Sign (const UA_ByteString * message,
                                         RSA_PKCS1_PSS_PADDING, outSignature);
 }
 
-UA_StatusCode
-UA_OpenSSL_HMAC_SHA256_Verify (const UA_ByteString *     message,
-                               const UA_ByteString *     key,
-                               const UA_ByteString *     signature
-                              ) {
-    unsigned char buf[SHA256_DIGEST_LENGTH] = {0};
-    UA_ByteString mac = {SHA256_DIGEST_LENGTH, buf};
-
-    if (HMAC (EVP_sha256(), key->data, (int) key->length, message->data, message->length,
-              mac.data, (unsigned int *) &mac.length) == NULL) {
-        return UA_STATUSCODE_BADINTERNALERROR;
-    }
-    if (UA_ByteString_equal (signature, &mac)) {
-        return UA_STATUSCODE_GOOD;
+void
+UA_OpenSSL_SymContext_clear(UA_OpenSSL_SymContext *sc) {
+    if(sc->cipherCtx)
+        EVP_CIPHER_CTX_free(sc->cipherCtx);
+#if (OPENSSL_VERSION_NUMBER >= 0x30000000L)
+    if(sc->macCtx)
+        EVP_MAC_CTX_free(sc->macCtx);
+#else
+    if(sc->macCtx)
+        HMAC_CTX_free(sc->macCtx);
+#endif
+    memset(sc, 0, sizeof(UA_OpenSSL_SymContext));
+}
+
+/* Compute the HMAC with the reusable context. The key is only set after it
+ * has changed. Otherwise the context is reset to the keyed state. */
+static UA_StatusCode
+UA_OpenSSL_HMAC(UA_OpenSSL_SymContext *sc, const EVP_MD *md,
+                const UA_ByteString *key, const UA_ByteString *message,
+                UA_Byte *mac, size_t macSize) {
+    int opensslRet;
+#if (OPENSSL_VERSION_NUMBER >= 0x30000000L)
+    if(!sc->macCtx) {
+        EVP_MAC *hmac = EVP_MAC_fetch(NULL, OSSL_MAC_NAME_HMAC, NULL);
+        if(!hmac)
+            return UA_STATUSCODE_BADINTERNALERROR;
+        sc->macCtx = EVP_MAC_CTX_new(hmac);
+        EVP_MAC_free(hmac); /* The context keeps a reference */
+        if(!sc->macCtx)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        sc->macKeyed = false;
+    }
+
+    if(!sc->macKeyed) {
+        OSSL_PARAM params[2];
+        params[0] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST,
+                                   (char *)(uintptr_t)EVP_MD_get0_name(md), 0);
+        params[1] = OSSL_PARAM_construct_end();
+        opensslRet = EVP_MAC_init(sc->macCtx, key->data, key->length, params);
+    } else {
+        opensslRet = EVP_MAC_init(sc->macCtx, NULL, 0, NULL);
     }
-    else {
+    sc->macKeyed = (opensslRet == 1);
+    if(opensslRet != 1)
         return UA_STATUSCODE_BADINTERNALERROR;
-    }
-}
 
-UA_StatusCode
-UA_OpenSSL_HMAC_SHA256_Sign (const UA_ByteString *     message,
-                             const UA_ByteString *     key,
-                             UA_ByteString *           signature
-                             ) {
-    if (HMAC (EVP_sha256(), key->data, (int) key->length, message->data,
-              message->length,
-              signature->data, (unsigned int *) &(signature->length)) == NULL) {
+    size_t outLen = 0;
+    if(EVP_MAC_update(sc->macCtx, message->data, message->length) != 1 ||
+       EVP_MAC_final(sc->macCtx, mac, &outLen, macSize) != 1 || outLen != macSize)
         return UA_STATUSCODE_BADINTERNALERROR;
-    }
+#else
+    if(!sc->macCtx) {
+        sc->macCtx = HMAC_CTX_new();
+        if(!sc->macCtx)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        sc->macKeyed = false;
+    }
+
+    if(!sc->macKeyed)
+        opensslRet = HMAC_Init_ex(sc->macCtx, key->data, (int)key->length, md, NULL);
+    else
+        opensslRet = HMAC_Init_ex(sc->macCtx, NULL, 0, NULL, NULL);
+    sc->macKeyed = (opensslRet == 1);
+    if(opensslRet != 1)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    unsigned int outLen = 0;
+    if(HMAC_Update(sc->macCtx, message->data, message->length) != 1 ||
+       HMAC_Final(sc->macCtx, mac, &outLen) != 1 || outLen != macSize)
+        return UA_STATUSCODE_BADINTERNALERROR;
+#endif
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-UA_OpenSSL_Decrypt (const UA_ByteString * iv,
-                    const UA_ByteString * key,
-                    const EVP_CIPHER *    cipherAlg,
-                    UA_ByteString *       data  /* [in/out]*/) {
-    UA_ByteString    ivCopy    = {0, NULL};
-    UA_ByteString    cipherTxt = {0, NULL};
-    EVP_CIPHER_CTX * ctx       = NULL;
-    UA_StatusCode    ret;
-    int              opensslRet;
-    int              outLen;
-    int              tmpLen;
-
-    /* copy the IV because the AES_cbc_encrypt function overwrites it. */
-
-    ret = UA_ByteString_copy (iv, &ivCopy);
-    if (ret != UA_STATUSCODE_GOOD) {
-        goto errout;
-    }
-
-    ret = UA_ByteString_copy (data, &cipherTxt);
-    if (ret != UA_STATUSCODE_GOOD) {
-        goto errout;
-    }
-
-    ctx = EVP_CIPHER_CTX_new ();
-    if (ctx == NULL) {
-        ret = UA_STATUSCODE_BADOUTOFMEMORY;
-        goto errout;
-    }
-
-    /* call EVP_* to decrypt */
-
-    opensslRet = EVP_DecryptInit_ex (ctx, cipherAlg, NULL, key->data, ivCopy.data);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    /* EVP_DecryptFinal() will return an error code if padding is enabled
-     * and the final block is not correctly formatted.
-     */
-    EVP_CIPHER_CTX_set_padding (ctx, 0);
-    opensslRet = EVP_DecryptUpdate (ctx, data->data, &outLen,
-                                    cipherTxt.data, (int) cipherTxt.length);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    opensslRet = EVP_DecryptFinal_ex (ctx, data->data + outLen, &tmpLen);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    outLen += tmpLen;
-    data->length = (size_t) outLen;
-    ret = UA_STATUSCODE_GOOD;
-
-errout:
-    UA_ByteString_clear (&ivCopy);
-    UA_ByteString_clear (&cipherTxt);
-    if (ctx != NULL) {
-        EVP_CIPHER_CTX_free(ctx);
-    }
-    return ret;
+UA_OpenSSL_HMAC_Verify(UA_OpenSSL_SymContext *sc, const EVP_MD *md,
+                       const UA_ByteString *message, const UA_ByteString *key,
+                       const UA_ByteString *signature) {
+    unsigned char buf[EVP_MAX_MD_SIZE];
+    UA_ByteString mac = {(size_t)EVP_MD_size(md), buf};
+    UA_StatusCode ret = UA_OpenSSL_HMAC(sc, md, key, message, mac.data, mac.length);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+    if(!UA_ByteString_equal(signature, &mac))
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-UA_OpenSSL_Encrypt (const UA_ByteString * iv,
-                    const UA_ByteString * key,
-                    const EVP_CIPHER *    cipherAlg,
-                    UA_ByteString *       data  /* [in/out]*/
-                    ) {
-
-    UA_ByteString    ivCopy   = {0, NULL};
-    UA_ByteString    plainTxt = {0, NULL};
-    EVP_CIPHER_CTX * ctx      = NULL;
-    UA_StatusCode    ret;
-    int              opensslRet;
-    int              outLen;
-    int              tmpLen;
-
-    /* copy the IV because the AES_cbc_encrypt function overwrites it. */
-
-    ret = UA_ByteString_copy (iv, &ivCopy);
-    if (ret != UA_STATUSCODE_GOOD) {
-        goto errout;
-    }
-
-    ret = UA_ByteString_copy (data, &plainTxt);
-    if (ret != UA_STATUSCODE_GOOD) {
-        goto errout;
-    }
-
-    ctx = EVP_CIPHER_CTX_new ();
-    if (ctx == NULL) {
-        ret = UA_STATUSCODE_BADOUTOFMEMORY;
-        goto errout;
-    }
+UA_OpenSSL_HMAC_Sign(UA_OpenSSL_SymContext *sc, const EVP_MD *md,
+                     const UA_ByteString *message, const UA_ByteString *key,
+                     UA_ByteString *signature) {
+    size_t macSize = (size_t)EVP_MD_size(md);
+    if(signature->length < macSize)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    UA_StatusCode ret = UA_OpenSSL_HMAC(sc, md, key, message, signature->data, macSize);
+    if(ret == UA_STATUSCODE_GOOD)
+        signature->length = macSize;
+    return ret;
+}
 
-    /* call EVP_* to encrypt */
+UA_StatusCode
+UA_OpenSSL_HMAC_SHA256_Verify(UA_OpenSSL_SymContext *sc,
+                              const UA_ByteString *message,
+                              const UA_ByteString *key,
+                              const UA_ByteString *signature) {
+    return UA_OpenSSL_HMAC_Verify(sc, EVP_sha256(), message, key, signature);
+}
 
-    opensslRet = EVP_EncryptInit_ex (ctx, cipherAlg, NULL, key->data, ivCopy.data);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
+UA_StatusCode
+UA_OpenSSL_HMAC_SHA256_Sign(UA_OpenSSL_SymContext *sc,
+                            const UA_ByteString *message,
+                            const UA_ByteString *key,
+                            UA_ByteString *signature) {
+    return UA_OpenSSL_HMAC_Sign(sc, EVP_sha256(), message, key, signature);
+}
 
-    /* Disable padding. Padding is done in the stack before calling encryption.
-     * Ensure that we have a multiple of the block size */
-    if(data->length % (size_t)EVP_CIPHER_CTX_block_size(ctx)) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    opensslRet = EVP_CIPHER_CTX_set_padding(ctx, 0);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
+/* AES-CBC in place over the data with the reusable context. The key schedule
+ * is only computed after the key has changed. Otherwise only the IV is reset.
+ * Padding is done in the stack before calling the encryption. */
+static UA_StatusCode
+UA_OpenSSL_CBC(UA_OpenSSL_SymContext *sc, const EVP_CIPHER *cipherAlg, int enc,
+               const UA_ByteString *iv, const UA_ByteString *key,
+               UA_ByteString *data  /* [in/out]*/) {
+    if(!sc->cipherCtx) {
+        sc->cipherCtx = EVP_CIPHER_CTX_new();
+        if(!sc->cipherCtx)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        sc->cipherKeyed = false;
+    }
+
+    if(!sc->cipherKeyed) {
+        if(key->length < (size_t)EVP_CIPHER_key_length(cipherAlg) ||
+           EVP_CipherInit_ex(sc->cipherCtx, cipherAlg, NULL,
+                             key->data, NULL, enc) != 1)
+            return UA_STATUSCODE_BADINTERNALERROR;
+        sc->cipherKeyed = true;
     }
 
-    /* Encrypt the data */
-    opensslRet = EVP_EncryptUpdate (ctx, data->data, &outLen,
-                                    plainTxt.data, (int) plainTxt.length);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
+    if(iv->length < (size_t)EVP_CIPHER_CTX_iv_length(sc->cipherCtx) ||
+       EVP_CipherInit_ex(sc->cipherCtx, NULL, NULL, NULL, iv->data, enc) != 1 ||
+       EVP_CIPHER_CTX_set_padding(sc->cipherCtx, 0) != 1)
+        return UA_STATUSCODE_BADINTERNALERROR;
 
-    /* Encrypt-final does nothing as padding is disabled */
-    opensslRet = EVP_EncryptFinal_ex(ctx, data->data + outLen, &tmpLen);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    outLen += tmpLen;
-    data->length = (size_t) outLen;
-    ret = UA_STATUSCODE_GOOD;
+    /* Padding is disabled. Ensure that we have a multiple of the block size. */
+    if(data->length % (size_t)EVP_CIPHER_CTX_block_size(sc->cipherCtx) != 0 ||
+       data->length > INT_MAX)
+        return UA_STATUSCODE_BADINTERNALERROR;
 
-errout:
-    UA_ByteString_clear (&ivCopy);
-    UA_ByteString_clear (&plainTxt);
-    if (ctx != NULL) {
-        EVP_CIPHER_CTX_free(ctx);
-    }
-    return ret;
+    /* CBC allows the input and output buffer to be identical. The final step
+     * does nothing as padding is disabled. */
+    int outLen = 0;
+    int tmpLen = 0;
+    if(EVP_CipherUpdate(sc->cipherCtx, data->data, &outLen,
+                        data->data, (int)data->length) != 1 ||
+       EVP_CipherFinal_ex(sc->cipherCtx, data->data + outLen, &tmpLen) != 1)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    data->length = (size_t)(outLen + tmpLen);
+    return UA_STATUSCODE_GOOD;
 }
 
 UA_StatusCode
-UA_OpenSSL_AES_256_CBC_Decrypt (const UA_ByteString * iv,
-                                const UA_ByteString * key,
-                                UA_ByteString *       data  /* [in/out]*/
-                                ) {
-    return UA_OpenSSL_Decrypt (iv, key, EVP_aes_256_cbc (), data);
+UA_OpenSSL_AES_256_CBC_Decrypt(UA_OpenSSL_SymContext *sc,
+                               const UA_ByteString *iv,
+                               const UA_ByteString *key,
+                               UA_ByteString *data  /* [in/out]*/) {
+    return UA_OpenSSL_CBC(sc, EVP_aes_256_cbc(), 0, iv, key, data);
 }
 
 UA_StatusCode
-UA_OpenSSL_AES_256_CBC_Encrypt (const UA_ByteString * iv,
-                            const UA_ByteString * key,
-                            UA_ByteString *       data  /* [in/out]*/
-                            ) {
-    return UA_OpenSSL_Encrypt (iv, key, EVP_aes_256_cbc (), data);
+UA_OpenSSL_AES_256_CBC_Encrypt(UA_OpenSSL_SymContext *sc,
+                               const UA_ByteString *iv,
+                               const UA_ByteString *key,
+                               UA_ByteString *data  /* [in/out]*/) {
+    return UA_OpenSSL_CBC(sc, EVP_aes_256_cbc(), 1, iv, key, data);
 }
 
 UA_StatusCode
@@ -949,36 +933,19 @@ UA_Openssl_Random_Key_PSHA1_Derive (const UA_ByteString *     secret,
 }
 
 UA_StatusCode
-UA_OpenSSL_HMAC_SHA1_Verify (const UA_ByteString *     message,
-                             const UA_ByteString *     key,
-                             const UA_ByteString *     signature
-                             ) {
-    unsigned char buf[SHA1_DIGEST_LENGTH] = {0};
-    UA_ByteString mac = {SHA1_DIGEST_LENGTH, buf};
-
-    if(HMAC (EVP_sha1(), key->data, (int) key->length, message->data, message->length,
-             mac.data, (unsigned int *) &mac.length) == NULL) {
-        return UA_STATUSCODE_BADINTERNALERROR;
-    }
-    if (UA_ByteString_equal (signature, &mac)) {
-        return UA_STATUSCODE_GOOD;
-    }
-    else {
-        return UA_STATUSCODE_BADINTERNALERROR;
-    }
+UA_OpenSSL_HMAC_SHA1_Verify(UA_OpenSSL_SymContext *sc,
+                            const UA_ByteString *message,
+                            const UA_ByteString *key,
+                            const UA_ByteString *signature) {
+    return UA_OpenSSL_HMAC_Verify(sc, EVP_sha1(), message, key, signature);
 }
 
 UA_StatusCode
-UA_OpenSSL_HMAC_SHA1_Sign (const UA_ByteString *     message,
-                           const UA_ByteString *     key,
-                           UA_ByteString *           signature
-                           ) {
-    if (HMAC (EVP_sha1(), key->data, (int) key->length, message->data,
-              message->length,
-              signature->data, (unsigned int *) &(signature->length)) == NULL) {
-        return UA_STATUSCODE_BADINTERNALERROR;
-    }
-    return UA_STATUSCODE_GOOD;
+UA_OpenSSL_HMAC_SHA1_Sign(UA_OpenSSL_SymContext *sc,
+                          const UA_ByteString *message,
+                          const UA_ByteString *key,
+                          UA_ByteString *signature) {
+    return UA_OpenSSL_HMAC_Sign(sc, EVP_sha1(), message, key, signature);
 }
 
 UA_StatusCode
@@ -1006,19 +973,19 @@ UA_Openssl_RSA_PKCS1_V15_Encrypt (UA_ByteString * data,
 }
 
 UA_StatusCode
-UA_OpenSSL_AES_128_CBC_Decrypt (const UA_ByteString * iv,
-                                const UA_ByteString * key,
-                                UA_ByteString *       data  /* [in/out]*/
-                                ) {
-    return UA_OpenSSL_Decrypt (iv, key, EVP_aes_128_cbc (), data);
+UA_OpenSSL_AES_128_CBC_Decrypt(UA_OpenSSL_SymContext *sc,
+                               const UA_ByteString *iv,
+                               const UA_ByteString *key,
+                               UA_ByteString *data  /* [in/out]*/) {
+    return UA_OpenSSL_CBC(sc, EVP_aes_128_cbc(), 0, iv, key, data);
 }
 
 UA_StatusCode
-UA_OpenSSL_AES_128_CBC_Encrypt (const UA_ByteString * iv,
-                                const UA_ByteString * key,
-                                UA_ByteString *       data  /* [in/out]*/
-                                ) {
-    return UA_OpenSSL_Encrypt (iv, key, EVP_aes_128_cbc (), data);
+UA_OpenSSL_AES_128_CBC_Encrypt(UA_OpenSSL_SymContext *sc,
+                               const UA_ByteString *iv,
+                               const UA_ByteString *key,
+                               UA_ByteString *data  /* [in/out]*/) {
+    return UA_OpenSSL_CBC(sc, EVP_aes_128_cbc(), 1, iv, key, data);
 }
 
 static UA_StatusCode
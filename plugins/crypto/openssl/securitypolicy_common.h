@@ -18,6 +18,7 @@
 
 #include <openssl/x509.h>
 #include <openssl/evp.h>
+#include <openssl/hmac.h>
 
 #define UA_SHA1_LENGTH 20
 
@@ -52,6 +53,24 @@ _UA_BEGIN_DECLS
 #define get_error_line_data(pFile, pLine, pData, pFlags) ERR_get_error_all(pFile, pLine, NULL, pData, pFlags)
 #endif
 
+/* Reusable symmetric crypto contexts for one direction of a SecureChannel.
+ * The cipher and HMAC contexts are keyed on first use after the key was set
+ * and then only reinitialized with the IV (or reset) for every chunk. This
+ * avoids allocating contexts and recomputing the key schedule per chunk. */
+typedef struct {
+    EVP_CIPHER_CTX *cipherCtx;
+#if (OPENSSL_VERSION_NUMBER >= 0x30000000L)
+    EVP_MAC_CTX *macCtx;
+#else
+    HMAC_CTX *macCtx;
+#endif
+    UA_Boolean cipherKeyed;
+    UA_Boolean macKeyed;
+} UA_OpenSSL_SymContext;
+
+void
+UA_OpenSSL_SymContext_clear(UA_OpenSSL_SymContext *sc);
+
 void saveDataToFile(const char *fileName, const UA_ByteString *str);
 void UA_Openssl_Init(void);
 
@@ -133,22 +152,26 @@ UA_Openssl_ECDSA_SHA256_Verify (const UA_ByteString * message,
                                 const UA_ByteString * signature);
 
 UA_StatusCode
-UA_OpenSSL_HMAC_SHA256_Verify(const UA_ByteString *message,
+UA_OpenSSL_HMAC_SHA256_Verify(UA_OpenSSL_SymContext *sc,
+                              const UA_ByteString *message,
                               const UA_ByteString *key,
                               const UA_ByteString *signature);
 
 UA_StatusCode
-UA_OpenSSL_HMAC_SHA256_Sign(const UA_ByteString *message,
+UA_OpenSSL_HMAC_SHA256_Sign(UA_OpenSSL_SymContext *sc,
+                            const UA_ByteString *message,
                             const UA_ByteString *key,
                             UA_ByteString *signature);
 
 UA_StatusCode
-UA_OpenSSL_AES_256_CBC_Decrypt(const UA_ByteString *iv,
+UA_OpenSSL_AES_256_CBC_Decrypt(UA_OpenSSL_SymContext *sc,
+                               const UA_ByteString *iv,
                                const UA_ByteString *key,
                                UA_ByteString *data  /* [in/out]*/);
 
 UA_StatusCode
-UA_OpenSSL_AES_256_CBC_Encrypt(const UA_ByteString *iv,
+UA_OpenSSL_AES_256_CBC_Encrypt(UA_OpenSSL_SymContext *sc,
+                               const UA_ByteString *iv,
                                const UA_ByteString *key,
                                UA_ByteString *data  /* [in/out]*/);
 
@@ -173,12 +196,14 @@ UA_Openssl_Random_Key_PSHA1_Derive(const UA_ByteString *secret,
                                    const UA_ByteString *seed,
                                    UA_ByteString *out);
 UA_StatusCode
-UA_OpenSSL_HMAC_SHA1_Verify(const UA_ByteString *message,
+UA_OpenSSL_HMAC_SHA1_Verify(UA_OpenSSL_SymContext *sc,
+                            const UA_ByteString *message,
                             const UA_ByteString *key,
                             const UA_ByteString *signature);
 
 UA_StatusCode
-UA_OpenSSL_HMAC_SHA1_Sign(const UA_ByteString *message,
+UA_OpenSSL_HMAC_SHA1_Sign(UA_OpenSSL_SymContext *sc,
+                          const UA_ByteString *message,
                           const UA_ByteString *key,
                           UA_ByteString *signature);
 
@@ -192,12 +217,14 @@ UA_Openssl_RSA_PKCS1_V15_Encrypt(UA_ByteString *data,
                                  X509 *publicX509);
 
 UA_StatusCode
-UA_OpenSSL_AES_128_CBC_Decrypt(const UA_ByteString *iv,
+UA_OpenSSL_AES_128_CBC_Decrypt(UA_OpenSSL_SymContext *sc,
+                               const UA_ByteString *iv,
                                const UA_ByteString *key,
                                UA_ByteString *data  /* [in/out]*/);
 
 UA_StatusCode
-UA_OpenSSL_AES_128_CBC_Encrypt(const UA_ByteString *iv,
+UA_OpenSSL_AES_128_CBC_Encrypt(UA_OpenSSL_SymContext *sc,
+                               const UA_ByteString *iv,
                                const UA_ByteString *key,
                                UA_ByteString *data  /* [in/out]*/);
 
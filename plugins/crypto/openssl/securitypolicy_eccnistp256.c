@@ -39,6 +39,8 @@ typedef struct _Channel_Context_EccNistP256 {
     UA_ByteString remoteSymSigningKey;
     UA_ByteString remoteSymEncryptingKey;
     UA_ByteString remoteSymIv;
+    UA_OpenSSL_SymContext localSymCtx;
+    UA_OpenSSL_SymContext remoteSymCtx;
 
     Policy_Context_EccNistP256 *policyContext;
     UA_ByteString remoteCertificate;
@@ -241,6 +243,8 @@ UA_ChannelModule_EccNistP256_Delete_Context(void *channelContext) {
         UA_ByteString_clear(&cc->remoteSymSigningKey);
         UA_ByteString_clear(&cc->remoteSymEncryptingKey);
         UA_ByteString_clear(&cc->remoteSymIv);
+        UA_OpenSSL_SymContext_clear(&cc->localSymCtx);
+        UA_OpenSSL_SymContext_clear(&cc->remoteSymCtx);
         EVP_PKEY_free(cc->localEphemeralKeyPair);
 
         /* Remove reference */
@@ -393,6 +397,7 @@ UA_ChannelModule_EccNistP256_setLocalSymSigningKey(void *channelContext,
     Channel_Context_EccNistP256 *cc =
         (Channel_Context_EccNistP256 *)channelContext;
     UA_ByteString_clear(&cc->localSymSigningKey);
+    cc->localSymCtx.macKeyed = false;
     return UA_ByteString_copy(key, &cc->localSymSigningKey);
 }
 
@@ -404,6 +409,7 @@ UA_ChannelM_EccNistP256_setLocalSymEncryptingKey(void *channelContext,
     Channel_Context_EccNistP256 *cc =
         (Channel_Context_EccNistP256 *)channelContext;
     UA_ByteString_clear(&cc->localSymEncryptingKey);
+    cc->localSymCtx.cipherKeyed = false;
     return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
 }
 
@@ -443,6 +449,7 @@ UA_ChannelM_EccNistP256_setRemoteSymSigningKey(void *channelContext,
     Channel_Context_EccNistP256 *cc =
         (Channel_Context_EccNistP256 *)channelContext;
     UA_ByteString_clear(&cc->remoteSymSigningKey);
+    cc->remoteSymCtx.macKeyed = false;
     return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
 }
 
@@ -454,6 +461,7 @@ UA_ChannelM_EccNistP256_setRemoteSymEncryptingKey(void *channelContext,
     Channel_Context_EccNistP256 *cc =
         (Channel_Context_EccNistP256 *)channelContext;
     UA_ByteString_clear(&cc->remoteSymEncryptingKey);
+    cc->remoteSymCtx.cipherKeyed = false;
     return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
 }
 
@@ -516,7 +524,8 @@ UA_SymSig_EccNistP256_verify(void *channelContext, const UA_ByteString *message,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_EccNistP256 *cc =
         (Channel_Context_EccNistP256 *)channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Verify(message, &cc->remoteSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA256_Verify(&cc->remoteSymCtx,
+                                         message, &cc->remoteSymSigningKey, signature);
 }
 
 static UA_StatusCode
@@ -528,7 +537,8 @@ UA_SymSig_EccNistP256_sign(void *channelContext, const UA_ByteString *message,
 
     Channel_Context_EccNistP256 *cc =
         (Channel_Context_EccNistP256 *)channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Sign(message, &cc->localSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA256_Sign(&cc->localSymCtx,
+                                       message, &cc->localSymSigningKey, signature);
 }
 
 static size_t
@@ -542,7 +552,8 @@ UA_SymEn_EccNistP256_decrypt(void *channelContext, UA_ByteString *data) {
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_EccNistP256 *cc =
         (Channel_Context_EccNistP256 *)channelContext;
-    return UA_OpenSSL_AES_128_CBC_Decrypt(&cc->remoteSymIv, &cc->remoteSymEncryptingKey,
+    return UA_OpenSSL_AES_128_CBC_Decrypt(&cc->remoteSymCtx,
+                                          &cc->remoteSymIv, &cc->remoteSymEncryptingKey,
                                           data);
 }
 
@@ -553,7 +564,8 @@ UA_SymEn_EccNistP256_encrypt(void *channelContext, UA_ByteString *data) {
 
     Channel_Context_EccNistP256 *cc =
         (Channel_Context_EccNistP256 *)channelContext;
-    return UA_OpenSSL_AES_128_CBC_Encrypt(&cc->localSymIv, &cc->localSymEncryptingKey,
+    return UA_OpenSSL_AES_128_CBC_Encrypt(&cc->localSymCtx,
+                                          &cc->localSymIv, &cc->localSymEncryptingKey,
                                           data);
 }
 
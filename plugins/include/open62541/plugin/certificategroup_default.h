@@ -31,6 +31,11 @@ UA_CertificateGroup_AcceptAll(UA_CertificateGroup *certGroup);
  * 0:max-rejected-listsize [uint32]
  *    The maximum number of certificate files that can be stored in the rejected list.
  *    (default: 100).
+ *
+ * 0:max-verify-cachesize [uint32]
+ *    The maximum number of cached certificate verification results. The cache
+ *    is invalidated when the trust list changes. 0 disables the cache.
+ *    (default: 128).
  */
 UA_EXPORT UA_StatusCode
 UA_CertificateGroup_Memorystore(UA_CertificateGroup *certGroup,
@@ -57,6 +62,11 @@ UA_CertificateGroup_Memorystore(UA_CertificateGroup *certGroup,
  *    The maximum number of certificate files that can be stored in the rejected list.
  *    (default: 100).
  *
+ * 0:max-verify-cachesize [uint32]
+ *    The maximum number of cached certificate verification results. The cache
+ *    is invalidated when the trust list changes. 0 disables the cache.
+ *    (default: 128).
+ *
  * **PKI folder structure**
  *
  * pki
@@ -7,6 +7,7 @@
 #ifndef UA_LOG_STDOUT_H_
 #define UA_LOG_STDOUT_H_
 
+#include <open62541/types.h>
 #include <open62541/plugin/log.h>
 
 _UA_BEGIN_DECLS
@@ -22,6 +23,44 @@ UA_Log_Stdout_withLevel(UA_LogLevel minlevel);
 UA_EXPORT UA_Logger *
 UA_Log_Stdout_new(UA_LogLevel minlevel);
 
+#if UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX)
+
+/* Asynchronous Stdout Logger
+ * --------------------------
+ * The log calls only format the message into a slot of a lock-free ring
+ * buffer. A background thread adds the timestamp header and writes the
+ * messages to stdout in batches. The overflow policy defines what happens to
+ * new messages when the buffer is full. The logger is stopped and the pending
+ * messages are written out by the _clear method. */
+
+typedef enum {
+    UA_LOGOVERFLOW_DROP = 0,  /* Drop the message */
+    UA_LOGOVERFLOW_COUNT = 1, /* Drop and report the number of dropped
+                               * messages in the log once there is space */
+    UA_LOGOVERFLOW_BLOCK = 2  /* Wait until the background thread has made
+                               * space in the buffer */
+} UA_LogOverflowPolicy;
+
+typedef struct {
+    UA_UInt32 written; /* Messages written to stdout */
+    UA_UInt32 dropped; /* Messages dropped because the buffer was full */
+    UA_UInt32 blocked; /* Log calls that had to wait for space */
+} UA_LogAsyncStatistics;
+
+/* The buffer size (number of messages) is rounded up to the next power of two.
+ * Returns NULL if the logger could not be allocated or the background thread
+ * could not be started. */
+UA_EXPORT UA_Logger *
+UA_Log_Stdout_newAsync(UA_LogLevel minlevel, size_t bufferSize,
+                       UA_LogOverflowPolicy overflow);
+
+/* Returns BADINVALIDARGUMENT if this is not an asynchronous stdout logger */
+UA_EXPORT UA_StatusCode
+UA_Log_Stdout_getAsyncStatistics(const UA_Logger *logger,
+                                 UA_LogAsyncStatistics *stats);
+
+#endif
+
 _UA_END_DECLS
 
 #endif /* UA_LOG_STDOUT_H_ */
@@ -18,6 +18,55 @@ _UA_BEGIN_DECLS
 UA_EXPORT UA_StatusCode
 UA_Nodestore_HashMap(UA_Nodestore *ns);
 
+/* The concurrent variant of the HashMap Nodestore allows getNode/releaseNode
+ * from several threads in parallel without any lock. Published nodes are never
+ * changed in-situ. GetEditNode returns a private copy that replaces the
+ * original when the last user releases it. Replaced and removed nodes (and the
+ * old hash-map arrays after a resize) are freed after all readers that could
+ * still see them have left. Modifications (insert/replace/remove/getEditNode)
+ * still have to be serialized by the caller. See the
+ * UA_ServerConfig.concurrentReads option. */
+UA_EXPORT UA_StatusCode
+UA_Nodestore_HashMapConcurrent(UA_Nodestore *ns);
+
+/* The SwissTable Nodestore is an open-addressing hash-map. It compares the
+ * hash tags of a group of 16 slots at once (with SSE2 where available) and
+ * needs no modulo operation during the lookup. When the table has to be
+ * resized, the entries are moved to the new table incrementally with the next
+ * modifications. So no single insert or remove takes O(n) time. String and
+ * ByteString NodeIds are interned. Node copies from getNodeCopy share the
+ * identifier with the original. */
+UA_EXPORT UA_StatusCode
+UA_Nodestore_SwissTable(UA_Nodestore *ns);
+
+/* The Frozen Nodestore serves the nodes from a read-only image file that was
+ * written with UA_Nodestore_writeFrozenImage. The image contains the nodes in
+ * their in-memory layout and is mapped into memory (mmap) when the Nodestore
+ * is created. So no nodes are decoded or allocated during the startup. Several
+ * processes that use the same image share the memory pages. Nodes that are
+ * added at runtime and modified nodes are kept in a writable overlay.
+ *
+ * The image does not contain the nodes of namespace zero with a numeric
+ * identifier below 50000. They are created by the server as usual. The
+ * references from namespace zero nodes to nodes in the image are restored
+ * when the server adds the namespace zero nodes. The namespaces of the image
+ * have to be added to the server in the same order as when the image was
+ * written.
+ *
+ * The DataTypes of the values in the image are looked up by their NodeId in
+ * the standard-defined types and in the customTypes (can be NULL). */
+UA_EXPORT UA_StatusCode
+UA_Nodestore_Frozen(UA_Nodestore *ns, const char *imagePath,
+                    const UA_DataTypeArray *customTypes);
+
+/* Writes the nodes of the Nodestore into an image file for the Frozen
+ * Nodestore. Node contexts and callbacks (method callbacks, lifecycle
+ * callbacks, callback value sources, ...) are not written. They have to be set
+ * again after the image is loaded. The image can only be loaded with the same
+ * version and build configuration of open62541 on the same architecture. */
+UA_EXPORT UA_StatusCode
+UA_Nodestore_writeFrozenImage(const UA_Nodestore *ns, const char *imagePath);
+
 /* The ZipTree Nodestore holds all nodes in RAM in a tree structure. The lookup
  * time is about O(log n). Adding/removing nodes does not require resizing of
  * the underlying array with the linear overhead.
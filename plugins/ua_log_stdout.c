@@ -9,9 +9,15 @@
 #include <open62541/types.h>
 
 #include <stdio.h>
+#include <string.h>
 
 #include "mp_printf.h"
 
+#if UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 /* ANSI escape sequences for color output taken from here:
  * https://stackoverflow.com/questions/3219393/stdlib-and-colored-output-in-c*/
 
@@ -56,6 +62,28 @@ static UA_INLINE void spinUnLock(void) {
 }
 #endif
 
+#define STDOUT_LOGBUFSIZE 512
+
+static int
+logLevelSlot(UA_LogLevel level) {
+    int slot = ((int)level / 100) - 1;
+    if(slot < 0 || slot > 5)
+        slot = 5; /* Set to fatal if the level is outside the range */
+    return slot;
+}
+
+/* Print the message header with the local time */
+static int
+printHeader(char *buf, size_t bufSize, UA_DateTime t, UA_Int64 tOffset,
+            UA_LogLevel level, UA_LogCategory category) {
+    UA_DateTimeStruct dts = UA_DateTime_toStruct(t + tOffset);
+    return snprintf(buf, bufSize, "[%04u-%02u-%02u %02u:%02u:%02u.%03u (UTC%+05d)] "
+                    "%s/%s" ANSI_COLOR_RESET "\t",
+                    dts.year, dts.month, dts.day, dts.hour, dts.min, dts.sec,
+                    dts.milliSec, (int)(tOffset / UA_DATETIME_SEC / 36),
+                    logLevelNames[logLevelSlot(level)], logCategoryNames[category]);
+}
+
 #ifdef __clang__
 __attribute__((__format__(__printf__, 4 , 0)))
 #endif
@@ -67,28 +95,20 @@ UA_Log_Stdout_log(void *context, UA_LogLevel level, UA_LogCategory category,
     if(minLevel > level)
         return;
 
-    UA_Int64 tOffset = UA_DateTime_localTimeUtcOffset();
-    UA_DateTimeStruct dts = UA_DateTime_toStruct(UA_DateTime_now() + tOffset);
+    char header[128];
+    printHeader(header, sizeof(header), UA_DateTime_now(),
+                UA_DateTime_localTimeUtcOffset(), level, category);
 
-    int logLevelSlot = ((int)level / 100) - 1;
-    if(logLevelSlot < 0 || logLevelSlot > 5)
-        logLevelSlot = 5; /* Set to fatal if the level is outside the range */
+    char logbuf[STDOUT_LOGBUFSIZE];
+    mp_vsnprintf(logbuf, STDOUT_LOGBUFSIZE, msg, args);
 
     /* Lock */
 #if UA_MULTITHREADING >= 100
     spinLock();
 #endif
 
-#define STDOUT_LOGBUFSIZE 512
-    char logbuf[STDOUT_LOGBUFSIZE];
-
     /* Log */
-    printf("[%04u-%02u-%02u %02u:%02u:%02u.%03u (UTC%+05d)] %s/%s" ANSI_COLOR_RESET "\t",
-           dts.year, dts.month, dts.day, dts.hour, dts.min, dts.sec, dts.milliSec,
-           (int)(tOffset / UA_DATETIME_SEC / 36), logLevelNames[logLevelSlot],
-           logCategoryNames[category]);
-    mp_vsnprintf(logbuf, STDOUT_LOGBUFSIZE, msg, args);
-    printf("%s\n", logbuf);
+    printf("%s%s\n", header, logbuf);
     fflush(stdout);
 
     /* Unlock */
@@ -121,3 +141,278 @@ UA_Log_Stdout_new(UA_LogLevel minlevel) {
     logger->clear = UA_Log_Stdout_clear;
     return logger;
 }
+
+#if UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX)
+
+/* Asynchronous Stdout Logger
+ * --------------------------
+ * Bounded multi-producer/single-consumer ring buffer. Every slot carries a
+ * sequence number. A slot at position pos is free for the producer if
+ * seq == pos and ready for the consumer if seq == pos + 1. The consumer
+ * releases the slot for the next round with seq = pos + size. Producers claim
+ * a position with a CAS on the head. The positions are stored in pointer-sized
+ * atomics and compared as signed differences to be robust against wrap-around.
+ *
+ * The message body is formatted by the producer, as the arguments (e.g. %S
+ * strings) can point to memory that is gone once the log call returns. The
+ * expensive parts (calendar time conversion, local time offset, writing and
+ * flushing the stream) are left to the background thread. */
+
+#define ASYNC_LOGBATCHSIZE 16384
+
+typedef struct {
+    void *seq;
+    UA_DateTime timestamp;
+    UA_LogLevel level;
+    UA_LogCategory category;
+    char msg[STDOUT_LOGBUFSIZE];
+} AsyncLogSlot;
+
+typedef struct {
+    UA_LogLevel minLevel;
+    UA_LogOverflowPolicy overflow;
+
+    AsyncLogSlot *slots;
+    uintptr_t mask; /* Number of slots - 1 */
+    void *head;     /* Next position for the producers */
+    uintptr_t tail; /* Next position for the consumer */
+
+    /* Statistics */
+    volatile uint32_t written;
+    volatile uint32_t dropped;
+    volatile uint32_t blocked;
+    uint32_t droppedReported; /* Used by the consumer for _COUNT */
+
+    /* The consumer sleeps on the condition when the buffer is empty */
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    volatile uint32_t sleeping;
+    volatile uint32_t running;
+
+    char batch[ASYNC_LOGBATCHSIZE];
+} AsyncLogger;
+
+static UA_INLINE uintptr_t
+loadPos(void **addr) {
+    return (uintptr_t)UA_atomic_load(addr);
+}
+
+static UA_INLINE void
+wakeConsumer(AsyncLogger *al) {
+    if(!UA_atomic_loadUInt32(&al->sleeping))
+        return;
+    pthread_mutex_lock(&al->mutex);
+    pthread_cond_signal(&al->cond);
+    pthread_mutex_unlock(&al->mutex);
+}
+
+/* Returns NULL if the buffer is full */
+static AsyncLogSlot *
+claimSlot(AsyncLogger *al) {
+    uintptr_t pos = loadPos(&al->head);
+    for(;;) {
+        AsyncLogSlot *slot = &al->slots[pos & al->mask];
+        intptr_t diff = (intptr_t)(loadPos(&slot->seq) - pos);
+        if(diff == 0) {
+            uintptr_t old = (uintptr_t)
+                UA_atomic_cmpxchg(&al->head, (void*)pos, (void*)(pos + 1));
+            if(old == pos)
+                return slot;
+            pos = old;
+        } else if(diff < 0) {
+            return NULL; /* The consumer has not yet released the slot */
+        } else {
+            pos = loadPos(&al->head); /* Another producer was faster */
+        }
+    }
+}
+
+#ifdef __clang__
+__attribute__((__format__(__printf__, 4 , 0)))
+#endif
+static void
+UA_Log_Stdout_asyncLog(void *context, UA_LogLevel level, UA_LogCategory category,
+                       const char *msg, va_list args) {
+    AsyncLogger *al = (AsyncLogger*)context;
+    if(al->minLevel > level)
+        return;
+
+    AsyncLogSlot *slot = claimSlot(al);
+    if(!slot) {
+        if(al->overflow != UA_LOGOVERFLOW_BLOCK) {
+            UA_atomic_addUInt32(&al->dropped, 1);
+            return;
+        }
+        UA_atomic_addUInt32(&al->blocked, 1);
+        do {
+            wakeConsumer(al);
+            sched_yield();
+            slot = claimSlot(al);
+        } while(!slot);
+    }
+
+    /* The position of the slot is seq. Publish with seq + 1. */
+    uintptr_t pos = loadPos(&slot->seq);
+    slot->timestamp = UA_DateTime_now();
+    slot->level = level;
+    slot->category = category;
+    mp_vsnprintf(slot->msg, STDOUT_LOGBUFSIZE, msg, args);
+    UA_atomic_xchg(&slot->seq, (void*)(pos + 1));
+
+    wakeConsumer(al);
+}
+
+static size_t
+flushBatch(AsyncLogger *al, size_t len) {
+    if(len > 0) {
+        fwrite(al->batch, 1, len, stdout);
+        fflush(stdout);
+    }
+    return 0;
+}
+
+/* Write out all messages that are ready. Returns the number of messages. */
+static size_t
+drainSlots(AsyncLogger *al) {
+    size_t count = 0;
+    size_t len = 0;
+    UA_Int64 tOffset = UA_DateTime_localTimeUtcOffset();
+    for(;;) {
+        AsyncLogSlot *slot = &al->slots[al->tail & al->mask];
+        if(loadPos(&slot->seq) != al->tail + 1)
+            break;
+
+        /* Header and message fit into the remaining batch buffer? The header
+         * is always shorter than 128 bytes. */
+        if(len + 128 + STDOUT_LOGBUFSIZE + 1 > ASYNC_LOGBATCHSIZE)
+            len = flushBatch(al, len);
+        len += (size_t)printHeader(al->batch + len, ASYNC_LOGBATCHSIZE - len,
+                                   slot->timestamp, tOffset,
+                                   slot->level, slot->category);
+        size_t msgLen = strlen(slot->msg);
+        memcpy(al->batch + len, slot->msg, msgLen);
+        len += msgLen;
+        al->batch[len++] = '\n';
+
+        /* Release the slot for the next round */
+        UA_atomic_xchg(&slot->seq, (void*)(al->tail + al->mask + 1));
+        al->tail++;
+        count++;
+    }
+
+    /* Report the dropped messages once there was space again */
+    uint32_t dropped = UA_atomic_loadUInt32(&al->dropped);
+    if(al->overflow == UA_LOGOVERFLOW_COUNT && dropped != al->droppedReported) {
+        if(len + 128 + STDOUT_LOGBUFSIZE > ASYNC_LOGBATCHSIZE)
+            len = flushBatch(al, len);
+        len += (size_t)printHeader(al->batch + len, ASYNC_LOGBATCHSIZE - len,
+                                   UA_DateTime_now(), tOffset,
+                                   UA_LOGLEVEL_WARNING, UA_LOGCATEGORY_USERLAND);
+        len += (size_t)snprintf(al->batch + len, ASYNC_LOGBATCHSIZE - len,
+                                "Dropped %u log messages\n",
+                                (unsigned)(dropped - al->droppedReported));
+        al->droppedReported = dropped;
+    }
+
+    flushBatch(al, len);
+    if(count > 0)
+        UA_atomic_addUInt32(&al->written, (uint32_t)count);
+    return count;
+}
+
+static void *
+asyncLogLoop(void *context) {
+    AsyncLogger *al = (AsyncLogger*)context;
+    while(UA_atomic_loadUInt32(&al->running)) {
+        if(drainSlots(al) > 0)
+            continue;
+
+        /* Announce the sleep and check again before waiting. A producer that
+         * publishes after the check sees the flag and signals under the mutex,
+         * after the wait has released it. */
+        pthread_mutex_lock(&al->mutex);
+        UA_atomic_storeUInt32(&al->sleeping, 1);
+        AsyncLogSlot *slot = &al->slots[al->tail & al->mask];
+        if(loadPos(&slot->seq) != al->tail + 1 &&
+           UA_atomic_loadUInt32(&al->running))
+            pthread_cond_wait(&al->cond, &al->mutex);
+        UA_atomic_storeUInt32(&al->sleeping, 0);
+        pthread_mutex_unlock(&al->mutex);
+    }
+
+    /* Write out the remaining messages */
+    drainSlots(al);
+    return NULL;
+}
+
+static void
+UA_Log_Stdout_asyncClear(UA_Logger *logger) {
+    AsyncLogger *al = (AsyncLogger*)logger->context;
+    pthread_mutex_lock(&al->mutex);
+    UA_atomic_storeUInt32(&al->running, 0);
+    pthread_cond_signal(&al->cond);
+    pthread_mutex_unlock(&al->mutex);
+    pthread_join(al->thread, NULL);
+    pthread_cond_destroy(&al->cond);
+    pthread_mutex_destroy(&al->mutex);
+    UA_free(al->slots);
+    UA_free(al);
+    UA_free(logger);
+}
+
+UA_Logger *
+UA_Log_Stdout_newAsync(UA_LogLevel minlevel, size_t bufferSize,
+                       UA_LogOverflowPolicy overflow) {
+    /* Round up to the next power of two */
+    size_t size = 2;
+    while(size < bufferSize)
+        size <<= 1;
+
+    UA_Logger *logger = (UA_Logger*)UA_malloc(sizeof(UA_Logger));
+    AsyncLogger *al = (AsyncLogger*)UA_calloc(1, sizeof(AsyncLogger));
+    AsyncLogSlot *slots = (AsyncLogSlot*)UA_calloc(size, sizeof(AsyncLogSlot));
+    if(!logger || !al || !slots)
+        goto error;
+
+    al->minLevel = minlevel;
+    al->overflow = overflow;
+    al->slots = slots;
+    al->mask = (uintptr_t)size - 1;
+    for(size_t i = 0; i < size; i++)
+        slots[i].seq = (void*)(uintptr_t)i;
+
+    al->running = 1;
+    pthread_mutex_init(&al->mutex, NULL);
+    pthread_cond_init(&al->cond, NULL);
+    if(pthread_create(&al->thread, NULL, asyncLogLoop, al) != 0) {
+        pthread_cond_destroy(&al->cond);
+        pthread_mutex_destroy(&al->mutex);
+        goto error;
+    }
+
+    logger->log = UA_Log_Stdout_asyncLog;
+    logger->context = al;
+    logger->clear = UA_Log_Stdout_asyncClear;
+    return logger;
+
+ error:
+    UA_free(slots);
+    UA_free(al);
+    UA_free(logger);
+    return NULL;
+}
+
+UA_StatusCode
+UA_Log_Stdout_getAsyncStatistics(const UA_Logger *logger,
+                                 UA_LogAsyncStatistics *stats) {
+    if(!logger || logger->log != UA_Log_Stdout_asyncLog)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    AsyncLogger *al = (AsyncLogger*)logger->context;
+    stats->written = UA_atomic_loadUInt32(&al->written);
+    stats->dropped = UA_atomic_loadUInt32(&al->dropped);
+    stats->blocked = UA_atomic_loadUInt32(&al->blocked);
+    return UA_STATUSCODE_GOOD;
+}
+
+#endif /* UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX) */
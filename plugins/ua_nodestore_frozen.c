@@ -0,0 +1,1735 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information.
+ *
+ *    Copyright 2014-2019 (c) Fraunhofer IOSB (Author: Julius Pfrommer)
+ */
+
+#include <open62541/types.h>
+#include <open62541/plugin/nodestore_default.h>
+#include "ziptree.h"
+
+#include <stdio.h>
+
+#ifdef UA_ARCHITECTURE_POSIX
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+#endif
+
+#ifndef container_of
+#define container_of(ptr, type, member) \
+    (type *)((uintptr_t)ptr - offsetof(type,member))
+#endif
+
+/* The Frozen Nodestore serves the nodes from a read-only image file. The image
+ * contains the nodes in their native in-memory layout. So the image can be
+ * mapped into memory and the nodes are used without decoding.
+ *
+ * Image Layout
+ * ------------
+ * All pointers inside the image (strings, arrays, references, ...) point to a
+ * position inside the image. They are written for a preferred base address of
+ * the image. The image contains a relocation table with the position of every
+ * pointer. If the image cannot be mapped at the preferred base address, then
+ * all pointers are moved by the distance to the actual address.
+ *
+ * Pointers to UA_DataType descriptions (in Variants and ExtensionObjects) point
+ * outside of the image. The image contains the NodeId of every used DataType
+ * and a second relocation table for the type pointers. These pointers are
+ * resolved when the image is loaded. Only the pages where a pointer actually
+ * changes are written to. The memory pages are mapped private and
+ * copy-on-write. Pages that are not written to are shared between all
+ * processes mapping the same image. To maximize the sharing, the image has two
+ * segments. The second segment contains the Variable and VariableType nodes
+ * and all values that contain type pointers. After the relocation, the image
+ * is write-protected.
+ *
+ * The image has a hash-index for the lookup of the nodes by their NodeId
+ * (linear probing with the NodeId hash).
+ *
+ * Namespace Zero
+ * --------------
+ * The nodes of namespace zero are created by the server during startup. They
+ * are not served from the image. Except for namespace zero nodes with a
+ * generated NodeId above UA_FROZEN_NS0DYNAMIC (for example the arguments of
+ * methods). The references from namespace zero nodes to nodes in the image
+ * (for example from the ObjectsFolder or from the supertypes) are stored in
+ * the image. They are added when the server inserts the namespace zero node.
+ * The same for the subtypes of the ReferenceTypes in namespace zero.
+ *
+ * Overlay
+ * -------
+ * Nodes that are inserted at runtime and the modified versions of nodes from
+ * the image are kept in an overlay ZipTree. The image nodes are never written
+ * to. GetEditNode for a node from the image first moves a copy of the node to
+ * the overlay. The image node is then marked as shadowed. */
+
+#define UA_FROZEN_MAGIC 0x4E5A5246 /* "FRZN" */
+#define UA_FROZEN_VERSION 1
+#define UA_FROZEN_SEGMENTALIGN 4096
+#define UA_FROZEN_NOTFOUND (~(size_t)0)
+
+/* Namespace zero NodeIds below this are created by the server during startup.
+ * Generated NodeIds start above (same as in the HashMap Nodestore). */
+#define UA_FROZEN_NS0DYNAMIC 50000
+
+/* Tags of the NodePointer. Same as in ua_nodes.c. */
+#define UA_FROZEN_NODEPOINTER_MASK 0x03
+#define UA_FROZEN_NODEPOINTER_NODEID 0x01
+#define UA_FROZEN_NODEPOINTER_EXPANDEDNODEID 0x02
+#define UA_FROZEN_NODEPOINTER_NODE 0x03
+
+/* All positions are byte offsets from the beginning of the image */
+typedef struct {
+    UA_UInt32 magic;
+    UA_UInt32 version;
+    UA_UInt64 layout;        /* Fingerprint of the node structures */
+    UA_UInt64 base;          /* Preferred address of the image (or zero) */
+    UA_UInt64 size;          /* Size of the image file */
+    UA_UInt64 nodes;         /* Array of node pointers */
+    UA_UInt64 nodesSize;
+    UA_UInt64 index;         /* Hash-index of the nodes */
+    UA_UInt64 indexSize;     /* Power of two */
+    UA_UInt64 anchors;       /* Namespace zero nodes with the references to
+                              * nodes in the image */
+    UA_UInt64 anchorsSize;
+    UA_UInt64 anchorIndex;
+    UA_UInt64 anchorIndexSize;
+    UA_UInt64 referenceTypeIds; /* NodeIds of the ReferenceTypes by index */
+    UA_UInt64 referenceTypeIdsSize;
+    UA_UInt64 types;         /* NodeIds of the DataTypes */
+    UA_UInt64 typesSize;
+    UA_UInt64 relocs;        /* UA_UInt64 positions of the pointers */
+    UA_UInt64 relocsSize;
+    UA_UInt64 typeRelocs;    /* Pairs of UA_UInt64 position and type index */
+    UA_UInt64 typeRelocsSize;
+} FrozenHeader;
+
+typedef struct {
+    UA_UInt32 hash;
+    UA_UInt32 node; /* Position in the nodes array plus one. Zero if empty. */
+} FrozenSlot;
+
+/* Changes when the layout of the node structures changes. Then old images
+ * cannot be used anymore. */
+static UA_UInt64
+frozenLayout(void) {
+    const size_t sizes[] = {
+        sizeof(void*), sizeof(size_t), sizeof(UA_NodeHead),
+        sizeof(UA_VariableNode), sizeof(UA_VariableTypeNode),
+        sizeof(UA_MethodNode), sizeof(UA_ObjectNode),
+        sizeof(UA_ObjectTypeNode), sizeof(UA_ReferenceTypeNode),
+        sizeof(UA_DataTypeNode), sizeof(UA_ViewNode),
+        sizeof(UA_NodeReferenceKind), sizeof(UA_ReferenceTargetTreeElem),
+        sizeof(UA_Variant), sizeof(UA_DataValue), sizeof(UA_ExtensionObject),
+        UA_OPEN62541_VER_MAJOR, UA_OPEN62541_VER_MINOR
+    };
+    UA_UInt64 layout = 0;
+    for(size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        layout = (layout * 1099511628211ULL) ^ (UA_UInt64)sizes[i];
+    return layout;
+}
+
+static UA_Boolean
+isServerNode(const UA_NodeId *id) {
+    return (id->namespaceIndex == 0 &&
+            id->identifierType == UA_NODEIDTYPE_NUMERIC &&
+            id->identifier.numeric < UA_FROZEN_NS0DYNAMIC);
+}
+
+static size_t
+nodeSize(UA_NodeClass nodeClass) {
+    switch(nodeClass) {
+    case UA_NODECLASS_OBJECT: return sizeof(UA_ObjectNode);
+    case UA_NODECLASS_VARIABLE: return sizeof(UA_VariableNode);
+    case UA_NODECLASS_METHOD: return sizeof(UA_MethodNode);
+    case UA_NODECLASS_OBJECTTYPE: return sizeof(UA_ObjectTypeNode);
+    case UA_NODECLASS_VARIABLETYPE: return sizeof(UA_VariableTypeNode);
+    case UA_NODECLASS_REFERENCETYPE: return sizeof(UA_ReferenceTypeNode);
+    case UA_NODECLASS_DATATYPE: return sizeof(UA_DataTypeNode);
+    case UA_NODECLASS_VIEW: return sizeof(UA_ViewNode);
+    default: return 0;
+    }
+}
+
+static size_t
+indexSizeFor(size_t count) {
+    size_t size = 16;
+    while(size < count * 2)
+        size <<= 1;
+    return size;
+}
+
+/*****************/
+/* Image Writing */
+/*****************/
+
+/* Segment 0 contains the header and all content without type pointers.
+ * Segment 1 contains the Variable(Type) nodes and the values with type
+ * pointers. */
+typedef struct {
+    UA_Byte *data;
+    size_t size;
+    size_t capacity;
+} FrozenSegment;
+
+typedef struct {
+    UA_Byte seg;       /* Segment of the pointer */
+    UA_Byte targetSeg; /* Segment of the target */
+    size_t pos;        /* Position of the pointer in the segment */
+    size_t target;     /* Position of the target (plus NodePointer tag) */
+} FrozenPointer;
+
+typedef struct {
+    UA_Byte seg;
+    size_t pos;
+    size_t type; /* Index in the types array */
+} FrozenTypePointer;
+
+typedef struct {
+    FrozenSegment segs[2];
+    FrozenPointer *ptrs;
+    size_t ptrsSize;
+    size_t ptrsCapacity;
+    FrozenTypePointer *typePtrs;
+    size_t typePtrsSize;
+    size_t typePtrsCapacity;
+    const UA_DataType **types;
+    size_t typesSize;
+    size_t typesCapacity;
+    UA_StatusCode res; /* The first error is kept. Further writes are ignored. */
+} FrozenWriter;
+
+#define FROZEN_AT(w, seg, pos) ((void*)&(w)->segs[seg].data[pos])
+
+static UA_StatusCode
+growArray(void **array, size_t *capacity, size_t needed, size_t elemSize) {
+    if(needed <= *capacity)
+        return UA_STATUSCODE_GOOD;
+    size_t newCapacity = (*capacity > 0) ? *capacity * 2 : 64;
+    while(newCapacity < needed)
+        newCapacity *= 2;
+    void *newArray = UA_realloc(*array, newCapacity * elemSize);
+    if(!newArray)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    *array = newArray;
+    *capacity = newCapacity;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Returns the position of zeroed memory in the segment. The returned position
+ * is only valid if w->res is good. Pointers into the segment become invalid
+ * with the next allocation. */
+static size_t
+frozenAlloc(FrozenWriter *w, UA_Byte seg, size_t size) {
+    if(w->res != UA_STATUSCODE_GOOD)
+        return 0;
+    FrozenSegment *s = &w->segs[seg];
+    size_t pos = (s->size + 7) & ~(size_t)7;
+    size_t oldCapacity = s->capacity;
+    w->res = growArray((void**)&s->data, &s->capacity, pos + size, 1);
+    if(w->res != UA_STATUSCODE_GOOD)
+        return 0;
+    if(s->capacity > oldCapacity)
+        memset(&s->data[oldCapacity], 0, s->capacity - oldCapacity);
+    s->size = pos + size;
+    return pos;
+}
+
+static void
+addPointer(FrozenWriter *w, UA_Byte seg, size_t pos,
+           UA_Byte targetSeg, size_t target) {
+    if(w->res != UA_STATUSCODE_GOOD)
+        return;
+    w->res = growArray((void**)&w->ptrs, &w->ptrsCapacity,
+                       w->ptrsSize + 1, sizeof(FrozenPointer));
+    if(w->res != UA_STATUSCODE_GOOD)
+        return;
+    FrozenPointer *p = &w->ptrs[w->ptrsSize++];
+    p->seg = seg;
+    p->pos = pos;
+    p->targetSeg = targetSeg;
+    p->target = target;
+}
+
+static void
+addTypePointer(FrozenWriter *w, UA_Byte seg, size_t pos, const UA_DataType *type) {
+    if(w->res != UA_STATUSCODE_GOOD)
+        return;
+    size_t t = 0;
+    for(; t < w->typesSize; t++) {
+        if(w->types[t] == type)
+            break;
+    }
+    if(t == w->typesSize) {
+        w->res = growArray((void**)&w->types, &w->typesCapacity,
+                           w->typesSize + 1, sizeof(UA_DataType*));
+        if(w->res != UA_STATUSCODE_GOOD)
+            return;
+        w->types[w->typesSize++] = type;
+    }
+    w->res = growArray((void**)&w->typePtrs, &w->typePtrsCapacity,
+                       w->typePtrsSize + 1, sizeof(FrozenTypePointer));
+    if(w->res != UA_STATUSCODE_GOOD)
+        return;
+    FrozenTypePointer *p = &w->typePtrs[w->typePtrsSize++];
+    p->seg = seg;
+    p->pos = pos;
+    p->type = t;
+}
+
+/* Does the memory of the type contain pointers to DataTypes? */
+static UA_Boolean
+hasTypePointer(const UA_DataType *type, size_t depth) {
+    if(depth > 8)
+        return true; /* Recursive type. Be conservative. */
+    switch(type->typeKind) {
+    case UA_DATATYPEKIND_EXTENSIONOBJECT:
+    case UA_DATATYPEKIND_DATAVALUE:
+    case UA_DATATYPEKIND_VARIANT:
+        return true;
+    case UA_DATATYPEKIND_STRUCTURE:
+    case UA_DATATYPEKIND_OPTSTRUCT:
+    case UA_DATATYPEKIND_UNION:
+        for(size_t i = 0; i < type->membersSize; i++) {
+            if(hasTypePointer(type->members[i].memberType, depth + 1))
+                return true;
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+static void
+writeValue(FrozenWriter *w, UA_Byte seg, size_t pos,
+           const void *src, const UA_DataType *type);
+
+/* Copy an array to the image and set the pointer at pos to the copy */
+static void
+writeArray(FrozenWriter *w, UA_Byte seg, size_t pos, const void *array,
+           size_t size, const UA_DataType *type) {
+    if(w->res != UA_STATUSCODE_GOOD)
+        return;
+    if(!array || array == UA_EMPTY_ARRAY_SENTINEL || size == 0) {
+        *(void**)FROZEN_AT(w, seg, pos) = (array) ? UA_EMPTY_ARRAY_SENTINEL : NULL;
+        return;
+    }
+    UA_Byte targetSeg = hasTypePointer(type, 0) ? 1 : 0;
+    size_t target = frozenAlloc(w, targetSeg, type->memSize * size);
+    if(w->res != UA_STATUSCODE_GOOD)
+        return;
+    memcpy(FROZEN_AT(w, targetSeg, target), array, type->memSize * size);
+    addPointer(w, seg, pos, targetSeg, target);
+    uintptr_t s = (uintptr_t)array;
+    for(size_t i = 0; i < size; i++) {
+        writeValue(w, targetSeg, target + (i * type->memSize), (const void*)s, type);
+        s += type->memSize;
+    }
+}
+
+static void
+writeString(FrozenWriter *w, UA_Byte seg, size_t pos, const UA_String *s) {
+    writeArray(w, seg, pos + offsetof(UA_String, data), s->data, s->length,
+               &UA_TYPES[UA_TYPES_BYTE]);
+}
+
+static void
+writeNodeId(FrozenWriter *w, UA_Byte seg, size_t pos, const UA_NodeId *id) {
+    if(id->identifierType == UA_NODEIDTYPE_STRING ||
+       id->identifierType == UA_NODEIDTYPE_BYTESTRING)
+        writeString(w, seg, pos + offsetof(UA_NodeId, identifier.string),
+                    &id->identifier.string);
+}
+
+static void
+writeMember(FrozenWriter *w, UA_Byte seg, size_t *pos, uintptr_t *src,
+            const UA_DataTypeMember *m) {
+    const UA_DataType *mt = m->memberType;
+    *pos += m->padding;
+    *src += m->padding;
+    if(!m->isOptional && !m->isArray) {
+        writeValue(w, seg, *pos, (const void*)*src, mt);
+        *pos += mt->memSize;
+        *src += mt->memSize;
+        return;
+    }
+    if(m->isArray) {
+        size_t size = *(const size_t*)*src;
+        *pos += sizeof(size_t);
+        *src += sizeof(size_t);
+        writeArray(w, seg, *pos, *(void * const *)*src, size, mt);
+    } else {
+        /* Optional scalar */
+        const void *p = *(void * const *)*src;
+        writeArray(w, seg, *pos, p, (p) ? 1 : 0, mt);
+    }
+    *pos += sizeof(void*);
+    *src += sizeof(void*);
+}
+
+/* The memory at pos is a bitwise copy of src. Copy the content behind the
+ * pointers to the image and register the pointers for the relocation. */
+static void
+writeValue(FrozenWriter *w, UA_Byte seg, size_t pos,
+           const void *src, const UA_DataType *type) {
+    if(w->res != UA_STATUSCODE_GOOD)
+        return;
+    switch(type->typeKind) {
+    case UA_DATATYPEKIND_STRING:
+    case UA_DATATYPEKIND_BYTESTRING:
+    case UA_DATATYPEKIND_XMLELEMENT:
+        writeString(w, seg, pos, (const UA_String*)src);
+        break;
+    case UA_DATATYPEKIND_NODEID:
+        writeNodeId(w, seg, pos, (const UA_NodeId*)src);
+        break;
+    case UA_DATATYPEKIND_EXPANDEDNODEID: {
+        const UA_ExpandedNodeId *e = (const UA_ExpandedNodeId*)src;
+        writeNodeId(w, seg, pos + offsetof(UA_ExpandedNodeId, nodeId), &e->nodeId);
+        writeString(w, seg, pos + offsetof(UA_ExpandedNodeId, namespaceUri),
+                    &e->namespaceUri);
+        break;
+    }
+    case UA_DATATYPEKIND_QUALIFIEDNAME:
+        writeString(w, seg, pos + offsetof(UA_QualifiedName, name),
+                    &((const UA_QualifiedName*)src)->name);
+        break;
+    case UA_DATATYPEKIND_LOCALIZEDTEXT: {
+        const UA_LocalizedText *lt = (const UA_LocalizedText*)src;
+        writeString(w, seg, pos + offsetof(UA_LocalizedText, locale), &lt->locale);
+        writeString(w, seg, pos + offsetof(UA_LocalizedText, text), &lt->text);
+        break;
+    }
+    case UA_DATATYPEKIND_EXTENSIONOBJECT: {
+        const UA_ExtensionObject *eo = (const UA_ExtensionObject*)src;
+        if(eo->encoding >= UA_EXTENSIONOBJECT_DECODED) {
+            if(!eo->content.decoded.type) {
+                w->res = UA_STATUSCODE_BADINTERNALERROR;
+                return;
+            }
+            addTypePointer(w, seg, pos + offsetof(UA_ExtensionObject, content.decoded.type),
+                           eo->content.decoded.type);
+            writeArray(w, seg, pos + offsetof(UA_ExtensionObject, content.decoded.data),
+                       eo->content.decoded.data, 1, eo->content.decoded.type);
+        } else {
+            writeNodeId(w, seg, pos + offsetof(UA_ExtensionObject, content.encoded.typeId),
+                        &eo->content.encoded.typeId);
+            writeString(w, seg, pos + offsetof(UA_ExtensionObject, content.encoded.body),
+                        &eo->content.encoded.body);
+        }
+        break;
+    }
+    case UA_DATATYPEKIND_DATAVALUE:
+        writeValue(w, seg, pos + offsetof(UA_DataValue, value),
+                   &((const UA_DataValue*)src)->value, &UA_TYPES[UA_TYPES_VARIANT]);
+        break;
+    case UA_DATATYPEKIND_VARIANT: {
+        const UA_Variant *v = (const UA_Variant*)src;
+        if(v->type) {
+            addTypePointer(w, seg, pos + offsetof(UA_Variant, type), v->type);
+            writeArray(w, seg, pos + offsetof(UA_Variant, data), v->data,
+                       UA_Variant_isScalar(v) ? 1 : v->arrayLength, v->type);
+        } else if(v->data) {
+            w->res = UA_STATUSCODE_BADINTERNALERROR;
+            return;
+        }
+        writeArray(w, seg, pos + offsetof(UA_Variant, arrayDimensions),
+                   v->arrayDimensions, v->arrayDimensionsSize, &UA_TYPES[UA_TYPES_UINT32]);
+        break;
+    }
+    case UA_DATATYPEKIND_DIAGNOSTICINFO: {
+        const UA_DiagnosticInfo *di = (const UA_DiagnosticInfo*)src;
+        writeString(w, seg, pos + offsetof(UA_DiagnosticInfo, additionalInfo),
+                    &di->additionalInfo);
+        writeArray(w, seg, pos + offsetof(UA_DiagnosticInfo, innerDiagnosticInfo),
+                   di->innerDiagnosticInfo, (di->innerDiagnosticInfo) ? 1 : 0,
+                   &UA_TYPES[UA_TYPES_DIAGNOSTICINFO]);
+        break;
+    }
+    case UA_DATATYPEKIND_STRUCTURE:
+    case UA_DATATYPEKIND_OPTSTRUCT: {
+        uintptr_t s = (uintptr_t)src;
+        for(size_t i = 0; i < type->membersSize; i++)
+            writeMember(w, seg, &pos, &s, &type->members[i]);
+        break;
+    }
+    case UA_DATATYPEKIND_UNION: {
+        UA_UInt32 selection = *(const UA_UInt32*)src;
+        if(selection == 0)
+            break;
+        if(selection > type->membersSize) {
+            w->res = UA_STATUSCODE_BADINTERNALERROR;
+            return;
+        }
+        uintptr_t s = (uintptr_t)src;
+        writeMember(w, seg, &pos, &s, &type->members[selection-1]);
+        break;
+    }
+    case UA_DATATYPEKIND_DECIMAL:
+    case UA_DATATYPEKIND_BITFIELDCLUSTER:
+        w->res = UA_STATUSCODE_BADNOTIMPLEMENTED;
+        break;
+    default:
+        break; /* No pointers inside */
+    }
+}
+
+static void
+writeNodePointer(FrozenWriter *w, UA_Byte seg, size_t pos, UA_NodePointer np) {
+    if(w->res != UA_STATUSCODE_GOOD)
+        return;
+    uintptr_t tag = np.immediate & UA_FROZEN_NODEPOINTER_MASK;
+    const void *p = (const void*)(np.immediate & ~(uintptr_t)UA_FROZEN_NODEPOINTER_MASK);
+    const UA_DataType *type;
+    switch(tag) {
+    case UA_FROZEN_NODEPOINTER_NODEID:
+        type = &UA_TYPES[UA_TYPES_NODEID];
+        break;
+    case UA_FROZEN_NODEPOINTER_EXPANDEDNODEID:
+        type = &UA_TYPES[UA_TYPES_EXPANDEDNODEID];
+        break;
+    case UA_FROZEN_NODEPOINTER_NODE: {
+        /* Pointers to nodes of the original Nodestore are stored as NodeIds */
+        const UA_NodeId *id = &((const UA_NodeHead*)p)->nodeId;
+        writeNodePointer(w, seg, pos, UA_NodePointer_fromNodeId(id));
+        return;
+    }
+    default:
+        *(UA_NodePointer*)FROZEN_AT(w, seg, pos) = np;
+        return;
+    }
+    size_t target = frozenAlloc(w, 0, type->memSize);
+    if(w->res != UA_STATUSCODE_GOOD)
+        return;
+    memcpy(FROZEN_AT(w, 0, target), p, type->memSize);
+    writeValue(w, 0, target, p, type);
+    addPointer(w, seg, pos, 0, target + tag);
+}
+
+static void
+writeLocalizedTextList(FrozenWriter *w, UA_Byte seg, size_t pos,
+                       const UA_LocalizedTextListEntry *lt) {
+    for(; lt; lt = lt->next) {
+        size_t entry = frozenAlloc(w, 0, sizeof(UA_LocalizedTextListEntry));
+        if(w->res != UA_STATUSCODE_GOOD)
+            return;
+        memcpy(FROZEN_AT(w, 0, entry), lt, sizeof(UA_LocalizedTextListEntry));
+        writeValue(w, 0, entry + offsetof(UA_LocalizedTextListEntry, localizedText),
+                   &lt->localizedText, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+        addPointer(w, seg, pos, 0, entry);
+        seg = 0;
+        pos = entry + offsetof(UA_LocalizedTextListEntry, next);
+    }
+    if(w->res == UA_STATUSCODE_GOOD)
+        *(void**)FROZEN_AT(w, seg, pos) = NULL;
+}
+
+/* Collect the targets of a ReferenceKind. Only foreign targets (not created
+ * by the server) if foreignOnly is set. */
+typedef struct {
+    const UA_ReferenceTarget **targets;
+    size_t size;
+    UA_Boolean foreignOnly;
+} TargetList;
+
+/* Returns the target if it is not a namespace zero node created by the server */
+static void *
+findForeignTarget(void *context, UA_ReferenceTarget *target) {
+    if(!UA_NodePointer_isLocal(target->targetId))
+        return target;
+    UA_NodeId id = UA_NodePointer_toNodeId(target->targetId);
+    return (!isServerNode(&id)) ? target : NULL;
+}
+
+static void *
+collectTarget(void *context, UA_ReferenceTarget *target) {
+    TargetList *tl = (TargetList*)context;
+    if(tl->foreignOnly && !findForeignTarget(NULL, target))
+        return NULL;
+    tl->targets[tl->size++] = target;
+    return NULL;
+}
+
+typedef struct {
+    const UA_ReferenceTargetTreeElem *elem;
+    size_t index;
+} TreeElemPos;
+
+static int
+cmpTreeElemPos(const void *a, const void *b) {
+    uintptr_t aa = (uintptr_t)((const TreeElemPos*)a)->elem;
+    uintptr_t bb = (uintptr_t)((const TreeElemPos*)b)->elem;
+    return (aa < bb) ? -1 : (aa > bb) ? 1 : 0;
+}
+
+/* Set the pointer at pos to the copy of the tree element */
+static void
+writeTreeLink(FrozenWriter *w, size_t pos, const UA_ReferenceTargetTreeElem *elem,
+              const TreeElemPos *sorted, size_t size, size_t elems) {
+    if(w->res != UA_STATUSCODE_GOOD)
+        return;
+    if(!elem) {
+        *(void**)FROZEN_AT(w, 0, pos) = NULL;
+        return;
+    }
+    TreeElemPos key;
+    key.elem = elem;
+    const TreeElemPos *found = (const TreeElemPos*)
+        bsearch(&key, sorted, size, sizeof(TreeElemPos), cmpTreeElemPos);
+    if(!found) {
+        w->res = UA_STATUSCODE_BADINTERNALERROR;
+        return;
+    }
+    addPointer(w, 0, pos, 0, elems + (found->index * sizeof(UA_ReferenceTargetTreeElem)));
+}
+
+/* Copy the tree elements into an array. The left/right pointers of both trees
+ * are relocated to the copied elements. */
+static void
+writeReferenceTree(FrozenWriter *w, size_t rkPos, const UA_NodeReferenceKind *rk,
+                   const TargetList *tl) {
+    const size_t esize = sizeof(UA_ReferenceTargetTreeElem);
+    TreeElemPos *sorted = (TreeElemPos*)UA_malloc(sizeof(TreeElemPos) * tl->size);
+    if(!sorted) {
+        w->res = UA_STATUSCODE_BADOUTOFMEMORY;
+        return;
+    }
+    size_t elems = frozenAlloc(w, 0, esize * tl->size);
+    for(size_t i = 0; i < tl->size && w->res == UA_STATUSCODE_GOOD; i++) {
+        /* The target is the first member of the tree element */
+        const UA_ReferenceTargetTreeElem *e =
+            (const UA_ReferenceTargetTreeElem*)tl->targets[i];
+        sorted[i].elem = e;
+        sorted[i].index = i;
+        memcpy(FROZEN_AT(w, 0, elems + (i * esize)), e, esize);
+        writeNodePointer(w, 0, elems + (i * esize) +
+                         offsetof(UA_ReferenceTargetTreeElem, target.targetId),
+                         e->target.targetId);
+    }
+    qsort(sorted, tl->size, sizeof(TreeElemPos), cmpTreeElemPos);
+    for(size_t i = 0; i < tl->size; i++) {
+        const UA_ReferenceTargetTreeElem *e =
+            (const UA_ReferenceTargetTreeElem*)tl->targets[i];
+        size_t pos = elems + (i * esize);
+        writeTreeLink(w, pos + offsetof(UA_ReferenceTargetTreeElem, idTreeEntry.left),
+                      e->idTreeEntry.left, sorted, tl->size, elems);
+        writeTreeLink(w, pos + offsetof(UA_ReferenceTargetTreeElem, idTreeEntry.right),
+                      e->idTreeEntry.right, sorted, tl->size, elems);
+        writeTreeLink(w, pos + offsetof(UA_ReferenceTargetTreeElem, nameTreeEntry.left),
+                      e->nameTreeEntry.left, sorted, tl->size, elems);
+        writeTreeLink(w, pos + offsetof(UA_ReferenceTargetTreeElem, nameTreeEntry.right),
+                      e->nameTreeEntry.right, sorted, tl->size, elems);
+    }
+    writeTreeLink(w, rkPos + offsetof(UA_NodeReferenceKind, targets.tree.idRoot),
+                  rk->targets.tree.idRoot, sorted, tl->size, elems);
+    writeTreeLink(w, rkPos + offsetof(UA_NodeReferenceKind, targets.tree.nameRoot),
+                  rk->targets.tree.nameRoot, sorted, tl->size, elems);
+    UA_free(sorted);
+}
+
+static void
+writeReferenceArray(FrozenWriter *w, size_t rkPos, const TargetList *tl) {
+    const size_t tsize = sizeof(UA_ReferenceTarget);
+    size_t targets = frozenAlloc(w, 0, tsize * tl->size);
+    for(size_t i = 0; i < tl->size && w->res == UA_STATUSCODE_GOOD; i++) {
+        memcpy(FROZEN_AT(w, 0, targets + (i * tsize)), tl->targets[i], tsize);
+        writeNodePointer(w, 0, targets + (i * tsize) + offsetof(UA_ReferenceTarget, targetId),
+                         tl->targets[i]->targetId);
+    }
+    addPointer(w, 0, rkPos + offsetof(UA_NodeReferenceKind, targets.array), 0, targets);
+}
+
+static void
+writeReferences(FrozenWriter *w, UA_Byte seg, size_t pos,
+                const UA_NodeHead *head, UA_Boolean foreignOnly) {
+    UA_NodeHead *dst = (UA_NodeHead*)FROZEN_AT(w, seg, pos);
+    dst->references = NULL;
+    dst->referencesSize = 0;
+    if(head->referencesSize == 0)
+        return;
+
+    size_t rks = frozenAlloc(w, 0, sizeof(UA_NodeReferenceKind) * head->referencesSize);
+    size_t rksSize = 0;
+    TargetList tl;
+    tl.foreignOnly = foreignOnly;
+    for(size_t i = 0; i < head->referencesSize && w->res == UA_STATUSCODE_GOOD; i++) {
+        UA_NodeReferenceKind *rk = &head->references[i];
+        tl.size = 0;
+        tl.targets = (const UA_ReferenceTarget**)
+            UA_malloc(sizeof(UA_ReferenceTarget*) * (rk->targetsSize + 1));
+        if(!tl.targets) {
+            w->res = UA_STATUSCODE_BADOUTOFMEMORY;
+            return;
+        }
+        UA_NodeReferenceKind_iterate(rk, collectTarget, &tl);
+        if(tl.size > 0) {
+            size_t rkPos = rks + (rksSize * sizeof(UA_NodeReferenceKind));
+            UA_NodeReferenceKind *drk = (UA_NodeReferenceKind*)FROZEN_AT(w, 0, rkPos);
+            *drk = *rk;
+            drk->targetsSize = tl.size;
+            if(rk->hasRefTree && !foreignOnly) {
+                writeReferenceTree(w, rkPos, rk, &tl);
+            } else {
+                drk->hasRefTree = false;
+                writeReferenceArray(w, rkPos, &tl);
+            }
+            rksSize++;
+        }
+        UA_free((void*)(uintptr_t)tl.targets);
+    }
+    if(w->res != UA_STATUSCODE_GOOD || rksSize == 0)
+        return;
+    dst = (UA_NodeHead*)FROZEN_AT(w, seg, pos);
+    dst->referencesSize = rksSize;
+    addPointer(w, seg, pos + offsetof(UA_NodeHead, references), 0, rks);
+}
+
+static void
+writeVariableAttributes(FrozenWriter *w, UA_Byte seg, size_t pos, const UA_Node *node) {
+    /* VariableNode and VariableTypeNode have the same layout up to the end of
+     * the variable attributes */
+    const UA_VariableNode *vn = &node->variableNode;
+    writeNodeId(w, seg, pos + offsetof(UA_VariableNode, dataType), &vn->dataType);
+    writeArray(w, seg, pos + offsetof(UA_VariableNode, arrayDimensions),
+               vn->arrayDimensions, vn->arrayDimensionsSize, &UA_TYPES[UA_TYPES_UINT32]);
+    if(w->res != UA_STATUSCODE_GOOD)
+        return;
+
+    /* Callbacks are not stored in the image. External and callback value
+     * sources become an internal value source without a value. */
+    UA_VariableNode *dst = (UA_VariableNode*)FROZEN_AT(w, seg, pos);
+    memset(&dst->valueSource, 0, sizeof(dst->valueSource));
+    dst->valueSourceType = UA_VALUESOURCETYPE_INTERNAL;
+    if(vn->valueSourceType != UA_VALUESOURCETYPE_INTERNAL)
+        return;
+    dst->valueSource.internal.value = vn->valueSource.internal.value;
+    writeValue(w, seg, pos + offsetof(UA_VariableNode, valueSource.internal.value),
+               &vn->valueSource.internal.value, &UA_TYPES[UA_TYPES_DATAVALUE]);
+}
+
+/* Returns the position of the node in its segment */
+static size_t
+writeNode(FrozenWriter *w, const UA_Node *node, UA_Byte *outSeg,
+          UA_Boolean foreignOnly) {
+    size_t size = nodeSize(node->head.nodeClass);
+    if(size == 0) {
+        w->res = UA_STATUSCODE_BADINTERNALERROR;
+        return 0;
+    }
+    UA_Byte seg = (node->head.nodeClass == UA_NODECLASS_VARIABLE ||
+                   node->head.nodeClass == UA_NODECLASS_VARIABLETYPE) ? 1 : 0;
+    size_t pos = frozenAlloc(w, seg, size);
+    if(w->res != UA_STATUSCODE_GOOD)
+        return 0;
+    memcpy(FROZEN_AT(w, seg, pos), node, size);
+
+    /* Reset the members that point outside of the Nodestore */
+    UA_Node *dst = (UA_Node*)FROZEN_AT(w, seg, pos);
+    dst->head.context = NULL;
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+    dst->head.monitoredItems = NULL;
+#endif
+    switch(node->head.nodeClass) {
+    case UA_NODECLASS_METHOD:
+        dst->methodNode.method = NULL;
+        break;
+    case UA_NODECLASS_OBJECTTYPE:
+        memset(&dst->objectTypeNode.lifecycle, 0, sizeof(UA_NodeTypeLifecycle));
+        break;
+    case UA_NODECLASS_VARIABLETYPE:
+        memset(&dst->variableTypeNode.lifecycle, 0, sizeof(UA_NodeTypeLifecycle));
+        break;
+    default:
+        break;
+    }
+
+    const UA_NodeHead *head = &node->head;
+    writeNodeId(w, seg, pos + offsetof(UA_NodeHead, nodeId), &head->nodeId);
+    writeValue(w, seg, pos + offsetof(UA_NodeHead, browseName),
+               &head->browseName, &UA_TYPES[UA_TYPES_QUALIFIEDNAME]);
+    writeLocalizedTextList(w, seg, pos + offsetof(UA_NodeHead, displayName),
+                           head->displayName);
+    writeLocalizedTextList(w, seg, pos + offsetof(UA_NodeHead, description),
+                           head->description);
+    if(w->res == UA_STATUSCODE_GOOD)
+        writeReferences(w, seg, pos, head, foreignOnly);
+
+    switch(node->head.nodeClass) {
+    case UA_NODECLASS_VARIABLE:
+    case UA_NODECLASS_VARIABLETYPE:
+        writeVariableAttributes(w, seg, pos, node);
+        break;
+    case UA_NODECLASS_REFERENCETYPE:
+        writeValue(w, seg, pos + offsetof(UA_ReferenceTypeNode, inverseName),
+                   &node->referenceTypeNode.inverseName,
+                   &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+        break;
+    default:
+        break;
+    }
+
+    *outSeg = seg;
+    return pos;
+}
+
+typedef struct {
+    UA_Byte seg;
+    size_t pos;
+    UA_UInt32 hash;
+} WrittenNode;
+
+typedef struct {
+    FrozenWriter *w;
+    WrittenNode *nodes;
+    size_t nodesSize;
+    size_t nodesCapacity;
+    WrittenNode *anchors;
+    size_t anchorsSize;
+    size_t anchorsCapacity;
+} DumpContext;
+
+/* Namespace zero nodes are written as anchors if they have references to
+ * nodes in the image. ReferenceTypes are always written as anchors for their
+ * subtypes bitfield. */
+static UA_Boolean
+isAnchor(const UA_Node *node) {
+    if(node->head.nodeClass == UA_NODECLASS_REFERENCETYPE)
+        return true;
+    for(size_t i = 0; i < node->head.referencesSize; i++) {
+        if(UA_NodeReferenceKind_iterate(&node->head.references[i],
+                                        findForeignTarget, NULL))
+            return true;
+    }
+    return false;
+}
+
+static void
+dumpVisitor(void *visitorCtx, const UA_Node *node) {
+    DumpContext *dc = (DumpContext*)visitorCtx;
+    FrozenWriter *w = dc->w;
+    if(w->res != UA_STATUSCODE_GOOD)
+        return;
+    UA_Boolean anchor = isServerNode(&node->head.nodeId);
+    if(anchor && !isAnchor(node))
+        return;
+
+    WrittenNode **list = (anchor) ? &dc->anchors : &dc->nodes;
+    size_t *size = (anchor) ? &dc->anchorsSize : &dc->nodesSize;
+    size_t *capacity = (anchor) ? &dc->anchorsCapacity : &dc->nodesCapacity;
+    w->res = growArray((void**)list, capacity, *size + 1, sizeof(WrittenNode));
+    if(w->res != UA_STATUSCODE_GOOD)
+        return;
+    WrittenNode *wn = &(*list)[*size];
+    wn->hash = UA_NodeId_hash(&node->head.nodeId);
+    wn->pos = writeNode(w, node, &wn->seg, anchor);
+    (*size)++;
+}
+
+/* Write the array of node pointers and the hash-index */
+static void
+writeNodeIndex(FrozenWriter *w, const WrittenNode *nodes, size_t nodesSize,
+               UA_UInt64 *outNodes, UA_UInt64 *outIndex, UA_UInt64 *outIndexSize) {
+    size_t ptrs = frozenAlloc(w, 0, sizeof(void*) * (nodesSize + 1));
+    size_t indexSize = indexSizeFor(nodesSize);
+    size_t index = frozenAlloc(w, 0, sizeof(FrozenSlot) * indexSize);
+    if(w->res != UA_STATUSCODE_GOOD)
+        return;
+    for(size_t i = 0; i < nodesSize; i++) {
+        addPointer(w, 0, ptrs + (i * sizeof(void*)), nodes[i].seg, nodes[i].pos);
+        FrozenSlot *slots = (FrozenSlot*)FROZEN_AT(w, 0, index);
+        size_t s = nodes[i].hash & (indexSize - 1);
+        while(slots[s].node != 0)
+            s = (s + 1) & (indexSize - 1);
+        slots[s].hash = nodes[i].hash;
+        slots[s].node = (UA_UInt32)(i + 1);
+    }
+    *outNodes = ptrs;
+    *outIndex = index;
+    *outIndexSize = indexSize;
+}
+
+static UA_StatusCode
+writeSegment(FILE *f, const FrozenSegment *s, size_t paddedSize) {
+    if(s->size > 0 && fwrite(s->data, s->size, 1, f) != 1)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    for(size_t i = s->size; i < paddedSize; i++) {
+        if(fputc(0, f) == EOF)
+            return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static size_t
+alignUp(size_t pos, size_t align) {
+    return (pos + align - 1) & ~(align - 1);
+}
+
+/* Set the pointers to the final positions and write the image file */
+static UA_StatusCode
+writeImage(FrozenWriter *w, const char *path) {
+    size_t seg1Start = alignUp(w->segs[0].size, UA_FROZEN_SEGMENTALIGN);
+    size_t relocsStart = seg1Start + alignUp(w->segs[1].size, 8);
+    size_t typeRelocsStart = relocsStart + (w->ptrsSize * sizeof(UA_UInt64));
+    size_t imageSize = typeRelocsStart + (w->typePtrsSize * 2 * sizeof(UA_UInt64));
+    const size_t segStart[2] = {0, seg1Start};
+
+    /* Image at a preferred address. The region is usually unused on 64bit
+     * architectures. Different images get different addresses. */
+    UA_UInt64 base = 0;
+    if(sizeof(void*) == 8)
+        base = 0x100000000000ULL + ((UA_UInt64)(UA_UInt32_random() & 0xfff) << 32);
+
+    FrozenHeader *h = (FrozenHeader*)FROZEN_AT(w, 0, 0);
+    h->magic = UA_FROZEN_MAGIC;
+    h->version = UA_FROZEN_VERSION;
+    h->layout = frozenLayout();
+    h->base = base;
+    h->size = imageSize;
+    h->relocs = relocsStart;
+    h->relocsSize = w->ptrsSize;
+    h->typeRelocs = typeRelocsStart;
+    h->typeRelocsSize = w->typePtrsSize;
+
+    UA_UInt64 *relocs = (UA_UInt64*)
+        UA_malloc(sizeof(UA_UInt64) * (w->ptrsSize + (2 * w->typePtrsSize) + 1));
+    if(!relocs)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    for(size_t i = 0; i < w->ptrsSize; i++) {
+        const FrozenPointer *p = &w->ptrs[i];
+        *(uintptr_t*)FROZEN_AT(w, p->seg, p->pos) =
+            (uintptr_t)(base + segStart[p->targetSeg] + p->target);
+        relocs[i] = segStart[p->seg] + p->pos;
+    }
+    UA_UInt64 *typeRelocs = &relocs[w->ptrsSize];
+    for(size_t i = 0; i < w->typePtrsSize; i++) {
+        const FrozenTypePointer *p = &w->typePtrs[i];
+        /* Keep the current address. Then nothing changes during the loading if
+         * the DataType is at the same address (e.g. without ASLR). */
+        *(const UA_DataType**)FROZEN_AT(w, p->seg, p->pos) = w->types[p->type];
+        typeRelocs[2*i] = segStart[p->seg] + p->pos;
+        typeRelocs[(2*i)+1] = p->type;
+    }
+
+    UA_StatusCode res = UA_STATUSCODE_BADINTERNALERROR;
+    FILE *f = fopen(path, "wb");
+    if(f) {
+        res = writeSegment(f, &w->segs[0], seg1Start);
+        res |= writeSegment(f, &w->segs[1], relocsStart - seg1Start);
+        size_t relocsSize = w->ptrsSize + (2 * w->typePtrsSize);
+        if(res == UA_STATUSCODE_GOOD && relocsSize > 0 &&
+           fwrite(relocs, sizeof(UA_UInt64) * relocsSize, 1, f) != 1)
+            res = UA_STATUSCODE_BADINTERNALERROR;
+        if(fclose(f) != 0)
+            res = UA_STATUSCODE_BADINTERNALERROR;
+        if(res != UA_STATUSCODE_GOOD)
+            res = UA_STATUSCODE_BADINTERNALERROR;
+    }
+    UA_free(relocs);
+    return res;
+}
+
+UA_StatusCode
+UA_Nodestore_writeFrozenImage(const UA_Nodestore *ns, const char *imagePath) {
+    FrozenWriter w;
+    memset(&w, 0, sizeof(FrozenWriter));
+    DumpContext dc;
+    memset(&dc, 0, sizeof(DumpContext));
+    dc.w = &w;
+
+    /* The header is at the beginning of the first segment */
+    frozenAlloc(&w, 0, sizeof(FrozenHeader));
+
+    /* Write the nodes */
+    ns->iterate(ns->context, dumpVisitor, &dc);
+
+    UA_UInt64 nodes = 0, index = 0, indexSize = 0;
+    UA_UInt64 anchors = 0, anchorIndex = 0, anchorIndexSize = 0;
+    writeNodeIndex(&w, dc.nodes, dc.nodesSize, &nodes, &index, &indexSize);
+    writeNodeIndex(&w, dc.anchors, dc.anchorsSize,
+                   &anchors, &anchorIndex, &anchorIndexSize);
+
+    /* Write the NodeIds of the ReferenceTypes */
+    size_t refTypesSize = 0;
+    while(refTypesSize < UA_REFERENCETYPESET_MAX &&
+          ns->getReferenceTypeId(ns->context, (UA_Byte)refTypesSize))
+        refTypesSize++;
+    size_t refTypes = frozenAlloc(&w, 0, sizeof(UA_NodeId) * (refTypesSize + 1));
+    for(size_t i = 0; i < refTypesSize && w.res == UA_STATUSCODE_GOOD; i++) {
+        const UA_NodeId *id = ns->getReferenceTypeId(ns->context, (UA_Byte)i);
+        size_t pos = refTypes + (i * sizeof(UA_NodeId));
+        *(UA_NodeId*)FROZEN_AT(&w, 0, pos) = *id;
+        writeNodeId(&w, 0, pos, id);
+    }
+
+    /* Write the NodeIds of the DataTypes. This adds no further types. */
+    size_t types = frozenAlloc(&w, 0, sizeof(UA_NodeId) * (w.typesSize + 1));
+    for(size_t i = 0; i < w.typesSize && w.res == UA_STATUSCODE_GOOD; i++) {
+        size_t pos = types + (i * sizeof(UA_NodeId));
+        *(UA_NodeId*)FROZEN_AT(&w, 0, pos) = w.types[i]->typeId;
+        writeNodeId(&w, 0, pos, &w.types[i]->typeId);
+    }
+
+    UA_StatusCode res = w.res;
+    if(res == UA_STATUSCODE_GOOD) {
+        FrozenHeader *h = (FrozenHeader*)FROZEN_AT(&w, 0, 0);
+        h->nodes = nodes;
+        h->nodesSize = dc.nodesSize;
+        h->index = index;
+        h->indexSize = indexSize;
+        h->anchors = anchors;
+        h->anchorsSize = dc.anchorsSize;
+        h->anchorIndex = anchorIndex;
+        h->anchorIndexSize = anchorIndexSize;
+        h->referenceTypeIds = refTypes;
+        h->referenceTypeIdsSize = refTypesSize;
+        h->types = types;
+        h->typesSize = w.typesSize;
+        res = writeImage(&w, imagePath);
+    }
+
+    UA_free(dc.nodes);
+    UA_free(dc.anchors);
+    UA_free(w.segs[0].data);
+    UA_free(w.segs[1].data);
+    UA_free(w.ptrs);
+    UA_free(w.typePtrs);
+    UA_free(w.types);
+    return res;
+}
+
+/***********/
+/* Overlay */
+/***********/
+
+struct NodeEntry;
+typedef struct NodeEntry NodeEntry;
+
+struct NodeEntry {
+    ZIP_ENTRY(NodeEntry) zipfields;
+    UA_UInt32 nodeIdHash;
+    UA_UInt16 refCount; /* How many consumers have a reference to the node? */
+    UA_Boolean deleted; /* Node was marked as deleted and can be deleted when refCount == 0 */
+    const UA_Node *orig; /* If a copy is made to replace a node, track that we
+                          * replace only the node from which the copy was made.
+                          * Can point to a node in the image. */
+    UA_NodeId nodeId; /* This is actually a UA_Node that also starts with a NodeId */
+};
+
+/* Absolute ordering for NodeIds */
+static enum ZIP_CMP
+cmpNodeId(const void *a, const void *b) {
+    const NodeEntry *aa = (const NodeEntry*)a;
+    const NodeEntry *bb = (const NodeEntry*)b;
+
+    /* Compare hash */
+    if(aa->nodeIdHash < bb->nodeIdHash)
+        return ZIP_CMP_LESS;
+    if(aa->nodeIdHash > bb->nodeIdHash)
+        return ZIP_CMP_MORE;
+
+    /* Compore nodes in detail */
+    return (enum ZIP_CMP)UA_NodeId_order(&aa->nodeId, &bb->nodeId);
+}
+
+ZIP_HEAD(NodeTree, NodeEntry);
+typedef struct NodeTree NodeTree;
+
+ZIP_FUNCTIONS(NodeTree, NodeEntry, zipfields, NodeEntry, zipfields, cmpNodeId)
+
+/* State of the image nodes */
+#define UA_FROZEN_LIVE 0
+#define UA_FROZEN_SHADOWED 1 /* The current version is in the overlay */
+#define UA_FROZEN_REMOVED 2
+
+typedef struct {
+    /* The image */
+    UA_Byte *image;
+    size_t imageSize;
+    UA_Boolean mapped; /* Mapped or allocated */
+    const UA_Node * const *nodes;
+    size_t nodesSize;
+    const FrozenSlot *index;
+    size_t indexSize;
+    const UA_Node * const *anchors;
+    const FrozenSlot *anchorIndex;
+    size_t anchorIndexSize;
+    UA_Byte *state; /* For every node in the image */
+
+    /* The overlay */
+    NodeTree root;
+
+    /* Maps ReferenceTypeIndex to the NodeId of the ReferenceType */
+    UA_NodeId referenceTypeIds[UA_REFERENCETYPESET_MAX];
+    UA_Byte referenceTypeCounter;
+} FrozenContext;
+
+static NodeEntry *
+newEntry(UA_NodeClass nodeClass) {
+    size_t size = nodeSize(nodeClass);
+    if(size == 0)
+        return NULL;
+    NodeEntry *entry = (NodeEntry*)UA_calloc(1, sizeof(NodeEntry) - sizeof(UA_NodeId) + size);
+    if(!entry)
+        return NULL;
+    UA_Node *node = (UA_Node*)&entry->nodeId;
+    node->head.nodeClass = nodeClass;
+    return entry;
+}
+
+static void
+deleteEntry(NodeEntry *entry) {
+    UA_Node_clear((UA_Node*)&entry->nodeId);
+    UA_free(entry);
+}
+
+static void
+switchReferenceTrees(UA_Node *node) {
+    for(size_t i = 0; i < node->head.referencesSize; i++) {
+        UA_NodeReferenceKind *rk = &node->head.references[i];
+        if(rk->targetsSize > 16 && !rk->hasRefTree)
+            UA_NodeReferenceKind_switch(rk);
+    }
+}
+
+static void
+cleanupEntry(NodeEntry *entry) {
+    if(entry->refCount > 0)
+        return;
+    if(entry->deleted) {
+        deleteEntry(entry);
+        return;
+    }
+    switchReferenceTrees((UA_Node*)&entry->nodeId);
+}
+
+static UA_Boolean
+inImage(const FrozenContext *ctx, const void *p) {
+    return ((uintptr_t)p >= (uintptr_t)ctx->image &&
+            (uintptr_t)p < (uintptr_t)ctx->image + ctx->imageSize);
+}
+
+/* Returns the position of the node in the image or UA_FROZEN_NOTFOUND */
+static size_t
+findFrozen(const FrozenSlot *index, size_t indexSize,
+           const UA_Node * const *nodes,
+           const UA_NodeId *nodeId, UA_UInt32 hash) {
+    if(indexSize == 0)
+        return UA_FROZEN_NOTFOUND;
+    size_t s = hash & (indexSize - 1);
+    for(; index[s].node != 0; s = (s + 1) & (indexSize - 1)) {
+        if(index[s].hash != hash)
+            continue;
+        const UA_Node *node = nodes[index[s].node - 1];
+        if(UA_NodeId_equal(&node->head.nodeId, nodeId))
+            return index[s].node - 1;
+    }
+    return UA_FROZEN_NOTFOUND;
+}
+
+static NodeEntry *
+findOverlay(FrozenContext *ctx, const UA_NodeId *nodeId, UA_UInt32 hash) {
+    NodeEntry dummy;
+    dummy.nodeIdHash = hash;
+    dummy.nodeId = *nodeId;
+    return ZIP_FIND(NodeTree, &ctx->root, &dummy);
+}
+
+/* Move a copy of the image node to the overlay */
+static NodeEntry *
+shadowNode(FrozenContext *ctx, size_t pos, UA_UInt32 hash) {
+    const UA_Node *node = ctx->nodes[pos];
+    NodeEntry *entry = newEntry(node->head.nodeClass);
+    if(!entry)
+        return NULL;
+    if(UA_Node_copy(node, (UA_Node*)&entry->nodeId) != UA_STATUSCODE_GOOD) {
+        deleteEntry(entry);
+        return NULL;
+    }
+    entry->nodeIdHash = hash;
+    ZIP_INSERT(NodeTree, &ctx->root, entry);
+    ctx->state[pos] = UA_FROZEN_SHADOWED;
+    return entry;
+}
+
+/* Add the references of the anchor to the namespace zero node */
+static UA_StatusCode
+attachAnchor(FrozenContext *ctx, UA_Node *node, UA_UInt32 hash) {
+    size_t pos = findFrozen(ctx->anchorIndex, ctx->anchorIndexSize,
+                            ctx->anchors, &node->head.nodeId, hash);
+    if(pos == UA_FROZEN_NOTFOUND)
+        return UA_STATUSCODE_GOOD;
+    const UA_Node *anchor = ctx->anchors[pos];
+    for(size_t i = 0; i < anchor->head.referencesSize; i++) {
+        const UA_NodeReferenceKind *rk = &anchor->head.references[i];
+        for(size_t j = 0; j < rk->targetsSize; j++) {
+            const UA_ReferenceTarget *t = &rk->targets.array[j];
+            UA_ExpandedNodeId target = UA_NodePointer_toExpandedNodeId(t->targetId);
+            UA_StatusCode res =
+                UA_Node_addReference(node, rk->referenceTypeIndex, !rk->isInverse,
+                                     &target, t->targetNameHash);
+            if(res == UA_STATUSCODE_BADOUTOFMEMORY)
+                return res;
+            /* Switch to the tree early. Otherwise the duplicate check of
+             * every added reference is linear in the array size. */
+            if(j == 16)
+                switchReferenceTrees(node);
+        }
+    }
+    if(node->head.nodeClass == UA_NODECLASS_REFERENCETYPE &&
+       anchor->head.nodeClass == UA_NODECLASS_REFERENCETYPE)
+        node->referenceTypeNode.subTypes =
+            UA_ReferenceTypeSet_union(node->referenceTypeNode.subTypes,
+                                      anchor->referenceTypeNode.subTypes);
+    return UA_STATUSCODE_GOOD;
+}
+
+/***********************/
+/* Interface functions */
+/***********************/
+
+/* Not yet inserted into the FrozenContext */
+static UA_Node *
+frozenNsNewNode(void *nsCtx, UA_NodeClass nodeClass) {
+    NodeEntry *entry = newEntry(nodeClass);
+    if(!entry)
+        return NULL;
+    return (UA_Node*)&entry->nodeId;
+}
+
+/* Not yet inserted into the FrozenContext */
+static void
+frozenNsDeleteNode(void *nsCtx, UA_Node *node) {
+    deleteEntry(container_of(node, NodeEntry, nodeId));
+}
+
+static const UA_Node *
+frozenNsGetNode(void *nsCtx, const UA_NodeId *nodeId,
+                UA_UInt32 attributeMask,
+                UA_ReferenceTypeSet references,
+                UA_BrowseDirection referenceDirections) {
+    FrozenContext *ctx = (FrozenContext*)nsCtx;
+    UA_UInt32 hash = UA_NodeId_hash(nodeId);
+    size_t pos = findFrozen(ctx->index, ctx->indexSize, ctx->nodes, nodeId, hash);
+    if(pos != UA_FROZEN_NOTFOUND && ctx->state[pos] == UA_FROZEN_LIVE)
+        return ctx->nodes[pos];
+    NodeEntry *entry = findOverlay(ctx, nodeId, hash);
+    if(!entry)
+        return NULL;
+    ++entry->refCount;
+    return (const UA_Node*)&entry->nodeId;
+}
+
+static const UA_Node *
+frozenNsGetNodeFromPtr(void *nsCtx, UA_NodePointer ptr,
+                       UA_UInt32 attributeMask,
+                       UA_ReferenceTypeSet references,
+                       UA_BrowseDirection referenceDirections) {
+    if(!UA_NodePointer_isLocal(ptr))
+        return NULL;
+    UA_NodeId id = UA_NodePointer_toNodeId(ptr);
+    return frozenNsGetNode(nsCtx, &id, attributeMask,
+                           references, referenceDirections);
+}
+
+static UA_Node *
+frozenNsGetEditNode(void *nsCtx, const UA_NodeId *nodeId,
+                    UA_UInt32 attributeMask,
+                    UA_ReferenceTypeSet references,
+                    UA_BrowseDirection referenceDirections) {
+    FrozenContext *ctx = (FrozenContext*)nsCtx;
+    UA_UInt32 hash = UA_NodeId_hash(nodeId);
+    size_t pos = findFrozen(ctx->index, ctx->indexSize, ctx->nodes, nodeId, hash);
+    NodeEntry *entry;
+    if(pos != UA_FROZEN_NOTFOUND && ctx->state[pos] == UA_FROZEN_LIVE)
+        entry = shadowNode(ctx, pos, hash);
+    else
+        entry = findOverlay(ctx, nodeId, hash);
+    if(!entry)
+        return NULL;
+    ++entry->refCount;
+    return (UA_Node*)&entry->nodeId;
+}
+
+static UA_Node *
+frozenNsGetEditNodeFromPtr(void *nsCtx, UA_NodePointer ptr,
+                           UA_UInt32 attributeMask,
+                           UA_ReferenceTypeSet references,
+                           UA_BrowseDirection referenceDirections) {
+    if(!UA_NodePointer_isLocal(ptr))
+        return NULL;
+    UA_NodeId id = UA_NodePointer_toNodeId(ptr);
+    return frozenNsGetEditNode(nsCtx, &id, attributeMask,
+                               references, referenceDirections);
+}
+
+static void
+frozenNsReleaseNode(void *nsCtx, const UA_Node *node) {
+    if(!node || inImage((FrozenContext*)nsCtx, node))
+        return;
+    NodeEntry *entry = container_of(node, NodeEntry, nodeId);
+    UA_assert(entry->refCount > 0);
+    --entry->refCount;
+    cleanupEntry(entry);
+}
+
+static UA_StatusCode
+frozenNsGetNodeCopy(void *nsCtx, const UA_NodeId *nodeId,
+                    UA_Node **outNode) {
+    const UA_Node *node =
+        frozenNsGetNode(nsCtx, nodeId, UA_NODEATTRIBUTESMASK_ALL,
+                        UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    if(!node)
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+
+    /* Create the new entry */
+    NodeEntry *ne = newEntry(node->head.nodeClass);
+    if(!ne) {
+        frozenNsReleaseNode(nsCtx, node);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    /* Copy the node content */
+    UA_Node *nnode = (UA_Node*)&ne->nodeId;
+    UA_StatusCode retval = UA_Node_copy(node, nnode);
+    frozenNsReleaseNode(nsCtx, node);
+    if(retval != UA_STATUSCODE_GOOD) {
+        deleteEntry(ne);
+        return retval;
+    }
+
+    ne->orig = node;
+    *outNode = nnode;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_Boolean
+frozenNsExists(FrozenContext *ctx, const UA_NodeId *nodeId, UA_UInt32 hash) {
+    size_t pos = findFrozen(ctx->index, ctx->indexSize, ctx->nodes, nodeId, hash);
+    if(pos != UA_FROZEN_NOTFOUND && ctx->state[pos] == UA_FROZEN_LIVE)
+        return true;
+    return (findOverlay(ctx, nodeId, hash) != NULL);
+}
+
+static UA_StatusCode
+frozenNsInsertNode(void *nsCtx, UA_Node *node, UA_NodeId *addedNodeId) {
+    NodeEntry *entry = container_of(node, NodeEntry, nodeId);
+    FrozenContext *ctx = (FrozenContext*)nsCtx;
+
+    /* Ensure that the NodeId is unique */
+    UA_UInt32 hash;
+    if(node->head.nodeId.identifierType == UA_NODEIDTYPE_NUMERIC &&
+       node->head.nodeId.identifier.numeric == 0) {
+        UA_UInt32 numId;
+        do { /* Create a random nodeid until we find an unoccupied id */
+            numId = UA_UInt32_random();
+            /* Keep generated namespace zero NodeIds out of the range of the
+             * nodes that are created by the server */
+            if(node->head.nodeId.namespaceIndex == 0 &&
+               numId < UA_FROZEN_NS0DYNAMIC)
+                numId += UA_FROZEN_NS0DYNAMIC;
+#if SIZE_MAX <= UA_UINT32_MAX
+            /* The compressed "immediate" representation of nodes does not
+             * support the full range on 32bit systems. Generate smaller
+             * identifiers as they can be stored more compactly. */
+            if(numId >= (0x01 << 24))
+                numId = numId % (0x01 << 24);
+#endif
+            node->head.nodeId.identifier.numeric = numId;
+            hash = UA_NodeId_hash(&node->head.nodeId);
+        } while(numId == 0 || frozenNsExists(ctx, &node->head.nodeId, hash));
+    } else {
+        hash = UA_NodeId_hash(&node->head.nodeId);
+        if(frozenNsExists(ctx, &node->head.nodeId, hash)) {
+            deleteEntry(entry);
+            return UA_STATUSCODE_BADNODEIDEXISTS;
+        }
+    }
+
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    /* For new ReferencetypeNodes add to the index map. ReferenceTypes that are
+     * known from the image keep their index. */
+    if(node->head.nodeClass == UA_NODECLASS_REFERENCETYPE) {
+        UA_ReferenceTypeNode *refNode = &node->referenceTypeNode;
+        UA_Byte refTypeIndex = 0;
+        for(; refTypeIndex < ctx->referenceTypeCounter; refTypeIndex++) {
+            if(UA_NodeId_equal(&node->head.nodeId,
+                               &ctx->referenceTypeIds[refTypeIndex]))
+                break;
+        }
+        if(refTypeIndex == ctx->referenceTypeCounter) {
+            if(ctx->referenceTypeCounter >= UA_REFERENCETYPESET_MAX) {
+                deleteEntry(entry);
+                return UA_STATUSCODE_BADINTERNALERROR;
+            }
+            retval = UA_NodeId_copy(&node->head.nodeId,
+                                    &ctx->referenceTypeIds[refTypeIndex]);
+            if(retval != UA_STATUSCODE_GOOD) {
+                deleteEntry(entry);
+                return UA_STATUSCODE_BADINTERNALERROR;
+            }
+            ctx->referenceTypeCounter++;
+        }
+
+        /* Assign the ReferenceTypeIndex to the new ReferenceTypeNode */
+        refNode->referenceTypeIndex = refTypeIndex;
+        refNode->subTypes = UA_REFTYPESET(refTypeIndex);
+    }
+
+    /* Add the references from the image to namespace zero nodes */
+    if(isServerNode(&node->head.nodeId)) {
+        retval = attachAnchor(ctx, node, hash);
+        if(retval != UA_STATUSCODE_GOOD) {
+            deleteEntry(entry);
+            return retval;
+        }
+    }
+
+    /* Copy the NodeId */
+    if(addedNodeId) {
+        retval = UA_NodeId_copy(&node->head.nodeId, addedNodeId);
+        if(retval != UA_STATUSCODE_GOOD) {
+            deleteEntry(entry);
+            return retval;
+        }
+    }
+
+    /* Insert the node */
+    entry->nodeIdHash = hash;
+    ZIP_INSERT(NodeTree, &ctx->root, entry);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+frozenNsReplaceNode(void *nsCtx, UA_Node *node) {
+    FrozenContext *ctx = (FrozenContext*)nsCtx;
+    NodeEntry *entry = container_of(node, NodeEntry, nodeId);
+    UA_UInt32 hash = UA_NodeId_hash(&node->head.nodeId);
+
+    /* Replace a node from the image */
+    size_t pos = findFrozen(ctx->index, ctx->indexSize, ctx->nodes,
+                            &node->head.nodeId, hash);
+    if(pos != UA_FROZEN_NOTFOUND && ctx->state[pos] == UA_FROZEN_LIVE) {
+        if(entry->orig != ctx->nodes[pos]) {
+            /* The node was already updated since the copy was made */
+            deleteEntry(entry);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+        entry->nodeIdHash = hash;
+        ZIP_INSERT(NodeTree, &ctx->root, entry);
+        ctx->state[pos] = UA_FROZEN_SHADOWED;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Replace a node from the overlay */
+    NodeEntry *oldEntry = findOverlay(ctx, &node->head.nodeId, hash);
+    if(!oldEntry) {
+        deleteEntry(entry);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+    if(entry->orig != (const UA_Node*)&oldEntry->nodeId) {
+        /* The node was already updated since the copy was made */
+        deleteEntry(entry);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    ZIP_REMOVE(NodeTree, &ctx->root, oldEntry);
+    entry->nodeIdHash = hash;
+    ZIP_INSERT(NodeTree, &ctx->root, entry);
+    oldEntry->deleted = true;
+    cleanupEntry(oldEntry);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+frozenNsRemoveNode(void *nsCtx, const UA_NodeId *nodeId) {
+    FrozenContext *ctx = (FrozenContext*)nsCtx;
+    UA_UInt32 hash = UA_NodeId_hash(nodeId);
+    size_t pos = findFrozen(ctx->index, ctx->indexSize, ctx->nodes, nodeId, hash);
+    if(pos != UA_FROZEN_NOTFOUND && ctx->state[pos] == UA_FROZEN_LIVE) {
+        ctx->state[pos] = UA_FROZEN_REMOVED;
+        return UA_STATUSCODE_GOOD;
+    }
+    NodeEntry *entry = findOverlay(ctx, nodeId, hash);
+    if(!entry)
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    ZIP_REMOVE(NodeTree, &ctx->root, entry);
+    entry->deleted = true;
+    cleanupEntry(entry);
+    if(pos != UA_FROZEN_NOTFOUND)
+        ctx->state[pos] = UA_FROZEN_REMOVED;
+    return UA_STATUSCODE_GOOD;
+}
+
+static const UA_NodeId *
+frozenNsGetReferenceTypeId(void *nsCtx, UA_Byte refTypeIndex) {
+    FrozenContext *ctx = (FrozenContext*)nsCtx;
+    if(refTypeIndex >= ctx->referenceTypeCounter)
+        return NULL;
+    return &ctx->referenceTypeIds[refTypeIndex];
+}
+
+struct VisitorData {
+    UA_NodestoreVisitor visitor;
+    void *visitorContext;
+};
+
+static void *
+nodeVisitor(void *data, NodeEntry *entry) {
+    struct VisitorData *d = (struct VisitorData*)data;
+    d->visitor(d->visitorContext, (UA_Node*)&entry->nodeId);
+    return NULL;
+}
+
+static void
+frozenNsIterate(void *nsCtx, UA_NodestoreVisitor visitor,
+                void *visitorCtx) {
+    FrozenContext *ctx = (FrozenContext*)nsCtx;
+    for(size_t i = 0; i < ctx->nodesSize; i++) {
+        if(ctx->state[i] == UA_FROZEN_LIVE)
+            visitor(visitorCtx, ctx->nodes[i]);
+    }
+    struct VisitorData d;
+    d.visitor = visitor;
+    d.visitorContext = visitorCtx;
+    ZIP_ITER(NodeTree, &ctx->root, nodeVisitor, &d);
+}
+
+static void *
+deleteNodeVisitor(void *data, NodeEntry *entry) {
+    deleteEntry(entry);
+    return NULL;
+}
+
+/*****************/
+/* Image Loading */
+/*****************/
+
+static void
+releaseImage(FrozenContext *ctx) {
+    if(!ctx->image)
+        return;
+#ifdef UA_ARCHITECTURE_POSIX
+    if(ctx->mapped) {
+        munmap(ctx->image, ctx->imageSize);
+        ctx->image = NULL;
+        return;
+    }
+#endif
+    UA_free(ctx->image);
+    ctx->image = NULL;
+}
+
+static UA_StatusCode
+checkHeader(const FrozenHeader *h, size_t fileSize) {
+    if(h->magic != UA_FROZEN_MAGIC || h->version != UA_FROZEN_VERSION ||
+       h->layout != frozenLayout() || h->size != fileSize ||
+       h->relocs + (h->relocsSize * sizeof(UA_UInt64)) > fileSize ||
+       h->typeRelocs + (h->typeRelocsSize * 2 * sizeof(UA_UInt64)) > fileSize ||
+       h->nodes + (h->nodesSize * sizeof(void*)) > fileSize ||
+       h->index + (h->indexSize * sizeof(FrozenSlot)) > fileSize ||
+       h->anchors + (h->anchorsSize * sizeof(void*)) > fileSize ||
+       h->anchorIndex + (h->anchorIndexSize * sizeof(FrozenSlot)) > fileSize ||
+       h->referenceTypeIdsSize > UA_REFERENCETYPESET_MAX ||
+       h->referenceTypeIds + (h->referenceTypeIdsSize * sizeof(UA_NodeId)) > fileSize ||
+       h->types + (h->typesSize * sizeof(UA_NodeId)) > fileSize)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Map the image at the preferred address if possible */
+static UA_StatusCode
+loadImage(FrozenContext *ctx, const char *path) {
+    FrozenHeader h;
+#ifdef UA_ARCHITECTURE_POSIX
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return UA_STATUSCODE_BADNOTFOUND;
+    struct stat st;
+    if(fstat(fd, &st) != 0 ||
+       pread(fd, &h, sizeof(FrozenHeader), 0) != (ssize_t)sizeof(FrozenHeader) ||
+       checkHeader(&h, (size_t)st.st_size) != UA_STATUSCODE_GOOD) {
+        close(fd);
+        return UA_STATUSCODE_BADDECODINGERROR;
+    }
+    void *addr = MAP_FAILED;
+    if(h.base != 0) {
+        int flags = MAP_PRIVATE;
+#ifdef MAP_FIXED_NOREPLACE
+        flags |= MAP_FIXED_NOREPLACE;
+#endif
+        addr = mmap((void*)(uintptr_t)h.base, (size_t)h.size,
+                    PROT_READ | PROT_WRITE, flags, fd, 0);
+        if(addr != MAP_FAILED && (uintptr_t)addr != (uintptr_t)h.base) {
+            munmap(addr, (size_t)h.size); /* The hint was not followed */
+            addr = MAP_FAILED;
+        }
+    }
+    if(addr == MAP_FAILED)
+        addr = mmap(NULL, (size_t)h.size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(addr == MAP_FAILED)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    ctx->image = (UA_Byte*)addr;
+    ctx->mapped = true;
+#else
+    FILE *f = fopen(path, "rb");
+    if(!f)
+        return UA_STATUSCODE_BADNOTFOUND;
+    UA_StatusCode res = UA_STATUSCODE_BADDECODINGERROR;
+    if(fread(&h, sizeof(FrozenHeader), 1, f) == 1 &&
+       fseek(f, 0, SEEK_END) == 0) {
+        long fileSize = ftell(f);
+        if(fileSize > 0 && checkHeader(&h, (size_t)fileSize) == UA_STATUSCODE_GOOD) {
+            ctx->image = (UA_Byte*)UA_malloc((size_t)h.size);
+            if(!ctx->image)
+                res = UA_STATUSCODE_BADOUTOFMEMORY;
+            else if(fseek(f, 0, SEEK_SET) == 0 &&
+                    fread(ctx->image, (size_t)h.size, 1, f) == 1)
+                res = UA_STATUSCODE_GOOD;
+        }
+    }
+    fclose(f);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+#endif
+    ctx->imageSize = (size_t)h.size;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+relocateImage(FrozenContext *ctx, const UA_DataTypeArray *customTypes) {
+    const FrozenHeader *h = (const FrozenHeader*)ctx->image;
+    UA_Byte *image = ctx->image;
+
+    /* Move the pointers if not mapped at the preferred address */
+    uintptr_t delta = (uintptr_t)image - (uintptr_t)h->base;
+    if(delta != 0) {
+        const UA_UInt64 *relocs = (const UA_UInt64*)&image[h->relocs];
+        for(size_t i = 0; i < h->relocsSize; i++) {
+            if(relocs[i] + sizeof(void*) > h->size)
+                return UA_STATUSCODE_BADDECODINGERROR;
+            *(uintptr_t*)&image[relocs[i]] += delta;
+        }
+    }
+
+    /* Resolve the DataTypes */
+    const UA_NodeId *typeIds = (const UA_NodeId*)&image[h->types];
+    const UA_DataType **types = (const UA_DataType**)
+        UA_malloc(sizeof(UA_DataType*) * (h->typesSize + 1));
+    if(!types)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    for(size_t i = 0; i < h->typesSize; i++) {
+        types[i] = UA_findDataTypeWithCustom(&typeIds[i], customTypes);
+        if(!types[i]) {
+            UA_free((void*)(uintptr_t)types);
+            return UA_STATUSCODE_BADDATATYPEIDUNKNOWN;
+        }
+    }
+
+    /* Set the type pointers. Only write if the pointer changes so that the
+     * page is not copied. */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    const UA_UInt64 *typeRelocs = (const UA_UInt64*)&image[h->typeRelocs];
+    for(size_t i = 0; i < h->typeRelocsSize; i++) {
+        UA_UInt64 pos = typeRelocs[2*i];
+        UA_UInt64 t = typeRelocs[(2*i)+1];
+        if(pos + sizeof(void*) > h->size || t >= h->typesSize) {
+            res = UA_STATUSCODE_BADDECODINGERROR;
+            break;
+        }
+        const UA_DataType **field = (const UA_DataType**)(uintptr_t)&image[pos];
+        if(*field != types[t])
+            *field = types[t];
+    }
+    UA_free((void*)(uintptr_t)types);
+    return res;
+}
+
+/***********************/
+/* Nodestore Lifecycle */
+/***********************/
+
+static void
+frozenNsClear(void *nsCtx) {
+    if(!nsCtx)
+        return;
+    FrozenContext *ctx = (FrozenContext*)nsCtx;
+    ZIP_ITER(NodeTree, &ctx->root, deleteNodeVisitor, NULL);
+
+    /* Clean up the ReferenceTypes index array */
+    for(size_t i = 0; i < ctx->referenceTypeCounter; i++)
+        UA_NodeId_clear(&ctx->referenceTypeIds[i]);
+
+    releaseImage(ctx);
+    UA_free(ctx->state);
+    UA_free(ctx);
+}
+
+UA_StatusCode
+UA_Nodestore_Frozen(UA_Nodestore *ns, const char *imagePath,
+                    const UA_DataTypeArray *customTypes) {
+    /* Allocate and initialize the context */
+    FrozenContext *ctx = (FrozenContext*)UA_calloc(1, sizeof(FrozenContext));
+    if(!ctx)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    ZIP_INIT(&ctx->root);
+
+    /* Load and relocate the image */
+    UA_StatusCode res = loadImage(ctx, imagePath);
+    if(res == UA_STATUSCODE_GOOD)
+        res = relocateImage(ctx, customTypes);
+#ifdef UA_ARCHITECTURE_POSIX
+    if(res == UA_STATUSCODE_GOOD && mprotect(ctx->image, ctx->imageSize, PROT_READ) != 0)
+        res = UA_STATUSCODE_BADINTERNALERROR;
+#endif
+    if(res != UA_STATUSCODE_GOOD) {
+        frozenNsClear(ctx);
+        return res;
+    }
+
+    const FrozenHeader *h = (const FrozenHeader*)ctx->image;
+    ctx->nodes = (const UA_Node * const *)(uintptr_t)&ctx->image[h->nodes];
+    ctx->nodesSize = (size_t)h->nodesSize;
+    ctx->index = (const FrozenSlot*)(uintptr_t)&ctx->image[h->index];
+    ctx->indexSize = (size_t)h->indexSize;
+    ctx->anchors = (const UA_Node * const *)(uintptr_t)&ctx->image[h->anchors];
+    ctx->anchorIndex = (const FrozenSlot*)(uintptr_t)&ctx->image[h->anchorIndex];
+    ctx->anchorIndexSize = (size_t)h->anchorIndexSize;
+
+    /* The state of the image nodes */
+    ctx->state = (UA_Byte*)UA_calloc(ctx->nodesSize + 1, sizeof(UA_Byte));
+    if(!ctx->state) {
+        frozenNsClear(ctx);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    /* The ReferenceTypes from the image keep their index */
+    const UA_NodeId *refTypeIds = (const UA_NodeId*)&ctx->image[h->referenceTypeIds];
+    for(size_t i = 0; i < h->referenceTypeIdsSize; i++) {
+        res = UA_NodeId_copy(&refTypeIds[i], &ctx->referenceTypeIds[i]);
+        if(res != UA_STATUSCODE_GOOD) {
+            frozenNsClear(ctx);
+            return res;
+        }
+        ctx->referenceTypeCounter++;
+    }
+
+    /* Populate the nodestore */
+    ns->context = (void*)ctx;
+    ns->clear = frozenNsClear;
+    ns->newNode = frozenNsNewNode;
+    ns->deleteNode = frozenNsDeleteNode;
+    ns->getNode = frozenNsGetNode;
+    ns->getNodeFromPtr = frozenNsGetNodeFromPtr;
+    ns->getEditNode = frozenNsGetEditNode;
+    ns->getEditNodeFromPtr = frozenNsGetEditNodeFromPtr;
+    ns->releaseNode = frozenNsReleaseNode;
+    ns->getNodeCopy = frozenNsGetNodeCopy;
+    ns->insertNode = frozenNsInsertNode;
+    ns->replaceNode = frozenNsReplaceNode;
+    ns->removeNode = frozenNsRemoveNode;
+    ns->getReferenceTypeId = frozenNsGetReferenceTypeId;
+    ns->iterate = frozenNsIterate;
+    return UA_STATUSCODE_GOOD;
+}
@@ -19,12 +19,35 @@
  *
  * - Tombstone or non-matching NodeId: continue searching
  * - Matching NodeId: Return the entry
- * - NULL: Abort the search */
+ * - NULL: Abort the search
+ *
+ * Concurrent Readers
+ * ------------------
+ * In the concurrent mode (see UA_Nodestore_HashMapConcurrent), readers get and
+ * release nodes without holding a lock. Writers (insert, replace, remove and
+ * the editable nodes from getEditNode) still need to be serialized, for example
+ * by the service lock of the server.
+ *
+ * Published nodes are never modified in-situ. GetEditNode returns a private
+ * copy that atomically replaces the original once the last user has released
+ * it. Entries and slot tables that are no longer reachable are "retired" and
+ * freed after a grace period. Readers enter the current epoch while they search
+ * the table and increase the refCount. Once all readers of the epoch in which
+ * an entry was retired have left, no new reference to the entry can be taken.
+ * The map itself holds one reference on every published entry. That reference
+ * is dropped after the grace period. Whoever decreases the refCount to zero
+ * frees the entry. */
 
 typedef struct UA_NodeMapEntry {
     struct UA_NodeMapEntry *orig; /* the version this is a copy from (or NULL) */
-    UA_UInt16 refCount; /* How many consumers have a reference to the node? */
+    struct UA_NodeMapEntry *editCopy; /* Concurrent mode: Outstanding copy from
+                                       * getEditNode for a published entry */
+    struct UA_NodeMapEntry *retiredNext; /* Concurrent mode: List of retired
+                                          * entries */
+    UA_UInt32 refCount; /* How many consumers have a reference to the node? */
     UA_Boolean deleted; /* Node was marked as deleted and can be deleted when refCount == 0 */
+    UA_Boolean editing; /* Concurrent mode: Private copy from getEditNode. The
+                         * refCount counts the (nested) edit users. */
     UA_Node node;
 } UA_NodeMapEntry;
 
@@ -36,15 +59,32 @@ typedef struct {
     UA_UInt32 nodeIdHash;
 } UA_NodeMapSlot;
 
-typedef struct {
-    UA_NodeMapSlot *slots;
+/* The slots and their size are allocated together. So that concurrent readers
+ * can exchange them with a single atomic operation. */
+typedef struct UA_NodeMapTable {
+    struct UA_NodeMapTable *retiredNext;
     UA_UInt32 size;
+    UA_NodeMapSlot *slots; /* Points into the same allocation */
+} UA_NodeMapTable;
+
+typedef struct {
+    UA_NodeMapTable *table;
     UA_UInt32 count;
     UA_UInt32 sizePrimeIndex;
 
     /* Maps ReferenceTypeIndex to the NodeId of the ReferenceType */
     UA_NodeId referenceTypeIds[UA_REFERENCETYPESET_MAX];
     UA_Byte referenceTypeCounter;
+
+    /* Concurrent mode */
+    UA_Boolean concurrent;
+    UA_UInt32 epoch;
+    UA_UInt32 readers[2]; /* Readers per epoch (even/odd) */
+    UA_NodeMapEntry *retiredEntries; /* Retired during the current epoch */
+    UA_NodeMapTable *retiredTables;
+    UA_NodeMapEntry *graceEntries;   /* Waiting for the readers of the
+                                      * previous epoch to leave */
+    UA_NodeMapTable *graceTables;
 } UA_NodeMap;
 
 /*********************/
@@ -78,18 +118,29 @@ higher_prime_index(UA_UInt32 n) {
     return low;
 }
 
+static UA_NodeMapTable *
+createTable(UA_UInt32 size) {
+    UA_NodeMapTable *table = (UA_NodeMapTable*)
+        UA_calloc(1, sizeof(UA_NodeMapTable) + (size * sizeof(UA_NodeMapSlot)));
+    if(!table)
+        return NULL;
+    table->size = size;
+    table->slots = (UA_NodeMapSlot*)(uintptr_t)&table[1];
+    return table;
+}
+
 /* Returns an empty slot or null if the nodeid exists or if no empty slot is found. */
 static UA_NodeMapSlot *
-findFreeSlot(const UA_NodeMap *ns, const UA_NodeId *nodeid) {
+findFreeSlot(const UA_NodeMapTable *table, const UA_NodeId *nodeid) {
     UA_UInt32 h = UA_NodeId_hash(nodeid);
-    UA_UInt32 size = ns->size;
+    UA_UInt32 size = table->size;
     UA_UInt64 idx = mod(h, size); /* Use 64bit container to avoid overflow  */
     UA_UInt32 startIdx = (UA_UInt32)idx;
     UA_UInt32 hash2 = mod2(h, size);
 
     UA_NodeMapSlot *candidate = NULL;
     do {
-        UA_NodeMapSlot *slot = &ns->slots[(UA_UInt32)idx];
+        UA_NodeMapSlot *slot = &table->slots[(UA_UInt32)idx];
 
         if(slot->entry > UA_NODEMAP_TOMBSTONE) {
             /* A Node with the NodeId does already exist */
@@ -113,38 +164,207 @@ findFreeSlot(const UA_NodeMap *ns, const UA_NodeId *nodeid) {
     return candidate;
 }
 
+static void
+deleteNodeMapEntry(UA_NodeMapEntry *entry) {
+    UA_Node_clear(&entry->node);
+    UA_free(entry);
+}
+
+/* Switch large reference arrays to the tree representation */
+static void
+optimizeReferences(UA_NodeMapEntry *entry) {
+    for(size_t i = 0; i < entry->node.head.referencesSize; i++) {
+        UA_NodeReferenceKind *rk = &entry->node.head.references[i];
+        if(rk->targetsSize > 16 && !rk->hasRefTree)
+            UA_NodeReferenceKind_switch(rk);
+    }
+}
+
+static void
+cleanupNodeMapEntry(UA_NodeMapEntry *entry) {
+    if(entry->refCount > 0)
+        return;
+    if(entry->deleted) {
+        deleteNodeMapEntry(entry);
+        return;
+    }
+    optimizeReferences(entry);
+}
+
+/********************/
+/* Concurrent Mode */
+/********************/
+
+/* Drop a reference. The last reference frees the entry. In the concurrent mode
+ * the map holds a reference on every published entry. So this can only happen
+ * after the entry was retired and its grace period has passed. */
+static void
+releaseEntryConcurrent(UA_NodeMapEntry *entry) {
+    if(UA_atomic_subUInt32(&entry->refCount, 1) == 0)
+        deleteNodeMapEntry(entry);
+}
+
+static UA_UInt32
+enterEpoch(UA_NodeMap *ns) {
+    while(true) {
+        UA_UInt32 epoch = UA_atomic_loadUInt32(&ns->epoch);
+        UA_atomic_addUInt32(&ns->readers[epoch & 1], 1);
+        /* The writer started a new epoch in between. Retry so that the writer
+         * does not miss us when it waits for the readers of the old epoch. */
+        if(UA_atomic_loadUInt32(&ns->epoch) == epoch)
+            return epoch;
+        UA_atomic_subUInt32(&ns->readers[epoch & 1], 1);
+    }
+}
+
+static void
+leaveEpoch(UA_NodeMap *ns, UA_UInt32 epoch) {
+    UA_atomic_subUInt32(&ns->readers[epoch & 1], 1);
+}
+
+static void
+freeRetired(UA_NodeMapEntry *entries, UA_NodeMapTable *tables) {
+    while(entries) {
+        UA_NodeMapEntry *next = entries->retiredNext;
+        releaseEntryConcurrent(entries);
+        entries = next;
+    }
+    while(tables) {
+        UA_NodeMapTable *next = tables->retiredNext;
+        UA_free(tables);
+        tables = next;
+    }
+}
+
+/* Called by the writer. Free the retired entries whose grace period has passed
+ * and start a new grace period for the recently retired entries. */
+static void
+reclaim(UA_NodeMap *ns) {
+    for(size_t i = 0; i < 2; i++) {
+        if(ns->graceEntries || ns->graceTables) {
+            /* The readers of the previous epoch are still active */
+            if(UA_atomic_loadUInt32(&ns->readers[(ns->epoch - 1) & 1]) > 0)
+                return;
+            freeRetired(ns->graceEntries, ns->graceTables);
+            ns->graceEntries = NULL;
+            ns->graceTables = NULL;
+        }
+
+        if(!ns->retiredEntries && !ns->retiredTables)
+            return;
+
+        /* Start the grace period and a new epoch */
+        ns->graceEntries = ns->retiredEntries;
+        ns->graceTables = ns->retiredTables;
+        ns->retiredEntries = NULL;
+        ns->retiredTables = NULL;
+        UA_atomic_addUInt32(&ns->epoch, 1);
+    }
+}
+
+static void
+retireEntry(UA_NodeMap *ns, UA_NodeMapEntry *entry) {
+    /* An outstanding edit is dropped once released */
+    if(entry->editCopy) {
+        entry->editCopy->orig = NULL;
+        entry->editCopy = NULL;
+    }
+    entry->retiredNext = ns->retiredEntries;
+    ns->retiredEntries = entry;
+    reclaim(ns);
+}
+
+static void
+retireTable(UA_NodeMap *ns, UA_NodeMapTable *table) {
+    table->retiredNext = ns->retiredTables;
+    ns->retiredTables = table;
+    reclaim(ns);
+}
+
+/* Publish a new entry in the slot. The map takes a reference. The nodeIdHash
+ * is written before the entry pointer becomes visible. It does not change if
+ * an entry is replaced with a new version. */
+static void
+publishEntry(UA_NodeMapSlot *slot, UA_NodeMapEntry *entry) {
+    optimizeReferences(entry);
+    entry->refCount = 1;
+    UA_UInt32 h = UA_NodeId_hash(&entry->node.head.nodeId);
+    if(slot->nodeIdHash != h)
+        slot->nodeIdHash = h;
+    UA_atomic_xchg((void**)&slot->entry, entry);
+}
+
+/* The lookup for readers loads every slot entry only once */
+static UA_NodeMapEntry *
+findEntryConcurrent(UA_NodeMapTable *table, const UA_NodeId *nodeid) {
+    UA_UInt32 h = UA_NodeId_hash(nodeid);
+    UA_UInt32 size = table->size;
+    UA_UInt64 idx = mod(h, size); /* Use 64bit container to avoid overflow */
+    UA_UInt32 hash2 = mod2(h, size);
+    UA_UInt32 startIdx = (UA_UInt32)idx;
+
+    do {
+        UA_NodeMapSlot *slot = &table->slots[(UA_UInt32)idx];
+        UA_NodeMapEntry *entry = (UA_NodeMapEntry*)UA_atomic_load((void**)&slot->entry);
+        if(entry > UA_NODEMAP_TOMBSTONE) {
+            if(UA_atomic_loadUInt32(&slot->nodeIdHash) == h &&
+               UA_NodeId_equal(&entry->node.head.nodeId, nodeid))
+                return entry;
+        } else {
+            if(entry == NULL)
+                return NULL; /* No further entry possible */
+        }
+
+        idx += hash2;
+        if(idx >= size)
+            idx -= size;
+    } while((UA_UInt32)idx != startIdx);
+
+    return NULL;
+}
+
+/********************/
+/* Table Management */
+/********************/
+
 /* The occupancy of the table after the call will be about 50% */
 static UA_StatusCode
 expand(UA_NodeMap *ns) {
-    UA_UInt32 osize = ns->size;
+    UA_NodeMapTable *otable = ns->table;
+    UA_UInt32 osize = otable->size;
     UA_UInt32 count = ns->count;
     /* Resize only when table after removal of unused elements is either too
        full or too empty */
     if(count * 2 < osize && (count * 8 > osize || osize <= UA_NODEMAP_MINSIZE))
         return UA_STATUSCODE_GOOD;
 
-    UA_NodeMapSlot *oslots = ns->slots;
     UA_UInt32 nindex = higher_prime_index(count * 2);
-    UA_UInt32 nsize = primes[nindex];
-    UA_NodeMapSlot *nslots= (UA_NodeMapSlot*)UA_calloc(nsize, sizeof(UA_NodeMapSlot));
-    if(!nslots)
+    UA_NodeMapTable *ntable = createTable(primes[nindex]);
+    if(!ntable)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
-    ns->slots = nslots;
-    ns->size = nsize;
-    ns->sizePrimeIndex = nindex;
-
     /* recompute the position of every entry and insert the pointer */
+    UA_NodeMapSlot *oslots = otable->slots;
     for(size_t i = 0, j = 0; i < osize && j < count; ++i) {
         if(oslots[i].entry <= UA_NODEMAP_TOMBSTONE)
             continue;
-        UA_NodeMapSlot *s = findFreeSlot(ns, &oslots[i].entry->node.head.nodeId);
+        UA_NodeMapSlot *s = findFreeSlot(ntable, &oslots[i].entry->node.head.nodeId);
         UA_assert(s);
         *s = oslots[i];
         ++j;
     }
 
-    UA_free(oslots);
+    ns->sizePrimeIndex = nindex;
+
+    /* Concurrent readers might still search in the old table */
+    if(ns->concurrent) {
+        UA_atomic_xchg((void**)&ns->table, ntable);
+        retireTable(ns, otable);
+        return UA_STATUSCODE_GOOD;
+    }
+
+    ns->table = ntable;
+    UA_free(otable);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -186,37 +406,16 @@ createEntry(UA_NodeClass nodeClass) {
     return entry;
 }
 
-static void
-deleteNodeMapEntry(UA_NodeMapEntry *entry) {
-    UA_Node_clear(&entry->node);
-    UA_free(entry);
-}
-
-static void
-cleanupNodeMapEntry(UA_NodeMapEntry *entry) {
-    if(entry->refCount > 0)
-        return;
-    if(entry->deleted) {
-        deleteNodeMapEntry(entry);
-        return;
-    }
-    for(size_t i = 0; i < entry->node.head.referencesSize; i++) {
-        UA_NodeReferenceKind *rk = &entry->node.head.references[i];
-        if(rk->targetsSize > 16 && !rk->hasRefTree)
-            UA_NodeReferenceKind_switch(rk);
-    }
-}
-
 static UA_NodeMapSlot *
-findOccupiedSlot(const UA_NodeMap *ns, const UA_NodeId *nodeid) {
+findOccupiedSlot(const UA_NodeMapTable *table, const UA_NodeId *nodeid) {
     UA_UInt32 h = UA_NodeId_hash(nodeid);
-    UA_UInt32 size = ns->size;
+    UA_UInt32 size = table->size;
     UA_UInt64 idx = mod(h, size); /* Use 64bit container to avoid overflow */
     UA_UInt32 hash2 = mod2(h, size);
     UA_UInt32 startIdx = (UA_UInt32)idx;
 
     do {
-        UA_NodeMapSlot *slot= &ns->slots[(UA_UInt32)idx];
+        UA_NodeMapSlot *slot= &table->slots[(UA_UInt32)idx];
         if(slot->entry > UA_NODEMAP_TOMBSTONE) {
             if(slot->nodeIdHash == h &&
                UA_NodeId_equal(&slot->entry->node.head.nodeId, nodeid))
@@ -259,7 +458,7 @@ UA_NodeMap_getNode(void *context, const UA_NodeId *nodeid,
                    UA_ReferenceTypeSet references,
                    UA_BrowseDirection referenceDirections) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
-    UA_NodeMapSlot *slot = findOccupiedSlot(ns, nodeid);
+    UA_NodeMapSlot *slot = findOccupiedSlot(ns->table, nodeid);
     if(!slot)
         return NULL;
     ++slot->entry->refCount;
@@ -273,6 +472,19 @@ UA_NodeMap_getNodeFromPtr(void *context, UA_NodePointer ptr,
                           UA_BrowseDirection referenceDirections) {
     if(!UA_NodePointer_isLocal(ptr))
         return NULL;
+
+    /* Direct pointer to a node that is still the published version. The
+     * caller holds a reference, so the entry was not freed. */
+    const UA_NodeHead *head = UA_NodePointer_toNode(ptr);
+    if(head) {
+        UA_NodeMapEntry *entry =
+            container_of((const UA_Node*)head, UA_NodeMapEntry, node);
+        if(!entry->deleted) {
+            ++entry->refCount;
+            return &entry->node;
+        }
+    }
+
     UA_NodeId id = UA_NodePointer_toNodeId(ptr);
     return UA_NodeMap_getNode(context, &id, attributeMask, references, referenceDirections);
 }
@@ -292,7 +504,7 @@ static UA_StatusCode
 UA_NodeMap_getNodeCopy(void *context, const UA_NodeId *nodeid,
                        UA_Node **outNode) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
-    UA_NodeMapSlot *slot = findOccupiedSlot(ns, nodeid);
+    UA_NodeMapSlot *slot = findOccupiedSlot(ns->table, nodeid);
     if(!slot)
         return UA_STATUSCODE_BADNODEIDUNKNOWN;
     UA_NodeMapEntry *entry = slot->entry;
@@ -312,17 +524,22 @@ UA_NodeMap_getNodeCopy(void *context, const UA_NodeId *nodeid,
 static UA_StatusCode
 UA_NodeMap_removeNode(void *context, const UA_NodeId *nodeid) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
-    UA_NodeMapSlot *slot = findOccupiedSlot(ns, nodeid);
+    UA_NodeMapSlot *slot = findOccupiedSlot(ns->table, nodeid);
     if(!slot)
         return UA_STATUSCODE_BADNODEIDUNKNOWN;
 
     UA_NodeMapEntry *entry = slot->entry;
-    slot->entry = UA_NODEMAP_TOMBSTONE;
-    entry->deleted = true;
-    cleanupNodeMapEntry(entry);
+    if(ns->concurrent) {
+        UA_atomic_xchg((void**)&slot->entry, UA_NODEMAP_TOMBSTONE);
+        retireEntry(ns, entry);
+    } else {
+        slot->entry = UA_NODEMAP_TOMBSTONE;
+        entry->deleted = true;
+        cleanupNodeMapEntry(entry);
+    }
     --ns->count;
     /* Downsize the hashmap if it is very empty */
-    if(ns->count * 8 < ns->size && ns->size > UA_NODEMAP_MINSIZE)
+    if(ns->count * 8 < ns->table->size && ns->table->size > UA_NODEMAP_MINSIZE)
         expand(ns); /* Can fail. Just continue with the bigger hashmap. */
     return UA_STATUSCODE_GOOD;
 }
@@ -335,7 +552,7 @@ static UA_StatusCode
 UA_NodeMap_insertNode(void *context, UA_Node *node,
                       UA_NodeId *addedNodeId) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
-    if(ns->size * 3 <= ns->count * 4) {
+    if(ns->table->size * 3 <= ns->count * 4) {
         if(expand(ns) != UA_STATUSCODE_GOOD){
             deleteNodeMapEntry(container_of(node, UA_NodeMapEntry, node));
             return UA_STATUSCODE_BADINTERNALERROR;
@@ -352,7 +569,7 @@ UA_NodeMap_insertNode(void *context, UA_Node *node,
          * val, we will reach the starting id again. E.g. adding a nodeset will
          * create children while there are still other nodes which need to be
          * created. Thus the node ids may collide. */
-        UA_UInt32 size = ns->size;
+        UA_UInt32 size = ns->table->size;
         UA_UInt64 identifier = mod(50000 + size+1, UA_UINT32_MAX); /* Use 64bit to
                                                                     * avoid overflow */
         UA_UInt32 increase = mod2(ns->count+1, size);
@@ -361,7 +578,7 @@ UA_NodeMap_insertNode(void *context, UA_Node *node,
 
         do {
             node->head.nodeId.identifier.numeric = (UA_UInt32)identifier;
-            slot = findFreeSlot(ns, &node->head.nodeId);
+            slot = findFreeSlot(ns->table, &node->head.nodeId);
             if(slot)
                 break;
             identifier += increase;
@@ -376,7 +593,7 @@ UA_NodeMap_insertNode(void *context, UA_Node *node,
 #endif
         } while((UA_UInt32)identifier != startId);
     } else {
-        slot = findFreeSlot(ns, &node->head.nodeId);
+        slot = findFreeSlot(ns->table, &node->head.nodeId);
     }
 
     if(!slot) {
@@ -417,8 +634,12 @@ UA_NodeMap_insertNode(void *context, UA_Node *node,
 
     /* Insert the node */
     UA_NodeMapEntry *newEntry = container_of(node, UA_NodeMapEntry, node);
-    slot->nodeIdHash = UA_NodeId_hash(&node->head.nodeId);
-    slot->entry = newEntry;
+    if(ns->concurrent) {
+        publishEntry(slot, newEntry);
+    } else {
+        slot->nodeIdHash = UA_NodeId_hash(&node->head.nodeId);
+        slot->entry = newEntry;
+    }
     ++ns->count;
     return retval;
 }
@@ -429,7 +650,7 @@ UA_NodeMap_replaceNode(void *context, UA_Node *node) {
     UA_NodeMapEntry *newEntry = container_of(node, UA_NodeMapEntry, node);
 
     /* Find the node */
-    UA_NodeMapSlot *slot = findOccupiedSlot(ns, &node->head.nodeId);
+    UA_NodeMapSlot *slot = findOccupiedSlot(ns->table, &node->head.nodeId);
     if(!slot) {
         deleteNodeMapEntry(newEntry);
         return UA_STATUSCODE_BADNODEIDUNKNOWN;
@@ -443,6 +664,12 @@ UA_NodeMap_replaceNode(void *context, UA_Node *node) {
     }
 
     /* Replace the entry */
+    if(ns->concurrent) {
+        newEntry->orig = NULL;
+        publishEntry(slot, newEntry);
+        retireEntry(ns, oldEntry);
+        return UA_STATUSCODE_GOOD;
+    }
     slot->entry = newEntry;
     oldEntry->deleted = true;
     cleanupNodeMapEntry(oldEntry);
@@ -461,8 +688,8 @@ static void
 UA_NodeMap_iterate(void *context, UA_NodestoreVisitor visitor,
                    void *visitorContext) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
-    for(UA_UInt32 i = 0; i < ns->size; ++i) {
-        UA_NodeMapSlot *slot = &ns->slots[i];
+    for(UA_UInt32 i = 0; i < ns->table->size; ++i) {
+        UA_NodeMapSlot *slot = &ns->table->slots[i];
         if(slot->entry > UA_NODEMAP_TOMBSTONE) {
             /* The visitor can delete the node. So refcount here. */
             slot->entry->refCount++;
@@ -473,6 +700,133 @@ UA_NodeMap_iterate(void *context, UA_NodestoreVisitor visitor,
     }
 }
 
+/*************************************/
+/* Interface functions (Concurrent)  */
+/*************************************/
+
+static const UA_Node *
+UA_NodeMap_getNodeConcurrent(void *context, const UA_NodeId *nodeid,
+                             UA_UInt32 attributeMask,
+                             UA_ReferenceTypeSet references,
+                             UA_BrowseDirection referenceDirections) {
+    UA_NodeMap *ns = (UA_NodeMap*)context;
+    UA_UInt32 epoch = enterEpoch(ns);
+    UA_NodeMapTable *table = (UA_NodeMapTable*)UA_atomic_load((void**)&ns->table);
+    UA_NodeMapEntry *entry = findEntryConcurrent(table, nodeid);
+    if(entry)
+        UA_atomic_addUInt32(&entry->refCount, 1);
+    leaveEpoch(ns, epoch);
+    return (entry) ? &entry->node : NULL;
+}
+
+static const UA_Node *
+UA_NodeMap_getNodeFromPtrConcurrent(void *context, UA_NodePointer ptr,
+                                    UA_UInt32 attributeMask,
+                                    UA_ReferenceTypeSet references,
+                                    UA_BrowseDirection referenceDirections) {
+    if(!UA_NodePointer_isLocal(ptr))
+        return NULL;
+    UA_NodeId id = UA_NodePointer_toNodeId(ptr);
+    return UA_NodeMap_getNodeConcurrent(context, &id, attributeMask,
+                                        references, referenceDirections);
+}
+
+/* Writers only. Nested calls for the same node return the same copy. */
+static UA_Node *
+UA_NodeMap_getEditNodeConcurrent(void *context, const UA_NodeId *nodeid,
+                                 UA_UInt32 attributeMask,
+                                 UA_ReferenceTypeSet references,
+                                 UA_BrowseDirection referenceDirections) {
+    UA_NodeMap *ns = (UA_NodeMap*)context;
+    UA_NodeMapSlot *slot = findOccupiedSlot(ns->table, nodeid);
+    if(!slot)
+        return NULL;
+
+    UA_NodeMapEntry *entry = slot->entry;
+    if(entry->editCopy) {
+        entry->editCopy->refCount++;
+        return &entry->editCopy->node;
+    }
+
+    UA_NodeMapEntry *copy = createEntry(entry->node.head.nodeClass);
+    if(!copy)
+        return NULL;
+    UA_StatusCode res = UA_Node_copy(&entry->node, &copy->node);
+    if(res != UA_STATUSCODE_GOOD) {
+        deleteNodeMapEntry(copy);
+        return NULL;
+    }
+    copy->orig = entry;
+    copy->editing = true;
+    copy->refCount = 1;
+    entry->editCopy = copy;
+    return &copy->node;
+}
+
+static UA_Node *
+UA_NodeMap_getEditNodeFromPtrConcurrent(void *context, UA_NodePointer ptr,
+                                        UA_UInt32 attributeMask,
+                                        UA_ReferenceTypeSet references,
+                                        UA_BrowseDirection referenceDirections) {
+    if(!UA_NodePointer_isLocal(ptr))
+        return NULL;
+    UA_NodeId id = UA_NodePointer_toNodeId(ptr);
+    return UA_NodeMap_getEditNodeConcurrent(context, &id, attributeMask,
+                                            references, referenceDirections);
+}
+
+static void
+UA_NodeMap_releaseNodeConcurrent(void *context, const UA_Node *node) {
+    if(!node)
+        return;
+    UA_NodeMapEntry *entry = container_of(node, UA_NodeMapEntry, node);
+    UA_assert(&entry->node == node);
+    if(!entry->editing) {
+        releaseEntryConcurrent(entry);
+        return;
+    }
+
+    /* Released an editable copy. Publish when the last user is done. */
+    UA_assert(entry->refCount > 0);
+    if(--entry->refCount > 0)
+        return;
+    entry->editing = false;
+    UA_NodeMapEntry *orig = entry->orig;
+    entry->orig = NULL;
+    if(!orig) {
+        /* The original was removed in the meantime */
+        deleteNodeMapEntry(entry);
+        return;
+    }
+    orig->editCopy = NULL;
+
+    UA_NodeMap *ns = (UA_NodeMap*)context;
+    UA_NodeMapSlot *slot = findOccupiedSlot(ns->table, &orig->node.head.nodeId);
+    UA_assert(slot && slot->entry == orig);
+    publishEntry(slot, entry);
+    retireEntry(ns, orig);
+}
+
+static void
+UA_NodeMap_iterateConcurrent(void *context, UA_NodestoreVisitor visitor,
+                             void *visitorContext) {
+    UA_NodeMap *ns = (UA_NodeMap*)context;
+    /* The visitor can delete nodes and resize the table. Stay in the epoch so
+     * that the table we iterate over is not freed. */
+    UA_UInt32 epoch = enterEpoch(ns);
+    UA_NodeMapTable *table = ns->table;
+    for(UA_UInt32 i = 0; i < table->size; ++i) {
+        UA_NodeMapEntry *entry = (UA_NodeMapEntry*)
+            UA_atomic_load((void**)&table->slots[i].entry);
+        if(entry <= UA_NODEMAP_TOMBSTONE)
+            continue;
+        UA_atomic_addUInt32(&entry->refCount, 1);
+        visitor(visitorContext, &entry->node);
+        releaseEntryConcurrent(entry);
+    }
+    leaveEpoch(ns, epoch);
+}
+
 static void
 UA_NodeMap_delete(void *context) {
     /* Already cleaned up? */
@@ -480,17 +834,21 @@ UA_NodeMap_delete(void *context) {
         return;
 
     UA_NodeMap *ns = (UA_NodeMap*)context;
-    UA_UInt32 size = ns->size;
-    UA_NodeMapSlot *slots = ns->slots;
+    UA_UInt32 size = ns->table->size;
+    UA_NodeMapSlot *slots = ns->table->slots;
     for(UA_UInt32 i = 0; i < size; ++i) {
         if(slots[i].entry > UA_NODEMAP_TOMBSTONE) {
             /* On debugging builds, check that all nodes were release */
-            UA_assert(slots[i].entry->refCount == 0);
+            UA_assert(slots[i].entry->refCount == (ns->concurrent ? 1 : 0));
             /* Delete the node */
             deleteNodeMapEntry(slots[i].entry);
         }
     }
-    UA_free(ns->slots);
+    UA_free(ns->table);
+
+    /* Free the retired entries and tables (concurrent mode) */
+    freeRetired(ns->graceEntries, ns->graceTables);
+    freeRetired(ns->retiredEntries, ns->retiredTables);
 
     /* Clean up the ReferenceTypes index array */
     for(size_t i = 0; i < ns->referenceTypeCounter; i++)
@@ -499,37 +857,44 @@ UA_NodeMap_delete(void *context) {
     UA_free(ns);
 }
 
-UA_StatusCode
-UA_Nodestore_HashMap(UA_Nodestore *ns) {
+static UA_StatusCode
+createNodeMap(UA_Nodestore *ns, UA_Boolean concurrent) {
     /* Allocate and initialize the nodemap */
-    UA_NodeMap *nodemap = (UA_NodeMap*)UA_malloc(sizeof(UA_NodeMap));
+    UA_NodeMap *nodemap = (UA_NodeMap*)UA_calloc(1, sizeof(UA_NodeMap));
     if(!nodemap)
         return UA_STATUSCODE_BADOUTOFMEMORY;
     nodemap->sizePrimeIndex = higher_prime_index(UA_NODEMAP_MINSIZE);
-    nodemap->size = primes[nodemap->sizePrimeIndex];
-    nodemap->count = 0;
-    nodemap->slots = (UA_NodeMapSlot*)
-        UA_calloc(nodemap->size, sizeof(UA_NodeMapSlot));
-    if(!nodemap->slots) {
+    nodemap->table = createTable(primes[nodemap->sizePrimeIndex]);
+    if(!nodemap->table) {
         UA_free(nodemap);
         return UA_STATUSCODE_BADOUTOFMEMORY;
     }
-
-    nodemap->referenceTypeCounter = 0;
+    nodemap->concurrent = concurrent;
 
     /* Populate the nodestore */
     ns->context = nodemap;
     ns->clear = UA_NodeMap_delete;
     ns->newNode = UA_NodeMap_newNode;
     ns->deleteNode = UA_NodeMap_deleteNode;
-    ns->getNode = UA_NodeMap_getNode;
-    ns->getNodeFromPtr = UA_NodeMap_getNodeFromPtr;
-    ns->releaseNode = UA_NodeMap_releaseNode;
     ns->getNodeCopy = UA_NodeMap_getNodeCopy;
     ns->insertNode = UA_NodeMap_insertNode;
     ns->replaceNode = UA_NodeMap_replaceNode;
     ns->removeNode = UA_NodeMap_removeNode;
     ns->getReferenceTypeId = UA_NodeMap_getReferenceTypeId;
+
+    if(concurrent) {
+        ns->getNode = UA_NodeMap_getNodeConcurrent;
+        ns->getNodeFromPtr = UA_NodeMap_getNodeFromPtrConcurrent;
+        ns->releaseNode = UA_NodeMap_releaseNodeConcurrent;
+        ns->iterate = UA_NodeMap_iterateConcurrent;
+        ns->getEditNode = UA_NodeMap_getEditNodeConcurrent;
+        ns->getEditNodeFromPtr = UA_NodeMap_getEditNodeFromPtrConcurrent;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    ns->getNode = UA_NodeMap_getNode;
+    ns->getNodeFromPtr = UA_NodeMap_getNodeFromPtr;
+    ns->releaseNode = UA_NodeMap_releaseNode;
     ns->iterate = UA_NodeMap_iterate;
 
     /* All nodes are stored in RAM. Changes are made in-situ. GetEditNode is
@@ -547,3 +912,13 @@ UA_Nodestore_HashMap(UA_Nodestore *ns) {
 
     return UA_STATUSCODE_GOOD;
 }
+
+UA_StatusCode
+UA_Nodestore_HashMap(UA_Nodestore *ns) {
+    return createNodeMap(ns, false);
+}
+
+UA_StatusCode
+UA_Nodestore_HashMapConcurrent(UA_Nodestore *ns) {
+    return createNodeMap(ns, true);
+}
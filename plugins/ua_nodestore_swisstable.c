@@ -0,0 +1,774 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information.
+ *
+ *    Copyright 2014-2019 (c) Fraunhofer IOSB (Author: Julius Pfrommer)
+ */
+
+#include <open62541/util.h>
+#include <open62541/plugin/nodestore_default.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define UA_SWISSTABLE_SSE2
+#endif
+
+#ifndef container_of
+#define container_of(ptr, type, member) \
+    (type *)((uintptr_t)ptr - offsetof(type,member))
+#endif
+
+/* The SwissTable Nodestore is an open-addressing hash-map with a power-of-two
+ * number of slots. Next to the slots, the table has one control byte per slot.
+ * The control byte is either EMPTY, DELETED (tombstone) or holds the 7-bit tag
+ * of the hash of the NodeId in the slot. The slots are arranged in groups of 16
+ * control bytes. Lookups compare the tag against all control bytes of a group
+ * at once (with SSE2 where available). Only the slots with a matching tag are
+ * compared in detail. The probing sequence visits the groups in triangular
+ * order. The search stops at the first group with an EMPTY control byte.
+ *
+ * The table is resized incrementally. When a resize is required, a new table
+ * is allocated and the old table is kept around. Every following insert and
+ * remove moves some of the remaining entries from the old table. Lookups search
+ * in both tables until the old table is empty.
+ *
+ * String and ByteString NodeIds of the inserted nodes are interned. The nodes
+ * and their copies from getNodeCopy share the same (reference-counted)
+ * identifier. Lookups with the NodeId of a node from the Nodestore then only
+ * compare the pointers. */
+
+#define UA_SWISSTABLE_GROUP 16
+#define UA_SWISSTABLE_MINSIZE 64   /* Slots. Must be a power of two. */
+#define UA_SWISSTABLE_MIGRATE 64   /* Slots to migrate with every modification */
+#define UA_SWISSTABLE_EMPTY   ((UA_Byte)0x80)
+#define UA_SWISSTABLE_DELETED ((UA_Byte)0xFE)
+#define UA_SWISSTABLE_NOTFOUND UA_UINT32_MAX
+
+typedef struct NodeEntry {
+    struct NodeEntry *orig; /* the version this is a copy from (or NULL) */
+    UA_UInt32 nodeIdHash;
+    UA_UInt32 refCount; /* How many consumers have a reference to the node? */
+    UA_Boolean deleted; /* Node was marked as deleted and can be deleted when
+                         * refCount == 0 */
+    UA_Boolean interned; /* The identifier of the NodeId is interned */
+    UA_Node node;
+} NodeEntry;
+
+/* Header of the interned String/ByteString identifiers. The bytes of the
+ * identifier follow directly. */
+typedef struct {
+    UA_UInt32 refCount;
+} InternedIdentifier;
+
+typedef struct {
+    UA_UInt32 size;   /* Number of slots. Zero if no table is allocated. */
+    UA_UInt32 used;   /* Number of non-empty slots (including tombstones) */
+    UA_Byte *ctrl;    /* Control bytes. Points into the slots allocation. */
+    NodeEntry **slots;
+} SwissTable;
+
+typedef struct {
+    SwissTable table;
+    SwissTable old;      /* Still migrating to the new table */
+    UA_UInt32 migrated;  /* Position of the migration in the old table */
+    UA_UInt32 count;     /* Number of entries in both tables */
+    UA_Boolean iterating; /* Don't resize during the iteration */
+
+    /* Maps ReferenceTypeIndex to the NodeId of the ReferenceType */
+    UA_NodeId referenceTypeIds[UA_REFERENCETYPESET_MAX];
+    UA_Byte referenceTypeCounter;
+} SwissContext;
+
+/*******************/
+/* Table Utilities */
+/*******************/
+
+/* Mix the bits of the NodeId hash. The tag is taken from the upper bits and
+ * the group from the lower bits. */
+static UA_UInt32
+swissHash(const UA_NodeId *nodeId) {
+    UA_UInt32 h = UA_NodeId_hash(nodeId);
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+static UA_Byte
+hashTag(UA_UInt32 h) {
+    return (UA_Byte)(h >> 25);
+}
+
+/* Bitmask of the control bytes in the group that are equal to the tag */
+static UA_UInt32
+groupMatch(const UA_Byte *group, UA_Byte tag) {
+#ifdef UA_SWISSTABLE_SSE2
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)(const void*)group);
+    return (UA_UInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)tag)));
+#else
+    UA_UInt32 mask = 0;
+    for(UA_UInt32 i = 0; i < UA_SWISSTABLE_GROUP; i++)
+        mask |= (UA_UInt32)(group[i] == tag) << i;
+    return mask;
+#endif
+}
+
+/* Bitmask of the EMPTY or DELETED control bytes. These have the high bit set,
+ * the tags of occupied slots have not. */
+static UA_UInt32
+groupMatchFree(const UA_Byte *group) {
+#ifdef UA_SWISSTABLE_SSE2
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)(const void*)group);
+    return (UA_UInt32)_mm_movemask_epi8(ctrl);
+#else
+    UA_UInt32 mask = 0;
+    for(UA_UInt32 i = 0; i < UA_SWISSTABLE_GROUP; i++)
+        mask |= (UA_UInt32)(group[i] >> 7) << i;
+    return mask;
+#endif
+}
+
+static UA_UInt32
+lowestBit(UA_UInt32 mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (UA_UInt32)__builtin_ctz(mask);
+#else
+    UA_UInt32 i = 0;
+    while(!(mask & 1)) {
+        mask >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+static UA_Boolean
+matchNodeId(const UA_NodeId *stored, const UA_NodeId *nodeId) {
+    if(stored->namespaceIndex != nodeId->namespaceIndex ||
+       stored->identifierType != nodeId->identifierType)
+        return false;
+    switch(nodeId->identifierType) {
+    case UA_NODEIDTYPE_NUMERIC:
+        return (stored->identifier.numeric == nodeId->identifier.numeric);
+    case UA_NODEIDTYPE_STRING:
+    case UA_NODEIDTYPE_BYTESTRING:
+        if(stored->identifier.string.length != nodeId->identifier.string.length)
+            return false;
+        /* Interned identifier */
+        if(stored->identifier.string.data == nodeId->identifier.string.data)
+            return true;
+        return (memcmp(stored->identifier.string.data,
+                       nodeId->identifier.string.data,
+                       nodeId->identifier.string.length) == 0);
+    case UA_NODEIDTYPE_GUID:
+        return UA_Guid_equal(&stored->identifier.guid, &nodeId->identifier.guid);
+    default:
+        return false;
+    }
+}
+
+static UA_StatusCode
+allocTable(SwissTable *t, UA_UInt32 size) {
+    /* The control bytes are placed after the slots */
+    NodeEntry **slots = (NodeEntry**)
+        UA_malloc((sizeof(NodeEntry*) + 1) * (size_t)size);
+    if(!slots)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    t->slots = slots;
+    t->ctrl = (UA_Byte*)&slots[size];
+    memset(t->ctrl, UA_SWISSTABLE_EMPTY, size);
+    t->size = size;
+    t->used = 0;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+freeTable(SwissTable *t) {
+    UA_free(t->slots);
+    memset(t, 0, sizeof(SwissTable));
+}
+
+/* Returns the slot index or UA_SWISSTABLE_NOTFOUND */
+static UA_UInt32
+findSlot(const SwissTable *t, const UA_NodeId *nodeId, UA_UInt32 h) {
+    if(t->size == 0)
+        return UA_SWISSTABLE_NOTFOUND;
+    UA_Byte tag = hashTag(h);
+    UA_UInt32 groupMask = (t->size / UA_SWISSTABLE_GROUP) - 1;
+    UA_UInt32 g = h & groupMask;
+    for(UA_UInt32 i = 0; i <= groupMask; i++) {
+        const UA_Byte *group = &t->ctrl[g * UA_SWISSTABLE_GROUP];
+        UA_UInt32 m = groupMatch(group, tag);
+        while(m) {
+            UA_UInt32 idx = g * UA_SWISSTABLE_GROUP + lowestBit(m);
+            const NodeEntry *entry = t->slots[idx];
+            if(entry->nodeIdHash == h &&
+               matchNodeId(&entry->node.head.nodeId, nodeId))
+                return idx;
+            m &= m - 1;
+        }
+        /* No matching entry can come afterwards */
+        if(groupMatch(group, UA_SWISSTABLE_EMPTY))
+            return UA_SWISSTABLE_NOTFOUND;
+        g = (g + i + 1) & groupMask; /* Triangular probing */
+    }
+    return UA_SWISSTABLE_NOTFOUND;
+}
+
+/* The entry must not be contained in the table and the table must have a free
+ * slot */
+static void
+insertSlot(SwissTable *t, NodeEntry *entry) {
+    UA_UInt32 h = entry->nodeIdHash;
+    UA_UInt32 groupMask = (t->size / UA_SWISSTABLE_GROUP) - 1;
+    UA_UInt32 g = h & groupMask;
+    for(UA_UInt32 i = 0; i <= groupMask; i++) {
+        UA_UInt32 m = groupMatchFree(&t->ctrl[g * UA_SWISSTABLE_GROUP]);
+        if(m) {
+            UA_UInt32 idx = g * UA_SWISSTABLE_GROUP + lowestBit(m);
+            if(t->ctrl[idx] == UA_SWISSTABLE_EMPTY)
+                t->used++;
+            t->ctrl[idx] = hashTag(h);
+            t->slots[idx] = entry;
+            return;
+        }
+        g = (g + i + 1) & groupMask;
+    }
+    UA_assert(false); /* The table is never full */
+}
+
+static void
+removeSlot(SwissTable *t, UA_UInt32 idx) {
+    t->ctrl[idx] = UA_SWISSTABLE_DELETED;
+    t->slots[idx] = NULL;
+}
+
+/* Never fill more than 7/8 of the slots (including the tombstones) */
+static UA_Boolean
+hasRoom(const SwissTable *t) {
+    return (t->used + 1 <= t->size - (t->size / 8));
+}
+
+/* Move the entries from up to "slots" positions of the old table. Free the
+ * old table once it is empty. Stops early if the new table needs a resize. */
+static void
+migrate(SwissContext *ns, UA_UInt32 slots) {
+    SwissTable *old = &ns->old;
+    if(old->size == 0)
+        return;
+    UA_UInt32 end = (slots < old->size - ns->migrated) ?
+        ns->migrated + slots : old->size;
+    for(; ns->migrated < end; ns->migrated++) {
+        if(old->ctrl[ns->migrated] & 0x80)
+            continue; /* Empty or deleted */
+        if(!hasRoom(&ns->table))
+            return;
+        insertSlot(&ns->table, old->slots[ns->migrated]);
+        removeSlot(old, ns->migrated);
+    }
+    if(ns->migrated == old->size)
+        freeTable(old);
+}
+
+/* Start the migration to a new table with an occupancy of 50% or less. The
+ * remaining entries of a pending migration are moved to the new table
+ * directly. */
+static UA_StatusCode
+resize(SwissContext *ns, UA_UInt32 count) {
+    UA_UInt32 size = UA_SWISSTABLE_MINSIZE;
+    while(size < count * 2) {
+        if(size >= (UA_UInt32)1 << 31)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        size <<= 1;
+    }
+
+    SwissTable t;
+    UA_StatusCode res = allocTable(&t, size);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    if(ns->old.size > 0) {
+        for(UA_UInt32 i = ns->migrated; i < ns->old.size; i++) {
+            if(!(ns->old.ctrl[i] & 0x80))
+                insertSlot(&t, ns->old.slots[i]);
+        }
+        freeTable(&ns->old);
+    }
+
+    ns->old = ns->table;
+    ns->table = t;
+    ns->migrated = 0;
+    migrate(ns, UA_SWISSTABLE_MIGRATE);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Find the entry in the current or the old table. Returns NULL if not found.
+ * If the table is set, it returns the table and the slot index. */
+static NodeEntry *
+findEntry(SwissContext *ns, const UA_NodeId *nodeId, UA_UInt32 h,
+          SwissTable **table, UA_UInt32 *slot) {
+    SwissTable *t = &ns->table;
+    UA_UInt32 idx = findSlot(t, nodeId, h);
+    if(idx == UA_SWISSTABLE_NOTFOUND) {
+        t = &ns->old;
+        idx = findSlot(t, nodeId, h);
+        if(idx == UA_SWISSTABLE_NOTFOUND)
+            return NULL;
+    }
+    if(table) {
+        *table = t;
+        *slot = idx;
+    }
+    return t->slots[idx];
+}
+
+/***********/
+/* Entries */
+/***********/
+
+static NodeEntry *
+createEntry(UA_NodeClass nodeClass) {
+    size_t size = sizeof(NodeEntry) - sizeof(UA_Node);
+    switch(nodeClass) {
+    case UA_NODECLASS_OBJECT:
+        size += sizeof(UA_ObjectNode);
+        break;
+    case UA_NODECLASS_VARIABLE:
+        size += sizeof(UA_VariableNode);
+        break;
+    case UA_NODECLASS_METHOD:
+        size += sizeof(UA_MethodNode);
+        break;
+    case UA_NODECLASS_OBJECTTYPE:
+        size += sizeof(UA_ObjectTypeNode);
+        break;
+    case UA_NODECLASS_VARIABLETYPE:
+        size += sizeof(UA_VariableTypeNode);
+        break;
+    case UA_NODECLASS_REFERENCETYPE:
+        size += sizeof(UA_ReferenceTypeNode);
+        break;
+    case UA_NODECLASS_DATATYPE:
+        size += sizeof(UA_DataTypeNode);
+        break;
+    case UA_NODECLASS_VIEW:
+        size += sizeof(UA_ViewNode);
+        break;
+    default:
+        return NULL;
+    }
+    NodeEntry *entry = (NodeEntry*)UA_calloc(1, size);
+    if(!entry)
+        return NULL;
+    entry->node.head.nodeClass = nodeClass;
+    return entry;
+}
+
+static InternedIdentifier *
+internedHeader(const UA_NodeId *nodeId) {
+    return (InternedIdentifier*)
+        (uintptr_t)(nodeId->identifier.string.data - sizeof(InternedIdentifier));
+}
+
+/* Replace the String/ByteString identifier with an interned copy */
+static UA_StatusCode
+internNodeId(NodeEntry *entry) {
+    UA_NodeId *nodeId = &entry->node.head.nodeId;
+    if(entry->interned ||
+       (nodeId->identifierType != UA_NODEIDTYPE_STRING &&
+        nodeId->identifierType != UA_NODEIDTYPE_BYTESTRING) ||
+       nodeId->identifier.string.length == 0)
+        return UA_STATUSCODE_GOOD;
+    InternedIdentifier *ii = (InternedIdentifier*)
+        UA_malloc(sizeof(InternedIdentifier) + nodeId->identifier.string.length);
+    if(!ii)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    ii->refCount = 1;
+    UA_Byte *data = (UA_Byte*)&ii[1];
+    memcpy(data, nodeId->identifier.string.data, nodeId->identifier.string.length);
+    UA_free(nodeId->identifier.string.data);
+    nodeId->identifier.string.data = data;
+    entry->interned = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Let the copy use the interned identifier of the original */
+static void
+shareNodeId(NodeEntry *copy, const NodeEntry *orig) {
+    if(!orig->interned)
+        return;
+    UA_NodeId *nodeId = &copy->node.head.nodeId;
+    UA_free(nodeId->identifier.string.data);
+    nodeId->identifier.string.data = orig->node.head.nodeId.identifier.string.data;
+    internedHeader(nodeId)->refCount++;
+    copy->interned = true;
+}
+
+static void
+deleteEntry(NodeEntry *entry) {
+    if(entry->interned) {
+        /* Detach the interned identifier before the node is cleared */
+        UA_NodeId *nodeId = &entry->node.head.nodeId;
+        InternedIdentifier *ii = internedHeader(nodeId);
+        if(--ii->refCount == 0)
+            UA_free(ii);
+        UA_NodeId_init(nodeId);
+    }
+    UA_Node_clear(&entry->node);
+    UA_free(entry);
+}
+
+static void
+cleanupEntry(NodeEntry *entry) {
+    if(entry->refCount > 0)
+        return;
+    if(entry->deleted) {
+        deleteEntry(entry);
+        return;
+    }
+    /* Switch large reference arrays to the tree representation */
+    for(size_t i = 0; i < entry->node.head.referencesSize; i++) {
+        UA_NodeReferenceKind *rk = &entry->node.head.references[i];
+        if(rk->targetsSize > 16 && !rk->hasRefTree)
+            UA_NodeReferenceKind_switch(rk);
+    }
+}
+
+/***********************/
+/* Interface functions */
+/***********************/
+
+static UA_Node *
+swissNsNewNode(void *nsCtx, UA_NodeClass nodeClass) {
+    NodeEntry *entry = createEntry(nodeClass);
+    if(!entry)
+        return NULL;
+    return &entry->node;
+}
+
+static void
+swissNsDeleteNode(void *nsCtx, UA_Node *node) {
+    deleteEntry(container_of(node, NodeEntry, node));
+}
+
+static const UA_Node *
+swissNsGetNode(void *nsCtx, const UA_NodeId *nodeId,
+               UA_UInt32 attributeMask,
+               UA_ReferenceTypeSet references,
+               UA_BrowseDirection referenceDirections) {
+    SwissContext *ns = (SwissContext*)nsCtx;
+    NodeEntry *entry = findEntry(ns, nodeId, swissHash(nodeId), NULL, NULL);
+    if(!entry)
+        return NULL;
+    ++entry->refCount;
+    return &entry->node;
+}
+
+static const UA_Node *
+swissNsGetNodeFromPtr(void *nsCtx, UA_NodePointer ptr,
+                      UA_UInt32 attributeMask,
+                      UA_ReferenceTypeSet references,
+                      UA_BrowseDirection referenceDirections) {
+    if(!UA_NodePointer_isLocal(ptr))
+        return NULL;
+
+    /* Direct pointer to a node that was not replaced or removed since. The
+     * caller holds a reference, so the entry is still allocated. */
+    const UA_NodeHead *head = UA_NodePointer_toNode(ptr);
+    if(head) {
+        NodeEntry *entry = container_of((const UA_Node*)head, NodeEntry, node);
+        if(!entry->deleted) {
+            ++entry->refCount;
+            return &entry->node;
+        }
+    }
+
+    UA_NodeId id = UA_NodePointer_toNodeId(ptr);
+    return swissNsGetNode(nsCtx, &id, attributeMask,
+                          references, referenceDirections);
+}
+
+static void
+swissNsReleaseNode(void *nsCtx, const UA_Node *node) {
+    if(!node)
+        return;
+    NodeEntry *entry = container_of(node, NodeEntry, node);
+    UA_assert(entry->refCount > 0);
+    --entry->refCount;
+    cleanupEntry(entry);
+}
+
+static UA_StatusCode
+swissNsGetNodeCopy(void *nsCtx, const UA_NodeId *nodeId,
+                   UA_Node **outNode) {
+    SwissContext *ns = (SwissContext*)nsCtx;
+    NodeEntry *entry = findEntry(ns, nodeId, swissHash(nodeId), NULL, NULL);
+    if(!entry)
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+
+    NodeEntry *newEntry = createEntry(entry->node.head.nodeClass);
+    if(!newEntry)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    UA_StatusCode retval = UA_Node_copy(&entry->node, &newEntry->node);
+    if(retval != UA_STATUSCODE_GOOD) {
+        deleteEntry(newEntry);
+        return retval;
+    }
+
+    shareNodeId(newEntry, entry);
+    newEntry->orig = entry; /* Store the pointer to the original */
+    *outNode = &newEntry->node;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* If this function fails in any way, the node parameter is deleted here, so
+ * the caller function does not need to take care of it anymore */
+static UA_StatusCode
+swissNsInsertNode(void *nsCtx, UA_Node *node, UA_NodeId *addedNodeId) {
+    SwissContext *ns = (SwissContext*)nsCtx;
+    NodeEntry *entry = container_of(node, NodeEntry, node);
+
+    /* Make room for the new entry */
+    migrate(ns, UA_SWISSTABLE_MIGRATE);
+    if(!hasRoom(&ns->table)) {
+        UA_StatusCode res = resize(ns, ns->count + 1);
+        if(res != UA_STATUSCODE_GOOD) {
+            deleteEntry(entry);
+            return res;
+        }
+    }
+
+    /* Ensure that the NodeId is unique */
+    UA_NodeId *nodeId = &node->head.nodeId;
+    if(nodeId->identifierType == UA_NODEIDTYPE_NUMERIC &&
+       nodeId->identifier.numeric == 0) {
+        UA_UInt32 numId;
+        do { /* Create a random nodeid until we find an unoccupied id */
+            numId = UA_UInt32_random();
+#if SIZE_MAX <= UA_UINT32_MAX
+            /* The compressed "immediate" representation of nodes does not
+             * support the full range on 32bit systems. Generate smaller
+             * identifiers as they can be stored more compactly. */
+            if(numId >= (0x01 << 24))
+                numId = numId % (0x01 << 24);
+#endif
+            nodeId->identifier.numeric = numId;
+            entry->nodeIdHash = swissHash(nodeId);
+        } while(numId == 0 ||
+                findEntry(ns, nodeId, entry->nodeIdHash, NULL, NULL));
+    } else {
+        entry->nodeIdHash = swissHash(nodeId);
+        if(findEntry(ns, nodeId, entry->nodeIdHash, NULL, NULL)) {
+            deleteEntry(entry); /* The nodeid exists */
+            return UA_STATUSCODE_BADNODEIDEXISTS;
+        }
+    }
+
+    /* Intern the identifier */
+    UA_StatusCode retval = internNodeId(entry);
+    if(retval != UA_STATUSCODE_GOOD) {
+        deleteEntry(entry);
+        return retval;
+    }
+
+    /* Copy the NodeId */
+    if(addedNodeId) {
+        retval = UA_NodeId_copy(nodeId, addedNodeId);
+        if(retval != UA_STATUSCODE_GOOD) {
+            deleteEntry(entry);
+            return retval;
+        }
+    }
+
+    /* For new ReferencetypeNodes add to the index map */
+    if(node->head.nodeClass == UA_NODECLASS_REFERENCETYPE) {
+        UA_ReferenceTypeNode *refNode = &node->referenceTypeNode;
+        if(ns->referenceTypeCounter >= UA_REFERENCETYPESET_MAX) {
+            deleteEntry(entry);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+
+        retval = UA_NodeId_copy(nodeId, &ns->referenceTypeIds[ns->referenceTypeCounter]);
+        if(retval != UA_STATUSCODE_GOOD) {
+            deleteEntry(entry);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+
+        /* Assign the ReferenceTypeIndex to the new ReferenceTypeNode */
+        refNode->referenceTypeIndex = ns->referenceTypeCounter;
+        refNode->subTypes = UA_REFTYPESET(ns->referenceTypeCounter);
+
+        ns->referenceTypeCounter++;
+    }
+
+    /* Insert the node */
+    insertSlot(&ns->table, entry);
+    ns->count++;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+swissNsReplaceNode(void *nsCtx, UA_Node *node) {
+    SwissContext *ns = (SwissContext*)nsCtx;
+    NodeEntry *entry = container_of(node, NodeEntry, node);
+
+    /* Find the node */
+    SwissTable *t;
+    UA_UInt32 idx;
+    UA_UInt32 h = swissHash(&node->head.nodeId);
+    NodeEntry *oldEntry = findEntry(ns, &node->head.nodeId, h, &t, &idx);
+    if(!oldEntry) {
+        deleteEntry(entry);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+
+    /* The node was already updated since the copy was made? */
+    if(oldEntry != entry->orig) {
+        deleteEntry(entry);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Replace the entry in-situ. The hash and tag are unchanged. */
+    entry->nodeIdHash = h;
+    entry->orig = NULL;
+    t->slots[idx] = entry;
+    oldEntry->deleted = true;
+    cleanupEntry(oldEntry);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+swissNsRemoveNode(void *nsCtx, const UA_NodeId *nodeId) {
+    SwissContext *ns = (SwissContext*)nsCtx;
+    SwissTable *t;
+    UA_UInt32 idx;
+    NodeEntry *entry = findEntry(ns, nodeId, swissHash(nodeId), &t, &idx);
+    if(!entry)
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    removeSlot(t, idx);
+    ns->count--;
+    entry->deleted = true;
+    cleanupEntry(entry);
+
+    if(ns->iterating)
+        return UA_STATUSCODE_GOOD;
+
+    /* Shrink the table if it is very empty. Can fail. Then just continue with
+     * the bigger table. */
+    migrate(ns, UA_SWISSTABLE_MIGRATE);
+    if(ns->old.size == 0 && ns->table.size > UA_SWISSTABLE_MINSIZE &&
+       ns->count * 8 < ns->table.size)
+        resize(ns, ns->count);
+    return UA_STATUSCODE_GOOD;
+}
+
+static const UA_NodeId *
+swissNsGetReferenceTypeId(void *nsCtx, UA_Byte refTypeIndex) {
+    SwissContext *ns = (SwissContext*)nsCtx;
+    if(refTypeIndex >= ns->referenceTypeCounter)
+        return NULL;
+    return &ns->referenceTypeIds[refTypeIndex];
+}
+
+static void
+iterateTable(SwissTable *t, UA_NodestoreVisitor visitor, void *visitorCtx) {
+    for(UA_UInt32 i = 0; i < t->size; i++) {
+        if(t->ctrl[i] & 0x80)
+            continue; /* Empty or deleted */
+        /* The visitor can delete the node. So refcount here. */
+        NodeEntry *entry = t->slots[i];
+        entry->refCount++;
+        visitor(visitorCtx, &entry->node);
+        entry->refCount--;
+        cleanupEntry(entry);
+    }
+}
+
+static void
+swissNsIterate(void *nsCtx, UA_NodestoreVisitor visitor,
+               void *visitorCtx) {
+    /* Removing nodes during the iteration does not resize (or migrate) the
+     * tables */
+    SwissContext *ns = (SwissContext*)nsCtx;
+    UA_Boolean iterating = ns->iterating;
+    ns->iterating = true;
+    iterateTable(&ns->table, visitor, visitorCtx);
+    iterateTable(&ns->old, visitor, visitorCtx);
+    ns->iterating = iterating;
+}
+
+/***********************/
+/* Nodestore Lifecycle */
+/***********************/
+
+static void
+clearTable(SwissTable *t) {
+    for(UA_UInt32 i = 0; i < t->size; i++) {
+        if(t->ctrl[i] & 0x80)
+            continue;
+        /* On debugging builds, check that all nodes were released */
+        UA_assert(t->slots[i]->refCount == 0);
+        deleteEntry(t->slots[i]);
+    }
+    freeTable(t);
+}
+
+static void
+swissNsClear(void *nsCtx) {
+    if(!nsCtx)
+        return;
+    SwissContext *ns = (SwissContext*)nsCtx;
+    clearTable(&ns->table);
+    clearTable(&ns->old);
+
+    /* Clean up the ReferenceTypes index array */
+    for(size_t i = 0; i < ns->referenceTypeCounter; i++)
+        UA_NodeId_clear(&ns->referenceTypeIds[i]);
+
+    UA_free(ns);
+}
+
+UA_StatusCode
+UA_Nodestore_SwissTable(UA_Nodestore *ns) {
+    /* Allocate and initialize the context */
+    SwissContext *ctx = (SwissContext*)UA_calloc(1, sizeof(SwissContext));
+    if(!ctx)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_StatusCode res = allocTable(&ctx->table, UA_SWISSTABLE_MINSIZE);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_free(ctx);
+        return res;
+    }
+
+    /* Populate the nodestore */
+    ns->context = (void*)ctx;
+    ns->clear = swissNsClear;
+    ns->newNode = swissNsNewNode;
+    ns->deleteNode = swissNsDeleteNode;
+    ns->getNode = swissNsGetNode;
+    ns->getNodeFromPtr = swissNsGetNodeFromPtr;
+    ns->releaseNode = swissNsReleaseNode;
+    ns->getNodeCopy = swissNsGetNodeCopy;
+    ns->insertNode = swissNsInsertNode;
+    ns->replaceNode = swissNsReplaceNode;
+    ns->removeNode = swissNsRemoveNode;
+    ns->getReferenceTypeId = swissNsGetReferenceTypeId;
+    ns->iterate = swissNsIterate;
+
+    /* All nodes are stored in RAM. Changes are made in-situ. GetEditNode is
+     * identical to GetNode -- but the Node pointer is non-const. */
+    ns->getEditNode =
+        (UA_Node * (*)(void *nsCtx, const UA_NodeId *nodeId,
+                       UA_UInt32 attributeMask,
+                       UA_ReferenceTypeSet references,
+                       UA_BrowseDirection referenceDirections))swissNsGetNode;
+    ns->getEditNodeFromPtr =
+        (UA_Node * (*)(void *nsCtx, UA_NodePointer ptr,
+                       UA_UInt32 attributeMask,
+                       UA_ReferenceTypeSet references,
+                       UA_BrowseDirection referenceDirections))swissNsGetNodeFromPtr;
+
+    return UA_STATUSCODE_GOOD;
+}
@@ -633,7 +633,7 @@ UA_PubSubConnection_connectUDP(UA_PubSubManager *psm, UA_PubSubConnection *c,
     UA_Boolean listen = true;
     UA_Boolean reuse = true;
     UA_Boolean loopback = true;
-    UA_KeyValuePair kvp[7];
+    UA_KeyValuePair kvp[8];
     UA_KeyValueMap kvm = {5, kvp};
     kvp[0].key = UA_QUALIFIEDNAME(0, "port");
     UA_Variant_setScalar(&kvp[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
@@ -676,9 +676,19 @@ UA_PubSubConnection_connectUDP(UA_PubSubManager *psm, UA_PubSubConnection *c,
         return UA_STATUSCODE_GOOD;
     }
 
-    /* Open a send connection */
+    /* Open a send connection. With the "batch" connection property, the
+     * NetworkMessages are queued and sent in a batch once per EventLoop
+     * iteration. */
     if(validate || (c->sendChannel == 0 && c->writerGroupsSize > 0)) {
         listen = false;
+        const UA_Variant *batch =
+            UA_KeyValueMap_get(&c->config.connectionProperties,
+                               UA_QUALIFIEDNAME(0, "batch"));
+        if(batch) {
+            kvp[kvm.mapSize].key = UA_QUALIFIEDNAME(0, "batch");
+            kvp[kvm.mapSize].value = *batch;
+            kvm.mapSize++;
+        }
         res = c->cm->openConnection(c->cm, &kvm, psm, c, PubSubSendChannelCallback);
         if(res != UA_STATUSCODE_GOOD) {
             UA_LOG_ERROR_PUBSUB(psm->logging, c, "Could not open an UDP recv channel");
@@ -1146,7 +1146,7 @@ UA_WriterGroup_connectUDPUnicast(UA_PubSubManager *psm, UA_WriterGroup *wg,
 
     /* Set up the connection parameters */
     UA_Boolean listen = false;
-    UA_KeyValuePair kvp[5];
+    UA_KeyValuePair kvp[6];
     UA_KeyValueMap kvm = {4, kvp};
     kvp[0].key = UA_QUALIFIEDNAME(0, "address");
     UA_Variant_setScalar(&kvp[0].value, &address, &UA_TYPES[UA_TYPES_STRING]);
@@ -1163,6 +1163,16 @@ UA_WriterGroup_connectUDPUnicast(UA_PubSubManager *psm, UA_WriterGroup *wg,
         kvm.mapSize++;
     }
 
+    /* Send in batches if configured for the PubSubConnection */
+    const UA_Variant *batch =
+        UA_KeyValueMap_get(&wg->linkedConnection->config.connectionProperties,
+                           UA_QUALIFIEDNAME(0, "batch"));
+    if(batch) {
+        kvp[kvm.mapSize].key = UA_QUALIFIEDNAME(0, "batch");
+        kvp[kvm.mapSize].value = *batch;
+        kvm.mapSize++;
+    }
+
     /* Connect */
     UA_ConnectionManager *cm = wg->linkedConnection->cm;
     res = cm->openConnection(cm, &kvm, psm, wg, WriterGroupChannelCallback);
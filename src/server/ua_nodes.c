@@ -185,6 +185,22 @@ UA_NodePointer_fromNodeId(const UA_NodeId *id) {
     return np;
 }
 
+UA_NodePointer
+UA_NodePointer_fromNode(const UA_NodeHead *head) {
+    UA_NodePointer np;
+    np.node = head;
+    np.immediate |= UA_NODEPOINTER_TAG_NODE;
+    return np;
+}
+
+const UA_NodeHead *
+UA_NodePointer_toNode(UA_NodePointer np) {
+    if((np.immediate & UA_NODEPOINTER_MASK) != UA_NODEPOINTER_TAG_NODE)
+        return NULL;
+    np.immediate &= ~(uintptr_t)UA_NODEPOINTER_MASK;
+    return np.node;
+}
+
 UA_NodeId
 UA_NodePointer_toNodeId(UA_NodePointer np) {
     UA_Byte tag = np.immediate & UA_NODEPOINTER_MASK;
@@ -546,6 +562,7 @@ UA_Node_copy(const UA_Node *src, UA_Node *dst) {
     retval |= UA_QualifiedName_copy(&srchead->browseName, &dsthead->browseName);
 
     /* Copy the display name in several languages */
+    UA_LocalizedTextListEntry **displayNameTail = &dsthead->displayName;
     for(UA_LocalizedTextListEntry *lt = srchead->displayName; lt != NULL; lt = lt->next) {
         UA_LocalizedTextListEntry *newEntry = (UA_LocalizedTextListEntry *)
             UA_calloc(1, sizeof(UA_LocalizedTextListEntry));
@@ -555,12 +572,14 @@ UA_Node_copy(const UA_Node *src, UA_Node *dst) {
         }
         retval |= UA_LocalizedText_copy(&lt->localizedText, &newEntry->localizedText);
 
-        /* Add to the linked list possibly in reverse order */
-        newEntry->next = dsthead->displayName;
-        dsthead->displayName = newEntry;
+        /* Append to keep the order of the locales. The first entry is
+         * returned if no locale matches. */
+        *displayNameTail = newEntry;
+        displayNameTail = &newEntry->next;
     }
 
     /* Copy the description in several languages */
+    UA_LocalizedTextListEntry **descriptionTail = &dsthead->description;
     for(UA_LocalizedTextListEntry *lt = srchead->description; lt != NULL; lt = lt->next) {
         UA_LocalizedTextListEntry *newEntry = (UA_LocalizedTextListEntry *)
             UA_calloc(1, sizeof(UA_LocalizedTextListEntry));
@@ -570,9 +589,10 @@ UA_Node_copy(const UA_Node *src, UA_Node *dst) {
         }
         retval |= UA_LocalizedText_copy(&lt->localizedText, &newEntry->localizedText);
 
-        /* Add to the linked list possibly in reverse order */
-        newEntry->next = dsthead->description;
-        dsthead->description= newEntry;
+        /* Append to keep the order of the locales. The first entry is
+         * returned if no locale matches. */
+        *descriptionTail = newEntry;
+        descriptionTail = &newEntry->next;
     }
 
     dsthead->writeMask = srchead->writeMask;
@@ -452,6 +452,10 @@ UA_Server_delete(UA_Server *server) {
     UA_ConditionList_delete(server);
 #endif
 
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    clearEventEmitCache(server);
+#endif
+
 #endif
 
 #if UA_MULTITHREADING >= 100
@@ -482,6 +486,7 @@ UA_Server_delete(UA_Server *server) {
 
 #if UA_MULTITHREADING >= 100
     UA_LOCK_DESTROY(&server->serviceMutex);
+    UA_LOCK_DESTROY(&server->handshakeMutex);
 #endif
 
     UA_GDSManager_clear(&server->gdsManager);
@@ -528,6 +533,7 @@ UA_Server_init(UA_Server *server) {
 #endif
 
     UA_LOCK_INIT(&server->serviceMutex);
+    UA_LOCK_INIT(&server->handshakeMutex);
     lockServer(server);
 
     /* Initialize the adminSession */
@@ -542,6 +548,8 @@ UA_Server_init(UA_Server *server) {
     server->adminSubscription = UA_Subscription_new();
     UA_CHECK_MEM(server->adminSubscription, goto cleanup);
     UA_Session_attachSubscription(&server->adminSession, server->adminSubscription);
+    ZIP_INIT(&server->subscriptionsById);
+    LIST_INIT(&server->samplingGroups);
 #endif
 
     /* Create Namespaces 0 and 1
@@ -555,6 +563,8 @@ UA_Server_init(UA_Server *server) {
 
     /* Initialize Session Management */
     LIST_INIT(&server->sessions);
+    ZIP_INIT(&server->sessionsByToken);
+    ZIP_INIT(&server->sessionsById);
     server->sessionCount = 0;
 
     /* Initialize SecureChannel */
@@ -929,7 +939,11 @@ UA_Server_updateCertificate(UA_Server *server,
         if(!UA_NodeId_equal(&sp->certificateTypeId, &certificateTypeId))
             continue;
 
+        /* Wait for the handshakes that use the private key outside of the
+         * service lock */
+        UA_LOCK(&server->handshakeMutex);
         retval = sp->updateCertificateAndPrivateKey(sp, certificate, newPrivateKey);
+        UA_UNLOCK(&server->handshakeMutex);
         if(retval != UA_STATUSCODE_GOOD) {
             unlockServer(server);
             return retval;
@@ -1387,3 +1401,41 @@ void unlockServer(UA_Server *server) {
         server->config.eventLoop->unlock(server->config.eventLoop);
     UA_UNLOCK(&server->serviceMutex);
 }
+
+#if UA_MULTITHREADING >= 100
+UA_THREAD_LOCAL UA_UInt32 readSectionDepth = 0;
+#endif
+
+void enterReadSection(UA_Server *server) {
+#if UA_MULTITHREADING >= 100
+    readSectionDepth++;
+#endif
+    unlockServer(server);
+}
+
+void leaveReadSection(UA_Server *server) {
+    lockServer(server);
+#if UA_MULTITHREADING >= 100
+    readSectionDepth--;
+#endif
+}
+
+UA_Boolean enterHandshakeSection(UA_Server *server) {
+#if UA_MULTITHREADING >= 100
+    UA_LOCK_ASSERT(&server->serviceMutex);
+    if(!server->config.concurrentHandshakes || server->serviceMutex.count != 1)
+        return false;
+    unlockServer(server);
+    UA_LOCK(&server->handshakeMutex);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void leaveHandshakeSection(UA_Server *server, UA_Boolean released) {
+    if(!released)
+        return;
+    UA_UNLOCK(&server->handshakeMutex);
+    lockServer(server);
+}
@@ -400,11 +400,12 @@ getBoundSession(UA_Server *server, const UA_SecureChannel *channel,
     UA_EventLoop *el = server->config.eventLoop;
     UA_DateTime nowMonotonic = el->dateTime_nowMonotonic(el);
 
-    for(UA_Session *s = channel->sessions; s; s = s->next) {
-        if(!UA_NodeId_equal(token, &s->authenticationToken))
-            continue;
-
+    /* Look up the session in the server-wide index */
+    session_list_entry *entry =
+        ZIP_FIND(UA_SessionTokenTree, &server->sessionsByToken, token);
+    if(entry && entry->session.channel == channel) {
         /* Has the session timed out? */
+        UA_Session *s = &entry->session;
         if(s->validTill < nowMonotonic) {
             server->serverDiagnosticsSummary.rejectedSessionCount++;
             return UA_STATUSCODE_BADSESSIONCLOSED;
@@ -417,9 +418,8 @@ getBoundSession(UA_Server *server, const UA_SecureChannel *channel,
 
     /* Session exists on another SecureChannel */
 #ifdef UA_ENABLE_DIAGNOSTICS
-    UA_Session *tmpSession = getSessionByToken(server, token);
-    if(tmpSession)
-        tmpSession->diagnostics.unauthorizedRequestCount++;
+    if(entry && entry->session.validTill >= nowMonotonic)
+        entry->session.diagnostics.unauthorizedRequestCount++;
 #endif
 
     /* Update the rejected statistics */
@@ -427,11 +427,11 @@ getBoundSession(UA_Server *server, const UA_SecureChannel *channel,
     return UA_STATUSCODE_BADSESSIONIDINVALID;
 }
 
+/* Decoding the request is done without the service lock. The lock is taken
+ * for processing the request and sending the response. */
 static UA_StatusCode
 processMSG(UA_Server *server, UA_SecureChannel *channel,
            UA_UInt32 requestId, const UA_ByteString *msg) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
-
     if(channel->state != UA_SECURECHANNELSTATE_OPEN)
         return UA_STATUSCODE_BADINTERNALERROR;
     /* Decode the nodeid */
@@ -457,24 +457,36 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
                                 "Unknown request with type identifier %" PRIi32,
                                 requestTypeId.identifier.numeric);
         }
-        return decodeHeaderSendServiceFault(server, channel, msg, offset,
-                                            &UA_TYPES[UA_TYPES_SERVICEFAULT],
-                                            requestId, UA_STATUSCODE_BADSERVICEUNSUPPORTED);
+        lockServer(server);
+        retval = decodeHeaderSendServiceFault(server, channel, msg, offset,
+                                              &UA_TYPES[UA_TYPES_SERVICEFAULT],
+                                              requestId, UA_STATUSCODE_BADSERVICEUNSUPPORTED);
+        unlockServer(server);
+        return retval;
     }
 
-    /* Decode the request */
+    /* Decode the request into the arena of the SecureChannel. The services
+     * copy what they retain from the request. So all memory of the request is
+     * released at once with a reset after the response was sent. This avoids
+     * a malloc/free for every string, array and variant in the request. */
     UA_Request request;
     size_t requestPos = offset; /* Store the offset (for sendServiceFault) */
     UA_DecodeBinaryOptions opt;
     memset(&opt, 0, sizeof(UA_DecodeBinaryOptions));
     opt.customTypes = server->config.customDataTypes;
+    opt.callocContext = &channel->requestArena;
+    opt.calloc = UA_Arena_calloc;
     retval = UA_decodeBinaryInternal(msg, &offset, &request, sd->requestType, &opt);
     if(retval != UA_STATUSCODE_GOOD) {
         UA_LOG_DEBUG_CHANNEL(server->config.logging, channel,
                              "Could not decode the request with StatusCode %s",
                              UA_StatusCode_name(retval));
-        return decodeHeaderSendServiceFault(server, channel, msg, requestPos,
-                                            sd->responseType, requestId, retval);
+        UA_Arena_reset(&channel->requestArena);
+        lockServer(server);
+        retval = decodeHeaderSendServiceFault(server, channel, msg, requestPos,
+                                              sd->responseType, requestId, retval);
+        unlockServer(server);
+        return retval;
     }
 
     /* Initialize the response */
@@ -482,38 +494,45 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
     UA_init(&response, sd->responseType);
     response.responseHeader.requestHandle = request.requestHeader.requestHandle;
 
-    /* Process the request */
+    /* Process the request and send the response if not async. The channel
+     * might have been closed in the meantime. Sending is done with the lock as
+     * the channel state is shared with the (Publish) responses sent from other
+     * threads. */
     lockServer(server);
-    UA_Boolean async =
-        UA_Server_processRequest(server, channel, requestId, sd, &request, &response);
-    unlockServer(server);
-
-    /* Send response if not async */
-    if(UA_LIKELY(!async)) {
-        retval = sendResponse(server, channel, requestId, &response, sd->responseType);
+    if(channel->state == UA_SECURECHANNELSTATE_OPEN) {
+        UA_Boolean async =
+            UA_Server_processRequest(server, channel, requestId, sd, &request, &response);
+        if(UA_LIKELY(!async))
+            retval = sendResponse(server, channel, requestId, &response, sd->responseType);
     }
+    unlockServer(server);
 
     /* Clean up */
-    UA_clear(&request, sd->requestType);
+    UA_Arena_reset(&channel->requestArena);
     UA_clear(&response, sd->responseType);
     return retval;
 }
 
-/* Takes decoded messages starting at the nodeid of the content type. */
+/* Takes decoded messages starting at the nodeid of the content type. Can be
+ * called without the service lock. Takes the lock where required. */
 static UA_StatusCode
 processSecureChannelMessage(UA_Server *server, UA_SecureChannel *channel,
                             UA_MessageType messagetype, UA_UInt32 requestId,
                             UA_ByteString *message) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
-
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
     switch(messagetype) {
     case UA_MESSAGETYPE_HEL:
         UA_LOG_TRACE_CHANNEL(server->config.logging, channel, "Process a HEL message");
+        lockServer(server);
         retval = processHEL(server, channel, message);
+        unlockServer(server);
         break;
     case UA_MESSAGETYPE_OPN:
+        /* The lock was taken already for extracting the OPN chunk. It is not
+         * taken recursively here. So that it can be released for the
+         * asymmetric crypto operations (see enterHandshakeSection). */
         UA_LOG_TRACE_CHANNEL(server->config.logging, channel, "Process an OPN message");
+        UA_LOCK_ASSERT(&server->serviceMutex);
         retval = processOPN(server, channel, requestId, message);
         break;
     case UA_MESSAGETYPE_MSG:
@@ -522,7 +541,9 @@ processSecureChannelMessage(UA_Server *server, UA_SecureChannel *channel,
         break;
     case UA_MESSAGETYPE_CLO:
         UA_LOG_TRACE_CHANNEL(server->config.logging, channel, "Process a CLO");
+        lockServer(server);
         Service_CloseSecureChannel(server, channel); /* Regular close */
+        unlockServer(server);
         break;
     default:
         UA_LOG_TRACE_CHANNEL(server->config.logging, channel, "Invalid message type");
@@ -530,10 +551,12 @@ processSecureChannelMessage(UA_Server *server, UA_SecureChannel *channel,
         break;
     }
     if(retval != UA_STATUSCODE_GOOD) {
+        lockServer(server);
         if(!UA_SecureChannel_isConnected(channel)) {
             UA_LOG_INFO_CHANNEL(server->config.logging, channel,
                                 "Processing the message failed. Channel already closed "
                                 "with StatusCode %s. ", UA_StatusCode_name(retval));
+            unlockServer(server);
             return retval;
         }
 
@@ -559,6 +582,7 @@ processSecureChannelMessage(UA_Server *server, UA_SecureChannel *channel,
             break;
         }
         UA_SecureChannel_shutdown(channel, reason);
+        unlockServer(server);
     }
 
     return retval;
@@ -620,6 +644,23 @@ configServerSecureChannel(void *application, UA_SecureChannel *channel,
     return UA_SecureChannel_setSecurityPolicy(channel, securityPolicy, &appInstCert);
 }
 
+/* The asymmetric crypto operations of the OPN handshake run without the
+ * service lock (if configured). Only for SecureChannels without Sessions.
+ * Otherwise responses for the Sessions could be sent in between and use up
+ * the SequenceNumbers out of order. */
+static UA_Boolean
+beginAsymmetricCrypto(void *application, UA_SecureChannel *channel) {
+    if(channel->sessions)
+        return false;
+    return enterHandshakeSection((UA_Server*)application);
+}
+
+static void
+endAsymmetricCrypto(void *application, UA_SecureChannel *channel,
+                    UA_Boolean released) {
+    leaveHandshakeSection((UA_Server*)application, released);
+}
+
 static UA_StatusCode
 createServerSecureChannel(UA_BinaryProtocolManager *bpm, UA_ConnectionManager *cm,
                           uintptr_t connectionId, UA_SecureChannel **outChannel) {
@@ -660,6 +701,8 @@ createServerSecureChannel(UA_BinaryProtocolManager *bpm, UA_ConnectionManager *c
     channel->certificateVerification = &config->secureChannelPKI;
     channel->processOPNHeader = configServerSecureChannel;
     channel->processOPNHeaderApplication = server;
+    channel->beginAsymmetricCrypto = beginAsymmetricCrypto;
+    channel->endAsymmetricCrypto = endAsymmetricCrypto;
     channel->connectionManager = cm;
     channel->connectionId = connectionId;
 
@@ -718,6 +761,85 @@ addDiscoveryUrl(UA_Server *server, const UA_String hostname, UA_UInt16 port) {
     }
 }
 
+/* Returns true if the buffer contains only (symmetric) MSG chunks. These are
+ * decrypted and decoded without the service lock. */
+static UA_Boolean
+onlyMSGChunks(const UA_SecureChannel *channel) {
+    const UA_ByteString *buf = &channel->unprocessed;
+    size_t pos = channel->unprocessedOffset;
+    while(buf->length - pos >= UA_SECURECHANNEL_MESSAGEHEADER_LENGTH) {
+        if(memcmp(&buf->data[pos], "MSG", 3) != 0)
+            return false;
+        size_t offset = pos + 4;
+        UA_UInt32 chunkSize = 0;
+        UA_UInt32_decodeBinary(buf, &offset, &chunkSize);
+        if(chunkSize < UA_SECURECHANNEL_MESSAGEHEADER_LENGTH ||
+           chunkSize > buf->length - pos)
+            break; /* Invalid or incomplete chunk */
+        pos += chunkSize;
+    }
+    return true;
+}
+
+/* Process all complete messages in the received buffer. The lock is taken if
+ * the SecureChannel is not open or the token is being renewed or the buffer
+ * contains other chunks than MSG. The asymmetric (OPN) handshake is always
+ * processed with the lock. Otherwise the lock is taken only for executing the
+ * services and sending the responses. */
+static void
+processChannelBuffer(UA_BinaryProtocolManager *bpm, UA_SecureChannel *channel,
+                     UA_ByteString msg) {
+    UA_Server *server = bpm->sc.server;
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_DateTime nowMonotonic = el->dateTime_nowMonotonic(el);
+
+    UA_StatusCode retval = UA_SecureChannel_loadBuffer(channel, msg);
+    UA_Boolean locked =
+        (retval != UA_STATUSCODE_GOOD ||
+         channel->state != UA_SECURECHANNELSTATE_OPEN ||
+         channel->renewState != UA_SECURECHANNELRENEWSTATE_NORMAL ||
+         !onlyMSGChunks(channel));
+    if(locked)
+        lockServer(server);
+
+    /* Process all complete messages */
+    while(UA_LIKELY(retval == UA_STATUSCODE_GOOD)) {
+        UA_MessageType messageType;
+        UA_UInt32 requestId = 0;
+        UA_ByteString payload = UA_BYTESTRING_NULL;
+        UA_Boolean copied = false;
+        retval = UA_SecureChannel_getCompleteMessage(channel, &messageType, &requestId,
+                                                     &payload, &copied, nowMonotonic);
+        if(retval != UA_STATUSCODE_GOOD || payload.length == 0)
+            break;
+        retval = processSecureChannelMessage(server, channel,
+                                             messageType, requestId, &payload);
+        if(copied)
+            UA_ByteString_clear(&payload);
+    }
+    retval |= UA_SecureChannel_persistBuffer(channel);
+
+    if(retval != UA_STATUSCODE_GOOD) {
+        if(!locked)
+            lockServer(server);
+        locked = true;
+
+        UA_LOG_WARNING_CHANNEL(bpm->logging, channel,
+                               "Processing the message failed with error %s",
+                               UA_StatusCode_name(retval));
+
+        /* Send an ERR message and close the connection */
+        UA_TcpErrorMessage error;
+        error.error = retval;
+        error.reason = UA_STRING_NULL;
+        UA_SecureChannel_sendError(channel, &error);
+        UA_SecureChannel_shutdown(channel, UA_SHUTDOWNREASON_ABORT);
+    }
+
+    if(locked)
+        unlockServer(server);
+}
+
 /* Callback of a TCP socket (server socket or an active connection) */
 static void
 serverNetworkCallbackLocked(UA_ConnectionManager *cm, uintptr_t connectionId,
@@ -829,39 +951,7 @@ serverNetworkCallbackLocked(UA_ConnectionManager *cm, uintptr_t connectionId,
     UA_debug_dumpCompleteChunk(server, channel->connection, message);
 #endif
 
-    UA_EventLoop *el = bpm->sc.server->config.eventLoop;
-    UA_DateTime nowMonotonic = el->dateTime_nowMonotonic(el);
-
-    /* Process all complete messages */
-    retval = UA_SecureChannel_loadBuffer(channel, msg);
-    while(UA_LIKELY(retval == UA_STATUSCODE_GOOD)) {
-        UA_MessageType messageType;
-        UA_UInt32 requestId = 0;
-        UA_ByteString payload = UA_BYTESTRING_NULL;
-        UA_Boolean copied = false;
-        retval = UA_SecureChannel_getCompleteMessage(channel, &messageType, &requestId,
-                                                     &payload, &copied, nowMonotonic);
-        if(retval != UA_STATUSCODE_GOOD || payload.length == 0)
-            break;
-        retval = processSecureChannelMessage(bpm->sc.server, channel,
-                                             messageType, requestId, &payload);
-        if(copied)
-            UA_ByteString_clear(&payload);
-    }
-    retval |= UA_SecureChannel_persistBuffer(channel);
-
-    if(retval != UA_STATUSCODE_GOOD) {
-        UA_LOG_WARNING_CHANNEL(bpm->logging, channel,
-                               "Processing the message failed with error %s",
-                               UA_StatusCode_name(retval));
-
-        /* Send an ERR message and close the connection */
-        UA_TcpErrorMessage error;
-        error.error = retval;
-        error.reason = UA_STRING_NULL;
-        UA_SecureChannel_sendError(channel, &error);
-        UA_SecureChannel_shutdown(channel, UA_SHUTDOWNREASON_ABORT);
-    }
+    processChannelBuffer(bpm, channel, msg);
 }
 
 void
@@ -871,6 +961,17 @@ serverNetworkCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
                       const UA_KeyValueMap *params,
                       UA_ByteString msg) {
     UA_BinaryProtocolManager *bpm = (UA_BinaryProtocolManager*)application;
+
+    /* Received data on an established SecureChannel. This can be called from a
+     * worker thread of the EventLoop. Take the lock only where required. */
+    UA_ServerConnection *sc = (UA_ServerConnection*)*connectionContext;
+    if(state == UA_CONNECTIONSTATE_ESTABLISHED && msg.length > 0 && sc &&
+       (sc < bpm->serverConnections ||
+        sc >= &bpm->serverConnections[UA_MAXSERVERCONNECTIONS])) {
+        processChannelBuffer(bpm, (UA_SecureChannel*)*connectionContext, msg);
+        return;
+    }
+
     lockServer(bpm->sc.server);
     serverNetworkCallbackLocked(cm, connectionId, application, connectionContext,
                                 state, params, msg);
@@ -903,8 +1004,8 @@ createServerConnection(UA_BinaryProtocolManager *bpm, const UA_String *serverUrl
             continue;
 
         /* Set up the parameters */
-        UA_KeyValuePair params[4];
-        size_t paramsSize = 3;
+        UA_KeyValuePair params[5];
+        size_t paramsSize = 4;
 
         params[0].key = UA_QUALIFIEDNAME(0, "port");
         UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
@@ -917,11 +1018,17 @@ createServerConnection(UA_BinaryProtocolManager *bpm, const UA_String *serverUrl
         params[2].key = UA_QUALIFIEDNAME(0, "reuse");
         UA_Variant_setScalar(&params[2].value, &reuseaddr, &UA_TYPES[UA_TYPES_BOOLEAN]);
 
+        /* Process the connections in the worker threads of the EventLoop (if
+         * configured) */
+        UA_Boolean workers = true;
+        params[3].key = UA_QUALIFIEDNAME(0, "workers");
+        UA_Variant_setScalar(&params[3].value, &workers, &UA_TYPES[UA_TYPES_BOOLEAN]);
+
         /* The hostname is non-empty */
         if(hostname.length > 0) {
-            params[3].key = UA_QUALIFIEDNAME(0, "address");
-            UA_Variant_setArray(&params[3].value, &hostname, 1, &UA_TYPES[UA_TYPES_STRING]);
-            paramsSize = 4;
+            params[4].key = UA_QUALIFIEDNAME(0, "address");
+            UA_Variant_setArray(&params[4].value, &hostname, 1, &UA_TYPES[UA_TYPES_STRING]);
+            paramsSize = 5;
         }
 
         UA_KeyValueMap paramsMap;
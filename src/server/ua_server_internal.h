@@ -182,12 +182,38 @@ getServerComponentByName(UA_Server *server, UA_String name);
 /* Server Structure */
 /********************/
 
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+#define UA_EVENTEMITCACHESIZE 64
+
+typedef struct {
+    UA_NodeId origin;
+    UA_UInt32 version;
+    size_t emitNodesSize; /* Zero if the entry is empty */
+    UA_ExpandedNodeId *emitNodes;
+} UA_EventEmitCacheEntry;
+#endif
+
 typedef struct session_list_entry {
     UA_DelayedCallback cleanupCallback;
     LIST_ENTRY(session_list_entry) pointers;
+    ZIP_ENTRY(session_list_entry) tokenTreeEntry;
+    ZIP_ENTRY(session_list_entry) idTreeEntry;
     UA_Session session;
 } session_list_entry;
 
+/* The sessions are indexed by their AuthenticationToken and SessionId. So the
+ * lookup for each request does not scan all sessions. */
+enum ZIP_CMP
+cmpSessionNodeId(const UA_NodeId *a, const UA_NodeId *b);
+
+typedef ZIP_HEAD(UA_SessionTokenTree, session_list_entry) UA_SessionTokenTree;
+ZIP_FUNCTIONS(UA_SessionTokenTree, session_list_entry, tokenTreeEntry,
+              UA_NodeId, session.authenticationToken, cmpSessionNodeId)
+
+typedef ZIP_HEAD(UA_SessionIdTree, session_list_entry) UA_SessionIdTree;
+ZIP_FUNCTIONS(UA_SessionIdTree, session_list_entry, idTreeEntry,
+              UA_NodeId, session.sessionId, cmpSessionNodeId)
+
 struct UA_Server {
     /* Config */
     UA_ServerConfig config;
@@ -209,6 +235,8 @@ struct UA_Server {
 
     /* Session Management */
     LIST_HEAD(session_list, session_list_entry) sessions;
+    UA_SessionTokenTree sessionsByToken;
+    UA_SessionIdTree sessionsById;
     UA_UInt32 sessionCount;
     UA_UInt32 activeSessionCount;
 
@@ -241,8 +269,25 @@ struct UA_Server {
     LIST_HEAD(, UA_Subscription) subscriptions; /* All subscriptions in the
                                                  * server. They may be detached
                                                  * from a session. */
+    UA_SubscriptionIdTree subscriptionsById;
     UA_UInt32 lastSubscriptionId; /* To generate unique SubscriptionIds */
 
+    /* Cyclic sampling of MonitoredItems, grouped by the sampling interval */
+    LIST_HEAD(, UA_SamplingGroup) samplingGroups;
+
+# ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    /* Cache for the nodes that emit the events of an origin node. The cache
+     * entries are invalidated when the version changes. That is, when a
+     * reference over which events propagate is added or removed. */
+    UA_UInt32 eventEmitVersion;
+    UA_ReferenceTypeSet eventEmitRefTypes;
+    UA_EventEmitCacheEntry eventEmitCache[UA_EVENTEMITCACHESIZE];
+
+    /* Compiled EventFilters, shared between MonitoredItems */
+    LIST_HEAD(, UA_EventFilterProgram) eventFilterPrograms;
+    UA_UInt64 eventSequence; /* Incremented for every emitted event */
+# endif
+
 # ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
     LIST_HEAD(, UA_ConditionSource) conditionSources;
     UA_NodeId refreshEvents[2];
@@ -251,6 +296,7 @@ struct UA_Server {
 
 #if UA_MULTITHREADING >= 100
     UA_Lock serviceMutex;
+    UA_Lock handshakeMutex; /* See enterHandshakeSection */
 #endif
 
     /* Statistics */
@@ -459,6 +505,55 @@ UA_Server_processServiceOperations(UA_Server *server, UA_Session *session,
 void lockServer(UA_Server *server);
 void unlockServer(UA_Server *server);
 
+/* Concurrent Reads
+ * ~~~~~~~~~~~~~~~~
+ * With UA_ServerConfig.concurrentReads the read-only services (Read, Browse,
+ * BrowseNext and TranslateBrowsePathsToNodeIds) run in a "read section"
+ * without the service lock. The nodestore has to allow concurrent readers.
+ * User-defined callbacks for the value (onRead, DataSource) and the changes to
+ * the session state (continuation points) are still done with the service lock
+ * held. The read section depth is tracked per thread for the assertions. */
+
+#if UA_MULTITHREADING >= 100
+extern UA_THREAD_LOCAL UA_UInt32 readSectionDepth;
+# define UA_READ_LOCK_ASSERT(server)                                    \
+    UA_assert(readSectionDepth > 0 || (server)->serviceMutex.count > 0)
+#else
+# define UA_READ_LOCK_ASSERT(server)
+#endif
+
+/* Release the service lock and enter the read section (and vice versa) */
+void enterReadSection(UA_Server *server);
+void leaveReadSection(UA_Server *server);
+
+/* Take the service lock if we are in a read section. Returns whether the lock
+ * needs to be released afterwards. */
+static UA_INLINE UA_Boolean
+lockServerInReadSection(UA_Server *server) {
+#if UA_MULTITHREADING >= 100
+    if(readSectionDepth > 0) {
+        lockServer(server);
+        return true;
+    }
+#endif
+    return false;
+}
+
+/* Concurrent Handshakes
+ * ~~~~~~~~~~~~~~~~~~~~~
+ * With UA_ServerConfig.concurrentHandshakes the asymmetric crypto operations
+ * of the handshake run in a "handshake section" without the service lock. The
+ * handshakeMutex is held instead. It keeps the private keys of the
+ * SecurityPolicies from being replaced (certificate update) during the
+ * operation. The lock order is serviceMutex -> handshakeMutex.
+ *
+ * Entering the section requires that the service lock is held exactly once by
+ * the current thread. Otherwise the section runs with the service lock held.
+ * Returns whether the service lock was released. */
+
+UA_Boolean enterHandshakeSection(UA_Server *server);
+void leaveHandshakeSection(UA_Server *server, UA_Boolean released);
+
 /******************************************/
 /* Internal function calls, without locks */
 /******************************************/
@@ -572,12 +667,30 @@ triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
              const UA_NodeId origin, UA_ByteString *outEventId,
              const UA_Boolean deleteEventNode);
 
+/* Triggers an event that is not represented in the information model. The
+ * fields are looked up by their BrowseName in the key/value map. The
+ * BrowseNames of nested fields are joined with a slash. */
+UA_StatusCode
+triggerTransientEvent(UA_Server *server, const UA_NodeId eventType,
+                      const UA_NodeId origin, const UA_KeyValueMap *eventFields,
+                      UA_ByteString *outEventId);
+
+/* The event emit cache is invalidated if references of the given type are
+ * added or removed */
+void
+invalidateEventEmitCache(UA_Server *server, UA_Byte refTypeIndex);
+
+void
+clearEventEmitCache(UA_Server *server);
+
 /* Filters the given event with the given filter and writes the results into a
- * notification */
+ * notification. The event is either a node (eventNode) or a transient event
+ * (eventFields with eventNode == NULL). The filter is compiled for a single
+ * use. MonitoredItems use their precompiled UA_EventFilterProgram instead. */
 UA_StatusCode
 filterEvent(UA_Server *server, UA_Session *session,
-            const UA_NodeId *eventNode, UA_EventFilter *filter,
-            UA_EventFieldList *efl, UA_EventFilterResult *result);
+            const UA_NodeId *eventNode, const UA_KeyValueMap *eventFields,
+            const UA_EventFilter *filter, UA_EventFieldList *efl);
 
 #endif /* UA_ENABLE_SUBSCRIPTIONS_EVENTS */
 
@@ -701,6 +814,11 @@ UA_StatusCode
 readValueAttribute(UA_Server *server, UA_Session *session,
                    const UA_VariableNode *vn, UA_DataValue *v);
 
+/* The UserAccessLevel of the Session masked with the AccessLevel of the node */
+UA_Byte
+getUserAccessLevel(UA_Server *server, const UA_Session *session,
+                   const UA_VariableNode *node);
+
 /* Test whether the value matches a variable definition given by
  * - datatype
  * - valuerank
@@ -899,6 +1017,10 @@ UA_NODESTORE_GETFROMREF(UA_Server *server, UA_NodePointer target) {
     server->config.nodestore.getNodeFromPtr(server->config.nodestore.context,      \
                                             target, attrMask, refs, refDirs)
 
+#define UA_NODESTORE_GETEDITFROMREF_SELECTIVE(server, target, attrMask, refs, refDirs) \
+    server->config.nodestore.getEditNodeFromPtr(server->config.nodestore.context,      \
+                                                target, attrMask, refs, refDirs)
+
 #define UA_NODESTORE_RELEASE(server, node)                              \
     server->config.nodestore.releaseNode(server->config.nodestore.context, node)
 
@@ -1158,7 +1158,11 @@ applyChangesToServer(UA_Server *server) {
             if(!UA_NodeId_equal(&sp->certificateTypeId, &certTypeId))
                 continue;
 
+            /* Wait for the handshakes that use the private key outside of
+             * the service lock */
+            UA_LOCK(&server->handshakeMutex);
             retval = sp->updateCertificateAndPrivateKey(sp, certificate, privateKey);
+            UA_UNLOCK(&server->handshakeMutex);
             if(retval != UA_STATUSCODE_GOOD)
                 goto cleanup;
 
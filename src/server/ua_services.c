@@ -172,6 +172,18 @@ getServiceDescription(UA_UInt32 requestTypeId) {
 static const UA_String securityPolicyNone =
     UA_STRING_STATIC("http://opcfoundation.org/UA/SecurityPolicy#None");
 
+#if UA_MULTITHREADING >= 100
+/* Services that only read from the nodestore. They can run without the service
+ * lock if UA_ServerConfig.concurrentReads is enabled. */
+static UA_Boolean
+isReadOnlyService(const UA_ServiceDescription *sd) {
+    return (sd->requestType == &UA_TYPES[UA_TYPES_READREQUEST] ||
+            sd->requestType == &UA_TYPES[UA_TYPES_BROWSEREQUEST] ||
+            sd->requestType == &UA_TYPES[UA_TYPES_BROWSENEXTREQUEST] ||
+            sd->requestType == &UA_TYPES[UA_TYPES_TRANSLATEBROWSEPATHSTONODEIDSREQUEST]);
+}
+#endif
+
 static UA_Boolean
 processServiceInternal(UA_Server *server, UA_SecureChannel *channel, UA_Session *session,
                        UA_UInt32 requestId, UA_ServiceDescription *sd,
@@ -272,6 +284,16 @@ processServiceInternal(UA_Server *server, UA_SecureChannel *channel, UA_Session
     }
 #endif
 
+    /* Execute the read-only services without the service lock */
+#if UA_MULTITHREADING >= 100
+    if(server->config.concurrentReads && isReadOnlyService(sd)) {
+        enterReadSection(server);
+        sd->serviceCallback(server, session, request, response);
+        leaveReadSection(server);
+        return false;
+    }
+#endif
+
     /* Execute the synchronous service call */
     sd->serviceCallback(server, session, request, response);
     return false;
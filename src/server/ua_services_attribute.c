@@ -74,7 +74,7 @@ attributeId2AttributeMask(UA_AttributeId id) {
 static UA_UInt32
 getUserWriteMask(UA_Server *server, const UA_Session *session,
                  const UA_NodeHead *head) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_READ_LOCK_ASSERT(server);
     if(session == &server->adminSession)
         return 0xFFFFFFFF; /* the local admin user has all rights */
     return head->writeMask & server->config.accessControl.
@@ -84,10 +84,10 @@ getUserWriteMask(UA_Server *server, const UA_Session *session,
                           &head->nodeId, head->context);
 }
 
-static UA_Byte
+UA_Byte
 getUserAccessLevel(UA_Server *server, const UA_Session *session,
                    const UA_VariableNode *node) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_READ_LOCK_ASSERT(server);
     if(session == &server->adminSession)
         return 0xFF; /* the local admin user has all rights */
     return node->accessLevel & server->config.accessControl.
@@ -100,7 +100,7 @@ getUserAccessLevel(UA_Server *server, const UA_Session *session,
 static UA_Boolean
 getUserExecutable(UA_Server *server, const UA_Session *session,
                   const UA_MethodNode *node) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_READ_LOCK_ASSERT(server);
     if(session == &server->adminSession)
         return true; /* the local admin user has all rights */
     return node->executable & server->config.accessControl.
@@ -141,7 +141,7 @@ static UA_StatusCode
 readInternalValueAttribute(UA_Server *server, UA_Session *session,
                            const UA_VariableNode *vn, UA_DataValue *v,
                            UA_NumericRange *rangeptr) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_READ_LOCK_ASSERT(server);
 
     /* Update the value by the user callback */
     if(vn->valueSource.internal.notifications.onRead) {
@@ -235,7 +235,12 @@ readValueAttributeComplete(UA_Server *server, UA_Session *session,
         rangeptr = &range;
     }
 
-    /* Read from the value souce */
+    /* Read from the value souce. User-defined callbacks are executed with the
+     * service lock also in a read section. */
+    UA_Boolean locked = false;
+    if(vn->valueSourceType != UA_VALUESOURCETYPE_INTERNAL ||
+       vn->valueSource.internal.notifications.onRead)
+        locked = lockServerInReadSection(server);
     switch(vn->valueSourceType) {
     case UA_VALUESOURCETYPE_INTERNAL:
         retval = readInternalValueAttribute(server, session, vn, v, rangeptr);
@@ -250,6 +255,8 @@ readValueAttributeComplete(UA_Server *server, UA_Session *session,
         retval = UA_STATUSCODE_BADINTERNALERROR;
         break;
     }
+    if(locked)
+        unlockServer(server);
 
     /* If not defined return a source timestamp of "now".
      * Static nodes always have the current time as source-time. */
@@ -282,25 +289,6 @@ static const UA_String jsonEncoding = {sizeof("Default JSON")-1, (UA_Byte*)"Defa
     }
 
 #ifdef UA_ENABLE_TYPEDESCRIPTION
-static const UA_DataType *
-findDataType(const UA_Node *node, const UA_DataTypeArray *customTypes) {
-    for(size_t i = 0; i < UA_TYPES_COUNT; ++i) {
-        if(UA_NodeId_equal(&UA_TYPES[i].typeId, &node->head.nodeId)) {
-            return &UA_TYPES[i];
-        }
-    }
-
-    // lookup custom type
-    while(customTypes) {
-        for(size_t i = 0; i < customTypes->typesSize; ++i) {
-            if(UA_NodeId_equal(&customTypes->types[i].typeId, &node->head.nodeId))
-                return &customTypes->types[i];
-        }
-        customTypes = customTypes->next;
-    }
-    return NULL;
-}
-
 static UA_StatusCode
 getStructureDefinition(const UA_DataType *type, UA_StructureDefinition *def) {
     UA_StatusCode retval =
@@ -528,7 +516,7 @@ ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
 
 #ifdef UA_ENABLE_TYPEDESCRIPTION
         const UA_DataType *type =
-            findDataType(node, server->config.customDataTypes);
+            UA_findDataTypeWithCustom(&node->head.nodeId, server->config.customDataTypes);
         if(!type) {
             retval = UA_STATUSCODE_BADATTRIBUTEIDINVALID;
             break;
@@ -592,12 +580,20 @@ ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
 void
 Operation_Read(UA_Server *server, UA_Session *session, UA_TimestampsToReturn *ttr,
                const UA_ReadValueId *rvi, UA_DataValue *dv) {
-    /* Get the node (with only the selected attribute if the NodeStore supports that) */
-    const UA_Node *node =
-        UA_NODESTORE_GET_SELECTIVE(server, &rvi->nodeId,
-                                   attributeId2AttributeMask((UA_AttributeId)rvi->attributeId),
-                                   UA_REFERENCETYPESET_NONE,
-                                   UA_BROWSEDIRECTION_INVALID);
+    /* Get the node (with only the selected attribute if the NodeStore supports
+     * that). Registered nodes are accessed via the pinned node pointer. */
+    const UA_Node *node;
+    UA_UInt32 attrMask = attributeId2AttributeMask((UA_AttributeId)rvi->attributeId);
+    const UA_RegisteredNode *rn = UA_Session_getRegisteredNode(session, &rvi->nodeId);
+    if(rn)
+        node = UA_NODESTORE_GETFROMREF_SELECTIVE(server,
+                                                 UA_NodePointer_fromNode(&rn->node->head),
+                                                 attrMask, UA_REFERENCETYPESET_NONE,
+                                                 UA_BROWSEDIRECTION_INVALID);
+    else
+        node = UA_NODESTORE_GET_SELECTIVE(server, &rvi->nodeId, attrMask,
+                                          UA_REFERENCETYPESET_NONE,
+                                          UA_BROWSEDIRECTION_INVALID);
     if(!node) {
         dv->hasStatus = true;
         dv->status = UA_STATUSCODE_BADNODEIDUNKNOWN;
@@ -613,7 +609,7 @@ void
 Service_Read(UA_Server *server, UA_Session *session,
              const UA_ReadRequest *request, UA_ReadResponse *response) {
     UA_LOG_DEBUG_SESSION(server->config.logging, session, "Processing ReadRequest");
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_READ_LOCK_ASSERT(server);
 
     /* Check if the timestampstoreturn is valid */
     if(request->timestampsToReturn > UA_TIMESTAMPSTORETURN_NEITHER) {
@@ -634,7 +630,7 @@ Service_Read(UA_Server *server, UA_Session *session,
         return;
     }
 
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_READ_LOCK_ASSERT(server);
 
     response->responseHeader.serviceResult =
         UA_Server_processServiceOperations(server, session,
@@ -650,7 +646,7 @@ UA_DataValue
 readWithSession(UA_Server *server, UA_Session *session,
                 const UA_ReadValueId *item,
                 UA_TimestampsToReturn timestampsToReturn) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_READ_LOCK_ASSERT(server);
 
     UA_DataValue dv;
     UA_DataValue_init(&dv);
@@ -707,6 +703,14 @@ readWithReadValue(UA_Server *server, const UA_NodeId *nodeId,
 UA_DataValue
 UA_Server_read(UA_Server *server, const UA_ReadValueId *item,
                UA_TimestampsToReturn timestamps) {
+#if UA_MULTITHREADING >= 100
+    if(server->config.concurrentReads) {
+        readSectionDepth++;
+        UA_DataValue dv = readWithSession(server, &server->adminSession, item, timestamps);
+        readSectionDepth--;
+        return dv;
+    }
+#endif
     lockServer(server);
     UA_DataValue dv = readWithSession(server, &server->adminSession, item, timestamps);
     unlockServer(server);
@@ -1843,6 +1847,24 @@ void
 Operation_Write(UA_Server *server, UA_Session *session, void *context,
                 const UA_WriteValue *wv, UA_StatusCode *result) {
     UA_assert(session != NULL);
+
+    /* Write to a registered node via the pinned node pointer */
+    const UA_RegisteredNode *rn = UA_Session_getRegisteredNode(session, &wv->nodeId);
+    if(rn) {
+        UA_Node *node =
+            UA_NODESTORE_GETEDITFROMREF_SELECTIVE(server,
+                                                  UA_NodePointer_fromNode(&rn->node->head),
+                                                  wv->attributeId, UA_REFERENCETYPESET_NONE,
+                                                  UA_BROWSEDIRECTION_INVALID);
+        if(!node) {
+            *result = UA_STATUSCODE_BADNODEIDUNKNOWN;
+            return;
+        }
+        *result = copyAttributeIntoNode(server, session, node, wv);
+        UA_NODESTORE_RELEASE(server, node);
+        return;
+    }
+
     *result = UA_Server_editNode(server, session, &wv->nodeId, wv->attributeId,
                                  UA_REFERENCETYPESET_NONE, UA_BROWSEDIRECTION_INVALID,
                                  (UA_EditNodeCallback)copyAttributeIntoNode,
@@ -355,6 +355,17 @@ Operation_CreateMonitoredItem(UA_Server *server, UA_Session *session,
                               UA_MonitoredItemCreateResult *result) {
     UA_LOCK_ASSERT(&server->serviceMutex);
 
+    /* The alias of a registered node is only valid within the session. The
+     * MonitoredItem uses the original NodeId. */
+    UA_MonitoredItemCreateRequest registeredRequest;
+    const UA_RegisteredNode *rn =
+        UA_Session_getRegisteredNode(session, &request->itemToMonitor.nodeId);
+    if(rn) {
+        registeredRequest = *request;
+        registeredRequest.itemToMonitor.nodeId = rn->nodeId;
+        request = &registeredRequest;
+    }
+
     /* Check available capacity */
     if(!cmc->localMon &&
        (((server->config.maxMonitoredItems != 0) &&
@@ -462,6 +473,15 @@ Operation_CreateMonitoredItem(UA_Server *server, UA_Session *session,
                                                          valueType, &newMon->parameters,
                                                          &result->filterResult);
 
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    /* Compile the EventFilter. MonitoredItems with identical filters share the
+     * program. */
+    if(result->statusCode == UA_STATUSCODE_GOOD &&
+       newMon->itemToMonitor.attributeId == UA_ATTRIBUTEID_EVENTNOTIFIER)
+        result->statusCode = UA_EventFilterProgram_acquire(server, (const UA_EventFilter*)
+            newMon->parameters.filter.content.decoded.data, &newMon->eventFilter);
+#endif
+
     if(result->statusCode != UA_STATUSCODE_GOOD) {
         UA_LOG_INFO_SUBSCRIPTION(server->config.logging, cmc->sub,
                                  "Could not create a MonitoredItem "
@@ -726,15 +746,37 @@ Operation_ModifyMonitoredItem(UA_Server *server, UA_Session *session, UA_Subscri
         return;
     }
 
-    /* Store the old sampling interval */
-    UA_Double oldSamplingInterval = mon->parameters.samplingInterval;
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    /* Compile the new EventFilter before releasing the old program */
+    if(mon->itemToMonitor.attributeId == UA_ATTRIBUTEID_EVENTNOTIFIER) {
+        UA_EventFilterProgram *program = NULL;
+        result->statusCode = UA_EventFilterProgram_acquire(server, (const UA_EventFilter*)
+            params.filter.content.decoded.data, &program);
+        if(result->statusCode != UA_STATUSCODE_GOOD) {
+            UA_MonitoringParameters_clear(&params);
+            return;
+        }
+        UA_EventFilterProgram_release(server, mon->eventFilter);
+        mon->eventFilter = program;
+    }
+#endif
+
+    /* Re-register the sampling if the interval changes. Cyclic MonitoredItems
+     * share samples with identically configured MonitoredItems. So they also
+     * re-register when the filter changes. */
+    UA_Boolean reregister =
+        (mon->parameters.samplingInterval != params.samplingInterval);
+    if(mon->samplingType == UA_MONITOREDITEMSAMPLINGTYPE_CYCLIC &&
+       !UA_equal(&mon->parameters.filter, &params.filter,
+                 &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]))
+        reregister = true;
 
     /* Move over the new settings */
     UA_MonitoringParameters_clear(&mon->parameters);
     mon->parameters = params;
 
     /* Re-register the callback if necessary */
-    if(oldSamplingInterval != mon->parameters.samplingInterval) {
+    if(reregister) {
         UA_MonitoredItem_unregisterSampling(server, mon);
         result->statusCode =
             UA_MonitoredItem_setMonitoringMode(server, mon, mon->monitoringMode);
@@ -2269,6 +2269,10 @@ Operation_addReference(UA_Server *server, UA_Session *session, void *context,
     if(targetNode)
         UA_NODESTORE_RELEASE(server, targetNode);
     UA_NODESTORE_RELEASE(server, sourceNode);
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    if(*retval == UA_STATUSCODE_GOOD)
+        invalidateEventEmitCache(server, refTypeIndex);
+#endif
 }
 
 void
@@ -2369,6 +2373,10 @@ Operation_deleteReference(UA_Server *server, UA_Session *session, void *context,
     if(*retval != UA_STATUSCODE_GOOD)
         return;
 
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    invalidateEventEmitCache(server, refTypeIndex);
+#endif
+
     if(!item->deleteBidirectional || item->targetNodeId.serverIndex != 0)
         return;
 
@@ -46,6 +46,9 @@ UA_Server_removeSession(UA_Server *server, session_list_entry *sentry,
     }
 #endif
 
+    /* Release the pinned nodes */
+    UA_Session_unregisterAllNodes(server, session);
+
     /* Callback into userland access control */
     if(server->config.accessControl.closeSession) {
         server->config.accessControl.
@@ -65,6 +68,8 @@ UA_Server_removeSession(UA_Server *server, session_list_entry *sentry,
     /* Detach the session from the session manager and make the capacity
      * available */
     LIST_REMOVE(sentry, pointers);
+    ZIP_REMOVE(UA_SessionTokenTree, &server->sessionsByToken, sentry);
+    ZIP_REMOVE(UA_SessionIdTree, &server->sessionsById, sentry);
     server->sessionCount--;
 
     switch(shutdownReason) {
@@ -101,14 +106,12 @@ UA_StatusCode
 UA_Server_removeSessionByToken(UA_Server *server, const UA_NodeId *token,
                                UA_ShutdownReason shutdownReason) {
     UA_LOCK_ASSERT(&server->serviceMutex);
-    session_list_entry *entry;
-    LIST_FOREACH(entry, &server->sessions, pointers) {
-        if(UA_NodeId_equal(&entry->session.authenticationToken, token)) {
-            UA_Server_removeSession(server, entry, shutdownReason);
-            return UA_STATUSCODE_GOOD;
-        }
-    }
-    return UA_STATUSCODE_BADSESSIONIDINVALID;
+    session_list_entry *entry =
+        ZIP_FIND(UA_SessionTokenTree, &server->sessionsByToken, token);
+    if(!entry)
+        return UA_STATUSCODE_BADSESSIONIDINVALID;
+    UA_Server_removeSession(server, entry, shutdownReason);
+    return UA_STATUSCODE_GOOD;
 }
 
 void
@@ -129,52 +132,39 @@ UA_Server_cleanupSessions(UA_Server *server, UA_DateTime nowMonotonic) {
 /* Services */
 /************/
 
-UA_Session *
-getSessionByToken(UA_Server *server, const UA_NodeId *token) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
-
-    session_list_entry *current = NULL;
-    LIST_FOREACH(current, &server->sessions, pointers) {
-        /* Token does not match */
-        if(!UA_NodeId_equal(&current->session.authenticationToken, token))
-            continue;
-
-        /* Session has timed out */
-        UA_EventLoop *el = server->config.eventLoop;
-        UA_DateTime now = el->dateTime_nowMonotonic(el);
-        if(now > current->session.validTill) {
-            UA_LOG_INFO_SESSION(server->config.logging, &current->session,
-                                "Client tries to use a session that has timed out");
-            return NULL;
-        }
+enum ZIP_CMP
+cmpSessionNodeId(const UA_NodeId *a, const UA_NodeId *b) {
+    return (enum ZIP_CMP)UA_NodeId_order(a, b);
+}
 
-        return &current->session;
+/* Returns NULL if the session has timed out */
+static UA_Session *
+checkSessionTimeout(UA_Server *server, session_list_entry *entry) {
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_DateTime now = el->dateTime_nowMonotonic(el);
+    if(now > entry->session.validTill) {
+        UA_LOG_INFO_SESSION(server->config.logging, &entry->session,
+                            "Client tries to use a session that has timed out");
+        return NULL;
     }
+    return &entry->session;
+}
 
-    return NULL;
+UA_Session *
+getSessionByToken(UA_Server *server, const UA_NodeId *token) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+    session_list_entry *entry =
+        ZIP_FIND(UA_SessionTokenTree, &server->sessionsByToken, token);
+    return (entry) ? checkSessionTimeout(server, entry) : NULL;
 }
 
 UA_Session *
 getSessionById(UA_Server *server, const UA_NodeId *sessionId) {
     UA_LOCK_ASSERT(&server->serviceMutex);
-
-    session_list_entry *current = NULL;
-    LIST_FOREACH(current, &server->sessions, pointers) {
-        /* Token does not match */
-        if(!UA_NodeId_equal(&current->session.sessionId, sessionId))
-            continue;
-
-        /* Session has timed out */
-        UA_EventLoop *el = server->config.eventLoop;
-        UA_DateTime now = el->dateTime_nowMonotonic(el);
-        if(now > current->session.validTill) {
-            UA_LOG_INFO_SESSION(server->config.logging, &current->session,
-                                "Client tries to use a session that has timed out");
-            return NULL;
-        }
-
-        return &current->session;
-    }
+    session_list_entry *entry =
+        ZIP_FIND(UA_SessionIdTree, &server->sessionsById, sessionId);
+    if(entry)
+        return checkSessionTimeout(server, entry);
 
     if(UA_NodeId_equal(sessionId, &server->adminSession.sessionId))
         return &server->adminSession;
@@ -261,6 +251,8 @@ UA_Server_createSession(UA_Server *server, UA_SecureChannel *channel,
 
     /* Add to the server */
     LIST_INSERT_HEAD(&server->sessions, newentry, pointers);
+    ZIP_INSERT(UA_SessionTokenTree, &server->sessionsByToken, newentry);
+    ZIP_INSERT(UA_SessionIdTree, &server->sessionsById, newentry);
     server->sessionCount++;
 
     *session = &newentry->session;
@@ -317,6 +309,20 @@ Service_CreateSession(UA_Server *server, UA_SecureChannel *channel,
         }
     }
 
+    /* Sign the client certificate and nonce. This is done before the Session
+     * is created. So that the signing can run without the service lock (see
+     * enterHandshakeSection). */
+    UA_Boolean released = enterHandshakeSection(server);
+    response->responseHeader.serviceResult =
+       signCreateSessionResponse(server, channel, request, response);
+    leaveHandshakeSection(server, released);
+    if(response->responseHeader.serviceResult != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING_CHANNEL(server->config.logging, channel,
+                               "Could not sign the CreateSessionResponse");
+        server->serverDiagnosticsSummary.rejectedSessionCount++;
+        return;
+    }
+
     /* Create the Session */
     UA_Session *newSession = NULL;
     response->responseHeader.serviceResult =
@@ -378,10 +384,6 @@ Service_CreateSession(UA_Server *server, UA_SecureChannel *channel,
         response->responseHeader.serviceResult |=
             UA_ByteString_copy(&sp->localCertificate, &response->serverCertificate);
 
-    /* Sign the signature */
-    response->responseHeader.serviceResult |=
-       signCreateSessionResponse(server, channel, request, response);
-
     /* Failure -> remove the session */
     if(response->responseHeader.serviceResult != UA_STATUSCODE_GOOD) {
         UA_Server_removeSessionByToken(server, &newSession->authenticationToken,
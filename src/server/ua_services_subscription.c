@@ -84,6 +84,7 @@ Service_CreateSubscription(UA_Server *server, UA_Session *session,
 
     /* Register the subscription in the server */
     LIST_INSERT_HEAD(&server->subscriptions, sub, serverListEntry);
+    ZIP_INSERT(UA_SubscriptionIdTree, &server->subscriptionsById, sub);
     server->subscriptionsSize++;
 
     /* Update the server statistics */
@@ -564,6 +565,7 @@ Operation_TransferSubscription(UA_Server *server, UA_Session *session,
     /* Add to the server */
     UA_assert(newSub->subscriptionId == sub->subscriptionId);
     LIST_INSERT_HEAD(&server->subscriptions, newSub, serverListEntry);
+    ZIP_INSERT(UA_SubscriptionIdTree, &server->subscriptionsById, newSub);
     server->subscriptionsSize++;
 
     /* Attach to the session */
@@ -509,6 +509,10 @@ struct ContinuationPoint {
     UA_NodePointer lastTarget;
     UA_Byte lastRefKindIndex;
     UA_Boolean lastRefInverse;
+
+    /* Position of the last target if the references are stored in an array.
+     * Used to resume without a search if the array was not modified. */
+    size_t lastTargetIndex;
 };
 
 ContinuationPoint *
@@ -641,6 +645,8 @@ browseReferencTargetCallback(void *context, UA_ReferenceTarget *t) {
     cp->lastTarget = t->targetId;
     cp->lastRefKindIndex = bc->rk->referenceTypeIndex;
     cp->lastRefInverse = bc->rk->isInverse;
+    if(!bc->rk->hasRefTree)
+        cp->lastTargetIndex = (size_t)(t - bc->rk->targets.array);
 
     /* Abort if the status is not good. Also doesn't make a deep-copy of
      * cp->lastTarget after returning from here. */
@@ -651,6 +657,31 @@ browseReferencTargetCallback(void *context, UA_ReferenceTarget *t) {
     return NULL;
 }
 
+/* In-order iteration over the targets that are larger than the key. Skips the
+ * smaller subtrees in O(log n) without modifying the tree. */
+static void *
+iterateTreeAfter(UA_ReferenceTargetTreeElem *elem,
+                 const UA_ReferenceTargetTreeElem *key,
+                 struct BrowseContext *bc) {
+    while(elem) {
+        if(cmpRefTargetId(key, elem) != ZIP_CMP_LESS) {
+            /* The element and its left subtree are <= key */
+            elem = ZIP_RIGHT(elem, idTreeEntry);
+            continue;
+        }
+        void *res = iterateTreeAfter(ZIP_LEFT(elem, idTreeEntry), key, bc);
+        if(res)
+            return res;
+        res = browseReferencTargetCallback(bc, &elem->target);
+        if(res)
+            return res;
+        UA_ReferenceIdTree right = {ZIP_RIGHT(elem, idTreeEntry)};
+        return ZIP_ITER(UA_ReferenceIdTree, &right,
+                        (UA_ReferenceIdTree_cb)browseReferencTargetCallback, bc);
+    }
+    return NULL;
+}
+
 /* Returns whether the node / continuationpoint is done */
 static void
 browseWithNode(struct BrowseContext *bc, const UA_NodeHead *head ) {
@@ -679,63 +710,53 @@ browseWithNode(struct BrowseContext *bc, const UA_NodeHead *head ) {
             continue;
 
         /* We have a matching ReferenceKind */
-
-        /* Skip ahead to the target where the last continuation point stopped.
-         * This temporarily modifies rk. */
-        UA_ReferenceIdTree left = {NULL}, right = {NULL};
-        size_t nextTargetIndex = 0;
-        if(bc->activeCP) {
+        bc->rk = rk;
+        void *res;
+        if(!bc->activeCP) {
+            /* Iterate over all reference targets */
+            res = UA_NodeReferenceKind_iterate(rk, browseReferencTargetCallback, bc);
+        } else {
+            /* Skip ahead to the target where the last continuation point
+             * stopped. The node is not modified for this. It might be
+             * shared with concurrent readers. Take over the last target
+             * before it gets overwritten in the following browse steps. */
+            UA_NodePointer lastTarget = cp->lastTarget;
+            UA_NodePointer_init(&cp->lastTarget);
+            bc->activeCP = false;
             if(rk->hasRefTree) {
-                /* Unzip the tree until the continuation point. All NodeIds
-                 * larger than the last target are guaranteed to sit on the
-                 * right-hand side. */
-                UA_ExpandedNodeId lastEn =
-                    UA_NodePointer_toExpandedNodeId(cp->lastTarget);
+                /* All NodeIds larger than the last target come afterwards in
+                 * the in-order traversal */
+                UA_ExpandedNodeId lastEn = UA_NodePointer_toExpandedNodeId(lastTarget);
                 UA_ReferenceTargetTreeElem key;
-                key.target.targetId = cp->lastTarget;
+                key.target.targetId = lastTarget;
                 key.targetIdHash = UA_ExpandedNodeId_hash(&lastEn);
-                ZIP_UNZIP(UA_ReferenceIdTree,
-                          (UA_ReferenceIdTree*)&rk->targets.tree.idRoot,
-                          &key, &left, &right);
-                rk->targets.tree.idRoot = right.root;
+                res = iterateTreeAfter(rk->targets.tree.idRoot, &key, bc);
             } else {
-                /* Iterate over the array to find the match */
+                /* Resume after the last position if the last target is still
+                 * there. Otherwise search the array for the last target. If
+                 * it was removed, its position was filled with the last
+                 * element of the array. Then continue at the same position. */
+                size_t nextTargetIndex = cp->lastTargetIndex;
+                if(nextTargetIndex < rk->targetsSize &&
+                   UA_NodePointer_equal(lastTarget,
+                                        rk->targets.array[nextTargetIndex].targetId)) {
+                    nextTargetIndex++;
+                } else {
+                    for(size_t j = 0; j < rk->targetsSize; j++) {
+                        if(UA_NodePointer_equal(lastTarget, rk->targets.array[j].targetId)) {
+                            nextTargetIndex = j + 1;
+                            break;
+                        }
+                    }
+                }
+                res = NULL;
                 for(; nextTargetIndex < rk->targetsSize; nextTargetIndex++) {
-                    UA_ReferenceTarget *t = &rk->targets.array[nextTargetIndex];
-                    if(UA_NodePointer_equal(cp->lastTarget, t->targetId))
+                    res = browseReferencTargetCallback(bc, &rk->targets.array[nextTargetIndex]);
+                    if(res)
                         break;
                 }
-                if(nextTargetIndex == rk->targetsSize) {
-                    /* Not found - assume that this reference kind is done */
-                    bc->activeCP = false;
-                    continue;
-                }
-                nextTargetIndex++; /* From the last index to the next index */
-                rk->targets.array = &rk->targets.array[nextTargetIndex];
-                rk->targetsSize -= nextTargetIndex;
             }
-
-            /* Clear cp->lastTarget before it gets overwritten in the following
-             * browse steps. */
-            UA_NodePointer_clear(&cp->lastTarget);
-        }
-
-        /* Iterate over all reference targets */
-        bc->rk = rk;
-        void *res = UA_NodeReferenceKind_iterate(rk, browseReferencTargetCallback, bc);
-
-        /* Undo the "skipping ahead" for the continuation point */
-        if(bc->activeCP) {
-            if(rk->hasRefTree) {
-                rk->targets.tree.idRoot =
-                    ZIP_ZIP(UA_ReferenceIdTree, left.root, right.root);
-            } else {
-                /* rk->targets.array = rk->targets.array[-nextTargetIndex]; */
-                rk->targets.array = rk->targets.array - nextTargetIndex;
-                rk->targetsSize += nextTargetIndex;
-                UA_assert(rk->targetsSize > 0);
-            }
-            bc->activeCP = false;
+            UA_NodePointer_clear(&lastTarget);
         }
 
         /* The iteration was aborted */
@@ -784,7 +805,7 @@ browse(struct BrowseContext *bc) {
 
     /* Check AccessControl rights */
     if(bc->session != &bc->server->adminSession) {
-        UA_LOCK_ASSERT(&bc->server->serviceMutex);
+        UA_READ_LOCK_ASSERT(bc->server);
         if(!bc->server->config.accessControl.
            allowBrowseNode(bc->server, &bc->server->config.accessControl,
                            &bc->session->sessionId, bc->session->context,
@@ -899,12 +920,6 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
     UA_Guid *ident = NULL;
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
 
-    /* Enough space for the continuation point? */
-    if(session->availableContinuationPoints == 0) {
-        retval = UA_STATUSCODE_BADNOCONTINUATIONPOINTS;
-        goto cleanup;
-    }
-
     /* Allocate and fill the data structure */
     cp2 = (ContinuationPoint*)UA_calloc(1, sizeof(ContinuationPoint));
     if(!cp2) {
@@ -922,6 +937,7 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
     UA_NodePointer_init(&cp.lastTarget); /* No longer clear below (cleanup) */
     cp2->lastRefKindIndex = cp.lastRefKindIndex;
     cp2->lastRefInverse = cp.lastRefInverse;
+    cp2->lastTargetIndex = cp.lastTargetIndex;
 
     /* Create a random bytestring via a Guid */
     ident = UA_Guid_new();
@@ -929,19 +945,34 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
         retval = UA_STATUSCODE_BADOUTOFMEMORY;
         goto cleanup;
     }
-    *ident = UA_Guid_random();
     cp2->identifier.data = (UA_Byte*)ident;
     cp2->identifier.length = sizeof(UA_Guid);
 
-    /* Return the cp identifier */
-    retval = UA_ByteString_copy(&cp2->identifier, &result->continuationPoint);
+    /* Allocate the cp identifier for the result */
+    retval = UA_ByteString_allocBuffer(&result->continuationPoint, sizeof(UA_Guid));
     if(retval != UA_STATUSCODE_GOOD)
         goto cleanup;
 
-    /* Attach the cp to the session */
+    /* The session and the random number generator are accessed with the
+     * service lock (also in a read section) */
+    UA_Boolean locked = lockServerInReadSection(server);
+
+    /* Enough space for the continuation point? */
+    if(session->availableContinuationPoints == 0) {
+        if(locked)
+            unlockServer(server);
+        retval = UA_STATUSCODE_BADNOCONTINUATIONPOINTS;
+        goto cleanup;
+    }
+
+    /* Return the cp identifier and attach the cp to the session */
+    *ident = UA_Guid_random();
+    memcpy(result->continuationPoint.data, ident, sizeof(UA_Guid));
     cp2->next = session->continuationPoints;
     session->continuationPoints = cp2;
     --session->availableContinuationPoints;
+    if(locked)
+        unlockServer(server);
     return;
 
  cleanup:
@@ -957,7 +988,7 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
 void Service_Browse(UA_Server *server, UA_Session *session,
                     const UA_BrowseRequest *request, UA_BrowseResponse *response) {
     UA_LOG_DEBUG_SESSION(server->config.logging, session, "Processing BrowseRequest");
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_READ_LOCK_ASSERT(server);
 
     /* Test the number of operations in the request */
     if(server->config.maxNodesPerBrowse != 0 &&
@@ -987,6 +1018,14 @@ UA_Server_browse(UA_Server *server, UA_UInt32 maxReferences,
                  const UA_BrowseDescription *bd) {
     UA_BrowseResult result;
     UA_BrowseResult_init(&result);
+#if UA_MULTITHREADING >= 100
+    if(server->config.concurrentReads) {
+        readSectionDepth++;
+        Operation_Browse(server, &server->adminSession, &maxReferences, bd, &result);
+        readSectionDepth--;
+        return result;
+    }
+#endif
     lockServer(server);
     Operation_Browse(server, &server->adminSession, &maxReferences, bd, &result);
     unlockServer(server);
@@ -997,7 +1036,10 @@ static void
 Operation_BrowseNext(UA_Server *server, UA_Session *session,
                      const UA_Boolean *releaseContinuationPoints,
                      const UA_ByteString *continuationPoint, UA_BrowseResult *result) {
-    /* Find the continuation point */
+    /* Find the continuation point and detach it from the session while we
+     * browse. The list of continuation points is modified only with the service
+     * lock held (also in a read section). */
+    UA_Boolean locked = lockServerInReadSection(server);
     ContinuationPoint **prev = &session->continuationPoints;
     ContinuationPoint *cp;
     while((cp = *prev)) {
@@ -1006,17 +1048,25 @@ Operation_BrowseNext(UA_Server *server, UA_Session *session,
         prev = &cp->next;
     }
     if(!cp) {
+        if(locked)
+            unlockServer(server);
         result->statusCode = UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
         return;
     }
+    *prev = cp->next;
+    cp->next = NULL;
 
     /* Remove the cp */
     if(*releaseContinuationPoints) {
-        *prev = ContinuationPoint_clear(cp);
-        UA_free(cp);
         ++session->availableContinuationPoints;
+        if(locked)
+            unlockServer(server);
+        ContinuationPoint_clear(cp);
+        UA_free(cp);
         return;
     }
+    if(locked)
+        unlockServer(server);
 
     /* Prepare the context */
     struct BrowseContext bc;
@@ -1036,7 +1086,7 @@ Operation_BrowseNext(UA_Server *server, UA_Session *session,
     }
     result->statusCode = RefResult_init(&bc.rr);
     if(result->statusCode != UA_STATUSCODE_GOOD)
-        return;
+        goto reattach_cp;
 
     /* Continue browsing */
     browse(&bc);
@@ -1062,13 +1112,24 @@ Operation_BrowseNext(UA_Server *server, UA_Session *session,
         UA_BrowseResult_clear(result);
         result->statusCode = bc.status;
     }
+
+ reattach_cp:
+    /* Re-attach the cp to the session */
+    locked = lockServerInReadSection(server);
+    cp->next = session->continuationPoints;
+    session->continuationPoints = cp;
+    if(locked)
+        unlockServer(server);
     return;
 
  remove_cp:
     /* Remove the cp */
-    *prev = ContinuationPoint_clear(cp);
+    ContinuationPoint_clear(cp);
     UA_free(cp);
+    locked = lockServerInReadSection(server);
     ++session->availableContinuationPoints;
+    if(locked)
+        unlockServer(server);
 }
 
 void
@@ -1077,7 +1138,7 @@ Service_BrowseNext(UA_Server *server, UA_Session *session,
                    UA_BrowseNextResponse *response) {
     UA_LOG_DEBUG_SESSION(server->config.logging, session,
                          "Processing BrowseNextRequest");
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_READ_LOCK_ASSERT(server);
 
     UA_Boolean releaseContinuationPoints =
         request->releaseContinuationPoints; /* request is const */
@@ -1096,6 +1157,15 @@ UA_Server_browseNext(UA_Server *server, UA_Boolean releaseContinuationPoint,
                      const UA_ByteString *continuationPoint) {
     UA_BrowseResult result;
     UA_BrowseResult_init(&result);
+#if UA_MULTITHREADING >= 100
+    if(server->config.concurrentReads) {
+        readSectionDepth++;
+        Operation_BrowseNext(server, &server->adminSession, &releaseContinuationPoint,
+                             continuationPoint, &result);
+        readSectionDepth--;
+        return result;
+    }
+#endif
     lockServer(server);
     Operation_BrowseNext(server, &server->adminSession, &releaseContinuationPoint,
                          continuationPoint, &result);
@@ -1233,7 +1303,7 @@ Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
                                        const UA_UInt32 *nodeClassMask,
                                        const UA_BrowsePath *path,
                                        UA_BrowsePathResult *result) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_READ_LOCK_ASSERT(server);
 
     if(path->relativePath.elementsSize == 0) {
         result->statusCode = UA_STATUSCODE_BADNOTHINGTODO;
@@ -1360,7 +1430,7 @@ Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
 UA_BrowsePathResult
 translateBrowsePathToNodeIds(UA_Server *server,
                              const UA_BrowsePath *browsePath) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_READ_LOCK_ASSERT(server);
     UA_BrowsePathResult result;
     UA_BrowsePathResult_init(&result);
     UA_UInt32 nodeClassMask = 0; /* All node classes */
@@ -1372,6 +1442,14 @@ translateBrowsePathToNodeIds(UA_Server *server,
 UA_BrowsePathResult
 UA_Server_translateBrowsePathToNodeIds(UA_Server *server,
                                        const UA_BrowsePath *browsePath) {
+#if UA_MULTITHREADING >= 100
+    if(server->config.concurrentReads) {
+        readSectionDepth++;
+        UA_BrowsePathResult result = translateBrowsePathToNodeIds(server, browsePath);
+        readSectionDepth--;
+        return result;
+    }
+#endif
     lockServer(server);
     UA_BrowsePathResult result = translateBrowsePathToNodeIds(server, browsePath);
     unlockServer(server);
@@ -1384,7 +1462,7 @@ Service_TranslateBrowsePathsToNodeIds(UA_Server *server, UA_Session *session,
                                       UA_TranslateBrowsePathsToNodeIdsResponse *response) {
     UA_LOG_DEBUG_SESSION(server->config.logging, session,
                          "Processing TranslateBrowsePathsToNodeIdsRequest");
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_READ_LOCK_ASSERT(server);
 
     /* Test the number of operations in the request */
     if(server->config.maxNodesPerTranslateBrowsePathsToNodeIds != 0 &&
@@ -1451,6 +1529,13 @@ UA_Server_browseSimplifiedBrowsePath(UA_Server *server, const UA_NodeId origin,
 /* Register */
 /************/
 
+static void
+Operation_RegisterNode(UA_Server *server, UA_Session *session, void *context,
+                       const UA_NodeId *nodeId, UA_NodeId *alias) {
+    /* Nothing to report back for the individual NodeIds */
+    UA_Session_registerNode(server, session, nodeId, alias);
+}
+
 void Service_RegisterNodes(UA_Server *server, UA_Session *session,
                            const UA_RegisterNodesRequest *request,
                            UA_RegisterNodesResponse *response) {
@@ -1458,12 +1543,6 @@ void Service_RegisterNodes(UA_Server *server, UA_Session *session,
                          "Processing RegisterNodesRequest");
     UA_LOCK_ASSERT(&server->serviceMutex);
 
-    //TODO: hang the nodeids to the session if really needed
-    if(request->nodesToRegisterSize == 0) {
-        response->responseHeader.serviceResult = UA_STATUSCODE_BADNOTHINGTODO;
-        return;
-    }
-
     /* Test the number of operations in the request */
     if(server->config.maxNodesPerRegisterNodes != 0 &&
        request->nodesToRegisterSize > server->config.maxNodesPerRegisterNodes) {
@@ -1471,11 +1550,16 @@ void Service_RegisterNodes(UA_Server *server, UA_Session *session,
         return;
     }
 
+    /* The registered nodes are pinned in the session and get a compact alias
+     * NodeId. Read, Write and CreateMonitoredItems access the pinned node
+     * directly via the alias. */
     response->responseHeader.serviceResult =
-        UA_Array_copy(request->nodesToRegister, request->nodesToRegisterSize,
-                      (void**)&response->registeredNodeIds, &UA_TYPES[UA_TYPES_NODEID]);
-    if(response->responseHeader.serviceResult == UA_STATUSCODE_GOOD)
-        response->registeredNodeIdsSize = request->nodesToRegisterSize;
+        UA_Server_processServiceOperations(server, session,
+                                           (UA_ServiceOperation)Operation_RegisterNode,
+                                           NULL, &request->nodesToRegisterSize,
+                                           &UA_TYPES[UA_TYPES_NODEID],
+                                           &response->registeredNodeIdsSize,
+                                           &UA_TYPES[UA_TYPES_NODEID]);
 }
 
 void Service_UnregisterNodes(UA_Server *server, UA_Session *session,
@@ -1485,9 +1569,10 @@ void Service_UnregisterNodes(UA_Server *server, UA_Session *session,
                          "Processing UnRegisterNodesRequest");
     UA_LOCK_ASSERT(&server->serviceMutex);
 
-    //TODO: remove the nodeids from the session if really needed
-    if(request->nodesToUnregisterSize == 0)
+    if(request->nodesToUnregisterSize == 0) {
         response->responseHeader.serviceResult = UA_STATUSCODE_BADNOTHINGTODO;
+        return;
+    }
 
     /* Test the number of operations in the request */
     if(server->config.maxNodesPerRegisterNodes != 0 &&
@@ -1495,4 +1580,7 @@ void Service_UnregisterNodes(UA_Server *server, UA_Session *session,
         response->responseHeader.serviceResult = UA_STATUSCODE_BADTOOMANYOPERATIONS;
         return;
     }
+
+    for(size_t i = 0; i < request->nodesToUnregisterSize; i++)
+        UA_Session_unregisterNode(server, session, &request->nodesToUnregister[i]);
 }
@@ -56,6 +56,8 @@ void UA_Session_clear(UA_Session *session, UA_Server* server) {
     session->continuationPoints = NULL;
     session->availableContinuationPoints = UA_MAXCONTINUATIONPOINTS;
 
+    UA_Session_unregisterAllNodes(server, session);
+
     UA_KeyValueMap_delete(session->attributes);
     session->attributes = NULL;
 
@@ -142,6 +144,122 @@ UA_Session_updateLifetime(UA_Session *session, UA_DateTime now,
 #endif
 }
 
+/********************/
+/* Registered Nodes */
+/********************/
+
+static UA_StatusCode
+growRegisteredNodes(UA_Session *session) {
+    if(session->registeredNodesSize >= UA_MAXREGISTEREDNODES)
+        return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+    size_t newSize = (session->registeredNodesSize == 0) ?
+        16 : (size_t)session->registeredNodesSize * 2;
+    if(newSize > UA_MAXREGISTEREDNODES)
+        newSize = UA_MAXREGISTEREDNODES;
+    UA_RegisteredNode *rn = (UA_RegisteredNode*)
+        UA_realloc(session->registeredNodes, newSize * sizeof(UA_RegisteredNode));
+    if(!rn)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* Add the new slots to the freelist */
+    for(size_t i = session->registeredNodesSize; i < newSize; i++) {
+        memset(&rn[i], 0, sizeof(UA_RegisteredNode));
+        rn[i].nextFree = session->registeredNodesFree;
+        session->registeredNodesFree = (UA_UInt16)(i + 1);
+    }
+    session->registeredNodes = rn;
+    session->registeredNodesSize = (UA_UInt16)newSize;
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_Session_registerNode(UA_Server *server, UA_Session *session,
+                        const UA_NodeId *nodeId, UA_NodeId *alias) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+
+    /* Already an alias */
+    if(UA_Session_getRegisteredNode(session, nodeId))
+        return UA_NodeId_copy(nodeId, alias);
+
+    /* Don't register unknown nodes. But don't return an error either. The
+     * client is free to use the returned NodeId. */
+    const UA_Node *node =
+        UA_NODESTORE_GET_SELECTIVE(server, nodeId, UA_NODEATTRIBUTESMASK_NONE,
+                                   UA_REFERENCETYPESET_NONE,
+                                   UA_BROWSEDIRECTION_INVALID);
+    if(!node)
+        return UA_NodeId_copy(nodeId, alias);
+
+    /* Get an empty slot. Return the original NodeId if the table is full. */
+    if(session->registeredNodesFree == 0 &&
+       growRegisteredNodes(session) != UA_STATUSCODE_GOOD) {
+        UA_NODESTORE_RELEASE(server, node);
+        return UA_NodeId_copy(nodeId, alias);
+    }
+    UA_UInt16 slot = (UA_UInt16)(session->registeredNodesFree - 1);
+    UA_RegisteredNode *rn = &session->registeredNodes[slot];
+    UA_StatusCode res = UA_NodeId_copy(nodeId, &rn->nodeId);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_NODESTORE_RELEASE(server, node);
+        return res;
+    }
+    session->registeredNodesFree = rn->nextFree;
+    rn->nextFree = 0;
+    rn->node = node; /* Keep the reference */
+
+    *alias = UA_NODEID_NUMERIC(UA_REGISTEREDNODES_NSINDEX,
+                               ((UA_UInt32)rn->generation << 16) | slot);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+releaseRegisteredNode(UA_Server *server, UA_Session *session, UA_UInt16 slot) {
+    UA_RegisteredNode *rn = &session->registeredNodes[slot];
+    UA_NODESTORE_RELEASE(server, rn->node);
+    rn->node = NULL;
+    UA_NodeId_clear(&rn->nodeId);
+    rn->generation++;
+    rn->nextFree = session->registeredNodesFree;
+    session->registeredNodesFree = (UA_UInt16)(slot + 1);
+}
+
+void
+UA_Session_unregisterNode(UA_Server *server, UA_Session *session,
+                          const UA_NodeId *alias) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+    const UA_RegisteredNode *rn = UA_Session_getRegisteredNode(session, alias);
+    if(rn)
+        releaseRegisteredNode(server, session,
+                              (UA_UInt16)(rn - session->registeredNodes));
+}
+
+void
+UA_Session_unregisterAllNodes(UA_Server *server, UA_Session *session) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+    for(UA_UInt16 i = 0; i < session->registeredNodesSize; i++) {
+        if(session->registeredNodes[i].node)
+            releaseRegisteredNode(server, session, i);
+    }
+    UA_free(session->registeredNodes);
+    session->registeredNodes = NULL;
+    session->registeredNodesSize = 0;
+    session->registeredNodesFree = 0;
+}
+
+const UA_RegisteredNode *
+UA_Session_getRegisteredNode(const UA_Session *session, const UA_NodeId *alias) {
+    if(alias->namespaceIndex != UA_REGISTEREDNODES_NSINDEX ||
+       alias->identifierType != UA_NODEIDTYPE_NUMERIC || !session)
+        return NULL;
+    UA_UInt32 slot = alias->identifier.numeric & 0xFFFF;
+    if(slot >= session->registeredNodesSize)
+        return NULL;
+    const UA_RegisteredNode *rn = &session->registeredNodes[slot];
+    if(!rn->node || rn->generation != (UA_UInt16)(alias->identifier.numeric >> 16))
+        return NULL;
+    return rn;
+}
+
 #ifdef UA_ENABLE_SUBSCRIPTIONS
 
 void
@@ -208,17 +326,19 @@ UA_Session_getSubscriptionById(UA_Session *session, UA_UInt32 subscriptionId) {
     return sub;
 }
 
+/* Prevent lookup of subscriptions that are to be deleted with a statuschange */
+static void *
+findActiveSubscription(void *context, UA_Subscription *sub) {
+    return (sub->statusChange == UA_STATUSCODE_GOOD) ? sub : NULL;
+}
+
 UA_Subscription *
 getSubscriptionById(UA_Server *server, UA_UInt32 subscriptionId) {
-    UA_Subscription *sub;
-    LIST_FOREACH(sub, &server->subscriptions, serverListEntry) {
-        /* Prevent lookup of subscriptions that are to be deleted with a statuschange */
-        if(sub->statusChange != UA_STATUSCODE_GOOD)
-            continue;
-        if(sub->subscriptionId == subscriptionId)
-            break;
-    }
-    return sub;
+    /* A transferred subscription is briefly in the tree twice with the same
+     * SubscriptionId. The old one has the statuschange set. */
+    return (UA_Subscription*)
+        ZIP_ITER_KEY(UA_SubscriptionIdTree, &server->subscriptionsById,
+                     &subscriptionId, findActiveSubscription, NULL);
 }
 
 UA_PublishResponseEntry*
@@ -248,14 +368,12 @@ UA_Session_queuePublishReq(UA_Session *session, UA_PublishResponseEntry* entry,
 UA_StatusCode
 UA_Server_closeSession(UA_Server *server, const UA_NodeId *sessionId) {
     lockServer(server);
-    session_list_entry *entry;
     UA_StatusCode res = UA_STATUSCODE_BADSESSIONIDINVALID;
-    LIST_FOREACH(entry, &server->sessions, pointers) {
-        if(UA_NodeId_equal(&entry->session.sessionId, sessionId)) {
-            UA_Server_removeSession(server, entry, UA_SHUTDOWNREASON_CLOSE);
-            res = UA_STATUSCODE_GOOD;
-            break;
-        }
+    session_list_entry *entry =
+        ZIP_FIND(UA_SessionIdTree, &server->sessionsById, sessionId);
+    if(entry) {
+        UA_Server_removeSession(server, entry, UA_SHUTDOWNREASON_CLOSE);
+        res = UA_STATUSCODE_GOOD;
     }
     unlockServer(server);
     return res;
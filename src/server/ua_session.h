@@ -10,6 +10,7 @@
 #define UA_SESSION_H_
 
 #include <open62541/util.h>
+#include <open62541/plugin/nodestore.h>
 
 #include "../ua_securechannel.h"
 
@@ -17,6 +18,23 @@ _UA_BEGIN_DECLS
 
 #define UA_MAXCONTINUATIONPOINTS 5
 
+/* RegisterNodes returns numeric alias NodeIds in this namespace index. The
+ * identifier contains the slot in the table of registered nodes (lower 16 bit)
+ * and the generation of the slot (upper 16 bit). So that the alias of an
+ * unregistered node is not silently reused. */
+#define UA_REGISTEREDNODES_NSINDEX 0xFFFF
+#define UA_MAXREGISTEREDNODES 0xFFFF
+
+/* The node is pinned in the Nodestore (we hold a reference) and accessed via a
+ * direct NodePointer. The Nodestore checks whether the node was replaced in the
+ * meantime and falls back to the lookup by NodeId. */
+typedef struct {
+    UA_NodeId nodeId;    /* Original NodeId */
+    const UA_Node *node; /* Pinned node. NULL for empty slots. */
+    UA_UInt16 generation;
+    UA_UInt16 nextFree;  /* Index+1 of the next empty slot. 0 for the end. */
+} UA_RegisteredNode;
+
 struct ContinuationPoint;
 typedef struct ContinuationPoint ContinuationPoint;
 
@@ -64,6 +82,11 @@ struct UA_Session {
     UA_UInt16         availableContinuationPoints;
     ContinuationPoint *continuationPoints;
 
+    /* Registered nodes */
+    UA_RegisteredNode *registeredNodes;
+    UA_UInt16 registeredNodesSize;
+    UA_UInt16 registeredNodesFree; /* Index+1 of the first empty slot */
+
     /* Localization information */
     size_t localeIdsSize;
     UA_String *localeIds;
@@ -102,6 +125,28 @@ UA_StatusCode UA_Session_generateNonce(UA_Session *session);
 void UA_Session_updateLifetime(UA_Session *session, UA_DateTime now,
                                UA_DateTime nowMonotonic);
 
+/**
+ * Registered Nodes
+ * ---------------- */
+
+/* Writes an alias NodeId to the output. The original NodeId is copied if the
+ * node does not exist or the table of registered nodes is full. */
+UA_StatusCode
+UA_Session_registerNode(UA_Server *server, UA_Session *session,
+                        const UA_NodeId *nodeId, UA_NodeId *alias);
+
+/* Ignores NodeIds that are not a registered alias */
+void
+UA_Session_unregisterNode(UA_Server *server, UA_Session *session,
+                          const UA_NodeId *alias);
+
+void
+UA_Session_unregisterAllNodes(UA_Server *server, UA_Session *session);
+
+/* Returns NULL if the NodeId is not a registered alias of the session */
+const UA_RegisteredNode *
+UA_Session_getRegisteredNode(const UA_Session *session, const UA_NodeId *alias);
+
 /**
  * Subscription handling
  * --------------------- */
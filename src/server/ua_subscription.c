@@ -22,6 +22,7 @@
 #include "ua_server_internal.h"
 #include "ua_subscription.h"
 #include "itoa.h"
+#include "../ua_types_encoding_binary.h"
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS /* conditional compilation */
 
@@ -61,6 +62,8 @@ UA_Notification_delete(UA_Notification *n) {
 #endif
     default:
         UA_MonitoredItemNotification_clear(&n->data.dataChange);
+        if(n->sharedValue)
+            UA_SharedDataValue_release(n->sharedValue);
         break;
     }
     UA_free(n);
@@ -252,6 +255,13 @@ UA_Notification_dequeueSub(UA_Notification *n) {
 /* Subscription */
 /****************/
 
+enum ZIP_CMP
+cmpSubscriptionId(const UA_UInt32 *a, const UA_UInt32 *b) {
+    if(*a == *b)
+        return ZIP_CMP_EQ;
+    return (*a < *b) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+}
+
 UA_Subscription *
 UA_Subscription_new(void) {
     /* Allocate the memory */
@@ -307,6 +317,7 @@ UA_Subscription_delete(UA_Server *server, UA_Subscription *sub) {
     /* Remove from the server if not previously registered */
     if(sub->serverListEntry.le_prev) {
         LIST_REMOVE(sub, serverListEntry);
+        ZIP_REMOVE(UA_SubscriptionIdTree, &server->subscriptionsById, sub);
         UA_assert(server->subscriptionsSize > 0);
         server->subscriptionsSize--;
         server->serverDiagnosticsSummary.currentSubscriptionCount--;
@@ -440,6 +451,102 @@ UA_Subscription_removeRetransmissionMessage(UA_Subscription *sub, UA_UInt32 sequ
     return UA_STATUSCODE_GOOD;
 }
 
+/* DataChangeNotifications are encoded to binary when the NotificationMessage
+ * is prepared. The NotificationMessage then contains the encoded
+ * ExtensionObject. Its bytes are spliced into the Publish response and copied
+ * for the Republish Service without encoding the values again. The encoding of
+ * a UA_SharedDataValue is cached and reused for all Subscriptions.
+ *
+ * The binary layout of the DataChangeNotification is:
+ * Int32 monitoredItemsSize | MonitoredItemNotification[] |
+ * Int32 diagnosticInfosSize */
+
+/* Always keeps space for the trailing DiagnosticInfo array length */
+static UA_StatusCode
+reserveEncodeBuffer(UA_ByteString *buf, size_t pos, size_t length) {
+    length += sizeof(UA_Int32);
+    if(pos + length <= buf->length)
+        return UA_STATUSCODE_GOOD;
+    size_t newLength = buf->length * 2;
+    if(newLength < pos + length)
+        newLength = pos + length;
+    UA_Byte *data = (UA_Byte*)UA_realloc(buf->data, newLength);
+    if(!data)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    buf->data = data;
+    buf->length = newLength;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+encodeAt(UA_ByteString *buf, size_t *pos, const void *src,
+         const UA_DataType *type, size_t length, UA_EncodeBinaryOptions *opts) {
+    UA_StatusCode res = reserveEncodeBuffer(buf, *pos, length);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    UA_Byte *bufPos = &buf->data[*pos];
+    const UA_Byte *bufEnd = &buf->data[*pos + length];
+    res = UA_encodeBinaryInternal(src, type, &bufPos, &bufEnd, opts, NULL, NULL);
+    if(res == UA_STATUSCODE_GOOD)
+        *pos += length;
+    return res;
+}
+
+/* The cached encoding can be used if the status of the notification was not
+ * changed (e.g. overflow bits) and no namespace mapping is applied */
+static const UA_ByteString *
+getSharedEncoding(const UA_Notification *n, const UA_EncodeBinaryOptions *opts) {
+    UA_SharedDataValue *sv = n->sharedValue;
+    const UA_DataValue *dv = &n->data.dataChange.value;
+    if(!sv || opts->namespaceMapping ||
+       dv->hasStatus != sv->value.hasStatus || dv->status != sv->value.status)
+        return NULL;
+    if(!sv->encoded.data &&
+       UA_encodeBinary(&sv->value, &UA_TYPES[UA_TYPES_DATAVALUE],
+                       &sv->encoded, NULL) != UA_STATUSCODE_GOOD)
+        return NULL;
+    return &sv->encoded;
+}
+
+/* Returns an error only if the buffer could not be allocated */
+static UA_StatusCode
+encodeDataChangeNotification(UA_ByteString *buf, size_t *pos,
+                             const UA_Notification *n,
+                             UA_EncodeBinaryOptions *opts) {
+    const UA_MonitoredItemNotification *min = &n->data.dataChange;
+
+    /* Splice in the cached encoding after the ClientHandle */
+    const UA_ByteString *shared = getSharedEncoding(n, opts);
+    if(shared) {
+        UA_StatusCode res =
+            reserveEncodeBuffer(buf, *pos, sizeof(UA_UInt32) + shared->length);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        res = encodeAt(buf, pos, &min->clientHandle, &UA_TYPES[UA_TYPES_UINT32],
+                       sizeof(UA_UInt32), opts);
+        UA_assert(res == UA_STATUSCODE_GOOD);
+        memcpy(&buf->data[*pos], shared->data, shared->length);
+        *pos += shared->length;
+        return res;
+    }
+
+    /* Encode the MonitoredItemNotification */
+    const UA_DataType *type = &UA_TYPES[UA_TYPES_MONITOREDITEMNOTIFICATION];
+    size_t length = UA_calcSizeBinary(min, type, opts);
+    UA_StatusCode res = (length > 0) ?
+        encodeAt(buf, pos, min, type, length, opts) : UA_STATUSCODE_BADENCODINGERROR;
+    if(res == UA_STATUSCODE_GOOD || res == UA_STATUSCODE_BADOUTOFMEMORY)
+        return res;
+
+    /* The value cannot be encoded. Send the error status instead. */
+    UA_MonitoredItemNotification errMin;
+    UA_MonitoredItemNotification_init(&errMin);
+    errMin.clientHandle = min->clientHandle;
+    errMin.value.hasStatus = true;
+    errMin.value.status = res;
+    return encodeAt(buf, pos, &errMin, type, UA_calcSizeBinary(&errMin, type, opts), opts);
+}
+
 /* The output counters are only set when the preparation is successful */
 static UA_StatusCode
 prepareNotificationMessage(UA_Server *server, UA_Subscription *sub,
@@ -459,28 +566,31 @@ prepareNotificationMessage(UA_Server *server, UA_Subscription *sub,
         return UA_STATUSCODE_BADOUTOFMEMORY;
     message->notificationDataSize = 2;
 
-    /* Pre-allocate DataChangeNotifications */
+    /* Pre-allocate the buffer for the encoded DataChangeNotification. Start
+     * after the array length. The buffer is extended when needed. */
     size_t notificationDataIdx = 0;
     size_t dcnPos = 0; /* How many DataChangeNotifications? */
-    UA_DataChangeNotification *dcn = NULL;
+    UA_ExtensionObject *dcn = NULL;
+    size_t dcnEncPos = sizeof(UA_Int32);
+    UA_EncodeBinaryOptions encOpts;
+    memset(&encOpts, 0, sizeof(UA_EncodeBinaryOptions));
+    if(sub->session && sub->session->channel)
+        encOpts.namespaceMapping = sub->session->channel->namespaceMapping;
     if(sub->dataChangeNotifications > 0) {
-        dcn = UA_DataChangeNotification_new();
-        if(!dcn) {
-            UA_NotificationMessage_clear(message);
-            return UA_STATUSCODE_BADOUTOFMEMORY;
-        }
-        UA_ExtensionObject_setValue(message->notificationData, dcn,
-                                    &UA_TYPES[UA_TYPES_DATACHANGENOTIFICATION]);
+        dcn = message->notificationData;
+        dcn->encoding = UA_EXTENSIONOBJECT_ENCODED_BYTESTRING;
+        dcn->content.encoded.typeId =
+            UA_TYPES[UA_TYPES_DATACHANGENOTIFICATION].binaryEncodingId;
         size_t dcnSize = sub->dataChangeNotifications;
         if(dcnSize > maxNotifications)
             dcnSize = maxNotifications;
-        dcn->monitoredItems = (UA_MonitoredItemNotification*)
-            UA_Array_new(dcnSize, &UA_TYPES[UA_TYPES_MONITOREDITEMNOTIFICATION]);
-        if(!dcn->monitoredItems) {
-            UA_NotificationMessage_clear(message); /* Also frees the dcn */
-            return UA_STATUSCODE_BADOUTOFMEMORY;
+        UA_StatusCode res =
+            UA_ByteString_allocBuffer(&dcn->content.encoded.body,
+                                      (2 * sizeof(UA_Int32)) + (dcnSize * 32));
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_NotificationMessage_clear(message);
+            return res;
         }
-        dcn->monitoredItemsSize = dcnSize;
         notificationDataIdx++;
     }
 
@@ -533,8 +643,12 @@ prepareNotificationMessage(UA_Server *server, UA_Subscription *sub,
 #endif
         default:
             UA_assert(dcn != NULL); /* Have at least one change notification */
-            dcn->monitoredItems[dcnPos] = n->data.dataChange;
-            UA_DataValue_init(&n->data.dataChange.value);
+            /* Stop if the buffer cannot be extended. The remaining
+             * notifications stay queued for the next Publish response. */
+            if(encodeDataChangeNotification(&dcn->content.encoded.body,
+                                            &dcnEncPos, n, &encOpts) !=
+               UA_STATUSCODE_GOOD)
+                goto finish;
             dcnPos++;
             break;
         }
@@ -557,13 +671,25 @@ prepareNotificationMessage(UA_Server *server, UA_Subscription *sub,
         totalNotifications++;
     }
 
-    /* Set sizes */
+ finish:
+    /* Set sizes. Write the length of the MonitoredItemNotification array and
+     * an empty DiagnosticInfo array. The memory for both is reserved. */
     if(dcn) {
-        dcn->monitoredItemsSize = dcnPos;
-        if(dcnPos == 0) {
-            UA_free(dcn->monitoredItems);
-            dcn->monitoredItems = NULL;
-        }
+        UA_ByteString *body = &dcn->content.encoded.body;
+        UA_Int32 arraySize = (dcnPos > 0) ? (UA_Int32)dcnPos : -1;
+        UA_Int32 diagnosticInfosSize = -1;
+        UA_Byte *bufPos = body->data;
+        const UA_Byte *bufEnd = &body->data[sizeof(UA_Int32)];
+        UA_StatusCode res =
+            UA_encodeBinaryInternal(&arraySize, &UA_TYPES[UA_TYPES_INT32],
+                                    &bufPos, &bufEnd, NULL, NULL, NULL);
+        bufPos = &body->data[dcnEncPos];
+        bufEnd = &body->data[dcnEncPos + sizeof(UA_Int32)];
+        res |= UA_encodeBinaryInternal(&diagnosticInfosSize, &UA_TYPES[UA_TYPES_INT32],
+                                       &bufPos, &bufEnd, NULL, NULL, NULL);
+        UA_assert(res == UA_STATUSCODE_GOOD);
+        (void)res;
+        body->length = dcnEncPos + sizeof(UA_Int32);
     }
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
@@ -1335,7 +1461,7 @@ UA_MonitoredItem_setMonitoringMode(UA_Server *server, UA_MonitoredItem *mon,
         TAILQ_FOREACH_SAFE(notification, &mon->queue, monEntry, notification_tmp) {
             UA_Notification_delete(notification);
         }
-        UA_DataValue_clear(&mon->lastValue);
+        UA_MonitoredItem_clearLastValue(mon);
         return UA_STATUSCODE_GOOD;
     }
 
@@ -1409,9 +1535,13 @@ UA_MonitoredItem_delete(UA_Server *server, UA_MonitoredItem *mon) {
     /* Remove the settings */
     UA_ReadValueId_clear(&mon->itemToMonitor);
     UA_MonitoringParameters_clear(&mon->parameters);
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    UA_EventFilterProgram_release(server, mon->eventFilter);
+    mon->eventFilter = NULL;
+#endif
 
     /* Remove the last samples */
-    UA_DataValue_clear(&mon->lastValue);
+    UA_MonitoredItem_clearLastValue(mon);
 
     /* If this is a local MonitoredItem, clean up additional values */
     if(mon->subscription == server->adminSubscription) {
@@ -1543,13 +1673,194 @@ UA_MonitoredItem_ensureQueueSpace(UA_Server *server, UA_MonitoredItem *mon) {
     }
 }
 
+enum ZIP_CMP
+cmpSamplingShareKey(const UA_UInt32 *a, const UA_UInt32 *b) {
+    if(*a == *b)
+        return ZIP_CMP_EQ;
+    return (*a < *b) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+}
+
+static UA_UInt32
+samplingShareHash(const UA_MonitoredItem *mon) {
+    const UA_ReadValueId *rvid = &mon->itemToMonitor;
+    UA_UInt32 h = UA_NodeId_hash(&rvid->nodeId);
+    h = UA_ByteString_hash(h, (const UA_Byte*)&rvid->attributeId,
+                           sizeof(UA_UInt32));
+    return UA_ByteString_hash(h, rvid->indexRange.data, rvid->indexRange.length);
+}
+
+/* MonitoredItems can share samples if the entire sampling configuration is the
+ * same. The sampling interval is the same within a SamplingGroup. */
+static void *
+findSamplingShare(void *context, UA_SamplingShare *ss) {
+    const UA_MonitoredItem *mon = (const UA_MonitoredItem*)context;
+    if(mon->timestampsToReturn != ss->timestampsToReturn)
+        return NULL;
+    if(!UA_equal(&mon->itemToMonitor, &ss->itemToMonitor,
+                 &UA_TYPES[UA_TYPES_READVALUEID]))
+        return NULL;
+    if(!UA_equal(&mon->parameters.filter, &ss->filter,
+                 &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]))
+        return NULL;
+    return ss;
+}
+
+/* Sample all MonitoredItems of the group under a single lock. Consecutive
+ * MonitoredItems on the same node (e.g. different attributes) reuse the node
+ * from the previous lookup in the Nodestore. The MonitoredItems are sampled in
+ * the order of the group (and not share-by-share) to keep the memory access
+ * local. */
 static void
-UA_MonitoredItem_lockAndSample(UA_Server *server, UA_MonitoredItem *mon) {
+UA_SamplingGroup_sample(UA_Server *server, UA_SamplingGroup *sg) {
     lockServer(server);
-    UA_MonitoredItem_sample(server, mon);
+
+    UA_LOG_DEBUG(server->config.logging, UA_LOGCATEGORY_SERVER,
+                 "SamplingGroup with interval %.2fms | Sampling %lu MonitoredItems",
+                 sg->samplingInterval, (long unsigned)sg->monitoredItemsSize);
+
+    const UA_Node *node = NULL;
+    UA_MonitoredItem *mon, *mon_tmp;
+    LIST_FOREACH_SAFE(mon, &sg->monitoredItems, sampling.cyclic.groupEntry, mon_tmp) {
+        /* Get the node if it differs from the previous MonitoredItem */
+        if(!node || !UA_NodeId_equal(&node->head.nodeId, &mon->itemToMonitor.nodeId)) {
+            if(node)
+                UA_NODESTORE_RELEASE(server, node);
+            node = UA_NODESTORE_GET(server, &mon->itemToMonitor.nodeId);
+        }
+
+        /* Sample the current value and process it */
+        UA_MonitoredItem_sampleShared(server, mon, node);
+    }
+    if(node)
+        UA_NODESTORE_RELEASE(server, node);
+
+    /* Release the shared samples of the cycle */
+    UA_SamplingShare *ss;
+    LIST_FOREACH(ss, &sg->shares, listEntry) {
+        UA_SamplingShare_reset(ss);
+    }
+
     unlockServer(server);
 }
 
+static void
+delayedFreeSampling(void *app, void *context) {
+    UA_free(context);
+}
+
+static UA_StatusCode
+addToSamplingGroup(UA_Server *server, UA_MonitoredItem *mon) {
+    /* Find an existing group with the same interval */
+    UA_SamplingGroup *sg;
+    LIST_FOREACH(sg, &server->samplingGroups, listEntry) {
+        if(sg->samplingInterval == mon->parameters.samplingInterval)
+            break;
+    }
+
+    /* Create a new group with its own repeated callback */
+    UA_Boolean newGroup = false;
+    if(!sg) {
+        sg = (UA_SamplingGroup*)UA_calloc(1, sizeof(UA_SamplingGroup));
+        if(!sg)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        sg->samplingInterval = mon->parameters.samplingInterval;
+        ZIP_INIT(&sg->sharesByKey);
+        newGroup = true;
+    }
+
+    /* Find the share with the identical sampling configuration or create it */
+    UA_UInt32 keyHash = samplingShareHash(mon);
+    UA_SamplingShare *ss = (UA_SamplingShare*)
+        ZIP_ITER_KEY(UA_SamplingShareTree, &sg->sharesByKey,
+                     &keyHash, findSamplingShare, mon);
+    if(!ss) {
+        ss = (UA_SamplingShare*)UA_calloc(1, sizeof(UA_SamplingShare));
+        if(!ss)
+            goto errout;
+        UA_StatusCode res =
+            UA_ReadValueId_copy(&mon->itemToMonitor, &ss->itemToMonitor);
+        res |= UA_ExtensionObject_copy(&mon->parameters.filter, &ss->filter);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_ReadValueId_clear(&ss->itemToMonitor);
+            UA_ExtensionObject_clear(&ss->filter);
+            UA_free(ss);
+            goto errout;
+        }
+        ss->timestampsToReturn = mon->timestampsToReturn;
+        ss->keyHash = keyHash;
+    }
+
+    /* Register the repeated callback for a new group */
+    if(newGroup) {
+        UA_StatusCode res =
+            addRepeatedCallback(server, (UA_ServerCallback)UA_SamplingGroup_sample,
+                                sg, sg->samplingInterval, &sg->callbackId);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_ReadValueId_clear(&ss->itemToMonitor);
+            UA_ExtensionObject_clear(&ss->filter);
+            UA_free(ss);
+            UA_free(sg);
+            return res;
+        }
+        LIST_INSERT_HEAD(&server->samplingGroups, sg, listEntry);
+    }
+
+    /* Add the new share */
+    if(ss->monitoredItemsSize == 0) {
+        ZIP_INSERT(UA_SamplingShareTree, &sg->sharesByKey, ss);
+        LIST_INSERT_HEAD(&sg->shares, ss, listEntry);
+    }
+
+    /* Add the MonitoredItem */
+    LIST_INSERT_HEAD(&sg->monitoredItems, mon, sampling.cyclic.groupEntry);
+    sg->monitoredItemsSize++;
+    ss->monitoredItemsSize++;
+    mon->sampling.cyclic.group = sg;
+    mon->sampling.cyclic.share = ss;
+    return UA_STATUSCODE_GOOD;
+
+ errout:
+    if(newGroup)
+        UA_free(sg);
+    return UA_STATUSCODE_BADOUTOFMEMORY;
+}
+
+static void
+removeFromSamplingGroup(UA_Server *server, UA_MonitoredItem *mon) {
+    UA_SamplingGroup *sg = mon->sampling.cyclic.group;
+    UA_SamplingShare *ss = mon->sampling.cyclic.share;
+    LIST_REMOVE(mon, sampling.cyclic.groupEntry);
+    sg->monitoredItemsSize--;
+    ss->monitoredItemsSize--;
+
+    /* Remove the empty share. The memory is freed in a delayed callback, as
+     * this might be called from within the sampling callback of the group. */
+    UA_EventLoop *el = server->config.eventLoop;
+    if(ss->monitoredItemsSize == 0) {
+        ZIP_REMOVE(UA_SamplingShareTree, &sg->sharesByKey, ss);
+        LIST_REMOVE(ss, listEntry);
+        UA_SamplingShare_reset(ss);
+        UA_ReadValueId_clear(&ss->itemToMonitor);
+        UA_ExtensionObject_clear(&ss->filter);
+        ss->delayedFreePointers.callback = delayedFreeSampling;
+        ss->delayedFreePointers.application = NULL;
+        ss->delayedFreePointers.context = ss;
+        el->addDelayedCallback(el, &ss->delayedFreePointers);
+    }
+
+    if(sg->monitoredItemsSize > 0)
+        return;
+
+    /* Remove the empty group. The memory is freed in a delayed callback, as
+     * this might be called from within the sampling callback of the group. */
+    removeCallback(server, sg->callbackId);
+    LIST_REMOVE(sg, listEntry);
+    sg->delayedFreePointers.callback = delayedFreeSampling;
+    sg->delayedFreePointers.application = NULL;
+    sg->delayedFreePointers.context = sg;
+    el->addDelayedCallback(el, &sg->delayedFreePointers);
+}
+
 UA_StatusCode
 UA_MonitoredItem_registerSampling(UA_Server *server, UA_MonitoredItem *mon) {
     UA_LOCK_ASSERT(&server->serviceMutex);
@@ -1578,13 +1889,9 @@ UA_MonitoredItem_registerSampling(UA_Server *server, UA_MonitoredItem *mon) {
                          sampling.subscriptionSampling);
         mon->samplingType = UA_MONITOREDITEMSAMPLINGTYPE_PUBLISH;
     } else {
-        /* DataChange MonitoredItems with a positive sampling interval have a
-         * repeated callback. Other MonitoredItems are attached to the Node in a
-         * linked list of backpointers. */
-        res = addRepeatedCallback(server,
-                                  (UA_ServerCallback)UA_MonitoredItem_lockAndSample,
-                                  mon, mon->parameters.samplingInterval,
-                                  &mon->sampling.callbackId);
+        /* DataChange MonitoredItems with a positive sampling interval are
+         * sampled in the repeated callback of their SamplingGroup */
+        res = addToSamplingGroup(server, mon);
         if(res == UA_STATUSCODE_GOOD)
             mon->samplingType = UA_MONITOREDITEMSAMPLINGTYPE_CYCLIC;
     }
@@ -1598,8 +1905,8 @@ UA_MonitoredItem_unregisterSampling(UA_Server *server, UA_MonitoredItem *mon) {
 
     switch(mon->samplingType) {
     case UA_MONITOREDITEMSAMPLINGTYPE_CYCLIC:
-        /* Remove repeated callback */
-        removeCallback(server, mon->sampling.callbackId);
+        /* Remove from the SamplingGroup */
+        removeFromSamplingGroup(server, mon);
         break;
 
     case UA_MONITOREDITEMSAMPLINGTYPE_EVENT: {
@@ -24,6 +24,7 @@
 
 #include "ua_session.h"
 #include "../util/ua_util_internal.h"
+#include "ziptree.h"
 
 _UA_BEGIN_DECLS
 
@@ -46,6 +47,19 @@ _UA_BEGIN_DECLS
 /* A notification was not (yet) added to the queue of a Subscription */
 #define UA_SUBSCRIPTION_QUEUE_SENTINEL ((UA_Notification*)0x01)
 
+/* A sampled value that is shared by several MonitoredItems (see the
+ * SamplingShare below). Notifications and the lastValue of the MonitoredItems
+ * hold a shallow copy of the DataValue (UA_VARIANT_DATA_NODELETE) and a
+ * reference. The value is freed when the last reference is released. */
+typedef struct {
+    size_t refCount;
+    UA_DataValue value;
+    UA_ByteString encoded; /* Binary encoding of the value. Created when the
+                            * value is first published. */
+} UA_SharedDataValue;
+
+void UA_SharedDataValue_release(UA_SharedDataValue *sv);
+
 typedef struct UA_Notification {
     /* The subEntry can be a sentinel value to indicate that the Notification is
      * not enqueue in the Subscription. This is the case when the Subscription
@@ -65,6 +79,10 @@ typedef struct UA_Notification {
 #endif
     } data;
 
+    /* Set if data.dataChange.value is a shallow copy of the shared value.
+     * Publishing then uses the cached encoding of the shared value. */
+    UA_SharedDataValue *sharedValue;
+
 #ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
     UA_Boolean isOverflowEvent; /* Counted manually */
 #endif
@@ -108,13 +126,70 @@ typedef TAILQ_HEAD(NotificationMessageQueue, UA_NotificationMessageEntry)
  * <0: Attached to the subscription. Triggered just before every "publish". */
 typedef enum {
     UA_MONITOREDITEMSAMPLINGTYPE_NONE = 0,
-    UA_MONITOREDITEMSAMPLINGTYPE_CYCLIC, /* Cyclic callback */
+    UA_MONITOREDITEMSAMPLINGTYPE_CYCLIC, /* Cyclic callback of a SamplingGroup */
     UA_MONITOREDITEMSAMPLINGTYPE_EVENT,  /* Attached to the node. Can be a "write
                                           * event" for DataChange MonitoredItems
                                           * with a zero sampling interval .*/
     UA_MONITOREDITEMSAMPLINGTYPE_PUBLISH /* Attached to the subscription */
 } UA_MonitoredItemSamplingType;
 
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+struct UA_EventFilterProgram;
+typedef struct UA_EventFilterProgram UA_EventFilterProgram;
+#endif
+
+/* Within a SamplingGroup, MonitoredItems with the same ItemToMonitor (NodeId,
+ * AttributeId, IndexRange, DataEncoding), TimestampsToReturn and filter are
+ * attached to a SamplingShare. This is typical when many clients (e.g. HMIs)
+ * monitor the same variables. If the read result does not depend on the
+ * Session, the value is sampled once per cycle for the share and the
+ * deadband/change detection is evaluated once for all MonitoredItems that
+ * reported the same last value. The MonitoredItems then enqueue Notifications
+ * that reference the same UA_SharedDataValue. The shares are looked up by the
+ * hash of their key. */
+typedef struct UA_SamplingShare {
+    UA_DelayedCallback delayedFreePointers;
+    LIST_ENTRY(UA_SamplingShare) listEntry;
+    ZIP_ENTRY(UA_SamplingShare) treeEntry;
+    UA_UInt32 keyHash;
+    size_t monitoredItemsSize;
+
+    /* Key */
+    UA_ReadValueId itemToMonitor;
+    UA_TimestampsToReturn timestampsToReturn;
+    UA_ExtensionObject filter;
+
+    /* State during the sampling cycle of the SamplingGroup */
+    UA_Boolean sampled;
+    UA_SharedDataValue *sample;        /* NULL if not read once for the share */
+    UA_SharedDataValue *compareValue;  /* The last change detection was done */
+    UA_Boolean compareChanged;         /* against this value */
+} UA_SamplingShare;
+
+enum ZIP_CMP
+cmpSamplingShareKey(const UA_UInt32 *a, const UA_UInt32 *b);
+
+typedef ZIP_HEAD(UA_SamplingShareTree, UA_SamplingShare) UA_SamplingShareTree;
+ZIP_FUNCTIONS(UA_SamplingShareTree, UA_SamplingShare, treeEntry,
+              UA_UInt32, keyHash, cmpSamplingShareKey)
+
+/* Cyclic MonitoredItems with the same sampling interval are collected in a
+ * SamplingGroup. The group has a single repeated callback that takes the
+ * service lock once and then samples all MonitoredItems of the group. This
+ * keeps the number of timers low (one per distinct sampling interval) even if
+ * there are a great many MonitoredItems. The SamplingGroups are kept in a
+ * server-wide list and are removed once the last MonitoredItem leaves. */
+typedef struct UA_SamplingGroup {
+    UA_DelayedCallback delayedFreePointers;
+    LIST_ENTRY(UA_SamplingGroup) listEntry;
+    UA_Double samplingInterval; /* in ms */
+    UA_UInt64 callbackId;
+    LIST_HEAD(, UA_MonitoredItem) monitoredItems;
+    size_t monitoredItemsSize;
+    LIST_HEAD(, UA_SamplingShare) shares;
+    UA_SamplingShareTree sharesByKey;
+} UA_SamplingGroup;
+
 struct UA_MonitoredItem {
     UA_DelayedCallback delayedFreePointers;
     LIST_ENTRY(UA_MonitoredItem) listEntry; /* Linked list in the Subscription */
@@ -151,12 +226,17 @@ struct UA_MonitoredItem {
     /* Sampling */
     UA_MonitoredItemSamplingType samplingType;
     union {
-        UA_UInt64 callbackId;
+        struct {
+            UA_SamplingGroup *group;
+            UA_SamplingShare *share;
+            LIST_ENTRY(UA_MonitoredItem) groupEntry;
+        } cyclic;
         UA_MonitoredItem *nodeListNext; /* Event-Based: Attached to Node */
         LIST_ENTRY(UA_MonitoredItem) subscriptionSampling; /* Linked to publish
                                                             * interval */
     } sampling;
     UA_DataValue lastValue;
+    UA_SharedDataValue *lastShared; /* Set if lastValue is a shallow copy */
 
     /* Triggering Links */
     size_t triggeringLinksSize;
@@ -168,6 +248,10 @@ struct UA_MonitoredItem {
                        * (maximum) queueSize in the parameters. */
     size_t eventOverflows; /* Separate counter for the queue. Can at most double
                             * the queue size */
+
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    UA_EventFilterProgram *eventFilter; /* Compiled from the filter parameter */
+#endif
 };
 
 void UA_MonitoredItem_init(UA_MonitoredItem *mon);
@@ -175,8 +259,8 @@ void UA_MonitoredItem_delete(UA_Server *server, UA_MonitoredItem *mon);
 void UA_MonitoredItem_removeOverflowInfoBits(UA_MonitoredItem *mon);
 void UA_Server_registerMonitoredItem(UA_Server *server, UA_MonitoredItem *mon);
 
-/* Register sampling. Either by adding a repeated callback or by adding the
- * MonitoredItem to a linked list in the node. */
+/* Register sampling. Either by adding the MonitoredItem to the SamplingGroup
+ * for its interval or by adding it to a linked list in the node. */
 UA_StatusCode
 UA_MonitoredItem_registerSampling(UA_Server *server, UA_MonitoredItem *mon);
 
@@ -190,6 +274,19 @@ UA_MonitoredItem_setMonitoringMode(UA_Server *server, UA_MonitoredItem *mon,
 void
 UA_MonitoredItem_sample(UA_Server *server, UA_MonitoredItem *mon);
 
+/* Sample a MonitoredItem of a SamplingGroup with the node (can be NULL). The
+ * value is read once for the SamplingShare if possible. */
+void
+UA_MonitoredItem_sampleShared(UA_Server *server, UA_MonitoredItem *mon,
+                              const UA_Node *node);
+
+/* Release the sample at the end of the sampling cycle */
+void
+UA_SamplingShare_reset(UA_SamplingShare *ss);
+
+void
+UA_MonitoredItem_clearLastValue(UA_MonitoredItem *mon);
+
 /* Do not use the value after calling this. It will be moved to mon or freed. */
 void
 UA_MonitoredItem_processSampledValue(UA_Server *server, UA_MonitoredItem *mon,
@@ -223,14 +320,16 @@ typedef enum {
     UA_SUBSCRIPTIONSTATE_ENABLED
 } UA_SubscriptionState;
 
-/* Subscriptions are managed in a server-wide linked list. If they are attached
- * to a Session, then they are additionaly in the per-Session linked-list. A
+/* Subscriptions are managed in a server-wide linked list and indexed by their
+ * SubscriptionId. If they are attached to a Session, then they are additionaly
+ * in the per-Session linked-list. A
  * subscription is always generated for a Session. But the CloseSession Service
  * may keep Subscriptions intact beyond the Session lifetime. They can then be
  * re-bound to a new Session with the TransferSubscription Service. */
 struct UA_Subscription {
     UA_DelayedCallback delayedFreePointers;
     LIST_ENTRY(UA_Subscription) serverListEntry;
+    ZIP_ENTRY(UA_Subscription) serverTreeEntry;
     /* Ordered according to the priority byte and round-robin scheduling for
      * late subscriptions. See ua_session.h. Only set if session != NULL. */
     TAILQ_ENTRY(UA_Subscription) sessionListEntry;
@@ -304,6 +403,15 @@ struct UA_Subscription {
 #endif
 };
 
+/* A transferred Subscription keeps its SubscriptionId. So the old and the new
+ * Subscription can have the same key until the old one is removed. */
+enum ZIP_CMP
+cmpSubscriptionId(const UA_UInt32 *a, const UA_UInt32 *b);
+
+typedef ZIP_HEAD(UA_SubscriptionIdTree, UA_Subscription) UA_SubscriptionIdTree;
+ZIP_FUNCTIONS(UA_SubscriptionIdTree, UA_Subscription, serverTreeEntry,
+              UA_UInt32, subscriptionId, cmpSubscriptionId)
+
 UA_Subscription * UA_Subscription_new(void);
 
 void
@@ -347,9 +455,30 @@ typedef struct UA_ConditionSource UA_ConditionSource;
 #define UA_EVENTFILTER_MAXOPERANDS 64 /* Max operands per operator */
 #define UA_EVENTFILTER_MAXSELECT   64 /* Max select clauses */
 
+/* The EventFilter of a MonitoredItem is compiled into a program. The program
+ * is shared (reference counted) between MonitoredItems with identical filters.
+ * The result of the evaluation for an event is then reused. */
+UA_StatusCode
+UA_EventFilterProgram_acquire(UA_Server *server, const UA_EventFilter *filter,
+                              UA_EventFilterProgram **program);
+
+void
+UA_EventFilterProgram_release(UA_Server *server, UA_EventFilterProgram *program);
+
+/* Returns UA_STATUSCODE_BADNOMATCH if the where-clause does not match. The
+ * result is reused for the same eventSeq (and session) unless eventSeq is
+ * zero. */
+UA_StatusCode
+UA_EventFilterProgram_evaluate(UA_Server *server, UA_EventFilterProgram *program,
+                               UA_Session *session, const UA_NodeId *eventNode,
+                               const UA_KeyValueMap *eventFields, UA_UInt64 eventSeq,
+                               UA_EventFieldList *efl);
+
+/* The eventSeq identifies the event during its emission (zero if unknown) */
 UA_StatusCode
 UA_MonitoredItem_addEvent(UA_Server *server, UA_MonitoredItem *mon,
-                          const UA_NodeId *event);
+                          const UA_NodeId *event, const UA_KeyValueMap *eventFields,
+                          UA_UInt64 eventSeq);
 
 UA_StatusCode
 generateEventId(UA_ByteString *generatedId);
@@ -368,6 +497,7 @@ UA_ContentFilterElementValidation(UA_Server *server, size_t operatorIndex,
 /* Evaluate content filter, exported only for unit testing */
 UA_StatusCode
 evaluateWhereClause(UA_Server *server, UA_Session *session, const UA_NodeId *eventNode,
+                    const UA_KeyValueMap *eventFields,
                     const UA_ContentFilter *contentFilter,
                     UA_ContentFilterResult *contentFilterResult);
 
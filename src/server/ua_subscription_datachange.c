@@ -15,41 +15,66 @@
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS /* conditional compilation */
 
+/* The change detection for arrays runs over blocks of elements. The inner loop
+ * has no early exit. So the compiler can vectorize it for the targeted
+ * instruction set. The blocks keep the early exit once a change was found. */
+#define UA_CHANGE_BLOCKSIZE 64
+
 /* Detect value changes outside the deadband */
-#define UA_DETECT_DEADBAND(TYPE) do {                           \
-    TYPE v1 = *(const TYPE*)data1;                              \
-    TYPE v2 = *(const TYPE*)data2;                              \
-    TYPE diff = (v1 > v2) ? (TYPE)(v1 - v2) : (TYPE)(v2 - v1);  \
-    return ((UA_Double)diff > deadband);                        \
-} while(false);
+#define UA_DETECT_DEADBAND(NAME, TYPE)                                  \
+    static UA_Boolean                                                   \
+    NAME(const TYPE *v1, const TYPE *v2, size_t length,                 \
+         const UA_Double deadband) {                                    \
+        for(size_t i = 0; i < length; i += UA_CHANGE_BLOCKSIZE) {       \
+            size_t end = i + UA_CHANGE_BLOCKSIZE;                       \
+            if(end > length)                                            \
+                end = length;                                           \
+            int changed = 0;                                            \
+            for(size_t j = i; j < end; j++) {                           \
+                TYPE diff = (v1[j] > v2[j]) ?                           \
+                    (TYPE)(v1[j] - v2[j]) : (TYPE)(v2[j] - v1[j]);      \
+                changed |= ((UA_Double)diff > deadband);                \
+            }                                                           \
+            if(changed)                                                 \
+                return true;                                            \
+        }                                                               \
+        return false;                                                   \
+    }
 
-static UA_Boolean
-detectScalarDeadBand(const void *data1, const void *data2,
-                     const UA_DataType *type, const UA_Double deadband) {
-    if(type->typeKind == UA_DATATYPEKIND_SBYTE) {
-        UA_DETECT_DEADBAND(UA_SByte);
-    } else if(type->typeKind == UA_DATATYPEKIND_BYTE) {
-        UA_DETECT_DEADBAND(UA_Byte);
-    } else if(type->typeKind == UA_DATATYPEKIND_INT16) {
-        UA_DETECT_DEADBAND(UA_Int16);
-    } else if(type->typeKind == UA_DATATYPEKIND_UINT16) {
-        UA_DETECT_DEADBAND(UA_UInt16);
-    } else if(type->typeKind == UA_DATATYPEKIND_INT32) {
-        UA_DETECT_DEADBAND(UA_Int32);
-    } else if(type->typeKind == UA_DATATYPEKIND_UINT32) {
-        UA_DETECT_DEADBAND(UA_UInt32);
-    } else if(type->typeKind == UA_DATATYPEKIND_INT64) {
-        UA_DETECT_DEADBAND(UA_Int64);
-    } else if(type->typeKind == UA_DATATYPEKIND_UINT64) {
-        UA_DETECT_DEADBAND(UA_UInt64);
-    } else if(type->typeKind == UA_DATATYPEKIND_FLOAT) {
-        UA_DETECT_DEADBAND(UA_Float);
-    } else if(type->typeKind == UA_DATATYPEKIND_DOUBLE) {
-        UA_DETECT_DEADBAND(UA_Double);
-    } else {
-        return false; /* Not a known numerical type */
+UA_DETECT_DEADBAND(sByteDeadband, UA_SByte)
+UA_DETECT_DEADBAND(byteDeadband, UA_Byte)
+UA_DETECT_DEADBAND(int16Deadband, UA_Int16)
+UA_DETECT_DEADBAND(uInt16Deadband, UA_UInt16)
+UA_DETECT_DEADBAND(int32Deadband, UA_Int32)
+UA_DETECT_DEADBAND(uInt32Deadband, UA_UInt32)
+UA_DETECT_DEADBAND(int64Deadband, UA_Int64)
+UA_DETECT_DEADBAND(uInt64Deadband, UA_UInt64)
+
+/* For floating point values, the difference is computed without a branch. The
+ * flags are accumulated in the floating point type, so that the results of the
+ * comparison have the same vector width as the values. */
+#define UA_DETECT_FLOATDEADBAND(NAME, TYPE)                             \
+    static UA_Boolean                                                   \
+    NAME(const TYPE *v1, const TYPE *v2, size_t length,                 \
+         const UA_Double deadband) {                                    \
+        for(size_t i = 0; i < length; i += UA_CHANGE_BLOCKSIZE) {       \
+            size_t end = i + UA_CHANGE_BLOCKSIZE;                       \
+            if(end > length)                                            \
+                end = length;                                           \
+            TYPE changed = 0;                                           \
+            for(size_t j = i; j < end; j++) {                           \
+                TYPE diff = v1[j] - v2[j];                              \
+                diff = (diff < 0) ? -diff : diff;                       \
+                changed += ((UA_Double)diff > deadband) ? 1 : 0;        \
+            }                                                           \
+            if(changed > 0)                                             \
+                return true;                                            \
+        }                                                               \
+        return false;                                                   \
     }
-}
+
+UA_DETECT_FLOATDEADBAND(floatDeadband, UA_Float)
+UA_DETECT_FLOATDEADBAND(doubleDeadband, UA_Double)
 
 static UA_Boolean
 detectVariantDeadband(const UA_Variant *value, const UA_Variant *oldValue,
@@ -61,17 +86,124 @@ detectVariantDeadband(const UA_Variant *value, const UA_Variant *oldValue,
     size_t length = 1;
     if(!UA_Variant_isScalar(value))
         length = value->arrayLength;
-    uintptr_t data = (uintptr_t)value->data;
-    uintptr_t oldData = (uintptr_t)oldValue->data;
-    UA_UInt32 memSize = value->type->memSize;
-    for(size_t i = 0; i < length; ++i) {
-        if(detectScalarDeadBand((const void*)data, (const void*)oldData,
-                                value->type, deadbandValue))
-            return true;
-        data += memSize;
-        oldData += memSize;
+    const void *v1 = value->data;
+    const void *v2 = oldValue->data;
+    switch(value->type->typeKind) {
+    case UA_DATATYPEKIND_SBYTE:
+        return sByteDeadband((const UA_SByte*)v1, (const UA_SByte*)v2,
+                             length, deadbandValue);
+    case UA_DATATYPEKIND_BYTE:
+        return byteDeadband((const UA_Byte*)v1, (const UA_Byte*)v2,
+                            length, deadbandValue);
+    case UA_DATATYPEKIND_INT16:
+        return int16Deadband((const UA_Int16*)v1, (const UA_Int16*)v2,
+                             length, deadbandValue);
+    case UA_DATATYPEKIND_UINT16:
+        return uInt16Deadband((const UA_UInt16*)v1, (const UA_UInt16*)v2,
+                              length, deadbandValue);
+    case UA_DATATYPEKIND_INT32:
+        return int32Deadband((const UA_Int32*)v1, (const UA_Int32*)v2,
+                             length, deadbandValue);
+    case UA_DATATYPEKIND_UINT32:
+        return uInt32Deadband((const UA_UInt32*)v1, (const UA_UInt32*)v2,
+                              length, deadbandValue);
+    case UA_DATATYPEKIND_INT64:
+        return int64Deadband((const UA_Int64*)v1, (const UA_Int64*)v2,
+                             length, deadbandValue);
+    case UA_DATATYPEKIND_UINT64:
+        return uInt64Deadband((const UA_UInt64*)v1, (const UA_UInt64*)v2,
+                              length, deadbandValue);
+    case UA_DATATYPEKIND_FLOAT:
+        return floatDeadband((const UA_Float*)v1, (const UA_Float*)v2,
+                             length, deadbandValue);
+    case UA_DATATYPEKIND_DOUBLE:
+        return doubleDeadband((const UA_Double*)v1, (const UA_Double*)v2,
+                              length, deadbandValue);
+    default:
+        return false; /* Not a known numerical type */
+    }
+}
+
+/* Floating point values are compared as in UA_order. NaN is equal to NaN and
+ * -0.0 is equal to 0.0. The flags are again accumulated in the floating point
+ * type. */
+#define UA_DETECT_FLOATCHANGE(NAME, TYPE)                               \
+    static UA_Boolean                                                   \
+    NAME(const TYPE *v1, const TYPE *v2, size_t length) {               \
+        for(size_t i = 0; i < length; i += UA_CHANGE_BLOCKSIZE) {       \
+            size_t end = i + UA_CHANGE_BLOCKSIZE;                       \
+            if(end > length)                                            \
+                end = length;                                           \
+            TYPE changed = 0;                                           \
+            for(size_t j = i; j < end; j++)                             \
+                changed += ((v1[j] != v2[j]) &                          \
+                            ((v1[j] == v1[j]) | (v2[j] == v2[j]))) ? 1 : 0; \
+            if(changed > 0)                                             \
+                return true;                                            \
+        }                                                               \
+        return false;                                                   \
+    }
+
+UA_DETECT_FLOATCHANGE(floatChange, UA_Float)
+UA_DETECT_FLOATCHANGE(doubleChange, UA_Double)
+
+/* Fast path for arrays of numerical values. Returns false if the arrays are not
+ * handled here and need to be compared with UA_equal. */
+static UA_Boolean
+detectArrayChange(const UA_Variant *value, const UA_Variant *oldValue,
+                  UA_Boolean *changed) {
+    const UA_DataType *type = value->type;
+    if(!type || type != oldValue->type ||
+       UA_Variant_isScalar(value) || UA_Variant_isScalar(oldValue))
+        return false;
+
+    size_t length = value->arrayLength;
+    if(length != oldValue->arrayLength) {
+        *changed = true;
+        return true;
+    }
+
+    switch(type->typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN:
+    case UA_DATATYPEKIND_SBYTE:
+    case UA_DATATYPEKIND_BYTE:
+    case UA_DATATYPEKIND_INT16:
+    case UA_DATATYPEKIND_UINT16:
+    case UA_DATATYPEKIND_INT32:
+    case UA_DATATYPEKIND_UINT32:
+    case UA_DATATYPEKIND_INT64:
+    case UA_DATATYPEKIND_UINT64:
+    case UA_DATATYPEKIND_FLOAT:
+    case UA_DATATYPEKIND_DOUBLE:
+    case UA_DATATYPEKIND_DATETIME:
+    case UA_DATATYPEKIND_STATUSCODE:
+        break;
+    default:
+        return false;
+    }
+
+    /* Equal memory means equal values. But floating point values with
+     * different memory can still be equal (-0.0 and 0.0, NaN). */
+    *changed = (length > 0 &&
+                memcmp(value->data, oldValue->data, length * type->memSize) != 0);
+    if(*changed && type->typeKind == UA_DATATYPEKIND_FLOAT)
+        *changed = floatChange((const UA_Float*)value->data,
+                               (const UA_Float*)oldValue->data, length);
+    else if(*changed && type->typeKind == UA_DATATYPEKIND_DOUBLE)
+        *changed = doubleChange((const UA_Double*)value->data,
+                                (const UA_Double*)oldValue->data, length);
+
+    /* Compare the ArrayDimensions */
+    if(*changed)
+        return true;
+    if(value->arrayDimensionsSize != oldValue->arrayDimensionsSize) {
+        *changed = true;
+        return true;
     }
-    return false;
+    *changed = (value->arrayDimensionsSize > 0 &&
+                memcmp(value->arrayDimensions, oldValue->arrayDimensions,
+                       value->arrayDimensionsSize * sizeof(UA_UInt32)) != 0);
+    return true;
 }
 
 static UA_Boolean
@@ -120,10 +252,34 @@ detectValueChange(UA_Server *server, UA_MonitoredItem *mon, const UA_DataValue *
     /* Has the value changed? */
     if(dv->hasValue != mon->lastValue.hasValue)
         return true;
+    UA_Boolean changed;
+    if(dv->hasValue &&
+       detectArrayChange(&dv->value, &mon->lastValue.value, &changed))
+        return changed;
     return !UA_equal(&dv->value, &mon->lastValue.value,
                      &UA_TYPES[UA_TYPES_VARIANT]);
 }
 
+void
+UA_SharedDataValue_release(UA_SharedDataValue *sv) {
+    UA_assert(sv->refCount > 0);
+    sv->refCount--;
+    if(sv->refCount > 0)
+        return;
+    UA_DataValue_clear(&sv->value);
+    UA_ByteString_clear(&sv->encoded);
+    UA_free(sv);
+}
+
+void
+UA_MonitoredItem_clearLastValue(UA_MonitoredItem *mon) {
+    UA_DataValue_clear(&mon->lastValue); /* No-op for the shallow copy */
+    if(mon->lastShared) {
+        UA_SharedDataValue_release(mon->lastShared);
+        mon->lastShared = NULL;
+    }
+}
+
 UA_StatusCode
 UA_MonitoredItem_createDataChangeNotification(UA_Server *server, UA_MonitoredItem *mon,
                                               const UA_DataValue *dv) {
@@ -177,7 +333,7 @@ UA_MonitoredItem_processSampledValue(UA_Server *server, UA_MonitoredItem *mon,
     }
 
     /* Move/store the value for filter comparison and TransferSubscription */
-    UA_DataValue_clear(&mon->lastValue);
+    UA_MonitoredItem_clearLastValue(mon);
     mon->lastValue = *value;
 
     /* Call the local callback if the MonitoredItem is not attached to a
@@ -194,6 +350,157 @@ UA_MonitoredItem_processSampledValue(UA_Server *server, UA_MonitoredItem *mon,
     }
 }
 
+/* Same as UA_MonitoredItem_processSampledValue after the value has been
+ * detected as changed. But the Notification and the lastValue only reference
+ * the shared value. */
+static void
+processSharedValue(UA_Server *server, UA_MonitoredItem *mon,
+                   UA_SharedDataValue *sv) {
+    UA_Notification *n = UA_Notification_new();
+    if(!n) {
+        UA_LOG_WARNING_SUBSCRIPTION(server->config.logging, mon->subscription,
+                                    "MonitoredItem %" PRIi32 " | "
+                                    "Processing the sample returned the statuscode %s",
+                                    mon->monitoredItemId,
+                                    UA_StatusCode_name(UA_STATUSCODE_BADOUTOFMEMORY));
+        return;
+    }
+
+    /* Prepare and enqueue the notification */
+    n->mon = mon;
+    n->data.dataChange.value = sv->value;
+    n->data.dataChange.value.value.storageType = UA_VARIANT_DATA_NODELETE;
+    n->data.dataChange.clientHandle = mon->parameters.clientHandle;
+    n->sharedValue = sv;
+    sv->refCount++;
+    UA_Notification_enqueueAndTrigger(server, n);
+
+    /* Store the value for filter comparison and TransferSubscription */
+    UA_MonitoredItem_clearLastValue(mon);
+    mon->lastValue = sv->value;
+    mon->lastValue.value.storageType = UA_VARIANT_DATA_NODELETE;
+    mon->lastShared = sv;
+    sv->refCount++;
+
+    /* Call the local callback if the MonitoredItem is not attached to a
+     * subscription. Do this at the very end. Because the callback might delete
+     * the subscription. */
+    if(!mon->subscription) {
+        UA_LocalMonitoredItem *localMon = (UA_LocalMonitoredItem*) mon;
+        void *nodeContext = NULL;
+        getNodeContext(server, mon->itemToMonitor.nodeId, &nodeContext);
+        localMon->callback.dataChangeCallback(server,
+                                              mon->monitoredItemId, localMon->context,
+                                              &mon->itemToMonitor.nodeId, nodeContext,
+                                              mon->itemToMonitor.attributeId,
+                                              &sv->value);
+    }
+}
+
+/* The value attribute of a VariableNode is the same for all Sessions (apart
+ * from the access rights) if no user-defined callback is involved. The
+ * callbacks get the SessionId and might return different values. */
+static UA_Boolean
+isSharedRead(const UA_Node *node, const UA_MonitoredItem *mon) {
+    if(mon->itemToMonitor.attributeId != UA_ATTRIBUTEID_VALUE ||
+       node->head.nodeClass != UA_NODECLASS_VARIABLE)
+        return false;
+    const UA_VariableNode *vn = &node->variableNode;
+    switch(vn->valueSourceType) {
+    case UA_VALUESOURCETYPE_INTERNAL:
+        return (vn->valueSource.internal.notifications.onRead == NULL);
+    case UA_VALUESOURCETYPE_EXTERNAL:
+        return (vn->valueSource.external.notifications.onRead == NULL);
+    default:
+        return false;
+    }
+}
+
+void
+UA_SamplingShare_reset(UA_SamplingShare *ss) {
+    if(ss->sample)
+        UA_SharedDataValue_release(ss->sample);
+    if(ss->compareValue)
+        UA_SharedDataValue_release(ss->compareValue);
+    ss->sample = NULL;
+    ss->compareValue = NULL;
+    ss->compareChanged = false;
+    ss->sampled = false;
+}
+
+void
+UA_MonitoredItem_sampleShared(UA_Server *server, UA_MonitoredItem *mon,
+                              const UA_Node *node) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_assert(mon->itemToMonitor.attributeId != UA_ATTRIBUTEID_EVENTNOTIFIER);
+
+    /* Read the value once per cycle for all MonitoredItems of the share. The
+     * read is done with the AdminSession. The access rights are checked for
+     * each MonitoredItem below. */
+    UA_SamplingShare *ss = mon->sampling.cyclic.share;
+    if(!ss->sampled) {
+        ss->sampled = true;
+        if(ss->monitoredItemsSize > 1 && node && isSharedRead(node, mon)) {
+            ss->sample = (UA_SharedDataValue*)
+                UA_calloc(1, sizeof(UA_SharedDataValue));
+            if(ss->sample) {
+                ss->sample->refCount = 1; /* Released in UA_SamplingShare_reset */
+                ReadWithNode(node, server, &server->adminSession,
+                             ss->timestampsToReturn, &ss->itemToMonitor,
+                             &ss->sample->value);
+            }
+        }
+    }
+
+    /* Use the shared value if the Session can read it. sub->session can be
+     * NULL when the subscription is detached. */
+    UA_Session *session = mon->subscription->session;
+    UA_SharedDataValue *sv = ss->sample;
+    if(sv && session &&
+       (getUserAccessLevel(server, session, &node->variableNode) &
+        UA_ACCESSLEVELMASK_READ)) {
+        /* MonitoredItems that reported the same last value get the same
+         * result from the change detection. The share keeps a reference so
+         * that the compared value cannot be freed and reallocated. */
+        UA_Boolean changed = ss->compareChanged;
+        if(!mon->lastShared || mon->lastShared != ss->compareValue) {
+            changed = detectValueChange(server, mon, &sv->value);
+            if(mon->lastShared) {
+                if(ss->compareValue)
+                    UA_SharedDataValue_release(ss->compareValue);
+                ss->compareValue = mon->lastShared;
+                ss->compareValue->refCount++;
+                ss->compareChanged = changed;
+            }
+        }
+        if(changed)
+            processSharedValue(server, mon, sv);
+        else
+            UA_LOG_DEBUG_SUBSCRIPTION(server->config.logging, mon->subscription,
+                                      "MonitoredItem %" PRIi32 " | "
+                                      "The value has not changed",
+                                      mon->monitoredItemId);
+        return;
+    }
+
+    /* Sample the current value for the individual MonitoredItem */
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    if(!session) {
+        dv.hasStatus = true;
+        dv.status = UA_STATUSCODE_BADUSERACCESSDENIED;
+    } else if(!node) {
+        dv.hasStatus = true;
+        dv.status = UA_STATUSCODE_BADNODEIDUNKNOWN;
+    } else {
+        ReadWithNode(node, server, session, mon->timestampsToReturn,
+                     &mon->itemToMonitor, &dv);
+    }
+
+    /* Process the sample. This always clears the value. */
+    UA_MonitoredItem_processSampledValue(server, mon, &dv);
+}
+
 void
 UA_MonitoredItem_sample(UA_Server *server, UA_MonitoredItem *mon) {
     UA_LOCK_ASSERT(&server->serviceMutex);
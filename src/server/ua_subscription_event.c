@@ -177,30 +177,22 @@ eventSetStandardFields(UA_Server *server, const UA_NodeId *event,
  * mons notification queue */
 UA_StatusCode
 UA_MonitoredItem_addEvent(UA_Server *server, UA_MonitoredItem *mon,
-                          const UA_NodeId *event) {
-    /* Get the filter */
-    if(mon->parameters.filter.content.decoded.type != &UA_TYPES[UA_TYPES_EVENTFILTER])
+                          const UA_NodeId *event, const UA_KeyValueMap *eventFields,
+                          UA_UInt64 eventSeq) {
+    /* Get the filter program (compiled when the MonitoredItem was created) */
+    if(!mon->eventFilter)
         return UA_STATUSCODE_BADFILTERNOTALLOWED;
-    UA_EventFilter *eventFilter = (UA_EventFilter*)
-        mon->parameters.filter.content.decoded.data;
 
     /* A MonitoredItem is always attached to a (local) Subscription.
      * A Subscription may not be attached to a Session. */
     UA_Subscription *sub = mon->subscription;
     UA_assert(sub);
 
-    /* Values to be returned when the filter matches */
-    UA_EventFieldList values;
-    UA_EventFieldList_init(&values);
-
-    UA_EventFilterResult efr; /* FilterResult contains only statuscodes. Ignored
-                               * outside the initial setup/validation. */
-    UA_EventFilterResult_init(&efr);
-
     /* Evaluate the filter. Return if it doesn't match. */
-    UA_StatusCode ret = filterEvent(server, sub->session, event,
-                                    eventFilter, &values, &efr);
-    UA_EventFilterResult_clear(&efr);
+    UA_EventFieldList values;
+    UA_StatusCode ret =
+        UA_EventFilterProgram_evaluate(server, mon->eventFilter, sub->session,
+                                       event, eventFields, eventSeq, &values);
     if(ret != UA_STATUSCODE_GOOD) {
         UA_EventFieldList_clear(&values);
         if(ret == UA_STATUSCODE_BADNOMATCH)
@@ -226,7 +218,8 @@ UA_MonitoredItem_addEvent(UA_Server *server, UA_MonitoredItem *mon,
 #ifdef UA_ENABLE_HISTORIZING
 static void
 setHistoricalEvent(UA_Server *server, const UA_NodeId *origin,
-                   const UA_NodeId *emitNodeId, const UA_NodeId *eventNodeId) {
+                   const UA_NodeId *emitNodeId, const UA_NodeId *eventNodeId,
+                   const UA_KeyValueMap *eventFields) {
     UA_Variant historicalEventFilterValue;
     UA_Variant_init(&historicalEventFilterValue);
 
@@ -259,12 +252,11 @@ setHistoricalEvent(UA_Server *server, const UA_NodeId *origin,
     /* Finally, if found and valid then filter */
     UA_EventFilter *filter = (UA_EventFilter*) historicalEventFilterValue.data;
     UA_EventFieldList efl;
-    UA_EventFilterResult result;
-    retval = filterEvent(server, &server->adminSession, eventNodeId, filter, &efl, &result);
+    retval = filterEvent(server, &server->adminSession, eventNodeId, eventFields,
+                         filter, &efl);
     if(retval == UA_STATUSCODE_GOOD)
         server->config.historyDatabase.setEvent(server, server->config.historyDatabase.context,
                                                 origin, emitNodeId, filter, &efl);
-    UA_EventFilterResult_clear(&result);
     UA_Variant_clear(&historicalEventFilterValue);
     UA_EventFieldList_clear(&efl);
 }
@@ -282,29 +274,35 @@ static const UA_NodeId isInFolderReferences[2] =
     {{0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_ORGANIZES}},
      {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_HASCOMPONENT}}};
 
-UA_StatusCode
-triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
-             const UA_NodeId origin, UA_ByteString *outEventId,
-             const UA_Boolean deleteEventNode) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+/* The list of nodes that emit the events of an origin node is cached. The cache
+ * entries are invalidated by bumping the version whenever a reference is added
+ * or removed that is relevant for the event propagation. */
 
-    UA_LOG_DEBUG(server->config.logging, UA_LOGCATEGORY_SERVER,
-                 "Events: An event is triggered on node %N", origin);
+void
+invalidateEventEmitCache(UA_Server *server, UA_Byte refTypeIndex) {
+    /* HasSubtype changes the ReferenceType hierarchy */
+    if(refTypeIndex == UA_REFERENCETYPEINDEX_HASSUBTYPE ||
+       UA_ReferenceTypeSet_contains(&server->eventEmitRefTypes, refTypeIndex))
+        server->eventEmitVersion++;
+}
 
-#ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
-    UA_Boolean isCallerAC = false;
-    if(isConditionOrBranch(server, &eventNodeId, &origin, &isCallerAC)) {
-        if(!isCallerAC) {
-          UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
-                                 "Condition Events: Please use A&C API to trigger Condition Events 0x%08X",
-                                  UA_STATUSCODE_BADINVALIDARGUMENT);
-          return UA_STATUSCODE_BADINVALIDARGUMENT;
-        }
+void
+clearEventEmitCache(UA_Server *server) {
+    for(size_t i = 0; i < UA_EVENTEMITCACHESIZE; i++) {
+        UA_EventEmitCacheEntry *entry = &server->eventEmitCache[i];
+        UA_NodeId_clear(&entry->origin);
+        UA_Array_delete(entry->emitNodes, entry->emitNodesSize,
+                        &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+        entry->emitNodes = NULL;
+        entry->emitNodesSize = 0;
     }
-#endif /* UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS */
+}
 
+static UA_StatusCode
+computeEmitNodes(UA_Server *server, const UA_NodeId *origin,
+                 size_t *emitNodesSize, UA_ExpandedNodeId **emitNodes) {
     /* Check that the origin node exists */
-    const UA_Node *originNode = UA_NODESTORE_GET(server, &origin);
+    const UA_Node *originNode = UA_NODESTORE_GET(server, origin);
     if(!originNode) {
         UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_USERLAND,
                      "Origin node for event does not exist.");
@@ -328,26 +326,12 @@ triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
         refTypes = UA_ReferenceTypeSet_union(refTypes, tmpRefTypes);
     }
 
-    if(!isNodeInTree(server, &origin, &objectsFolderId, &refTypes)) {
+    if(!isNodeInTree(server, origin, &objectsFolderId, &refTypes)) {
         UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_USERLAND,
                      "Node for event must be in ObjectsFolder!");
         return UA_STATUSCODE_BADINVALIDARGUMENT;
     }
 
-    /* Update the standard fields of the event */
-    retval = eventSetStandardFields(server, &eventNodeId, &origin, outEventId);
-    if(retval != UA_STATUSCODE_GOOD) {
-        UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
-                       "Events: Could not set the standard event fields with StatusCode %s",
-                       UA_StatusCode_name(retval));
-        return retval;
-    }
-
-    /* List of nodes that emit the node. Events propagate upwards (bubble up) in
-     * the node hierarchy. */
-    UA_ExpandedNodeId *emitNodes = NULL;
-    size_t emitNodesSize = 0;
-
     /* Add the server node to the list of nodes from which the event is emitted.
      * The server node emits all events.
      *
@@ -356,7 +340,7 @@ triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
      * a Server and as such has implied HasEventSource References to every event
      * source in a Server. */
     UA_NodeId emitStartNodes[2];
-    emitStartNodes[0] = origin;
+    emitStartNodes[0] = *origin;
     emitStartNodes[1] = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER);
 
     /* Get all ReferenceTypes over which the events propagate */
@@ -369,23 +353,81 @@ triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
             UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
                            "Events: Could not create the list of references for event "
                            "propagation with StatusCode %s", UA_StatusCode_name(retval));
-            goto cleanup;
+            return retval;
         }
         emitRefTypes = UA_ReferenceTypeSet_union(emitRefTypes, tmpRefTypes);
     }
 
+    /* Changes to these references invalidate the cached emit nodes. The
+     * references for the ObjectsFolder check are a subset. */
+    server->eventEmitRefTypes = UA_ReferenceTypeSet_union(emitRefTypes, refTypes);
+
     /* Get the list of nodes in the hierarchy that emits the event. */
     retval = browseRecursive(server, 2, emitStartNodes, UA_BROWSEDIRECTION_INVERSE,
                              &emitRefTypes, UA_NODECLASS_UNSPECIFIED, true,
-                             &emitNodesSize, &emitNodes);
+                             emitNodesSize, emitNodes);
     if(retval != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
                        "Events: Could not create the list of nodes listening on the "
                        "event with StatusCode %s", UA_StatusCode_name(retval));
+    }
+    return retval;
+}
+
+/* Take the list of emit nodes out of the cache or compute it. The list is
+ * handed back with releaseEmitNodes. While the event is emitted, the cache
+ * entry is empty. So (recursive) events from the callbacks can't free it. */
+static UA_StatusCode
+getEmitNodes(UA_Server *server, const UA_NodeId *origin,
+             size_t *emitNodesSize, UA_ExpandedNodeId **emitNodes) {
+    UA_EventEmitCacheEntry *entry =
+        &server->eventEmitCache[UA_NodeId_hash(origin) % UA_EVENTEMITCACHESIZE];
+    if(entry->emitNodesSize > 0 && entry->version == server->eventEmitVersion &&
+       UA_NodeId_equal(&entry->origin, origin)) {
+        *emitNodes = entry->emitNodes;
+        *emitNodesSize = entry->emitNodesSize;
+        entry->emitNodes = NULL;
+        entry->emitNodesSize = 0;
+        return UA_STATUSCODE_GOOD;
+    }
+    return computeEmitNodes(server, origin, emitNodesSize, emitNodes);
+}
+
+static void
+releaseEmitNodes(UA_Server *server, const UA_NodeId *origin, UA_UInt32 version,
+                 size_t emitNodesSize, UA_ExpandedNodeId *emitNodes) {
+    UA_EventEmitCacheEntry *entry =
+        &server->eventEmitCache[UA_NodeId_hash(origin) % UA_EVENTEMITCACHESIZE];
+
+    /* The references have changed in the meantime */
+    if(emitNodesSize == 0 || version != server->eventEmitVersion)
         goto cleanup;
+
+    /* Replace the cache entry */
+    if(!UA_NodeId_equal(&entry->origin, origin)) {
+        UA_NodeId_clear(&entry->origin);
+        if(UA_NodeId_copy(origin, &entry->origin) != UA_STATUSCODE_GOOD)
+            goto cleanup;
     }
+    UA_Array_delete(entry->emitNodes, entry->emitNodesSize,
+                    &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+    entry->version = version;
+    entry->emitNodes = emitNodes;
+    entry->emitNodesSize = emitNodesSize;
+    return;
 
-    /* Add the event to the listening MonitoredItems at each relevant node */
+ cleanup:
+    UA_Array_delete(emitNodes, emitNodesSize, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+}
+
+/* Add the event to the listening MonitoredItems at each relevant node */
+static void
+emitEvent(UA_Server *server, const UA_NodeId *origin, const UA_NodeId *eventNode,
+          const UA_KeyValueMap *eventFields,
+          size_t emitNodesSize, const UA_ExpandedNodeId *emitNodes) {
+    /* MonitoredItems with a shared filter program reuse the filter result for
+     * the same event */
+    UA_UInt64 eventSeq = ++server->eventSequence;
     for(size_t i = 0; i < emitNodesSize; i++) {
         /* Get the node */
         const UA_Node *node = UA_NODESTORE_GET(server, &emitNodes[i].nodeId);
@@ -404,12 +446,14 @@ triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
             /* Is this an Event-MonitoredItem? */
             if(mon->itemToMonitor.attributeId != UA_ATTRIBUTEID_EVENTNOTIFIER)
                 continue;
-            retval = UA_MonitoredItem_addEvent(server, mon, &eventNodeId);
+            /* Only log problems with individual emit nodes */
+            UA_StatusCode retval =
+                UA_MonitoredItem_addEvent(server, mon, eventNode, eventFields,
+                                          eventSeq);
             if(retval != UA_STATUSCODE_GOOD) {
                 UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
                                "Events: Could not add the event to a listening "
                                "node with StatusCode %s", UA_StatusCode_name(retval));
-                retval = UA_STATUSCODE_GOOD; /* Only log problems with individual emit nodes */
             }
         }
 
@@ -418,9 +462,58 @@ triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
         /* Add event entry in the historical database */
 #ifdef UA_ENABLE_HISTORIZING
         if(server->config.historyDatabase.setEvent)
-            setHistoricalEvent(server, &origin, &emitNodes[i].nodeId, &eventNodeId);
+            setHistoricalEvent(server, origin, &emitNodes[i].nodeId,
+                               eventNode, eventFields);
+#else
+        (void)origin;
 #endif
     }
+}
+
+UA_StatusCode
+triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
+             const UA_NodeId origin, UA_ByteString *outEventId,
+             const UA_Boolean deleteEventNode) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+
+    UA_LOG_DEBUG(server->config.logging, UA_LOGCATEGORY_SERVER,
+                 "Events: An event is triggered on node %N", origin);
+
+#ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
+    UA_Boolean isCallerAC = false;
+    if(isConditionOrBranch(server, &eventNodeId, &origin, &isCallerAC)) {
+        if(!isCallerAC) {
+          UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
+                                 "Condition Events: Please use A&C API to trigger Condition Events 0x%08X",
+                                  UA_STATUSCODE_BADINVALIDARGUMENT);
+          return UA_STATUSCODE_BADINVALIDARGUMENT;
+        }
+    }
+#endif /* UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS */
+
+    /* List of nodes that emit the node. Events propagate upwards (bubble up) in
+     * the node hierarchy. This also checks that the origin node exists and is
+     * in the ObjectsFolder. */
+    UA_UInt32 version = server->eventEmitVersion;
+    UA_ExpandedNodeId *emitNodes = NULL;
+    size_t emitNodesSize = 0;
+    UA_StatusCode retval = getEmitNodes(server, &origin, &emitNodesSize, &emitNodes);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* Update the standard fields of the event */
+    retval = eventSetStandardFields(server, &eventNodeId, &origin, outEventId);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
+                       "Events: Could not set the standard event fields with StatusCode %s",
+                       UA_StatusCode_name(retval));
+        releaseEmitNodes(server, &origin, version, emitNodesSize, emitNodes);
+        return retval;
+    }
+
+    /* Add the event to the listening MonitoredItems */
+    emitEvent(server, &origin, &eventNodeId, NULL, emitNodesSize, emitNodes);
+    releaseEmitNodes(server, &origin, version, emitNodesSize, emitNodes);
 
     /* Delete the node representation of the event */
     if(deleteEventNode) {
@@ -432,8 +525,6 @@ triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
         }
     }
 
- cleanup:
-    UA_Array_delete(emitNodes, emitNodesSize, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
     return retval;
 }
 
@@ -448,4 +539,101 @@ UA_Server_triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
     return res;
 }
 
+/* The standard fields are set by the server and come before the user-defined
+ * fields. The lookup uses the first matching key. Only the Time can be
+ * overridden as it is appended after the user-defined fields. */
+#define TRANSIENT_EVENT_STANDARD_FIELDS 4
+
+UA_StatusCode
+triggerTransientEvent(UA_Server *server, const UA_NodeId eventType,
+                      const UA_NodeId origin, const UA_KeyValueMap *eventFields,
+                      UA_ByteString *outEventId) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+
+    UA_LOG_DEBUG(server->config.logging, UA_LOGCATEGORY_SERVER,
+                 "Events: A transient event is triggered on node %N", origin);
+
+    /* Make sure the eventType is a subtype of BaseEventType */
+    UA_NodeId baseEventTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
+    if(!isNodeInTree_singleRef(server, &eventType, &baseEventTypeId,
+                               UA_REFERENCETYPEINDEX_HASSUBTYPE)) {
+        UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_USERLAND,
+                     "Event type must be a subtype of BaseEventType!");
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    }
+
+    /* Get the nodes that emit the event */
+    UA_UInt32 version = server->eventEmitVersion;
+    UA_ExpandedNodeId *emitNodes = NULL;
+    size_t emitNodesSize = 0;
+    UA_StatusCode retval = getEmitNodes(server, &origin, &emitNodesSize, &emitNodes);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* Set up the event record. The fields point to the stack and the
+     * user-defined map. They are not cleaned up individually. */
+    size_t userFieldsSize = (eventFields) ? eventFields->mapSize : 0;
+    UA_KeyValueMap record;
+    record.mapSize = TRANSIENT_EVENT_STANDARD_FIELDS + userFieldsSize + 1;
+    record.map = (UA_KeyValuePair*)UA_malloc(sizeof(UA_KeyValuePair) * record.mapSize);
+    UA_ByteString eventId = UA_BYTESTRING_NULL;
+    if(!record.map) {
+        retval = UA_STATUSCODE_BADOUTOFMEMORY;
+        goto cleanup;
+    }
+    retval = generateEventId(&eventId);
+    if(retval != UA_STATUSCODE_GOOD)
+        goto cleanup;
+
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_DateTime rcvTime = el->dateTime_now(el);
+    UA_KeyValuePair *field = record.map;
+    field->key = UA_QUALIFIEDNAME(0, "EventId");
+    UA_Variant_setScalar(&field->value, &eventId, &UA_TYPES[UA_TYPES_BYTESTRING]);
+    field++;
+    field->key = UA_QUALIFIEDNAME(0, "EventType");
+    UA_Variant_setScalar(&field->value, (void*)(uintptr_t)&eventType,
+                         &UA_TYPES[UA_TYPES_NODEID]);
+    field++;
+    field->key = UA_QUALIFIEDNAME(0, "SourceNode");
+    UA_Variant_setScalar(&field->value, (void*)(uintptr_t)&origin,
+                         &UA_TYPES[UA_TYPES_NODEID]);
+    field++;
+    field->key = UA_QUALIFIEDNAME(0, "ReceiveTime");
+    UA_Variant_setScalar(&field->value, &rcvTime, &UA_TYPES[UA_TYPES_DATETIME]);
+    field++;
+    if(userFieldsSize > 0)
+        memcpy(field, eventFields->map, sizeof(UA_KeyValuePair) * userFieldsSize);
+    field += userFieldsSize;
+    field->key = UA_QUALIFIEDNAME(0, "Time");
+    UA_Variant_setScalar(&field->value, &rcvTime, &UA_TYPES[UA_TYPES_DATETIME]);
+
+    /* Add the event to the listening MonitoredItems */
+    emitEvent(server, &origin, NULL, &record, emitNodesSize, emitNodes);
+
+    /* Return the EventId */
+    if(outEventId) {
+        *outEventId = eventId;
+        UA_ByteString_init(&eventId);
+    }
+
+ cleanup:
+    releaseEmitNodes(server, &origin, version, emitNodesSize, emitNodes);
+    UA_ByteString_clear(&eventId);
+    UA_free(record.map);
+    return retval;
+}
+
+UA_StatusCode
+UA_Server_triggerTransientEvent(UA_Server *server, const UA_NodeId eventType,
+                                const UA_NodeId origin,
+                                const UA_KeyValueMap *eventFields,
+                                UA_ByteString *outEventId) {
+    lockServer(server);
+    UA_StatusCode res =
+        triggerTransientEvent(server, eventType, origin, eventFields, outEventId);
+    unlockServer(server);
+    return res;
+}
+
 #endif /* UA_ENABLE_SUBSCRIPTIONS_EVENTS */
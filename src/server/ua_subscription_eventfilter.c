@@ -448,16 +448,149 @@ castImplicit(const UA_Variant *in, const UA_DataType *outType, UA_Variant *out)
     return res;
 }
 
+/* Compiled Filter Programs
+ * ------------------------
+ * EventFilters are compiled once when the MonitoredItem is created or
+ * modified. The elements of the where-clause become a flat list of
+ * instructions in evaluation order. The SimpleAttributeOperands of the where-
+ * and the select-clauses are deduplicated into field slots. Each field is
+ * resolved at most once per event. Literals keep the result of their last
+ * implicit cast. Checks against the EventType are memoized for the last
+ * EventType.
+ *
+ * MonitoredItems with identical filters share the program. The result of the
+ * evaluation is then reused for all of them (with the same session). */
+
+typedef enum {
+    UA_FILTEROPERANDKIND_INVALID = 0,
+    UA_FILTEROPERANDKIND_ELEMENT, /* Result of another element */
+    UA_FILTEROPERANDKIND_LITERAL,
+    UA_FILTEROPERANDKIND_FIELD,   /* SimpleAttributeOperand */
+    UA_FILTEROPERANDKIND_TYPE     /* Literal NodeId operand of OfType */
+} UA_FilterOperandKind;
+
+typedef struct {
+    UA_FilterOperandKind kind;
+    size_t index; /* Index of the element, literal, field or type */
+} UA_FilterOperand;
+
+typedef struct {
+    UA_FilterOperator op;
+    UA_StatusCode status; /* Set if the element cannot be evaluated */
+    size_t element;       /* Index of the element in the ContentFilter */
+    size_t operandsSize;
+    UA_FilterOperand *operands;
+} UA_FilterInstruction;
+
+typedef struct {
+    const UA_Variant *value;     /* Points into the filter of the program */
+    const UA_DataType *castType; /* Target type of the last implicit cast */
+    UA_Variant cast;
+} UA_FilterLiteral;
+
+typedef struct {
+    const UA_SimpleAttributeOperand *sao; /* Points into the filter */
+    UA_NumericRange range;                /* Parsed IndexRange */
+    UA_StatusCode rangeStatus;
+} UA_FilterField;
+
+typedef enum {
+    UA_SELECTCHECK_NONE = 0,  /* TypeDefinition is the BaseEventType */
+    UA_SELECTCHECK_EVENT,     /* EventType must be a subtype of BaseEventType */
+    UA_SELECTCHECK_CONDITION  /* Also allow subtypes of ConditionType */
+} UA_SelectCheck;
+
+typedef struct {
+    size_t field;
+    UA_SelectCheck check;
+    UA_Boolean move; /* Last use of the field. Move instead of copying. */
+} UA_FilterSelect;
+
+/* Fixed positions in the list of types */
+#define UA_FILTERTYPE_BASEEVENTTYPE 0
+#define UA_FILTERTYPE_CONDITIONTYPE 1
+
+struct UA_EventFilterProgram {
+    LIST_ENTRY(UA_EventFilterProgram) listEntry;
+    size_t refCount; /* Number of MonitoredItems using the program */
+    UA_UInt32 hash;  /* Hash of the encoded filter */
+    UA_EventFilter filter;
+
+    size_t instructionsSize;
+    UA_FilterInstruction *instructions; /* In evaluation order */
+    UA_FilterOperand *operands;
+    size_t literalsSize;
+    UA_FilterLiteral *literals;
+    size_t fieldsSize;
+    UA_FilterField *fields;
+    UA_FilterSelect *selects; /* One for each select-clause */
+
+    /* The results of the type checks are memoized for the last EventType.
+     * They are reset when a HasSubtype reference changes (this always
+     * increases the eventEmitVersion). */
+    size_t typesSize;
+    UA_NodeId *types; /* Shallow copies. Point into the filter. */
+    UA_Ternary *typeResults; /* UA_TERNARY_NULL if not yet checked */
+    UA_NodeId typesEventType;
+    UA_UInt32 typesVersion;
+
+    /* Result of the last evaluation (only if the program is shared) */
+    UA_UInt64 lastEvent;
+    const UA_Session *lastSession;
+    UA_StatusCode lastResult;
+    UA_EventFieldList lastFields;
+};
+
+static const UA_NodeId baseEventTypeId =
+    {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_BASEEVENTTYPE}};
+static const UA_NodeId conditionTypeId =
+    {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_CONDITIONTYPE}};
+
+static void
+UA_EventFilterProgram_delete(UA_EventFilterProgram *p) {
+    for(size_t i = 0; i < p->literalsSize; i++)
+        UA_Variant_clear(&p->literals[i].cast);
+    for(size_t i = 0; i < p->fieldsSize; i++)
+        UA_free(p->fields[i].range.dimensions);
+    UA_free(p->instructions);
+    UA_free(p->operands);
+    UA_free(p->literals);
+    UA_free(p->fields);
+    UA_free(p->selects);
+    UA_free(p->types);
+    UA_free(p->typeResults);
+    UA_NodeId_clear(&p->typesEventType);
+    UA_EventFieldList_clear(&p->lastFields);
+    UA_EventFilter_clear(&p->filter);
+    UA_free(p);
+}
+
 /* Filter Evaluation
  * ----------------- */
 
+typedef struct {
+    UA_Variant value;
+    UA_StatusCode status;
+    UA_Boolean resolved;
+} UA_FilterFieldValue;
+
+/* Evaluations with up to this number of fields do not allocate */
+#define UA_FILTER_STACKFIELDS 16
+
 typedef struct {
     UA_Server *server;
     UA_Session *session;
     const UA_NodeId *eventNode;
-    const UA_ContentFilter *filter;
-    UA_ContentFilterResult *filterResult;
+    const UA_KeyValueMap *eventFields; /* For transient events */
+    UA_EventFilterProgram *program;
+    UA_ContentFilterResult *filterResult; /* Can be NULL */
     UA_Variant results[UA_EVENTFILTER_MAXELEMENTS];
+    UA_FilterFieldValue *fieldValues;
+
+    /* The EventType is read only once */
+    UA_Boolean eventTypeRead;
+    UA_StatusCode eventTypeStatus;
+    UA_Variant eventType;
 
     /* The stack contains temporary variants. Cleaned up after the evaluation of
      * each operator. */
@@ -469,6 +602,62 @@ typedef struct {
  * ~~~~~~~~~~~~~~~~~
  * Methods that all resolve an operator operand to a Variant. */
 
+/* Transient events keep their fields in a key/value map. The key is the
+ * BrowseName of the field. For nested fields the BrowseNames along the path are
+ * joined with a slash (and must all have the namespace index of the key). */
+static const UA_Variant *
+findEventField(const UA_KeyValueMap *eventFields,
+               size_t browsePathSize, const UA_QualifiedName *browsePath) {
+    if(!eventFields || browsePathSize == 0)
+        return NULL;
+    for(size_t i = 0; i < eventFields->mapSize; i++) {
+        const UA_QualifiedName *key = &eventFields->map[i].key;
+        const UA_Byte *pos = key->name.data;
+        const UA_Byte *end = &key->name.data[key->name.length];
+        size_t j = 0;
+        for(; j < browsePathSize; j++) {
+            const UA_QualifiedName *elem = &browsePath[j];
+            if(elem->namespaceIndex != key->namespaceIndex ||
+               (size_t)(end - pos) < elem->name.length ||
+               (elem->name.length > 0 &&
+                memcmp(pos, elem->name.data, elem->name.length) != 0))
+                break;
+            pos += elem->name.length;
+            if(j + 1 < browsePathSize) {
+                if(pos == end || *pos != '/')
+                    break;
+                pos++;
+            }
+        }
+        if(j == browsePathSize && pos == end)
+            return &eventFields->map[i].value;
+    }
+    return NULL;
+}
+
+static UA_StatusCode
+resolveEventField(const UA_KeyValueMap *eventFields,
+                  const UA_FilterField *f, UA_Variant *value) {
+    /* Transient events have no node attributes other than the field values */
+    const UA_SimpleAttributeOperand *sao = f->sao;
+    if(sao->attributeId != UA_ATTRIBUTEID_VALUE)
+        return UA_STATUSCODE_BADATTRIBUTEIDINVALID;
+
+    const UA_Variant *field =
+        findEventField(eventFields, sao->browsePathSize, sao->browsePath);
+    if(!field)
+        return UA_STATUSCODE_BADNOTFOUND;
+    if(UA_Variant_isEmpty(field))
+        return UA_STATUSCODE_BADNODATAAVAILABLE;
+
+    /* Copy the field (or only the index range) */
+    if(sao->indexRange.length == 0)
+        return UA_Variant_copy(field, value);
+    if(f->rangeStatus != UA_STATUSCODE_GOOD)
+        return f->rangeStatus;
+    return UA_Variant_copyRange(field, value, f->range);
+}
+
 /* Part 4, 7.4.4.5 SimpleAttributeOperand: The clause can point to any attribute
  * of nodes. Either a child of the event node and also the event type. */
 static UA_StatusCode
@@ -491,7 +680,6 @@ resolveSimpleAttributeOperand(UA_Server *server, UA_Session *session,
 
         /* A Condition is an indirection. Look up the target node. */
         /* TODO: check for Branches! One Condition could have multiple Branches */
-        UA_NodeId conditionTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_CONDITIONTYPE);
         if(UA_NodeId_equal(&sao->typeDefinitionId, &conditionTypeId)) {
 #ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
             UA_StatusCode res = UA_getConditionId(server, origin, &rvi.nodeId);
@@ -535,142 +723,203 @@ resolveSimpleAttributeOperand(UA_Server *server, UA_Session *session,
     return UA_STATUSCODE_GOOD;
 }
 
+/* Fields are resolved once and then reused during the evaluation */
 static UA_StatusCode
-resolveOperand(UA_FilterEvalContext *ctx, UA_ExtensionObject *op, UA_Variant *out) {
-    if(op->encoding != UA_EXTENSIONOBJECT_DECODED &&
-       op->encoding != UA_EXTENSIONOBJECT_DECODED_NODELETE)
-        return UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED;
-
-    /* Result of an operator that was evaluated prior */
-    if(op->content.decoded.type == &UA_TYPES[UA_TYPES_ELEMENTOPERAND]) {
-        UA_ElementOperand *eo = (UA_ElementOperand*)op->content.decoded.data;
-        *out = ctx->results[eo->index];
-        out->storageType = UA_VARIANT_DATA_NODELETE;
-        return UA_STATUSCODE_GOOD;
-    }
-
-    /* Literal value */
-    if(op->content.decoded.type == &UA_TYPES[UA_TYPES_LITERALOPERAND]) {
-        UA_LiteralOperand *lo = (UA_LiteralOperand*)op->content.decoded.data;
-        *out = lo->value;
-        out->storageType = UA_VARIANT_DATA_NODELETE;
-        return UA_STATUSCODE_GOOD;
+resolveField(UA_FilterEvalContext *ctx, size_t index, UA_Variant **out) {
+    UA_FilterFieldValue *fv = &ctx->fieldValues[index];
+    if(!fv->resolved) {
+        const UA_FilterField *f = &ctx->program->fields[index];
+        if(ctx->eventNode)
+            fv->status = resolveSimpleAttributeOperand(ctx->server, ctx->session,
+                                                       ctx->eventNode, f->sao,
+                                                       &fv->value);
+        else
+            fv->status = resolveEventField(ctx->eventFields, f, &fv->value);
+        fv->resolved = true;
     }
+    *out = &fv->value;
+    return fv->status;
+}
 
-    /* SimpleAttributeOperand with a BrowsePath */
-    if(op->content.decoded.type == &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]) {
-        UA_SimpleAttributeOperand *sao =
-            (UA_SimpleAttributeOperand*)op->content.decoded.data;
-        return resolveSimpleAttributeOperand(ctx->server, ctx->session,
-                                             ctx->eventNode, sao, out);
+static UA_StatusCode
+resolveOperand(UA_FilterEvalContext *ctx, const UA_FilterOperand *op, UA_Variant *out) {
+    UA_Variant *field;
+    UA_StatusCode res;
+    switch(op->kind) {
+    case UA_FILTEROPERANDKIND_ELEMENT:
+        *out = ctx->results[op->index];
+        break;
+    case UA_FILTEROPERANDKIND_LITERAL:
+        *out = *ctx->program->literals[op->index].value;
+        break;
+    case UA_FILTEROPERANDKIND_TYPE:
+        UA_Variant_setScalar(out, &ctx->program->types[op->index],
+                             &UA_TYPES[UA_TYPES_NODEID]);
+        break;
+    case UA_FILTEROPERANDKIND_FIELD:
+        res = resolveField(ctx, op->index, &field);
+        UA_CHECK_STATUS(res, return res);
+        *out = *field;
+        break;
+    default:
+        return UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED;
     }
-
-    return UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED;
+    out->storageType = UA_VARIANT_DATA_NODELETE;
+    return UA_STATUSCODE_GOOD;
 }
 
 /* The operandIndex is within the operator arguments, not the operand index for
  * the overall stack */
 static UA_StatusCode
-setOperandError(UA_FilterEvalContext *ctx, size_t elementIndex,
+setOperandError(UA_FilterEvalContext *ctx, const UA_FilterInstruction *in,
                 size_t operandIndex, UA_StatusCode statusCode) {
-    UA_ContentFilterElementResult *res = &ctx->filterResult->elementResults[elementIndex];
-    res->operandStatusCodes[operandIndex] = statusCode;
+    UA_ContentFilterResult *cfr = ctx->filterResult;
+    if(!cfr || in->element >= cfr->elementResultsSize)
+        return statusCode;
+    UA_ContentFilterElementResult *res = &cfr->elementResults[in->element];
+    if(operandIndex < res->operandStatusCodesSize)
+        res->operandStatusCodes[operandIndex] = statusCode;
     /* The operator status is set globally in a single location upwards the call chain
      * res->statusCode = statusCode; */
     return statusCode;
 }
 
+static const UA_QualifiedName eventTypeName = {0, {9, (UA_Byte*)"EventType"}};
+
+/* Read the EventType once per evaluation */
+static UA_StatusCode
+getEventType(UA_FilterEvalContext *ctx, const UA_NodeId **out) {
+    if(!ctx->eventTypeRead) {
+        ctx->eventTypeRead = true;
+        if(ctx->eventNode) {
+            ctx->eventTypeStatus =
+                readObjectProperty(ctx->server, *ctx->eventNode,
+                                   eventTypeName, &ctx->eventType);
+        } else {
+            const UA_Variant *field = findEventField(ctx->eventFields, 1, &eventTypeName);
+            ctx->eventTypeStatus = (field) ?
+                UA_Variant_copy(field, &ctx->eventType) : UA_STATUSCODE_BADNOTFOUND;
+        }
+        if(ctx->eventTypeStatus == UA_STATUSCODE_GOOD &&
+           !UA_Variant_hasScalarType(&ctx->eventType, &UA_TYPES[UA_TYPES_NODEID]))
+            ctx->eventTypeStatus = UA_STATUSCODE_BADINTERNALERROR;
+    }
+    if(ctx->eventTypeStatus == UA_STATUSCODE_GOOD)
+        *out = (const UA_NodeId*)ctx->eventType.data;
+    return ctx->eventTypeStatus;
+}
+
+/* Is the EventType equal to the type or a subtype of it? Memoized in the
+ * program for the last EventType. */
+static UA_Boolean
+isEventOfType(UA_FilterEvalContext *ctx, const UA_NodeId *eventType,
+              size_t typeIndex) {
+    UA_EventFilterProgram *p = ctx->program;
+    if(p->typesVersion != ctx->server->eventEmitVersion ||
+       !UA_NodeId_equal(&p->typesEventType, eventType)) {
+        UA_NodeId_clear(&p->typesEventType);
+        for(size_t i = 0; i < p->typesSize; i++)
+            p->typeResults[i] = UA_TERNARY_NULL;
+        if(UA_NodeId_copy(eventType, &p->typesEventType) != UA_STATUSCODE_GOOD)
+            return isNodeInTree_singleRef(ctx->server, eventType, &p->types[typeIndex],
+                                          UA_REFERENCETYPEINDEX_HASSUBTYPE);
+        p->typesVersion = ctx->server->eventEmitVersion;
+    }
+    if(p->typeResults[typeIndex] == UA_TERNARY_NULL)
+        p->typeResults[typeIndex] =
+            isNodeInTree_singleRef(ctx->server, eventType, &p->types[typeIndex],
+                                   UA_REFERENCETYPEINDEX_HASSUBTYPE) ?
+            UA_TERNARY_TRUE : UA_TERNARY_FALSE;
+    return (p->typeResults[typeIndex] == UA_TERNARY_TRUE);
+}
+
 /* Filter Operators
  * ~~~~~~~~~~~~~~~~ */
 
 static UA_StatusCode
-ofTypeOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter->elements[index];
-    UA_assert(elm->filterOperandsSize == 1);
-
-    /* Get the operand. Must be a literal NodeId */
-    UA_Variant *op0 = &ctx->stack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
-    if(res != UA_STATUSCODE_GOOD || !UA_Variant_hasScalarType(op0, &UA_TYPES[UA_TYPES_NODEID]))
-        return setOperandError(ctx, index, 0, UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED);
+ofTypeOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *in) {
+    UA_assert(in->operandsSize == 1);
+
+    /* Get the operand. Must be a literal NodeId (compiled into a type index) */
+    const UA_FilterOperand *op = &in->operands[0];
+    const UA_NodeId *operandTypeId = NULL;
+    if(op->kind != UA_FILTEROPERANDKIND_TYPE) {
+        UA_Variant *op0 = &ctx->stack[ctx->top++];
+        UA_StatusCode res = resolveOperand(ctx, op, op0);
+        if(res != UA_STATUSCODE_GOOD ||
+           !UA_Variant_hasScalarType(op0, &UA_TYPES[UA_TYPES_NODEID]))
+            return setOperandError(ctx, in, 0, UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED);
+        operandTypeId = (const UA_NodeId*)op0->data;
+    }
 
     /* Read the event type */
-    UA_Variant eventTypeVar;
-    UA_Variant_init(&eventTypeVar);
-    const UA_NodeId *operandTypeId = (const UA_NodeId *)op0->data;
-    res = readObjectProperty(ctx->server, *ctx->eventNode,
-                             UA_QUALIFIEDNAME(0, "EventType"), &eventTypeVar);
-    UA_CHECK_STATUS(res, return res);
-
-    if(!UA_Variant_hasScalarType(&eventTypeVar, &UA_TYPES[UA_TYPES_NODEID])) {
+    const UA_NodeId *eventTypeId = NULL;
+    UA_StatusCode res = getEventType(ctx, &eventTypeId);
+    if(res == UA_STATUSCODE_BADINTERNALERROR)
         UA_LOG_WARNING(ctx->server->config.logging, UA_LOGCATEGORY_SERVER,
                        "EventType has an invalid type.");
-        UA_Variant_clear(&eventTypeVar);
-        return UA_STATUSCODE_BADINTERNALERROR;
-    }
+    UA_CHECK_STATUS(res, return res);
 
     /* Check if the eventtype is equal to the operand or a subtype of it */
-    const UA_NodeId *eventTypeId = (UA_NodeId*)eventTypeVar.data;
-    UA_Boolean ofType = isNodeInTree_singleRef(ctx->server, eventTypeId, operandTypeId,
-                                               UA_REFERENCETYPEINDEX_HASSUBTYPE);
-    ctx->results[index] = t2v(ofType ? UA_TERNARY_TRUE : UA_TERNARY_FALSE);
-    UA_Variant_clear(&eventTypeVar);
+    UA_Boolean ofType = (operandTypeId) ?
+        isNodeInTree_singleRef(ctx->server, eventTypeId, operandTypeId,
+                               UA_REFERENCETYPEINDEX_HASSUBTYPE) :
+        isEventOfType(ctx, eventTypeId, op->index);
+    ctx->results[in->element] = t2v(ofType ? UA_TERNARY_TRUE : UA_TERNARY_FALSE);
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-andOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter->elements[index];
-    UA_assert(elm->filterOperandsSize == 2);
+andOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *in) {
+    UA_assert(in->operandsSize == 2);
     UA_Variant *op0 = &ctx->stack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &in->operands[0], op0);
     UA_CHECK_STATUS(res, return res);
     UA_Variant *op1 = &ctx->stack[ctx->top++];
-    res = resolveOperand(ctx, &elm->filterOperands[1], op1);
+    res = resolveOperand(ctx, &in->operands[1], op1);
     UA_CHECK_STATUS(res, return res);
-    ctx->results[index] = t2v(UA_Ternary_and(v2t(op0), v2t(op1)));
+    ctx->results[in->element] = t2v(UA_Ternary_and(v2t(op0), v2t(op1)));
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-orOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter->elements[index];
-    UA_assert(elm->filterOperandsSize == 2);
+orOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *in) {
+    UA_assert(in->operandsSize == 2);
     UA_Variant *op0 = &ctx->stack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &in->operands[0], op0);
     UA_CHECK_STATUS(res, return res);
     UA_Variant *op1 = &ctx->stack[ctx->top++];
-    res = resolveOperand(ctx, &elm->filterOperands[1], op1);
+    res = resolveOperand(ctx, &in->operands[1], op1);
     UA_CHECK_STATUS(res, return res);
-    ctx->results[index] = t2v(UA_Ternary_or(v2t(op0), v2t(op1)));
+    ctx->results[in->element] = t2v(UA_Ternary_or(v2t(op0), v2t(op1)));
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-notOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter->elements[index];
-    UA_assert(elm->filterOperandsSize == 1);
+notOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *in) {
+    UA_assert(in->operandsSize == 1);
     UA_Variant *op0 = &ctx->stack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &in->operands[0], op0);
     UA_CHECK_STATUS(res, return res);
-    ctx->results[index] = t2v(UA_Ternary_not(v2t(op0)));
+    ctx->results[in->element] = t2v(UA_Ternary_not(v2t(op0)));
     return UA_STATUSCODE_GOOD;
 }
 
 /* Resolves the operands and casts them implicitly to the same type.
- * The result is set at &ctx->stack[ctx->top] (for the initial value of top). */
+ * The result is set at &ctx->stack[ctx->top] (for the initial value of top).
+ * The cast of literal operands is kept in the program. */
 static UA_StatusCode
-castResolveOperands(UA_FilterEvalContext *ctx, size_t index, UA_Boolean setError) {
+castResolveOperands(UA_FilterEvalContext *ctx, const UA_FilterInstruction *in,
+                    UA_Boolean setError) {
     /* Enough space on the stack left? */
-    const UA_ContentFilterElement *elm = &ctx->filter->elements[index];
-    if(ctx->top + elm->filterOperandsSize > UA_EVENTFILTER_MAXOPERANDS)
+    if(ctx->top + in->operandsSize > UA_EVENTFILTER_MAXOPERANDS)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
     /* Resolve all operands */
     UA_assert(ctx->top == 0); /* Assume the stack is empty */
     UA_StatusCode res = UA_STATUSCODE_GOOD;
-    for(size_t i = 0; i < elm->filterOperandsSize; i++) {
-        res = resolveOperand(ctx, &elm->filterOperands[i], &ctx->stack[ctx->top++]);
+    for(size_t i = 0; i < in->operandsSize; i++) {
+        res = resolveOperand(ctx, &in->operands[i], &ctx->stack[ctx->top++]);
         UA_CHECK_STATUS(res, return res);
     }
     UA_assert(ctx->top > 0); /* Assume the stack is no longer empty */
@@ -681,15 +930,26 @@ castResolveOperands(UA_FilterEvalContext *ctx, size_t index, UA_Boolean setError
         if(targetType)
             targetType = implicitCastTargetType(targetType, ctx->stack[pos].type);
         if(!targetType)
-            return (setError) ? setOperandError(ctx, index, pos, res) : res;
+            return (setError) ? setOperandError(ctx, in, pos, res) : res;
     }
 
     /* Cast the operands. Put the result in the same location on the stack. */
     for(size_t pos = 0; pos < ctx->top; pos++) {
+        /* Reuse the last cast of the literal */
+        UA_FilterLiteral *lit = NULL;
+        if(in->operands[pos].kind == UA_FILTEROPERANDKIND_LITERAL) {
+            lit = &ctx->program->literals[in->operands[pos].index];
+            if(lit->castType == targetType) {
+                ctx->stack[pos] = lit->cast;
+                ctx->stack[pos].storageType = UA_VARIANT_DATA_NODELETE;
+                continue;
+            }
+        }
+
         UA_Variant orig = ctx->stack[pos];
         res = castImplicit(&orig, targetType, &ctx->stack[pos]);
         if(res != UA_STATUSCODE_GOOD)
-            return (setError) ? setOperandError(ctx, index, pos, res) : res;
+            return (setError) ? setOperandError(ctx, in, pos, res) : res;
         if(ctx->stack[pos].data == orig.data) {
             /* Reuse the storage type of the original data if the variant is
              * identical or only the type has changed */
@@ -697,34 +957,43 @@ castResolveOperands(UA_FilterEvalContext *ctx, size_t index, UA_Boolean setError
         } else {
             UA_Variant_clear(&orig); /* Fresh allocation of the cast variant. Clean up. */
         }
+
+        /* Keep the cast of the literal in the program */
+        if(lit) {
+            UA_Variant_clear(&lit->cast);
+            lit->cast = ctx->stack[pos];
+            lit->castType = targetType;
+            ctx->stack[pos].storageType = UA_VARIANT_DATA_NODELETE;
+        }
     }
 
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-compareOperator(UA_FilterEvalContext *ctx, size_t index, UA_FilterOperator op) {
-    UA_assert(ctx->filter->elements[index].filterOperandsSize == 2);
+compareOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *in) {
+    UA_assert(in->operandsSize == 2);
 
     /* Resolve and cast the operands. A failed casting results in FALSE. Note
      * that operands could cast to NULL. */
     UA_assert(ctx->top == 0); /* Assume the stack is empty */
-    UA_StatusCode res = castResolveOperands(ctx, index, false);
+    UA_StatusCode res = castResolveOperands(ctx, in, false);
     if(res != UA_STATUSCODE_GOOD || !ctx->stack[0].type ||
        ctx->stack[0].type != ctx->stack[1].type) {
-        ctx->results[index] = t2v(UA_TERNARY_FALSE);
+        ctx->results[in->element] = t2v(UA_TERNARY_FALSE);
         return UA_STATUSCODE_GOOD;
     }
     UA_assert(ctx->top == 2); /* Assume the stack is no longer empty */
 
     /* The equals operator is always possible. For the other comparisons it has
      * to be an ordered type: Numerical, Boolean, StatusCode or DateTime. */
+    UA_FilterOperator op = in->op;
     const UA_DataType *type = ctx->stack[0].type;
     if(op != UA_FILTEROPERATOR_EQUALS && !UA_DataType_isNumeric(type) &&
        type->typeKind != UA_DATATYPEKIND_BOOLEAN &&
        type->typeKind != UA_DATATYPEKIND_STATUSCODE &&
        type->typeKind != UA_DATATYPEKIND_DATETIME)
-        return setOperandError(ctx, index, 0, UA_STATUSCODE_BADFILTEROPERANDINVALID);
+        return setOperandError(ctx, in, 0, UA_STATUSCODE_BADFILTEROPERANDINVALID);
 
     /* Compute the order */
     UA_Order eq = UA_order(ctx->stack[0].data, ctx->stack[1].data, type);
@@ -754,42 +1023,17 @@ compareOperator(UA_FilterEvalContext *ctx, size_t index, UA_FilterOperator op) {
     }
 
     /* Set result as a literal value */
-    ctx->results[index] = t2v(operatorResult);
+    ctx->results[in->element] = t2v(operatorResult);
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-equalsOperator(UA_FilterEvalContext *ctx, size_t index) {
-    return compareOperator(ctx, index, UA_FILTEROPERATOR_EQUALS);
-}
-
-static UA_StatusCode
-gtOperator(UA_FilterEvalContext *ctx, size_t index) {
-    return compareOperator(ctx, index, UA_FILTEROPERATOR_GREATERTHAN);
-}
-
-static UA_StatusCode
-ltOperator(UA_FilterEvalContext *ctx, size_t index) {
-    return compareOperator(ctx, index, UA_FILTEROPERATOR_LESSTHAN);
-}
-
-static UA_StatusCode
-gteOperator(UA_FilterEvalContext *ctx, size_t index) {
-    return compareOperator(ctx, index, UA_FILTEROPERATOR_GREATERTHANOREQUAL);
-}
-
-static UA_StatusCode
-lteOperator(UA_FilterEvalContext *ctx, size_t index) {
-    return compareOperator(ctx, index, UA_FILTEROPERATOR_LESSTHANOREQUAL);
-}
-
-static UA_StatusCode
-bitwiseOperator(UA_FilterEvalContext *ctx, size_t index, UA_FilterOperator op) {
-    UA_assert(ctx->filter->elements[index].filterOperandsSize == 2);
+bitwiseOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *in) {
+    UA_assert(in->operandsSize == 2);
 
     /* Resolve and cast the operands. Note that operands could cast to NULL. */
     UA_assert(ctx->top == 0); /* Assume the stack is empty */
-    UA_StatusCode res = castResolveOperands(ctx, index, true);
+    UA_StatusCode res = castResolveOperands(ctx, in, true);
     UA_CHECK_STATUS(res, return res);
     UA_assert(ctx->top == 2); /* Assume we have two elements */
 
@@ -800,14 +1044,15 @@ bitwiseOperator(UA_FilterEvalContext *ctx, size_t index, UA_FilterOperator op) {
         return UA_STATUSCODE_BADTYPEMISMATCH;
 
     /* Copy the casted literal to the result */
-    res = UA_Variant_copy(&ctx->stack[0], &ctx->results[index]);
+    UA_Variant *result = &ctx->results[in->element];
+    res = UA_Variant_copy(&ctx->stack[0], result);
     UA_CHECK_STATUS(res, return res);
 
     /* Do the bitwise operation on the result data */
-    UA_Byte *bytesOut = (UA_Byte*)ctx->results[index].data;
+    UA_Byte *bytesOut = (UA_Byte*)result->data;
     const UA_Byte *bytes2 = (const UA_Byte*)ctx->stack[1].data;
     for(size_t i = 0; i < type->memSize; i++) {
-        if(op == UA_FILTEROPERATOR_BITWISEAND)
+        if(in->op == UA_FILTEROPERATOR_BITWISEAND)
             bytesOut[i] = bytesOut[i] & bytes2[i];
         else
             bytesOut[i] = bytesOut[i] | bytes2[i];
@@ -816,25 +1061,15 @@ bitwiseOperator(UA_FilterEvalContext *ctx, size_t index, UA_FilterOperator op) {
 }
 
 static UA_StatusCode
-bitwiseAndOperator(UA_FilterEvalContext *ctx, size_t index) {
-    return bitwiseOperator(ctx, index, UA_FILTEROPERATOR_BITWISEAND);
-}
-
-static UA_StatusCode
-bitwiseOrOperator(UA_FilterEvalContext *ctx, size_t index) {
-    return bitwiseOperator(ctx, index, UA_FILTEROPERATOR_BITWISEOR);
-}
-
-static UA_StatusCode
-betweenOperator(UA_FilterEvalContext *ctx, size_t index) {
-    UA_assert(ctx->filter->elements[index].filterOperandsSize == 3);
+betweenOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *in) {
+    UA_assert(in->operandsSize == 3);
 
     /* If no implicit conversion is available and the operands are of different
      * types, the particular result is FALSE. */
     UA_assert(ctx->top == 0); /* Assume the stack is empty */
-    UA_StatusCode res = castResolveOperands(ctx, index, false);
+    UA_StatusCode res = castResolveOperands(ctx, in, false);
     if(res != UA_STATUSCODE_GOOD) {
-        ctx->results[index] = t2v(UA_TERNARY_FALSE);
+        ctx->results[in->element] = t2v(UA_TERNARY_FALSE);
         return UA_STATUSCODE_GOOD;
     }
     UA_assert(ctx->top == 3); /* Assume we have three elements */
@@ -851,63 +1086,60 @@ betweenOperator(UA_FilterEvalContext *ctx, size_t index) {
                        (o2 == UA_ORDER_LESS || o2 == UA_ORDER_EQ)) ?
         UA_TERNARY_TRUE : UA_TERNARY_FALSE;
 
-    ctx->results[index] = t2v(comp);
+    ctx->results[in->element] = t2v(comp);
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-inListOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter->elements[index];
-    UA_assert(elm->filterOperandsSize >= 2);
+inListOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *in) {
+    UA_assert(in->operandsSize >= 2);
     UA_Boolean found = false;
     UA_Variant *op0 = &ctx->stack[ctx->top++];
     UA_Variant *op1 = &ctx->stack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &in->operands[0], op0);
     UA_CHECK_STATUS(res, return res);
-    for(size_t i = 1; i < elm->filterOperandsSize && !found; i++) {
-        res = resolveOperand(ctx, &elm->filterOperands[i], op1);
+    for(size_t i = 1; i < in->operandsSize && !found; i++) {
+        res = resolveOperand(ctx, &in->operands[i], op1);
         if(res != UA_STATUSCODE_GOOD)
             continue;
         if(op0->type == op1->type && UA_equal(op0->data, op1->data, op0->type))
             found = true;
         UA_Variant_clear(op1);
     }
-    ctx->results[index] = t2v((found) ? UA_TERNARY_TRUE: UA_TERNARY_FALSE);
+    ctx->results[in->element] = t2v((found) ? UA_TERNARY_TRUE: UA_TERNARY_FALSE);
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-isNullOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter->elements[index];
-    UA_assert(elm->filterOperandsSize == 1);
+isNullOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *in) {
+    UA_assert(in->operandsSize == 1);
     UA_Variant *op0 = &ctx->stack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &in->operands[0], op0);
     UA_CHECK_STATUS(res, return res);
-    ctx->results[index] = t2v(UA_Variant_isEmpty(op0) ? UA_TERNARY_TRUE : UA_TERNARY_FALSE);
+    ctx->results[in->element] =
+        t2v(UA_Variant_isEmpty(op0) ? UA_TERNARY_TRUE : UA_TERNARY_FALSE);
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-notImplementedOperator(UA_FilterEvalContext *ctx, size_t index) {
+notImplementedOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *in) {
     return UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED;
 }
 
-/* Filter Evaluation
- * ~~~~~~~~~~~~~~~~~ */
-
 typedef struct {
-    UA_StatusCode (*operatorMethod)(UA_FilterEvalContext *ctx, size_t index);
+    UA_StatusCode (*operatorMethod)(UA_FilterEvalContext *ctx,
+                                    const UA_FilterInstruction *in);
     UA_Byte minOperatorCount;
     UA_Byte maxOperatorCount;
 } UA_FilterOperatorJumptableElement;
 
 static const UA_FilterOperatorJumptableElement operatorJumptable[18] = {
-    {equalsOperator, 2, 2},
+    {compareOperator, 2, 2}, /* equals */
     {isNullOperator, 1, 1},
-    {gtOperator, 2, 2},
-    {ltOperator, 2, 2},
-    {gteOperator, 2, 2},
-    {lteOperator, 2, 2},
+    {compareOperator, 2, 2}, /* greater than */
+    {compareOperator, 2, 2}, /* less than */
+    {compareOperator, 2, 2}, /* greater than or equal */
+    {compareOperator, 2, 2}, /* less than or equal */
     {notImplementedOperator, 0, UA_EVENTFILTER_MAXOPERANDS}, /* like */
     {notOperator, 1, 1},
     {betweenOperator, 3, 3},
@@ -918,40 +1150,293 @@ static const UA_FilterOperatorJumptableElement operatorJumptable[18] = {
     {notImplementedOperator, 0, UA_EVENTFILTER_MAXOPERANDS}, /* in view */
     {ofTypeOperator, 1, 1},
     {notImplementedOperator, 0, UA_EVENTFILTER_MAXOPERANDS}, /* related to */
-    {bitwiseAndOperator, 2, 2},
-    {bitwiseOrOperator, 2, 2}
+    {bitwiseOperator, 2, 2}, /* bitwise and */
+    {bitwiseOperator, 2, 2}  /* bitwise or */
 };
 
+/* Program Compilation
+ * ~~~~~~~~~~~~~~~~~~~ */
+
+static size_t
+addField(UA_EventFilterProgram *p, const UA_SimpleAttributeOperand *sao) {
+    for(size_t i = 0; i < p->fieldsSize; i++) {
+        if(UA_equal(p->fields[i].sao, sao, &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]))
+            return i;
+    }
+    UA_FilterField *f = &p->fields[p->fieldsSize];
+    f->sao = sao;
+    if(sao->indexRange.length > 0 &&
+       UA_NumericRange_parse(&f->range, sao->indexRange) != UA_STATUSCODE_GOOD)
+        f->rangeStatus = UA_STATUSCODE_BADINDEXRANGEINVALID;
+    return p->fieldsSize++;
+}
+
+static size_t
+addType(UA_EventFilterProgram *p, const UA_NodeId *type) {
+    for(size_t i = 0; i < p->typesSize; i++) {
+        if(UA_NodeId_equal(&p->types[i], type))
+            return i;
+    }
+    p->types[p->typesSize] = *type;
+    return p->typesSize++;
+}
+
+static void
+compileOperand(UA_EventFilterProgram *p, const UA_ExtensionObject *op,
+               size_t element, UA_FilterOperand *out) {
+    out->kind = UA_FILTEROPERANDKIND_INVALID;
+    out->index = 0;
+    if(op->encoding != UA_EXTENSIONOBJECT_DECODED &&
+       op->encoding != UA_EXTENSIONOBJECT_DECODED_NODELETE)
+        return;
+
+    /* Result of an operator that is evaluated prior */
+    if(op->content.decoded.type == &UA_TYPES[UA_TYPES_ELEMENTOPERAND]) {
+        const UA_ElementOperand *eo = (const UA_ElementOperand*)op->content.decoded.data;
+        if(eo->index <= element || eo->index >= p->filter.whereClause.elementsSize)
+            return;
+        out->kind = UA_FILTEROPERANDKIND_ELEMENT;
+        out->index = eo->index;
+        return;
+    }
+
+    /* Literal value */
+    if(op->content.decoded.type == &UA_TYPES[UA_TYPES_LITERALOPERAND]) {
+        const UA_LiteralOperand *lo = (const UA_LiteralOperand*)op->content.decoded.data;
+        UA_FilterLiteral *l = &p->literals[p->literalsSize];
+        l->value = &lo->value;
+        out->kind = UA_FILTEROPERANDKIND_LITERAL;
+        out->index = p->literalsSize++;
+        return;
+    }
+
+    /* SimpleAttributeOperand with a BrowsePath */
+    if(op->content.decoded.type == &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]) {
+        out->kind = UA_FILTEROPERANDKIND_FIELD;
+        out->index = addField(p, (const UA_SimpleAttributeOperand*)op->content.decoded.data);
+    }
+}
+
+static UA_StatusCode
+compileEventFilter(const UA_EventFilter *filter, UA_EventFilterProgram **out) {
+    UA_EventFilterProgram *p = (UA_EventFilterProgram*)
+        UA_calloc(1, sizeof(UA_EventFilterProgram));
+    if(!p)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_StatusCode res = UA_EventFilter_copy(filter, &p->filter);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_free(p);
+        return res;
+    }
+
+    /* Allocate for the upper bounds */
+    const UA_ContentFilter *cf = &p->filter.whereClause;
+    size_t operandsSize = 0;
+    for(size_t i = 0; i < cf->elementsSize; i++)
+        operandsSize += cf->elements[i].filterOperandsSize;
+    size_t selectsSize = p->filter.selectClausesSize;
+    size_t typesSize = 2 + cf->elementsSize;
+    p->instructions = (UA_FilterInstruction*)
+        UA_calloc(cf->elementsSize + 1, sizeof(UA_FilterInstruction));
+    p->operands = (UA_FilterOperand*)
+        UA_calloc(operandsSize + 1, sizeof(UA_FilterOperand));
+    p->literals = (UA_FilterLiteral*)
+        UA_calloc(operandsSize + 1, sizeof(UA_FilterLiteral));
+    p->fields = (UA_FilterField*)
+        UA_calloc(operandsSize + selectsSize + 1, sizeof(UA_FilterField));
+    p->selects = (UA_FilterSelect*)
+        UA_calloc(selectsSize + 1, sizeof(UA_FilterSelect));
+    p->types = (UA_NodeId*)UA_calloc(typesSize, sizeof(UA_NodeId));
+    p->typeResults = (UA_Ternary*)UA_calloc(typesSize, sizeof(UA_Ternary));
+    if(!p->instructions || !p->operands || !p->literals || !p->fields ||
+       !p->selects || !p->types || !p->typeResults) {
+        UA_EventFilterProgram_delete(p);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    p->types[UA_FILTERTYPE_BASEEVENTTYPE] = baseEventTypeId;
+    p->types[UA_FILTERTYPE_CONDITIONTYPE] = conditionTypeId;
+    p->typesSize = 2;
+
+    /* Iterate backwards over the filter elements. This ensures that all
+     * element-index operands point to an evaluated element. */
+    UA_FilterOperand *operands = p->operands;
+    for(size_t i = 0; i < cf->elementsSize; i++) {
+        size_t element = cf->elementsSize - 1 - i;
+        const UA_ContentFilterElement *elm = &cf->elements[element];
+        UA_FilterInstruction *in = &p->instructions[i];
+        in->op = elm->filterOperator;
+        in->element = element;
+        in->operandsSize = elm->filterOperandsSize;
+        in->operands = operands;
+        operands += elm->filterOperandsSize;
+        for(size_t j = 0; j < elm->filterOperandsSize; j++)
+            compileOperand(p, &elm->filterOperands[j], element, &in->operands[j]);
+
+        /* Unsupported operator or operand count. The validation prevents this
+         * for the MonitoredItems. */
+        if((size_t)in->op >= UA_FILTEROPERATOR_BITWISEOR + 1) {
+            in->status = UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED;
+        } else if(in->operandsSize < operatorJumptable[in->op].minOperatorCount ||
+                  in->operandsSize > operatorJumptable[in->op].maxOperatorCount) {
+            in->status = UA_STATUSCODE_BADFILTEROPERANDCOUNTMISMATCH;
+        }
+
+        /* The OfType operand is a literal NodeId. Memoize the type check. */
+        if(in->op == UA_FILTEROPERATOR_OFTYPE && in->status == UA_STATUSCODE_GOOD &&
+           in->operands[0].kind == UA_FILTEROPERANDKIND_LITERAL) {
+            const UA_Variant *v = p->literals[in->operands[0].index].value;
+            if(UA_Variant_hasScalarType(v, &UA_TYPES[UA_TYPES_NODEID])) {
+                in->operands[0].kind = UA_FILTEROPERANDKIND_TYPE;
+                in->operands[0].index = addType(p, (const UA_NodeId*)v->data);
+            }
+        }
+    }
+    p->instructionsSize = cf->elementsSize;
+
+    /* Compile the select-clauses */
+    for(size_t i = 0; i < selectsSize; i++) {
+        const UA_SimpleAttributeOperand *sao = &p->filter.selectClauses[i];
+        UA_FilterSelect *sel = &p->selects[i];
+        sel->field = addField(p, sao);
+        if(UA_NodeId_equal(&sao->typeDefinitionId, &baseEventTypeId))
+            sel->check = UA_SELECTCHECK_NONE;
+        else if(UA_NodeId_equal(&sao->typeDefinitionId, &conditionTypeId))
+            sel->check = UA_SELECTCHECK_CONDITION;
+        else
+            sel->check = UA_SELECTCHECK_EVENT;
+    }
+
+    /* The last select-clause of a field moves the value to the output */
+    for(size_t i = 0; i < selectsSize; i++) {
+        p->selects[i].move = true;
+        for(size_t j = i + 1; j < selectsSize; j++) {
+            if(p->selects[j].field == p->selects[i].field) {
+                p->selects[i].move = false;
+                break;
+            }
+        }
+    }
+
+    *out = p;
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
-evaluateWhereClause(UA_Server *server, UA_Session *session, const UA_NodeId *eventNode,
-                    const UA_ContentFilter *contentFilter,
-                    UA_ContentFilterResult *contentFilterResult) {
+UA_EventFilterProgram_acquire(UA_Server *server, const UA_EventFilter *filter,
+                              UA_EventFilterProgram **program) {
     UA_LOCK_ASSERT(&server->serviceMutex);
 
-    /* An empty filter always succeeds */
-    if(contentFilter->elementsSize == 0)
-        return UA_STATUSCODE_GOOD;
+    /* Hash the encoded filter */
+    UA_ByteString encoded = UA_BYTESTRING_NULL;
+    UA_StatusCode res =
+        UA_encodeBinary(filter, &UA_TYPES[UA_TYPES_EVENTFILTER], &encoded, NULL);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    UA_UInt32 hash = UA_ByteString_hash(0, encoded.data, encoded.length);
+    UA_ByteString_clear(&encoded);
+
+    /* Reuse the program of an identical filter */
+    UA_EventFilterProgram *p;
+    LIST_FOREACH(p, &server->eventFilterPrograms, listEntry) {
+        if(p->hash == hash &&
+           UA_equal(&p->filter, filter, &UA_TYPES[UA_TYPES_EVENTFILTER])) {
+            p->refCount++;
+            *program = p;
+            return UA_STATUSCODE_GOOD;
+        }
+    }
+
+    /* Compile a new program */
+    res = compileEventFilter(filter, &p);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    p->hash = hash;
+    p->refCount = 1;
+    LIST_INSERT_HEAD(&server->eventFilterPrograms, p, listEntry);
+    *program = p;
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_EventFilterProgram_release(UA_Server *server, UA_EventFilterProgram *program) {
+    if(!program)
+        return;
+    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_assert(program->refCount > 0);
+    program->refCount--;
+    if(program->refCount > 0)
+        return;
+    LIST_REMOVE(program, listEntry);
+    UA_EventFilterProgram_delete(program);
+}
+
+/* Filter Evaluation
+ * ~~~~~~~~~~~~~~~~~ */
+
+static UA_Boolean
+isValidEvent(UA_FilterEvalContext *ctx, UA_SelectCheck check) {
+    /* Read the EventType (the value should be a NodeId) */
+    const UA_NodeId *eventType = NULL;
+    if(getEventType(ctx, &eventType) != UA_STATUSCODE_GOOD)
+        return false;
+
+    /* Check whether the EventType is a Subtype of CondtionType (Part 9 first
+     * implementation) */
+    if(check == UA_SELECTCHECK_CONDITION &&
+       isEventOfType(ctx, eventType, UA_FILTERTYPE_CONDITIONTYPE))
+        return true;
+
+    /* EventType is not a Subtype of CondtionType (ConditionId Clause won't be
+     * present in Events, which are not Conditions) */
+    /* Check whether Valid Event other than Conditions */
+    return isEventOfType(ctx, eventType, UA_FILTERTYPE_BASEEVENTTYPE);
+}
+
+/* Evaluate the where-clause. If efl is non-NULL, apply the select-clauses. */
+static UA_StatusCode
+evaluateProgram(UA_Server *server, UA_Session *session, UA_EventFilterProgram *p,
+                const UA_NodeId *eventNode, const UA_KeyValueMap *eventFields,
+                UA_ContentFilterResult *filterResult, UA_EventFieldList *efl) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
 
     /* Prepare the context */
     UA_FilterEvalContext ctx;
-    ctx.filterResult = contentFilterResult;
-    ctx.filter = contentFilter;
     ctx.server = server;
     ctx.session = session;
     ctx.eventNode = eventNode;
+    ctx.eventFields = eventFields;
+    ctx.program = p;
+    ctx.filterResult = filterResult;
+    ctx.eventTypeRead = false;
+    ctx.eventTypeStatus = UA_STATUSCODE_GOOD;
+    UA_Variant_init(&ctx.eventType);
     ctx.top = 0;
 
     /* Pacify some compilers by initializing the first result */
     UA_Variant_init(&ctx.results[0]);
 
-    /* Evaluate the filter. Iterate backwards over the filter elements and
-     * resolve each. This ensures that all element-index operands point to an
-     * evaluated element. */
+    /* The fields are resolved on demand */
+    UA_FilterFieldValue stackFields[UA_FILTER_STACKFIELDS];
+    ctx.fieldValues = stackFields;
+    if(p->fieldsSize > UA_FILTER_STACKFIELDS) {
+        ctx.fieldValues = (UA_FilterFieldValue*)
+            UA_malloc(p->fieldsSize * sizeof(UA_FilterFieldValue));
+        if(!ctx.fieldValues)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    for(size_t i = 0; i < p->fieldsSize; i++) {
+        UA_Variant_init(&ctx.fieldValues[i].value);
+        ctx.fieldValues[i].resolved = false;
+    }
+
+    /* Evaluate the where-clause. The instructions are sorted so that all
+     * element-index operands point to an evaluated element. */
     UA_StatusCode res = UA_STATUSCODE_GOOD;
-    int i = (int)contentFilter->elementsSize - 1;
-    for(; i >= 0; i--) {
-        UA_ContentFilterElement *cfe = &contentFilter->elements[i];
-        res = operatorJumptable[cfe->filterOperator].operatorMethod(&ctx, (size_t)i);
+    size_t i = 0;
+    for(; i < p->instructionsSize; i++) {
+        const UA_FilterInstruction *in = &p->instructions[i];
+        res = (in->status != UA_STATUSCODE_GOOD) ? in->status :
+            operatorJumptable[in->op].operatorMethod(&ctx, in);
         for(size_t j = 0; j < ctx.top; j++)
             UA_Variant_clear(&ctx.stack[j]); /* clean up the stack */
         ctx.top = 0;
@@ -959,154 +1444,132 @@ evaluateWhereClause(UA_Server *server, UA_Session *session, const UA_NodeId *eve
             break;
     }
 
-    /* The filter matches if the operator at the first position evaluates to TRUE */
-    if(res == UA_STATUSCODE_GOOD && v2t(&ctx.results[0]) != UA_TERNARY_TRUE)
+    /* The filter matches if the operator at the first position evaluates to
+     * TRUE. An empty filter always succeeds. */
+    if(res == UA_STATUSCODE_GOOD && p->instructionsSize > 0 &&
+       v2t(&ctx.results[0]) != UA_TERNARY_TRUE)
         res = UA_STATUSCODE_BADNOMATCH;
 
     /* Clean up the element result variants */
-    for(int j = (int)contentFilter->elementsSize - 1; j > i; j--)
-        UA_Variant_clear(&ctx.results[j]);
+    for(size_t j = 0; j < i; j++)
+        UA_Variant_clear(&ctx.results[p->instructions[j].element]);
+
+    /* Apply the select-clauses */
+    size_t selectsSize = p->filter.selectClausesSize;
+    if(res == UA_STATUSCODE_GOOD && efl && selectsSize > 0) {
+        efl->eventFields = (UA_Variant *)
+            UA_Array_new(selectsSize, &UA_TYPES[UA_TYPES_VARIANT]);
+        if(!efl->eventFields) {
+            res = UA_STATUSCODE_BADOUTOFMEMORY;
+            goto cleanup;
+        }
+        efl->eventFieldsSize = selectsSize;
+
+        for(size_t j = 0; j < selectsSize; j++) {
+            const UA_FilterSelect *sel = &p->selects[j];
+            if(sel->check != UA_SELECTCHECK_NONE && !isValidEvent(&ctx, sel->check))
+                continue;
+
+            /* Lookup the field. The overall filter can succeed even if a
+             * single select-field cannot be resolved. */
+            UA_Variant *field;
+            if(resolveField(&ctx, sel->field, &field) != UA_STATUSCODE_GOOD)
+                continue;
+            if(sel->move) {
+                efl->eventFields[j] = *field;
+                UA_Variant_init(field);
+            } else {
+                UA_Variant_copy(field, &efl->eventFields[j]);
+            }
+        }
+    }
+
+ cleanup:
+    for(size_t j = 0; j < p->fieldsSize; j++)
+        UA_Variant_clear(&ctx.fieldValues[j].value);
+    if(ctx.fieldValues != stackFields)
+        UA_free(ctx.fieldValues);
+    UA_Variant_clear(&ctx.eventType);
     return res;
 }
 
-static UA_Boolean
-isValidEvent(UA_Server *server, const UA_NodeId *validEventParent,
-             const UA_NodeId *eventId) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+UA_StatusCode
+UA_EventFilterProgram_evaluate(UA_Server *server, UA_EventFilterProgram *program,
+                               UA_Session *session, const UA_NodeId *eventNode,
+                               const UA_KeyValueMap *eventFields, UA_UInt64 eventSeq,
+                               UA_EventFieldList *efl) {
+    UA_EventFieldList_init(efl);
 
-    /* Find the eventType variableNode */
-    UA_QualifiedName findName = UA_QUALIFIEDNAME(0, "EventType");
-    UA_BrowsePathResult bpr = browseSimplifiedBrowsePath(server, *eventId, 1, &findName);
-    if(bpr.statusCode != UA_STATUSCODE_GOOD || bpr.targetsSize < 1) {
-        UA_BrowsePathResult_clear(&bpr);
-        return false;
+    /* Reuse the result from another MonitoredItem for the same event */
+    if(eventSeq != 0 && program->lastEvent == eventSeq &&
+       program->lastSession == session) {
+        if(program->lastResult != UA_STATUSCODE_GOOD)
+            return program->lastResult;
+        return UA_EventFieldList_copy(&program->lastFields, efl);
     }
 
-    /* Get the EventType Property Node */
-    UA_Variant tOutVariant;
-    UA_Variant_init(&tOutVariant);
-    /* Read the Value of EventType Property Node (the Value should be a NodeId) */
-    UA_StatusCode retval = readWithReadValue(server, &bpr.targets[0].targetId.nodeId,
-                                             UA_ATTRIBUTEID_VALUE, &tOutVariant);
-    if(retval != UA_STATUSCODE_GOOD ||
-       !UA_Variant_hasScalarType(&tOutVariant, &UA_TYPES[UA_TYPES_NODEID])) {
-        UA_BrowsePathResult_clear(&bpr);
-        return false;
-    }
+    UA_StatusCode res = evaluateProgram(server, session, program, eventNode,
+                                        eventFields, NULL, efl);
 
-    const UA_NodeId *tEventType = (UA_NodeId*)tOutVariant.data;
+    /* Store the result if the program is shared */
+    if(eventSeq == 0 || program->refCount < 2 ||
+       (res != UA_STATUSCODE_GOOD && res != UA_STATUSCODE_BADNOMATCH))
+        return res;
+    UA_EventFieldList_clear(&program->lastFields);
+    program->lastEvent = 0;
+    if(res == UA_STATUSCODE_GOOD &&
+       UA_EventFieldList_copy(efl, &program->lastFields) != UA_STATUSCODE_GOOD)
+        return res;
+    program->lastEvent = eventSeq;
+    program->lastSession = session;
+    program->lastResult = res;
+    return res;
+}
 
-    /* Check whether the EventType is a Subtype of CondtionType (Part 9 first
-     * implementation) */
-    UA_NodeId conditionTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_CONDITIONTYPE);
-    if(UA_NodeId_equal(validEventParent, &conditionTypeId) &&
-       isNodeInTree_singleRef(server, tEventType, &conditionTypeId,
-                              UA_REFERENCETYPEINDEX_HASSUBTYPE)) {
-        UA_BrowsePathResult_clear(&bpr);
-        UA_Variant_clear(&tOutVariant);
-        return true;
-    }
+UA_StatusCode
+evaluateWhereClause(UA_Server *server, UA_Session *session, const UA_NodeId *eventNode,
+                    const UA_KeyValueMap *eventFields,
+                    const UA_ContentFilter *contentFilter,
+                    UA_ContentFilterResult *contentFilterResult) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
 
-    /* EventType is not a Subtype of CondtionType (ConditionId Clause won't be
-     * present in Events, which are not Conditions) */
-    /* Check whether Valid Event other than Conditions */
-    UA_NodeId baseEventTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
-    UA_Boolean isSubtypeOfBaseEvent =
-        isNodeInTree_singleRef(server, tEventType, &baseEventTypeId,
-                               UA_REFERENCETYPEINDEX_HASSUBTYPE);
+    /* An empty filter always succeeds */
+    if(contentFilter->elementsSize == 0)
+        return UA_STATUSCODE_GOOD;
+    if(contentFilter->elementsSize > UA_EVENTFILTER_MAXELEMENTS)
+        return UA_STATUSCODE_BADEVENTFILTERINVALID;
 
-    UA_BrowsePathResult_clear(&bpr);
-    UA_Variant_clear(&tOutVariant);
-    return isSubtypeOfBaseEvent;
+    /* Compile for a single use */
+    UA_EventFilter filter;
+    UA_EventFilter_init(&filter);
+    filter.whereClause = *contentFilter;
+    UA_EventFilterProgram *p;
+    UA_StatusCode res = compileEventFilter(&filter, &p);
+    UA_CHECK_STATUS(res, return res);
+    res = evaluateProgram(server, session, p, eventNode, eventFields,
+                          contentFilterResult, NULL);
+    UA_EventFilterProgram_delete(p);
+    return res;
 }
 
 UA_StatusCode
 filterEvent(UA_Server *server, UA_Session *session,
-            const UA_NodeId *eventNode, UA_EventFilter *filter,
-            UA_EventFieldList *efl, UA_EventFilterResult *result) {
+            const UA_NodeId *eventNode, const UA_KeyValueMap *eventFields,
+            const UA_EventFilter *filter, UA_EventFieldList *efl) {
     UA_LOCK_ASSERT(&server->serviceMutex);
 
-    if(filter->selectClausesSize == 0)
-        return UA_STATUSCODE_BADEVENTFILTERINVALID;
-
     UA_EventFieldList_init(efl);
-    efl->eventFields = (UA_Variant *)
-        UA_Array_new(filter->selectClausesSize, &UA_TYPES[UA_TYPES_VARIANT]);
-    if(!efl->eventFields)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-    efl->eventFieldsSize = filter->selectClausesSize;
-
-    /* Empty event filter result */
-    UA_EventFilterResult_init(result);
-    result->selectClauseResultsSize = filter->selectClausesSize;
-    result->selectClauseResults = (UA_StatusCode *)
-        UA_Array_new(filter->selectClausesSize, &UA_TYPES[UA_TYPES_STATUSCODE]);
-    if(!result->selectClauseResults) {
-        UA_EventFieldList_clear(efl);
-        UA_EventFilterResult_clear(result);
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-    }
-
-    /* Prepare content filter result structure */
-    if(filter->whereClause.elementsSize > 0) {
-        result->whereClauseResult.elementResultsSize = filter->whereClause.elementsSize;
-        result->whereClauseResult.elementResults = (UA_ContentFilterElementResult *)
-            UA_Array_new(filter->whereClause.elementsSize,
-                         &UA_TYPES[UA_TYPES_CONTENTFILTERELEMENTRESULT]);
-        if(!result->whereClauseResult.elementResults) {
-            UA_EventFieldList_clear(efl);
-            UA_EventFilterResult_clear(result);
-            return UA_STATUSCODE_BADOUTOFMEMORY;
-        }
-
-        for(size_t i = 0; i < filter->whereClause.elementsSize; ++i) {
-            UA_ContentFilterElementResult *er =
-                &result->whereClauseResult.elementResults[i];
-            UA_ContentFilterElement *cf = &filter->whereClause.elements[i];
-            er->operandStatusCodesSize = cf->filterOperandsSize;
-            er->operandStatusCodes = (UA_StatusCode *)
-                UA_Array_new(er->operandStatusCodesSize, &UA_TYPES[UA_TYPES_STATUSCODE]);
-            if(!er->operandStatusCodes) {
-                UA_EventFieldList_clear(efl);
-                UA_EventFilterResult_clear(result);
-                return UA_STATUSCODE_BADOUTOFMEMORY;
-            }
-        }
-    }
-
-    /* Evaluate the where filter. Do we event need to consider the event? */
-    UA_StatusCode res = evaluateWhereClause(server, session, eventNode,
-                                            &filter->whereClause,
-                                            &result->whereClauseResult);
-    if(res != UA_STATUSCODE_GOOD){
-        UA_EventFieldList_clear(efl);
-        UA_EventFilterResult_clear(result);
-        return res;
-    }
-
-    /* Apply the select filter */
-    UA_NodeId baseEventTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
-    for(size_t i = 0; i < filter->selectClausesSize; i++) {
-        UA_SimpleAttributeOperand *sc = &filter->selectClauses[i];
-        /* Check if the browsePath is BaseEventType, in which case nothing more
-         * needs to be checked */
-        if(!UA_NodeId_equal(&sc->typeDefinitionId, &baseEventTypeId) &&
-           !isValidEvent(server, &sc->typeDefinitionId, eventNode)) {
-            UA_Variant_init(&efl->eventFields[i]);
-            /* EventFilterResult currently isn't being used
-               notification->result.selectClauseResults[i] =
-                   UA_STATUSCODE_BADTYPEDEFINITIONINVALID; */
-            continue;
-        }
-
-        /* Lookup the field. The overall filter can succeed even if a single
-         * select-field cannot be resolved. */
-        result->selectClauseResults[i] =
-            resolveSimpleAttributeOperand(server, session, eventNode,
-                                          sc, &efl->eventFields[i]);
-    }
+    if(filter->selectClausesSize == 0 ||
+       filter->whereClause.elementsSize > UA_EVENTFILTER_MAXELEMENTS)
+        return UA_STATUSCODE_BADEVENTFILTERINVALID;
 
-    return UA_STATUSCODE_GOOD;
+    /* Compile for a single use */
+    UA_EventFilterProgram *p;
+    UA_StatusCode res = compileEventFilter(filter, &p);
+    UA_CHECK_STATUS(res, return res);
+    res = evaluateProgram(server, session, p, eventNode, eventFields, NULL, efl);
+    UA_EventFilterProgram_delete(p);
+    return res;
 }
 
 /*****************************************/
@@ -210,6 +210,9 @@ UA_SecureChannel_clear(UA_SecureChannel *channel) {
     /* Delete remaining chunks */
     UA_SecureChannel_deleteBuffered(channel);
 
+    /* Release the memory for decoding requests */
+    UA_Arena_clear(&channel->requestArena);
+
     /* Clean up namespace mapping */
     UA_NamespaceMapping_delete(channel->namespaceMapping);
     channel->namespaceMapping = NULL;
@@ -255,6 +258,20 @@ UA_SecureChannel_processHELACK(UA_SecureChannel *channel,
     return UA_STATUSCODE_GOOD;
 }
 
+static UA_Boolean
+beginAsymmetricCrypto(UA_SecureChannel *channel) {
+    if(!channel->beginAsymmetricCrypto)
+        return false;
+    return channel->beginAsymmetricCrypto(channel->processOPNHeaderApplication, channel);
+}
+
+static void
+endAsymmetricCrypto(UA_SecureChannel *channel, UA_Boolean released) {
+    if(channel->endAsymmetricCrypto)
+        channel->endAsymmetricCrypto(channel->processOPNHeaderApplication,
+                                     channel, released);
+}
+
 /* Sends an OPN message using asymmetric encryption if defined */
 UA_StatusCode
 UA_SecureChannel_sendAsymmetricOPNMessage(UA_SecureChannel *channel,
@@ -284,6 +301,7 @@ UA_SecureChannel_sendAsymmetricOPNMessage(UA_SecureChannel *channel,
 
     /* Define variables here to pacify some compilers wrt goto */
     size_t securityHeaderLength, pre_sig_length, total_length, encryptedLength;
+    UA_Boolean released;
 
     /* Encode the message type and content */
     UA_EncodeBinaryOptions encOpts;
@@ -320,8 +338,10 @@ UA_SecureChannel_sendAsymmetricOPNMessage(UA_SecureChannel *channel,
                              securityHeaderLength, requestId, &encryptedLength);
     UA_CHECK_STATUS(res, goto error);
 
+    released = beginAsymmetricCrypto(channel);
     res = signAndEncryptAsym(channel, pre_sig_length, &buf,
                              securityHeaderLength, total_length);
+    endAsymmetricCrypto(channel, released);
     UA_CHECK_STATUS(res, goto error);
 
     /* Send the message, the buffer is freed in the network layer */
@@ -383,16 +403,22 @@ encodeHeadersSym(UA_MessageContext *mc, size_t totalLength) {
     return res;
 }
 
+/* Send the current chunk. The optional ref is borrowed memory with the final
+ * part of the chunk payload. It is only used without signing and encryption. */
 static UA_StatusCode
-sendSymmetricChunk(UA_MessageContext *mc) {
+sendSymmetricChunk(UA_MessageContext *mc, const UA_ByteString *ref) {
     UA_SecureChannel *channel = mc->channel;
     const UA_SecurityPolicy *sp = channel->securityPolicy;
     UA_ConnectionManager *cm = channel->connectionManager;
     if(!UA_SecureChannel_isConnected(channel))
         return UA_STATUSCODE_BADCONNECTIONCLOSED;
 
+    size_t refLength = (ref) ? ref->length : 0;
+    UA_assert(refLength == 0 ||
+              channel->securityMode == UA_MESSAGESECURITYMODE_NONE);
+
     /* The size of the message payload */
-    size_t bodyLength = (uintptr_t)mc->buf_pos -
+    size_t bodyLength = refLength + (uintptr_t)mc->buf_pos -
         (uintptr_t)&mc->messageBuffer.data[UA_SECURECHANNEL_SYMMETRIC_HEADER_TOTALLENGTH];
 
     /* Early-declare variables so we can use a goto in the error case */
@@ -418,7 +444,7 @@ sendSymmetricChunk(UA_MessageContext *mc) {
 
     /* Compute the total message length */
     pre_sig_length = (uintptr_t)mc->buf_pos - (uintptr_t)mc->messageBuffer.data;
-    total_length = pre_sig_length;
+    total_length = pre_sig_length + refLength;
     if(channel->securityMode == UA_MESSAGESECURITYMODE_SIGN ||
        channel->securityMode == UA_MESSAGESECURITYMODE_SIGNANDENCRYPT)
         total_length += sp->symmetricModule.cryptoModule.signatureAlgorithm.
@@ -434,7 +460,7 @@ sendSymmetricChunk(UA_MessageContext *mc) {
     UA_assert(total_length <= channel->config.sendBufferSize);
 
     /* Adjust the buffer size of the network layer */
-    mc->messageBuffer.length = total_length;
+    mc->messageBuffer.length = total_length - refLength;
 
     /* Generate and encode the header for symmetric messages */
     res = encodeHeadersSym(mc, total_length);
@@ -447,8 +473,15 @@ sendSymmetricChunk(UA_MessageContext *mc) {
     /* Send the chunk. The buffer is freed in the network layer. If sending goes
      * wrong, the connection is removed in the next iteration of the
      * SecureChannel. Set the SecureChannel to closing already. */
-    res = cm->sendWithConnection(cm, channel->connectionId,
-                                 &UA_KEYVALUEMAP_NULL, &mc->messageBuffer);
+    if(refLength > 0) {
+        UA_ByteString bufs[2] = {mc->messageBuffer, *ref};
+        mc->messageBuffer = UA_BYTESTRING_NULL;
+        res = cm->sendWithConnectionVec(cm, channel->connectionId,
+                                        &UA_KEYVALUEMAP_NULL, bufs, 2);
+    } else {
+        res = cm->sendWithConnection(cm, channel->connectionId,
+                                     &UA_KEYVALUEMAP_NULL, &mc->messageBuffer);
+    }
     if(res != UA_STATUSCODE_GOOD && UA_SecureChannel_isConnected(channel))
         channel->state = UA_SECURECHANNELSTATE_CLOSING;
     return res;
@@ -459,6 +492,24 @@ sendSymmetricChunk(UA_MessageContext *mc) {
     return res;
 }
 
+/* Allocate the buffer for the next chunk */
+static UA_StatusCode
+nextSymmetricChunk(UA_MessageContext *mc) {
+    UA_ConnectionManager *cm = mc->channel->connectionManager;
+    if(!UA_SecureChannel_isConnected(mc->channel))
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+
+    UA_StatusCode res =
+        cm->allocNetworkBuffer(cm, mc->channel->connectionId,
+                               &mc->messageBuffer,
+                               mc->channel->config.sendBufferSize);
+    UA_CHECK_STATUS(res, return res);
+
+    /* Hide bytes for header, padding and signature */
+    setBufPos(mc);
+    return UA_STATUSCODE_GOOD;
+}
+
 /* Callback from the encoding layer. Send the chunk and replace the buffer. */
 static UA_StatusCode
 sendSymmetricEncodingCallback(void *data, UA_Byte **buf_pos,
@@ -469,21 +520,42 @@ sendSymmetricEncodingCallback(void *data, UA_Byte **buf_pos,
     mc->buf_end = *buf_end;
 
     /* Send out */
-    UA_StatusCode res = sendSymmetricChunk(mc);
+    UA_StatusCode res = sendSymmetricChunk(mc, NULL);
     UA_CHECK_STATUS(res, return res);
 
     /* Set a new buffer for the next chunk */
-    UA_ConnectionManager *cm = mc->channel->connectionManager;
-    if(!UA_SecureChannel_isConnected(mc->channel))
-        return UA_STATUSCODE_BADCONNECTIONCLOSED;
-
-    res = cm->allocNetworkBuffer(cm, mc->channel->connectionId,
-                                 &mc->messageBuffer,
-                                 mc->channel->config.sendBufferSize);
+    res = nextSymmetricChunk(mc);
     UA_CHECK_STATUS(res, return res);
+    *buf_pos = mc->buf_pos;
+    *buf_end = mc->buf_end;
+    return UA_STATUSCODE_GOOD;
+}
 
-    /* Hide bytes for header, padding and signature */
-    setBufPos(mc);
+/* Callback from the encoding layer for large arrays. Every chunk is sent with
+ * the header from the message buffer and the payload taken directly from the
+ * array memory. Only the remainder that does not fill a chunk is copied. */
+static UA_StatusCode
+sendSymmetricReferenceCallback(void *data, const UA_Byte *ref, size_t refLength,
+                               UA_Byte **buf_pos, const UA_Byte **buf_end) {
+    UA_MessageContext *mc = (UA_MessageContext *)data;
+    mc->buf_pos = *buf_pos;
+    mc->buf_end = *buf_end;
+
+    UA_StatusCode res;
+    while(refLength > (size_t)(mc->buf_end - mc->buf_pos)) {
+        UA_ByteString refChunk;
+        refChunk.length = (size_t)(mc->buf_end - mc->buf_pos);
+        refChunk.data = (UA_Byte*)(uintptr_t)ref;
+        res = sendSymmetricChunk(mc, &refChunk);
+        UA_CHECK_STATUS(res, return res);
+        res = nextSymmetricChunk(mc);
+        UA_CHECK_STATUS(res, return res);
+        ref += refChunk.length;
+        refLength -= refChunk.length;
+    }
+
+    memcpy(mc->buf_pos, ref, refLength);
+    mc->buf_pos += refLength;
     *buf_pos = mc->buf_pos;
     *buf_end = mc->buf_end;
     return UA_STATUSCODE_GOOD;
@@ -526,9 +598,20 @@ UA_MessageContext_encode(UA_MessageContext *mc, const void *content,
     UA_EncodeBinaryOptions encOpts;
     memset(&encOpts, 0, sizeof(UA_EncodeBinaryOptions));
     encOpts.namespaceMapping = mc->channel->namespaceMapping;
+
+    /* Without signing and encryption, large arrays are sent from their memory
+     * if the ConnectionManager supports scatter-gather sending */
+    UA_referenceEncodeBuffer refCallback = NULL;
+    UA_ConnectionManager *cm = mc->channel->connectionManager;
+    if(mc->channel->securityMode == UA_MESSAGESECURITYMODE_NONE &&
+       cm && cm->sendWithConnectionVec)
+        refCallback = sendSymmetricReferenceCallback;
+
     UA_StatusCode res =
-        UA_encodeBinaryInternal(content, contentType, &mc->buf_pos, &mc->buf_end,
-                                &encOpts, sendSymmetricEncodingCallback, mc);
+        UA_encodeBinaryInternalZeroCopy(content, contentType,
+                                        &mc->buf_pos, &mc->buf_end, &encOpts,
+                                        sendSymmetricEncodingCallback,
+                                        refCallback, mc);
     if(res != UA_STATUSCODE_GOOD && mc->messageBuffer.length > 0)
         UA_MessageContext_abort(mc);
     return res;
@@ -537,7 +620,7 @@ UA_MessageContext_encode(UA_MessageContext *mc, const void *content,
 UA_StatusCode
 UA_MessageContext_finish(UA_MessageContext *mc) {
     mc->final = true;
-    return sendSymmetricChunk(mc);
+    return sendSymmetricChunk(mc, NULL);
 }
 
 void
@@ -652,9 +735,11 @@ unpackPayloadOPN(UA_SecureChannel *channel, UA_Chunk *chunk) {
     UA_CHECK_STATUS(res, return res);
 
     /* Decrypt the chunk payload */
+    UA_Boolean released = beginAsymmetricCrypto(channel);
     res = decryptAndVerifyChunk(channel,
                                 &channel->securityPolicy->asymmetricModule.cryptoModule,
                                 chunk->messageType, &chunk->bytes, offset);
+    endAsymmetricCrypto(channel, released);
     UA_CHECK_STATUS(res, return res);
 
     /* Decode the SequenceHeader */
@@ -832,6 +917,32 @@ UA_SecureChannel_loadBuffer(UA_SecureChannel *channel, const UA_ByteString buffe
     return UA_STATUSCODE_GOOD;
 }
 
+/* Append the chunk payload to the partial message */
+static UA_StatusCode
+appendChunk(UA_Chunk *message, const UA_Chunk *chunk) {
+    size_t length = message->bytes.length + chunk->bytes.length;
+    UA_Byte *data;
+    if(message->copied) {
+        data = (UA_Byte*)UA_realloc(message->bytes.data, length);
+    } else {
+        data = (UA_Byte*)UA_malloc(length);
+        if(data)
+            memcpy(data, message->bytes.data, message->bytes.length);
+    }
+    if(!data)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    memcpy(data + message->bytes.length, chunk->bytes.data, chunk->bytes.length);
+    message->bytes.data = data;
+    message->bytes.length = length;
+    message->copied = true;
+    message->chunksCount++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The chunks of a message are assembled as they arrive. The queue contains at
+ * most one partial message for every RequestId. So a message is held in memory
+ * only once (plus the current chunk) and not in the chunks and the assembled
+ * message at the same time. */
 UA_StatusCode
 UA_SecureChannel_getCompleteMessage(UA_SecureChannel *channel,
                                     UA_MessageType *messageType, UA_UInt32 *requestId,
@@ -847,16 +958,27 @@ UA_SecureChannel_getCompleteMessage(UA_SecureChannel *channel,
     if(chunk.bytes.length == 0 || res != UA_STATUSCODE_GOOD)
         return res; /* Error or no complete chunk could be extracted */
 
-    /* Process the chunk */
-    switch(chunk.chunkType) {
-    case UA_CHUNKTYPE_ABORT:
-        /* Remove all chunks received so far. Then continue extracting chunks. */
+    /* Abort removes all chunks received so far. Then continue extracting
+     * chunks. */
+    if(chunk.chunkType == UA_CHUNKTYPE_ABORT) {
         deleteChunks(channel);
         if(chunk.copied)
             UA_ByteString_clear(&chunk.bytes);
         goto extract_chunk;
+    }
+
+    /* Find the partial message with the same RequestId */
+    TAILQ_FOREACH(pchunk, &channel->chunks, pointers) {
+        if(chunk.requestId == pchunk->requestId)
+            break;
+    }
+    if(pchunk && chunk.messageType != pchunk->messageType) {
+        if(chunk.copied)
+            UA_ByteString_clear(&chunk.bytes);
+        return UA_STATUSCODE_BADTCPMESSAGETYPEINVALID;
+    }
 
-    case UA_CHUNKTYPE_INTERMEDIATE:
+    if(chunk.chunkType == UA_CHUNKTYPE_INTERMEDIATE) {
         /* Validate the resource limits */
         if((channel->config.localMaxChunkCount != 0 &&
             channel->chunksCount >= channel->config.localMaxChunkCount) ||
@@ -867,103 +989,59 @@ UA_SecureChannel_getCompleteMessage(UA_SecureChannel *channel,
             return UA_STATUSCODE_BADTCPMESSAGETOOLARGE;
         }
 
-        /* Add the chunk to the queue. Then continue extracting more chunks. */
-        pchunk = (UA_Chunk*)UA_malloc(sizeof(UA_Chunk));
-        if(!pchunk) {
+        if(pchunk) {
+            /* Append to the partial message */
+            res = appendChunk(pchunk, &chunk);
             if(chunk.copied)
                 UA_ByteString_clear(&chunk.bytes);
-            return UA_STATUSCODE_BADOUTOFMEMORY;
+            if(res != UA_STATUSCODE_GOOD)
+                return res;
+        } else {
+            /* Add the first chunk of the message to the queue */
+            pchunk = (UA_Chunk*)UA_malloc(sizeof(UA_Chunk));
+            if(!pchunk) {
+                if(chunk.copied)
+                    UA_ByteString_clear(&chunk.bytes);
+                return UA_STATUSCODE_BADOUTOFMEMORY;
+            }
+            *pchunk = chunk;
+            pchunk->chunksCount = 1;
+            TAILQ_INSERT_TAIL(&channel->chunks, pchunk, pointers);
         }
-        *pchunk = chunk;
-        TAILQ_INSERT_TAIL(&channel->chunks, pchunk, pointers);
         channel->chunksCount++;
-        channel->chunksLength += pchunk->bytes.length;
-        goto extract_chunk;
+        channel->chunksLength += chunk.bytes.length;
 
-    case UA_CHUNKTYPE_FINAL:
-    default:
-        UA_assert(chunk.chunkType == UA_CHUNKTYPE_FINAL); /* Was checked before */
-        break; /* A final chunk was received -- assemble the message */
+        /* Continue extracting more chunks */
+        goto extract_chunk;
     }
 
-    /* Compute the message size */
-    size_t messageSize = chunk.bytes.length;
-    UA_Chunk *first = NULL;
-    TAILQ_FOREACH(pchunk, &channel->chunks, pointers) {
-        if(chunk.requestId != pchunk->requestId)
-            continue;
-        if(chunk.messageType != pchunk->messageType) {
+    /* A final chunk was received -- complete the message */
+    UA_assert(chunk.chunkType == UA_CHUNKTYPE_FINAL); /* Was checked before */
+    if(pchunk) {
+        /* Validate the assembled message size */
+        if(channel->config.localMaxMessageSize != 0 &&
+           channel->chunksLength > channel->config.localMaxMessageSize) {
             if(chunk.copied)
                 UA_ByteString_clear(&chunk.bytes);
-            return UA_STATUSCODE_BADTCPMESSAGETYPEINVALID;
+            return UA_STATUSCODE_BADTCPMESSAGETOOLARGE;
         }
-        if(!first)
-            first = pchunk;
-        messageSize += pchunk->bytes.length;
-    }
 
-    /* Validate the assembled message size */
-    if(channel->config.localMaxMessageSize != 0 &&
-       channel->chunksLength > channel->config.localMaxMessageSize) {
+        /* Remove the partial message from the queue */
+        channel->chunksCount -= pchunk->chunksCount;
+        channel->chunksLength -= pchunk->bytes.length;
+        TAILQ_REMOVE(&channel->chunks, pchunk, pointers);
+
+        /* Append the final chunk */
+        res = appendChunk(pchunk, &chunk);
         if(chunk.copied)
             UA_ByteString_clear(&chunk.bytes);
-        return UA_STATUSCODE_BADTCPMESSAGETOOLARGE;
-    }
-
-    /* Assemble the full payload and store it in chunk.bytes */
-    if(messageSize > chunk.bytes.length) {
-        UA_assert(first != NULL);
-
-        /* Allocate the full memory and initialize with the first chunk content.
-         * Use realloc to speed up. */
-        UA_ByteString message;
-        if(first->copied) {
-            message.data = (UA_Byte*)UA_realloc(first->bytes.data, messageSize);
-        } else {
-            message.data = (UA_Byte*)UA_malloc(messageSize);
-            if(message.data)
-                memcpy(message.data, first->bytes.data, first->bytes.length);
-        }
-        if(!message.data) {
-            if(chunk.copied)
-                UA_ByteString_clear(&chunk.bytes);
-            return UA_STATUSCODE_BADOUTOFMEMORY;
-        }
-        message.length = first->bytes.length;
-
-        /* Remove the the first chunk */
-        pchunk = TAILQ_NEXT(first, pointers);
-        first->copied = false;
-        channel->chunksCount--;
-        channel->chunksLength -= first->bytes.length;
-        TAILQ_REMOVE(&channel->chunks, first, pointers);
-        UA_Chunk_delete(first);
-
-        /* Copy over the content from the remaining intermediate chunks.
-         * And remove them right away. */
-        UA_Chunk *next;
-        for(; pchunk; pchunk = next) {
-            next = TAILQ_NEXT(pchunk, pointers);
-            if(chunk.requestId != pchunk->requestId)
-                continue;
-            memcpy(message.data + message.length, pchunk->bytes.data, pchunk->bytes.length);
-            message.length += pchunk->bytes.length;
-            channel->chunksCount--;
-            channel->chunksLength -= pchunk->bytes.length;
-            TAILQ_REMOVE(&channel->chunks, pchunk, pointers);
+        if(res != UA_STATUSCODE_GOOD) {
             UA_Chunk_delete(pchunk);
+            return res;
         }
-
-        /* Copy over the content from the final chunk */
-        memcpy(message.data + message.length, chunk.bytes.data, chunk.bytes.length);
-        message.length += chunk.bytes.length;
-        UA_assert(message.length == messageSize);
-
-        /* Set assembled message as the content of the final chunk */
-        if(chunk.copied)
-            UA_ByteString_clear(&chunk.bytes);
-        chunk.bytes = message;
+        chunk.bytes = pchunk->bytes;
         chunk.copied = true;
+        UA_free(pchunk);
     }
 
     /* Return the assembled message */
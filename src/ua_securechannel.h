@@ -69,6 +69,7 @@ typedef struct UA_Chunk {
     UA_UInt32 requestId;
     UA_Boolean copied; /* Do the bytes point to a buffer from the network or was
                         * memory allocated for the chunk separately */
+    size_t chunksCount; /* Number of chunks assembled in the bytes */
 } UA_Chunk;
 
 typedef TAILQ_HEAD(UA_ChunkQueue, UA_Chunk) UA_ChunkQueue;
@@ -147,6 +148,10 @@ struct UA_SecureChannel {
      * used in the server) */
     UA_Session *sessions;
 
+    /* The requests are decoded into the arena (only used in the server). The
+     * arena is reset after the response was sent. */
+    UA_Arena requestArena;
+
     /* (Decrypted) chunks waiting to be processed */
     UA_ChunkQueue chunks;
     size_t chunksCount;
@@ -162,6 +167,14 @@ struct UA_SecureChannel {
     void *processOPNHeaderApplication;
     UA_StatusCode (*processOPNHeader)(void *application, UA_SecureChannel *channel,
                                       const UA_AsymmetricAlgorithmSecurityHeader *asymHeader);
+
+    /* Optional callbacks around the asymmetric crypto operations of the OPN
+     * messages (with the same application pointer as processOPNHeader). The
+     * server uses them to release the service lock in between. The return
+     * value of begin is passed to end. */
+    UA_Boolean (*beginAsymmetricCrypto)(void *application, UA_SecureChannel *channel);
+    void (*endAsymmetricCrypto)(void *application, UA_SecureChannel *channel,
+                                UA_Boolean released);
 };
 
 void UA_SecureChannel_init(UA_SecureChannel *channel);
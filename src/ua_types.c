@@ -19,6 +19,7 @@
 #include <open62541/types_generated.h>
 
 #include "parse_num.h"
+#include "ua_types_encoding_binary.h"
 #include "util/ua_util_internal.h"
 #include "../deps/itoa.h"
 #include "../deps/base64.h"
@@ -61,29 +62,125 @@ expandedNodeIdOrder(const UA_ExpandedNodeId *p1, const UA_ExpandedNodeId *p2,
 static UA_Order
 guidOrder(const UA_Guid *p1, const UA_Guid *p2, const UA_DataType *_);
 
+/* Binary search in a generated index of UA_TYPES (sorted by the numeric
+ * identifier). Returns the first matching type in the order of UA_TYPES. The
+ * idOffset selects the typeId or the binaryEncodingId. */
+static const UA_DataType *
+findTypesIndexed(const UA_UInt16 *index, size_t indexSize, size_t idOffset,
+                 const UA_NodeId *id) {
+    size_t lo = 0, hi = indexSize;
+    while(lo < hi) {
+        size_t mid = lo + ((hi - lo) >> 1);
+        const UA_NodeId *midId = (const UA_NodeId*)
+            ((uintptr_t)&UA_TYPES[index[mid]] + idOffset);
+        if(midId->identifier.numeric < id->identifier.numeric)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    for(; lo < indexSize; lo++) {
+        const UA_DataType *type = &UA_TYPES[index[lo]];
+        const UA_NodeId *typeId = (const UA_NodeId*)((uintptr_t)type + idOffset);
+        if(typeId->identifier.numeric != id->identifier.numeric)
+            break;
+        if(typeId->namespaceIndex == id->namespaceIndex)
+            return type;
+    }
+    return NULL;
+}
+
+/* The custom types are looked up through a direct-mapped cache that is filled
+ * lazily. A cached type is only returned if it is contained in one of the
+ * DataTypeArrays of the current lookup and if its NodeId still matches. So
+ * the cache needs no invalidation when the arrays are modified or freed. */
+#define UA_DATATYPE_CACHESIZE 256 /* Must be a power of two */
+
+static void *typeIdCache[UA_DATATYPE_CACHESIZE];
+static void *binaryEncodingIdCache[UA_DATATYPE_CACHESIZE];
+
+static UA_Boolean
+isInDataTypeArrays(const UA_DataType *type, const UA_DataTypeArray *customTypes) {
+    for(; customTypes; customTypes = customTypes->next) {
+        uintptr_t begin = (uintptr_t)customTypes->types;
+        uintptr_t end = begin + (customTypes->typesSize * sizeof(UA_DataType));
+        if((uintptr_t)type >= begin && (uintptr_t)type < end)
+            return (((uintptr_t)type - begin) % sizeof(UA_DataType) == 0);
+    }
+    return false;
+}
+
+static const UA_DataType *
+findCustomType(const UA_NodeId *id, const UA_DataTypeArray *customTypes,
+               size_t idOffset, void **cache) {
+    if(!customTypes)
+        return NULL;
+
+    /* Look in the cache */
+    void **slot = &cache[UA_NodeId_hash(id) & (UA_DATATYPE_CACHESIZE - 1)];
+    const UA_DataType *type = (const UA_DataType*)UA_atomic_load(slot);
+    if(type && isInDataTypeArrays(type, customTypes) &&
+       nodeIdOrder((const UA_NodeId*)((uintptr_t)type + idOffset),
+                   id, NULL) == UA_ORDER_EQ)
+        return type;
+
+    /* Search in the customTypes and remember the result */
+    for(; customTypes; customTypes = customTypes->next) {
+        for(size_t i = 0; i < customTypes->typesSize; ++i) {
+            type = &customTypes->types[i];
+            if(nodeIdOrder((const UA_NodeId*)((uintptr_t)type + idOffset),
+                           id, NULL) != UA_ORDER_EQ)
+                continue;
+            UA_atomic_xchg(slot, (void*)(uintptr_t)type);
+            return type;
+        }
+    }
+    return NULL;
+}
+
 const UA_DataType *
 UA_findDataTypeWithCustom(const UA_NodeId *typeId,
                           const UA_DataTypeArray *customTypes) {
     /* Always look in built-in types first (may contain data types from all
-     * namespaces).
-     *
-     * TODO: The standard-defined types are ordered. See if binary search is
-     * more efficient. */
-    for(size_t i = 0; i < UA_TYPES_COUNT; ++i) {
-        if(nodeIdOrder(&UA_TYPES[i].typeId, typeId, NULL) == UA_ORDER_EQ)
-            return &UA_TYPES[i];
+     * namespaces) */
+    const UA_DataType *type = NULL;
+    if(typeId->identifierType == UA_NODEIDTYPE_NUMERIC)
+        type = findTypesIndexed(UA_TYPES_TYPEIDINDEX, UA_TYPES_TYPEIDINDEX_COUNT,
+                                offsetof(UA_DataType, typeId), typeId);
+#if UA_TYPES_TYPEIDINDEX_COUNT < UA_TYPES_COUNT
+    else {
+        for(size_t i = 0; i < UA_TYPES_COUNT; ++i) {
+            if(nodeIdOrder(&UA_TYPES[i].typeId, typeId, NULL) == UA_ORDER_EQ)
+                return &UA_TYPES[i];
+        }
     }
+#endif
+    if(type)
+        return type;
 
     /* Search in the customTypes */
-    while(customTypes) {
-        for(size_t i = 0; i < customTypes->typesSize; ++i) {
-            if(nodeIdOrder(&customTypes->types[i].typeId, typeId, NULL) == UA_ORDER_EQ)
-                return &customTypes->types[i];
-        }
-        customTypes = customTypes->next;
+    return findCustomType(typeId, customTypes,
+                          offsetof(UA_DataType, typeId), typeIdCache);
+}
+
+const UA_DataType *
+UA_findDataTypeByBinaryWithCustom(const UA_NodeId *encodingId,
+                                  const UA_DataTypeArray *customTypes) {
+    /* Always look in the built-in types first. Assume that only numeric
+     * identifiers are used for the builtin types. (They may contain data types
+     * from all namespaces though.) */
+    if(encodingId->identifierType == UA_NODEIDTYPE_NUMERIC) {
+        const UA_DataType *type =
+            findTypesIndexed(UA_TYPES_BINARYENCODINGIDINDEX,
+                             UA_TYPES_BINARYENCODINGIDINDEX_COUNT,
+                             offsetof(UA_DataType, binaryEncodingId), encodingId);
+        if(type)
+            return type;
     }
 
-    return NULL;
+    /* Search in the customTypes */
+    return findCustomType(encodingId, customTypes,
+                          offsetof(UA_DataType, binaryEncodingId),
+                          binaryEncodingIdCache);
 }
 
 const UA_DataType *
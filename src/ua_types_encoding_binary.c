@@ -429,6 +429,12 @@ Array_encodeBinaryOverlayable(Ctx *ctx, uintptr_t ptr, size_t memSize) {
         return UA_STATUSCODE_GOOD;
     }
 
+    /* Hand over the memory if it spans several chunks */
+    if(ctx->referenceBufferCallback && ctx->end < ctx->pos + memSize)
+        return ctx->referenceBufferCallback(ctx->exchangeBufferCallbackHandle,
+                                            (const u8*)ptr, memSize,
+                                            &ctx->pos, &ctx->end);
+
     /* Loop as long as more elements remain than fit into the chunk */
     while(ctx->end < ctx->pos + memSize) {
         size_t possible = ((uintptr_t)ctx->end - (uintptr_t)ctx->pos);
@@ -769,7 +775,7 @@ FUNC_DECODE_BINARY(ExpandedNodeId) {
                                               dst->namespaceUri,
                                               &dst->nodeId.namespaceIndex);
             if(foundNsUri == UA_STATUSCODE_GOOD)
-                UA_String_clear(&dst->namespaceUri);
+                ctxClear(ctx, &dst->namespaceUri, &UA_TYPES[UA_TYPES_STRING]);
         }
     }
 
@@ -837,27 +843,7 @@ FUNC_DECODE_BINARY(LocalizedText) {
  * possible to reuse UA_findDataType */
 static const UA_DataType *
 UA_findDataTypeByBinaryInternal(Ctx *ctx, const UA_NodeId *typeId) {
-    /* Always look in the built-in types first. Assume that only numeric
-     * identifiers are used for the builtin types. (They may contain data types
-     * from all namespaces though.) */
-    if(typeId->identifierType == UA_NODEIDTYPE_NUMERIC) {
-        for(size_t i = 0; i < UA_TYPES_COUNT; ++i) {
-            if(UA_TYPES[i].binaryEncodingId.identifier.numeric == typeId->identifier.numeric &&
-               UA_TYPES[i].binaryEncodingId.namespaceIndex == typeId->namespaceIndex)
-                return &UA_TYPES[i];
-        }
-    }
-
-    const UA_DataTypeArray *customTypes = ctx->opts.customTypes;
-    while(customTypes) {
-        for(size_t i = 0; i < customTypes->typesSize; ++i) {
-            if(UA_NodeId_equal(typeId, &customTypes->types[i].binaryEncodingId))
-                return &customTypes->types[i];
-        }
-        customTypes = customTypes->next;
-    }
-
-    return NULL;
+    return UA_findDataTypeByBinaryWithCustom(typeId, ctx->opts.customTypes);
 }
 
 const UA_DataType *
@@ -1672,6 +1658,17 @@ UA_encodeBinaryInternal(const void *src, const UA_DataType *type,
                         UA_EncodeBinaryOptions *options,
                         UA_exchangeEncodeBuffer exchangeCallback,
                         void *exchangeHandle) {
+    return UA_encodeBinaryInternalZeroCopy(src, type, bufPos, bufEnd, options,
+                                           exchangeCallback, NULL, exchangeHandle);
+}
+
+status
+UA_encodeBinaryInternalZeroCopy(const void *src, const UA_DataType *type,
+                                u8 **bufPos, const u8 **bufEnd,
+                                UA_EncodeBinaryOptions *options,
+                                UA_exchangeEncodeBuffer exchangeCallback,
+                                UA_referenceEncodeBuffer referenceCallback,
+                                void *exchangeHandle) {
     if(!type || !src)
         return UA_STATUSCODE_BADENCODINGERROR;
 
@@ -1682,6 +1679,7 @@ UA_encodeBinaryInternal(const void *src, const UA_DataType *type,
     ctx.end = *bufEnd;
     ctx.depth = 0;
     ctx.exchangeBufferCallback = exchangeCallback;
+    ctx.referenceBufferCallback = referenceCallback;
     ctx.exchangeBufferCallbackHandle = exchangeHandle;
     if(options)
         ctx.opts.namespaceMapping = options->namespaceMapping;
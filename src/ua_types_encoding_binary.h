@@ -19,6 +19,14 @@ _UA_BEGIN_DECLS
 typedef UA_StatusCode (*UA_exchangeEncodeBuffer)(void *handle, UA_Byte **bufPos,
                                                  const UA_Byte **bufEnd);
 
+/* Hands the content of a large overlayable array to the exchange handle instead
+ * of copying it into the encoding buffer. The memory is only referenced during
+ * the call. Afterwards the encoding continues at the (possibly exchanged)
+ * buffer position. */
+typedef UA_StatusCode (*UA_referenceEncodeBuffer)(void *handle, const UA_Byte *data,
+                                                  size_t length, UA_Byte **bufPos,
+                                                  const UA_Byte **bufEnd);
+
 typedef struct {
     /* Pointers to the current and last buffer position */
     UA_Byte *pos;
@@ -30,6 +38,7 @@ typedef struct {
     UA_DecodeBinaryOptions opts;
 
     UA_exchangeEncodeBuffer exchangeBufferCallback;
+    UA_referenceEncodeBuffer referenceBufferCallback;
     void *exchangeBufferCallbackHandle;
 } Ctx;
 
@@ -82,6 +91,18 @@ UA_encodeBinaryInternal(const void *src, const UA_DataType *type,
                         void *exchangeHandle)
     UA_FUNC_ATTR_WARN_UNUSED_RESULT;
 
+/* Same as UA_encodeBinaryInternal. But overlayable arrays that do not fit into
+ * the remaining buffer are handed to the referenceCallback instead of being
+ * copied chunk by chunk. The referenceCallback receives the exchangeHandle. */
+UA_StatusCode
+UA_encodeBinaryInternalZeroCopy(const void *src, const UA_DataType *type,
+                                UA_Byte **bufPos, const UA_Byte **bufEnd,
+                                UA_EncodeBinaryOptions *options,
+                                UA_exchangeEncodeBuffer exchangeCallback,
+                                UA_referenceEncodeBuffer referenceCallback,
+                                void *exchangeHandle)
+    UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
 /* Decodes a scalar value described by type from binary encoding. Decoding is
  * reentrant and can be safely called from signal handlers or interrupts.
  *
@@ -107,6 +128,12 @@ UA_decodeBinaryInternal(const UA_ByteString *src, size_t *offset,
 const UA_DataType *
 UA_findDataTypeByBinary(const UA_NodeId *typeId);
 
+/* Looks up the type with the binaryEncodingId first in UA_TYPES and then in
+ * the custom types */
+const UA_DataType *
+UA_findDataTypeByBinaryWithCustom(const UA_NodeId *encodingId,
+                                  const UA_DataTypeArray *customTypes);
+
 _UA_END_DECLS
 
 #endif /* UA_TYPES_ENCODING_BINARY_H_ */
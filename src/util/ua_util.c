@@ -648,6 +648,74 @@ UA_EXPORT UA_THREAD_LOCAL void * (*UA_callocSingleton)(size_t nelem, size_t elsi
 UA_EXPORT UA_THREAD_LOCAL void * (*UA_reallocSingleton)(void *ptr, size_t size) = realloc;
 #endif
 
+/*******************/
+/* Arena Allocator */
+/*******************/
+
+#define UA_ARENA_ALIGN 8
+
+void *
+UA_Arena_calloc(void *arenaContext, size_t nelem, size_t elsize) {
+    UA_Arena *arena = (UA_Arena*)arenaContext;
+    if(elsize > 0 && nelem > (SIZE_MAX - UA_ARENA_ALIGN) / elsize)
+        return NULL;
+    size_t size = ((nelem * elsize) + (UA_ARENA_ALIGN - 1)) &
+        ~(size_t)(UA_ARENA_ALIGN - 1);
+
+    /* Start a new block. The remainder of the current block is not used. */
+    UA_ArenaBlock *block = arena->blocks;
+    if(!block || block->size - arena->used < size) {
+        size_t blockSize = (block) ? block->size * 2 : UA_ARENA_BLOCKSIZE;
+        if(blockSize < size)
+            blockSize = size;
+        UA_ArenaBlock *newBlock = (UA_ArenaBlock*)
+            UA_malloc(sizeof(UA_ArenaBlock) + blockSize);
+        if(!newBlock)
+            return NULL;
+        newBlock->next = block;
+        newBlock->size = blockSize;
+        arena->blocks = newBlock;
+        arena->used = 0;
+        block = newBlock;
+    }
+
+    void *p = (u8*)block + sizeof(UA_ArenaBlock) + arena->used;
+    arena->used += size;
+    memset(p, 0, size);
+    return p;
+}
+
+void
+UA_Arena_reset(UA_Arena *arena) {
+    /* Keep the largest block that is not above the limit */
+    UA_ArenaBlock *keep = NULL;
+    UA_ArenaBlock *block = arena->blocks;
+    while(block) {
+        UA_ArenaBlock *next = block->next;
+        if(block->size <= UA_ARENA_MAXKEEP && (!keep || block->size > keep->size)) {
+            UA_free(keep);
+            keep = block;
+        } else {
+            UA_free(block);
+        }
+        block = next;
+    }
+    if(keep)
+        keep->next = NULL;
+    arena->blocks = keep;
+    arena->used = 0;
+}
+
+void
+UA_Arena_clear(UA_Arena *arena) {
+    while(arena->blocks) {
+        UA_ArenaBlock *next = arena->blocks->next;
+        UA_free(arena->blocks);
+        arena->blocks = next;
+    }
+    arena->used = 0;
+}
+
 /************************/
 /* ReferenceType Lookup */
 /************************/
@@ -126,6 +126,39 @@ nodeId_printEscape(const UA_NodeId *id, UA_String *output,
 UA_StatusCode
 encodeDateTime(const UA_DateTime dt, UA_String *output);
 
+/**
+ * Arena Allocator
+ * ---------------
+ * Bump allocator for short-lived data that is released all at once. The memory
+ * is taken from blocks that grow in size. After a reset, the largest block up
+ * to UA_ARENA_MAXKEEP is kept for the next round. The calloc function can be
+ * used as the calloc-override of the UA_DecodeBinaryOptions. */
+
+#define UA_ARENA_BLOCKSIZE 4096
+#define UA_ARENA_MAXKEEP (256 * 1024)
+
+typedef struct UA_ArenaBlock {
+    struct UA_ArenaBlock *next;
+    size_t size; /* Usable size after the block header */
+} UA_ArenaBlock;
+
+typedef struct {
+    UA_ArenaBlock *blocks; /* The current block comes first */
+    size_t used;           /* Bytes used in the current block */
+} UA_Arena;
+
+/* Returns zeroed memory or NULL. Takes a UA_Arena as the context. */
+void *
+UA_Arena_calloc(void *arena, size_t nelem, size_t elsize);
+
+/* Release all allocations at once */
+void
+UA_Arena_reset(UA_Arena *arena);
+
+/* Release all allocations and the kept block */
+void
+UA_Arena_clear(UA_Arena *arena);
+
 /**
  * Error checking macros
  */
@@ -0,0 +1,333 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <open62541/server_config_default.h>
+#include <open62541/plugin/eventloop.h>
+#include <open62541/plugin/log_stdout.h>
+#include "open62541/types.h"
+#include "open62541/types_generated.h"
+
+#include "test_helpers.h"
+#include "testing_clock.h"
+#include "thread_wrapper.h"
+#include <time.h>
+#include <stdlib.h>
+#include <check.h>
+
+#define MSG_COUNT 200
+#define MSG_SIZE 1000
+#define LARGE_MSG_SIZE (1 << 20)
+
+static UA_EventLoop *el;
+static UA_ConnectionManager *cm;
+static unsigned connCount;
+static uintptr_t clientId;
+static uintptr_t serverId;
+static size_t receivedBytes;
+static size_t receivedMsgs;
+
+/* The payload is a running byte pattern. The stream can be received in
+ * arbitrary pieces. So every received byte is checked at its position. */
+static UA_Byte
+patternByte(size_t pos) {
+    return (UA_Byte)(pos % 251);
+}
+
+static void
+setupEL(UA_Boolean tcp) {
+    el = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    if(tcp)
+        cm = UA_ConnectionManager_new_IOURING_TCP(UA_STRING("tcpCM"));
+    else
+        cm = UA_ConnectionManager_new_IOURING_UDP(UA_STRING("udpCM"));
+    ck_assert(cm != NULL);
+
+    /* Use few and small receive buffers to cycle through them */
+    UA_UInt32 bufSize = 4096;
+    UA_UInt32 bufCount = 8;
+    UA_KeyValueMap_setScalar(&cm->eventSource.params,
+                             UA_QUALIFIEDNAME(0, "recv-bufsize"),
+                             &bufSize, &UA_TYPES[UA_TYPES_UINT32]);
+    UA_KeyValueMap_setScalar(&cm->eventSource.params,
+                             UA_QUALIFIEDNAME(0, "recv-buffers"),
+                             &bufCount, &UA_TYPES[UA_TYPES_UINT32]);
+    el->registerEventSource(el, &cm->eventSource);
+    connCount = 0;
+    clientId = 0;
+    serverId = 0;
+    receivedBytes = 0;
+    receivedMsgs = 0;
+}
+
+static void
+stopEL(void) {
+    int max_stop_iteration_count = 1000;
+    int iteration = 0;
+    el->stop(el);
+    while(el->state != UA_EVENTLOOPSTATE_STOPPED &&
+          iteration < max_stop_iteration_count) {
+        UA_DateTime next = el->run(el, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+        iteration++;
+    }
+    ck_assert(el->state == UA_EVENTLOOPSTATE_STOPPED);
+    el->free(el);
+    el = NULL;
+}
+
+static void
+connectionCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
+                   void *application, void **connectionContext,
+                   UA_ConnectionState status,
+                   const UA_KeyValueMap *params,
+                   UA_ByteString msg) {
+    if(msg.length == 0 && status == UA_CONNECTIONSTATE_ESTABLISHED) {
+        connCount++;
+        if(*connectionContext != NULL)
+            clientId = connectionId;
+        else
+            serverId = connectionId;
+    }
+
+    if(status == UA_CONNECTIONSTATE_CLOSING)
+        connCount--;
+
+    for(size_t i = 0; i < msg.length; i++)
+        ck_assert_uint_eq(msg.data[i], patternByte(receivedBytes + i));
+    receivedBytes += msg.length;
+    if(msg.length > 0)
+        receivedMsgs++;
+}
+
+static void
+sendPattern(uintptr_t connectionId, size_t offset, size_t length) {
+    UA_ByteString snd;
+    UA_StatusCode retval = cm->allocNetworkBuffer(cm, connectionId, &snd, length);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < length; i++)
+        snd.data[i] = patternByte(offset + i);
+    retval = cm->sendWithConnection(cm, connectionId, NULL, &snd);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+START_TEST(connectTCP) {
+    setupEL(true);
+    el->start(el);
+
+    UA_UInt16 port = 4840;
+    UA_Boolean listen = true;
+    UA_String host = UA_STRING("localhost");
+
+    UA_KeyValuePair params[3];
+    params[0].key = UA_QUALIFIEDNAME(0, "port");
+    UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
+    params[1].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[1].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    params[2].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[2].value, &host, &UA_TYPES[UA_TYPES_STRING]);
+    UA_KeyValueMap paramsMap = {3, params};
+
+    UA_StatusCode retval =
+        cm->openConnection(cm, &paramsMap, NULL, NULL, connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    size_t listenSockets = connCount;
+
+    /* Open a client connection */
+    listen = false;
+    retval = cm->openConnection(cm, &paramsMap, NULL, (void*)0x01, connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 100 && connCount < listenSockets + 2; i++)
+        el->run(el, 10);
+    ck_assert(clientId != 0);
+    ck_assert_uint_eq(connCount, listenSockets + 2);
+
+    /* Queue many messages at once. They are sent with gathering writes. */
+    for(size_t i = 0; i < MSG_COUNT; i++)
+        sendPattern(clientId, i * MSG_SIZE, MSG_SIZE);
+    for(size_t i = 0; i < 1000 && receivedBytes < MSG_COUNT * MSG_SIZE; i++)
+        el->run(el, 10);
+    ck_assert_uint_eq(receivedBytes, MSG_COUNT * MSG_SIZE);
+
+    /* A large message exceeds the socket buffer and is sent in parts. It is
+     * received in many buffers. */
+    sendPattern(clientId, receivedBytes, LARGE_MSG_SIZE);
+    for(size_t i = 0; i < 1000 &&
+            receivedBytes < MSG_COUNT * MSG_SIZE + LARGE_MSG_SIZE; i++)
+        el->run(el, 10);
+    ck_assert_uint_eq(receivedBytes, MSG_COUNT * MSG_SIZE + LARGE_MSG_SIZE);
+
+    /* Close the connection from the client side. The server side sees the
+     * closed socket. */
+    retval = cm->closeConnection(cm, clientId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 100 && connCount > listenSockets; i++)
+        el->run(el, 10);
+    ck_assert_uint_eq(connCount, listenSockets);
+
+    stopEL();
+    ck_assert_uint_eq(connCount, 0);
+} END_TEST
+
+START_TEST(closeWhileSending) {
+    setupEL(true);
+    el->start(el);
+
+    UA_UInt16 port = 4840;
+    UA_Boolean listen = true;
+    UA_String host = UA_STRING("localhost");
+
+    UA_KeyValuePair params[3];
+    params[0].key = UA_QUALIFIEDNAME(0, "port");
+    UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
+    params[1].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[1].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    params[2].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[2].value, &host, &UA_TYPES[UA_TYPES_STRING]);
+    UA_KeyValueMap paramsMap = {3, params};
+
+    UA_StatusCode retval =
+        cm->openConnection(cm, &paramsMap, NULL, NULL, connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Wait for the server side of the connection */
+    serverId = 0;
+    listen = false;
+    retval = cm->openConnection(cm, &paramsMap, NULL, (void*)0x01, connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 100 && serverId == 0; i++)
+        el->run(el, 10);
+    ck_assert(serverId != 0);
+
+    /* Close with sends in flight. The queued buffers are freed. */
+    for(size_t i = 0; i < 4; i++)
+        sendPattern(serverId, i * LARGE_MSG_SIZE, LARGE_MSG_SIZE);
+    el->run(el, 1);
+    retval = cm->closeConnection(cm, serverId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Stop with open connections */
+    stopEL();
+    ck_assert_uint_eq(connCount, 0);
+} END_TEST
+
+START_TEST(sendUDP) {
+    setupEL(false);
+    el->start(el);
+
+    UA_UInt16 port = 4840;
+    UA_Boolean listen = true;
+    UA_String host = UA_STRING("127.0.0.1");
+
+    UA_KeyValuePair params[3];
+    params[0].key = UA_QUALIFIEDNAME(0, "port");
+    UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
+    params[1].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[1].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    params[2].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[2].value, &host, &UA_TYPES[UA_TYPES_STRING]);
+    UA_KeyValueMap paramsMap = {3, params};
+
+    UA_StatusCode retval =
+        cm->openConnection(cm, &paramsMap, NULL, NULL, connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Open a send connection */
+    listen = false;
+    retval = cm->openConnection(cm, &paramsMap, NULL, (void*)0x01, connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(clientId != 0);
+
+    /* Every datagram is received on its own. Fewer datagrams than receive
+     * buffers are sent so that none are dropped. */
+    for(size_t i = 0; i < 8; i++)
+        sendPattern(clientId, i * MSG_SIZE, MSG_SIZE);
+    for(size_t i = 0; i < 100 && receivedMsgs < 8; i++)
+        el->run(el, 10);
+    ck_assert_uint_eq(receivedMsgs, 8);
+    ck_assert_uint_eq(receivedBytes, 8 * MSG_SIZE);
+
+    stopEL();
+    ck_assert_uint_eq(connCount, 0);
+} END_TEST
+
+static UA_Server *server;
+static UA_Boolean running;
+THREAD_HANDLE server_thread;
+
+THREAD_CALLBACK(serverloop) {
+    while(running)
+        UA_Server_run_iterate(server, true);
+    return 0;
+}
+
+/* The server uses the io_uring ConnectionManager from its EventLoop */
+START_TEST(serverReadWrite) {
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    config.eventLoop = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    UA_ConnectionManager *tcpCM =
+        UA_ConnectionManager_new_IOURING_TCP(UA_STRING("tcp connection manager"));
+    config.eventLoop->registerEventSource(config.eventLoop, &tcpCM->eventSource);
+    UA_ServerConfig_setDefault(&config);
+    config.tcpReuseAddr = true;
+    server = UA_Server_newWithConfig(&config);
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+    running = true;
+    THREAD_CREATE(server_thread, serverloop);
+
+    UA_Client *client = UA_Client_newForUnitTest();
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* The response to reading all namespaces exceeds a receive buffer */
+    for(size_t i = 0; i < 20; i++) {
+        UA_Variant val;
+        retval = UA_Client_readValueAttribute(client,
+                     UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_NAMESPACEARRAY), &val);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        UA_Variant_clear(&val);
+
+        UA_BrowseRequest bReq;
+        UA_BrowseRequest_init(&bReq);
+        UA_BrowseDescription bd;
+        UA_BrowseDescription_init(&bd);
+        bd.nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_TYPESFOLDER);
+        bd.browseDirection = UA_BROWSEDIRECTION_BOTH;
+        bd.resultMask = UA_BROWSERESULTMASK_ALL;
+        bReq.nodesToBrowse = &bd;
+        bReq.nodesToBrowseSize = 1;
+        UA_BrowseResponse bResp = UA_Client_Service_browse(client, bReq);
+        ck_assert_uint_eq(bResp.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(bResp.resultsSize, 1);
+        UA_BrowseResponse_clear(&bResp);
+    }
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+
+    running = false;
+    THREAD_JOIN(server_thread);
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+} END_TEST
+
+int main(void) {
+    Suite *s  = suite_create("Test io_uring EventLoop");
+    TCase *tc = tcase_create("test cases");
+    tcase_add_test(tc, connectTCP);
+    tcase_add_test(tc, closeWhileSending);
+    tcase_add_test(tc, sendUDP);
+    tcase_add_test(tc, serverReadWrite);
+    suite_add_tcase(s, tc);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -538,6 +538,125 @@ START_TEST(udpTalkerAndListenerDifferentDestination) {
     ck_assert_uint_eq(testContext.connCount, 0);
 } END_TEST
 
+#if !defined(UA_ARCHITECTURE_LWIP)
+#define BATCH_MESSAGES 50
+
+static size_t batchReceived;
+
+/* Message i has length batchLength(i) and is filled with the byte i */
+static size_t
+batchLength(size_t i) {
+    if(i < 40)
+        return 200; /* Same size, can be segmented by GSO */
+    return 100 + (i % 3) * 100;
+}
+
+static void
+batchCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
+              void *application, void **connectionContext,
+              UA_ConnectionState status, const UA_KeyValueMap *params,
+              UA_ByteString msg) {
+    if(msg.length == 0) {
+        connectionCallback(cm, connectionId, application, connectionContext,
+                           status, params, msg);
+        return;
+    }
+    ck_assert_uint_lt(batchReceived, BATCH_MESSAGES);
+    ck_assert_uint_eq(msg.length, batchLength(batchReceived));
+    for(size_t i = 0; i < msg.length; i++)
+        ck_assert_uint_eq(msg.data[i], (UA_Byte)batchReceived);
+    batchReceived++;
+}
+
+START_TEST(udpBatch) {
+    setupELTalkerAndListener();
+
+    /* Receive up to eight datagrams at once */
+    UA_UInt32 recvBatch = 8;
+    UA_KeyValueMap_setScalar(&cmListener->eventSource.params,
+                             UA_QUALIFIEDNAME(0, "recv-batch"),
+                             &recvBatch, &UA_TYPES[UA_TYPES_UINT32]);
+    elListener->start(elListener);
+    elTalker->start(elTalker);
+
+    /* Open a listener connection */
+    UA_UInt16 port = 30000;
+    UA_Boolean listen = true;
+    UA_Boolean batch = true;
+    UA_String targetHost = UA_STRING("localhost");
+
+    UA_KeyValuePair params[4];
+    UA_KeyValueMap paramsMap = {2, params};
+    params[0].key = UA_QUALIFIEDNAME(0, "port");
+    UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
+    params[1].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[1].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    params[2].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[2].value, &targetHost, &UA_TYPES[UA_TYPES_STRING]);
+    params[3].key = UA_QUALIFIEDNAME(0, "batch");
+    UA_Variant_setScalar(&params[3].value, &batch, &UA_TYPES[UA_TYPES_BOOLEAN]);
+
+    TestContext testContext;
+    testContext.connCount = 0;
+    UA_StatusCode retval =
+        cmListener->openConnection(cmListener, &paramsMap, NULL, &testContext,
+                                   batchCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    size_t listenSockets = testContext.connCount;
+
+    /* Open a talker connection that sends in batches */
+    clientId = 0;
+    listen = false;
+    paramsMap.mapSize = 4;
+    retval = cmTalker->openConnection(cmTalker, &paramsMap, NULL, &testContext,
+                                      batchCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_ne(clientId, 0);
+
+    /* Queue the messages. They are sent in the next EventLoop iteration. */
+    batchReceived = 0;
+    for(size_t i = 0; i < BATCH_MESSAGES; i++) {
+        UA_ByteString snd;
+        retval = cmTalker->allocNetworkBuffer(cmTalker, clientId, &snd, batchLength(i));
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        memset(snd.data, (UA_Byte)i, snd.length);
+        retval = cmTalker->sendWithConnection(cmTalker, clientId,
+                                              &UA_KEYVALUEMAP_NULL, &snd);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    elTalker->run(elTalker, 1);
+    for(size_t i = 0; i < 10 && batchReceived < BATCH_MESSAGES; i++)
+        elListener->run(elListener, 1);
+    ck_assert_uint_eq(batchReceived, BATCH_MESSAGES);
+
+    /* Messages queued when closing are dropped */
+    UA_ByteString snd;
+    retval = cmTalker->allocNetworkBuffer(cmTalker, clientId, &snd, 10);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = cmTalker->sendWithConnection(cmTalker, clientId, &UA_KEYVALUEMAP_NULL, &snd);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = cmTalker->closeConnection(cmTalker, clientId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Stop the EventLoops */
+    elTalker->stop(elTalker);
+    for(size_t i = 0; i < 10 && elTalker->state != UA_EVENTLOOPSTATE_STOPPED; i++)
+        elTalker->run(elTalker, 1);
+    ck_assert_int_eq(elTalker->state, UA_EVENTLOOPSTATE_STOPPED);
+    elTalker->free(elTalker);
+    elTalker = NULL;
+    ck_assert_uint_eq(testContext.connCount, listenSockets);
+
+    elListener->stop(elListener);
+    for(size_t i = 0; i < 10 && elListener->state != UA_EVENTLOOPSTATE_STOPPED; i++)
+        elListener->run(elListener, 1);
+    ck_assert_int_eq(elListener->state, UA_EVENTLOOPSTATE_STOPPED);
+    elListener->free(elListener);
+    elListener = NULL;
+    ck_assert_uint_eq(testContext.connCount, 0);
+} END_TEST
+#endif
+
 int main(void) {
     Suite *s  = suite_create("Test UDP EventLoop");
     TCase *tc = tcase_create("test cases");
@@ -547,6 +666,9 @@ int main(void) {
     tcase_add_test(tc, connectUDPValidationSucceeds);
     tcase_add_test(tc, udpTalkerAndListener);
     tcase_add_test(tc, udpTalkerAndListenerDifferentDestination);
+#if !defined(UA_ARCHITECTURE_LWIP)
+    tcase_add_test(tc, udpBatch);
+#endif
     suite_add_tcase(s, tc);
 
     SRunner *sr = srunner_create(s);
@@ -452,6 +452,145 @@ START_TEST(SecureChannel_sendSymmetricMessage_invalidParameters) {
     ck_assert_msg(retval != UA_STATUSCODE_GOOD, "Expected failure");
 } END_TEST
 
+/* ConnectionManager that appends all sent chunks to a stream. Borrowed
+ * buffers are copied during sendWithConnectionVec. */
+static UA_ConnectionManager vecConnectionManager;
+static UA_ByteString sentStream;
+static size_t vecCalls;
+
+static void
+appendToStream(const UA_ByteString *buf) {
+    UA_Byte *data = (UA_Byte*)
+        UA_realloc(sentStream.data, sentStream.length + buf->length);
+    ck_assert_ptr_ne(data, NULL);
+    memcpy(&data[sentStream.length], buf->data, buf->length);
+    sentStream.data = data;
+    sentStream.length += buf->length;
+}
+
+static UA_StatusCode
+vecSendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
+                      const UA_KeyValueMap *params, UA_ByteString *buf) {
+    appendToStream(buf);
+    UA_ByteString_clear(buf);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+vecSendWithConnectionVec(UA_ConnectionManager *cm, uintptr_t connectionId,
+                         const UA_KeyValueMap *params, UA_ByteString *bufs,
+                         size_t bufsSize) {
+    vecCalls++;
+    for(size_t i = 0; i < bufsSize; i++)
+        appendToStream(&bufs[i]);
+    UA_ByteString_clear(&bufs[0]);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+sendLargeArray(UA_MessageSecurityMode mode, UA_Double *arr, size_t arrSize) {
+    vecConnectionManager = testConnectionManagerTCP;
+    vecConnectionManager.sendWithConnection = vecSendWithConnection;
+    vecConnectionManager.sendWithConnectionVec = vecSendWithConnectionVec;
+    testChannel.connectionManager = &vecConnectionManager;
+    testChannel.securityMode = mode;
+    sentStream = UA_BYTESTRING_NULL;
+    vecCalls = 0;
+
+    for(size_t i = 0; i < arrSize; i++)
+        arr[i] = (UA_Double)i * 0.5;
+
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    UA_Variant_setArray(&dv.value, arr, arrSize, &UA_TYPES[UA_TYPES_DOUBLE]);
+    dv.hasValue = true;
+    UA_ReadResponse rr;
+    UA_ReadResponse_init(&rr);
+    rr.results = &dv;
+    rr.resultsSize = 1;
+
+    UA_StatusCode retval =
+        UA_SecureChannel_sendSymmetricMessage(&testChannel, 42, UA_MESSAGETYPE_MSG,
+                                              &rr, &UA_TYPES[UA_TYPES_READRESPONSE]);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+START_TEST(SecureChannel_sendSymmetricMessage_zeroCopy) {
+    size_t arrSize = 100000;
+    UA_Double *arr = (UA_Double*)UA_malloc(arrSize * sizeof(UA_Double));
+    ck_assert_ptr_ne(arr, NULL);
+    sendLargeArray(UA_MESSAGESECURITYMODE_NONE, arr, arrSize);
+    ck_assert_uint_gt(vecCalls, 10);
+
+    /* Reassemble the chunks */
+    UA_ByteString payload;
+    payload.data = (UA_Byte*)UA_malloc(sentStream.length);
+    ck_assert_ptr_ne(payload.data, NULL);
+    payload.length = 0;
+    size_t offset = 0;
+    size_t chunks = 0;
+    while(offset < sentStream.length) {
+        UA_TcpMessageHeader header;
+        size_t headerOffset = offset;
+        UA_StatusCode retval =
+            UA_decodeBinaryInternal(&sentStream, &headerOffset, &header,
+                                    &UA_TRANSPORT[UA_TRANSPORT_TCPMESSAGEHEADER], NULL);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        ck_assert_uint_le(header.messageSize, testChannel.config.sendBufferSize);
+        ck_assert_uint_le(offset + header.messageSize, sentStream.length);
+        size_t bodyLength =
+            header.messageSize - UA_SECURECHANNEL_SYMMETRIC_HEADER_TOTALLENGTH;
+        memcpy(&payload.data[payload.length],
+               &sentStream.data[offset + UA_SECURECHANNEL_SYMMETRIC_HEADER_TOTALLENGTH],
+               bodyLength);
+        payload.length += bodyLength;
+        offset += header.messageSize;
+        chunks++;
+        UA_ChunkType chunkType = (UA_ChunkType)
+            (header.messageTypeAndChunkType & 0xff000000u);
+        if(offset < sentStream.length)
+            ck_assert_uint_eq(chunkType, UA_CHUNKTYPE_INTERMEDIATE);
+        else
+            ck_assert_uint_eq(chunkType, UA_CHUNKTYPE_FINAL);
+    }
+    ck_assert_uint_ge(chunks, vecCalls);
+
+    /* Decode and compare */
+    UA_NodeId typeId;
+    UA_ReadResponse rr;
+    offset = 0;
+    UA_StatusCode retval =
+        UA_decodeBinaryInternal(&payload, &offset, &typeId,
+                                &UA_TYPES[UA_TYPES_NODEID], NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(UA_NodeId_equal(&typeId, &UA_TYPES[UA_TYPES_READRESPONSE].binaryEncodingId));
+    retval = UA_decodeBinaryInternal(&payload, &offset, &rr,
+                                     &UA_TYPES[UA_TYPES_READRESPONSE], NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(offset, payload.length);
+    ck_assert_uint_eq(rr.resultsSize, 1);
+    ck_assert_uint_eq(rr.results[0].value.arrayLength, arrSize);
+    ck_assert(memcmp(rr.results[0].value.data, arr, arrSize * sizeof(UA_Double)) == 0);
+
+    UA_ReadResponse_clear(&rr);
+    UA_ByteString_clear(&payload);
+    UA_ByteString_clear(&sentStream);
+    UA_free(arr);
+} END_TEST
+
+START_TEST(SecureChannel_sendSymmetricMessage_zeroCopySigned) {
+    /* Signed chunks are not sent from the array memory */
+    size_t arrSize = 100000;
+    UA_Double *arr = (UA_Double*)UA_malloc(arrSize * sizeof(UA_Double));
+    ck_assert_ptr_ne(arr, NULL);
+    sendLargeArray(UA_MESSAGESECURITYMODE_SIGN, arr, arrSize);
+    ck_assert_uint_eq(vecCalls, 0);
+    ck_assert(fCalled.sym_sign);
+    ck_assert_uint_gt(sentStream.length, arrSize * sizeof(UA_Double));
+    UA_ByteString_clear(&sentStream);
+    UA_free(arr);
+} END_TEST
+
 static UA_StatusCode
 UA_SecureChannel_processBuffer(UA_SecureChannel *channel, int *chunks_processed,
                                const UA_ByteString buffer) {
@@ -525,6 +664,90 @@ START_TEST(SecureChannel_assemblePartialChunks) {
     ck_assert_int_eq(chunks_processed, 5);
 } END_TEST
 
+/* The chunks of a message are appended to a single partial message as they
+ * arrive */
+START_TEST(SecureChannel_assembleMultiChunkMessage) {
+    size_t arrSize = 100000;
+    UA_Double *arr = (UA_Double*)UA_malloc(arrSize * sizeof(UA_Double));
+    ck_assert_ptr_ne(arr, NULL);
+    sendLargeArray(UA_MESSAGESECURITYMODE_NONE, arr, arrSize);
+
+    /* The SecurityToken must not time out */
+    testChannel.securityToken.createdAt = UA_DateTime_nowMonotonic();
+    testChannel.securityToken.revisedLifetime = 600000;
+
+    /* Receive the chunks in pieces that don't align with the chunk borders */
+    UA_ByteString payload = UA_BYTESTRING_NULL;
+    UA_Boolean copied = false;
+    size_t pieceSize = 5000;
+    size_t maxPartialChunks = 0;
+    for(size_t offset = 0; offset < sentStream.length; offset += pieceSize) {
+        ck_assert_uint_eq(payload.length, 0);
+        UA_ByteString buffer;
+        buffer.data = &sentStream.data[offset];
+        buffer.length = sentStream.length - offset;
+        if(buffer.length > pieceSize)
+            buffer.length = pieceSize;
+        UA_StatusCode retval = UA_SecureChannel_loadBuffer(&testChannel, buffer);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        while(true) {
+            UA_MessageType messageType;
+            UA_UInt32 requestId = 0;
+            UA_ByteString msg = UA_BYTESTRING_NULL;
+            UA_Boolean msgCopied = false;
+            retval = UA_SecureChannel_getCompleteMessage(&testChannel, &messageType,
+                                                         &requestId, &msg, &msgCopied,
+                                                         UA_DateTime_nowMonotonic());
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+            if(msg.length == 0)
+                break;
+            ck_assert_uint_eq(messageType, UA_MESSAGETYPE_MSG);
+            ck_assert_uint_eq(requestId, 42);
+            payload = msg;
+            copied = msgCopied;
+        }
+
+        /* At most one partial message is queued */
+        UA_Chunk *partial = TAILQ_FIRST(&testChannel.chunks);
+        if(partial) {
+            ck_assert_ptr_eq(TAILQ_NEXT(partial, pointers), NULL);
+            ck_assert_uint_eq(partial->chunksCount, testChannel.chunksCount);
+            ck_assert_uint_eq(partial->bytes.length, testChannel.chunksLength);
+            if(partial->chunksCount > maxPartialChunks)
+                maxPartialChunks = partial->chunksCount;
+        }
+        retval = UA_SecureChannel_persistBuffer(&testChannel);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    ck_assert_uint_gt(maxPartialChunks, 10);
+    ck_assert(TAILQ_EMPTY(&testChannel.chunks));
+    ck_assert_uint_eq(testChannel.chunksCount, 0);
+    ck_assert_uint_eq(testChannel.chunksLength, 0);
+    ck_assert(copied);
+
+    /* Decode and compare */
+    UA_NodeId typeId;
+    UA_ReadResponse rr;
+    size_t offset = 0;
+    UA_StatusCode retval =
+        UA_decodeBinaryInternal(&payload, &offset, &typeId,
+                                &UA_TYPES[UA_TYPES_NODEID], NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(UA_NodeId_equal(&typeId, &UA_TYPES[UA_TYPES_READRESPONSE].binaryEncodingId));
+    retval = UA_decodeBinaryInternal(&payload, &offset, &rr,
+                                     &UA_TYPES[UA_TYPES_READRESPONSE], NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(offset, payload.length);
+    ck_assert_uint_eq(rr.resultsSize, 1);
+    ck_assert_uint_eq(rr.results[0].value.arrayLength, arrSize);
+    ck_assert(memcmp(rr.results[0].value.data, arr, arrSize * sizeof(UA_Double)) == 0);
+
+    UA_ReadResponse_clear(&rr);
+    UA_ByteString_clear(&payload);
+    UA_ByteString_clear(&sentStream);
+    UA_free(arr);
+} END_TEST
+
 
 static Suite *
 testSuite_SecureChannel(void) {
@@ -559,6 +782,8 @@ testSuite_SecureChannel(void) {
     tcase_add_test(tc_sendSymmetricMessage, SecureChannel_sendSymmetricMessage_modeNone);
     tcase_add_test(tc_sendSymmetricMessage, SecureChannel_sendSymmetricMessage_modeSign);
     tcase_add_test(tc_sendSymmetricMessage, SecureChannel_sendSymmetricMessage_modeSignAndEncrypt);
+    tcase_add_test(tc_sendSymmetricMessage, SecureChannel_sendSymmetricMessage_zeroCopy);
+    tcase_add_test(tc_sendSymmetricMessage, SecureChannel_sendSymmetricMessage_zeroCopySigned);
     suite_add_tcase(s, tc_sendSymmetricMessage);
 
     TCase *tc_processBuffer = tcase_create("Test chunk assembly");
@@ -566,6 +791,7 @@ testSuite_SecureChannel(void) {
     tcase_add_checked_fixture(tc_processBuffer, setup_key_sizes, teardown_key_sizes);
     tcase_add_checked_fixture(tc_processBuffer, setup_secureChannel, teardown_secureChannel);
     tcase_add_test(tc_processBuffer, SecureChannel_assemblePartialChunks);
+    tcase_add_test(tc_processBuffer, SecureChannel_assembleMultiChunkMessage);
     suite_add_tcase(s, tc_processBuffer);
 
     return s;
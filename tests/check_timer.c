@@ -53,10 +53,245 @@ START_TEST(benchmarkTimer) {
     UA_Timer_clear(&timer);
 } END_TEST
 
+/* Cost of the timer for a growing number of entries. The entries are spread
+ * over a few typical intervals with random base times. */
+static const UA_Double intervals[5] = {50.0, 100.0, 250.0, 500.0, 1000.0};
+
+static void
+benchmarkEntries(size_t entries) {
+    UA_Timer timer;
+    UA_Timer_init(&timer);
+    count = 0;
+
+    srand(1);
+    clock_t begin = clock();
+    for(size_t i = 0; i < entries; i++) {
+        UA_Double interval = intervals[i % 5];
+        UA_DateTime baseTime = (UA_DateTime)
+            ((UA_Double)rand() / RAND_MAX * interval * UA_DATETIME_MSEC);
+        UA_StatusCode retval =
+            UA_Timer_add(&timer, timerCallback, NULL, NULL, interval, 0,
+                         &baseTime, UA_TIMERPOLICY_BASETIME, NULL);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    clock_t added = clock();
+
+    /* Simulate 1s in steps of 1ms */
+    for(UA_DateTime now = 0; now <= UA_DATETIME_SEC; now += UA_DATETIME_MSEC)
+        UA_Timer_process(&timer, now);
+    clock_t finish = clock();
+
+    double addTime = (double)(added - begin) / CLOCKS_PER_SEC;
+    double processTime = (double)(finish - added) / CLOCKS_PER_SEC;
+    printf("%lu entries: add %.0f ns/entry, process %.0f ns/callback "
+           "(%lu callbacks)\n", (unsigned long)entries,
+           addTime * 1e9 / (double)entries,
+           processTime * 1e9 / (double)count, (unsigned long)count);
+
+    UA_Timer_clear(&timer);
+}
+
+START_TEST(benchmarkTimerScaling) {
+    benchmarkEntries(10000);
+    benchmarkEntries(100000);
+    benchmarkEntries(1000000);
+} END_TEST
+
+/* Every callback checks that it is executed exactly at its scheduled time */
+typedef struct {
+    UA_DateTime interval;
+    UA_DateTime expected;
+    size_t executions;
+} ScheduledEntry;
+
+static UA_DateTime currentTime = 0;
+
+static void
+scheduledCallback(void *application, void *data) {
+    ScheduledEntry *se = (ScheduledEntry*)data;
+    ck_assert_int_eq(currentTime, se->expected);
+    se->expected += se->interval;
+    se->executions++;
+}
+
+/* Advance the time always to the next timer event. The timing wheel may
+ * return an earlier time from UA_Timer_next where its entries are moved
+ * between the levels. But no callback is executed early or late. */
+static void
+runExactExecution(UA_Double minInterval, UA_DateTime end) {
+    UA_Timer timer;
+    UA_Timer_init(&timer);
+    currentTime = 0;
+
+    ScheduledEntry entries[100];
+    for(size_t i = 0; i < 100; i++) {
+        UA_Double interval = minInterval * (UA_Double)(rand() % 10000 + 1) / 10.0;
+        if(i % 10 == 0)
+            interval *= 10.0;
+        entries[i].interval = (UA_DateTime)(interval * UA_DATETIME_MSEC);
+        entries[i].expected = entries[i].interval;
+        entries[i].executions = 0;
+        UA_StatusCode retval =
+            UA_Timer_add(&timer, scheduledCallback, NULL, &entries[i], interval,
+                         0, NULL, UA_TIMERPOLICY_BASETIME, NULL);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    while(currentTime < end) {
+        UA_DateTime next = UA_Timer_next(&timer);
+        ck_assert_int_gt(next, currentTime);
+        currentTime = next;
+        UA_Timer_process(&timer, currentTime);
+    }
+
+    for(size_t i = 0; i < 100; i++)
+        ck_assert_uint_eq(entries[i].executions,
+                          (size_t)(currentTime / entries[i].interval));
+
+    UA_Timer_clear(&timer);
+    currentTime = 0;
+}
+
+START_TEST(timerExactExecution) {
+    srand(2);
+    /* Intervals from 10us to 1s */
+    runExactExecution(0.1, 10 * UA_DATETIME_SEC);
+    /* Intervals from 6min to 400 days (beyond the range of the wheel) */
+    runExactExecution(60.0 * 60.0 * 1000.0, 2 * 365LL * 24 * 3600 * UA_DATETIME_SEC);
+} END_TEST
+
+static UA_DateTime lastExecuted;
+
+static void
+orderCallback(void *application, void *data) {
+    UA_DateTime scheduled = *(UA_DateTime*)data;
+    ck_assert_int_ge(scheduled, lastExecuted);
+    lastExecuted = scheduled;
+    count++;
+}
+
+/* Entries that are due in the same processing step are executed in the order
+ * of their scheduled time */
+START_TEST(timerOrderedExecution) {
+    UA_Timer timer;
+    UA_Timer_init(&timer);
+    count = 0;
+    lastExecuted = 0;
+
+    UA_DateTime scheduled[1000];
+    srand(3);
+    for(size_t i = 0; i < 1000; i++) {
+        /* Mix of sub-tick and long distances */
+        UA_Double interval = (i % 2 == 0) ?
+            (UA_Double)(rand() % 100 + 1) / 1000.0 :
+            (UA_Double)(rand() % 100000 + 1);
+        scheduled[i] = (UA_DateTime)(interval * UA_DATETIME_MSEC);
+        UA_StatusCode retval =
+            UA_Timer_add(&timer, orderCallback, NULL, &scheduled[i], interval,
+                         0, NULL, UA_TIMERPOLICY_ONCE, NULL);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    UA_DateTime next = UA_Timer_process(&timer, 200 * UA_DATETIME_SEC);
+    ck_assert_uint_eq(count, 1000);
+    ck_assert_int_eq(next, UA_INT64_MAX);
+    UA_Timer_clear(&timer);
+} END_TEST
+
+/* A missed execution window is handled according to the timer policy */
+START_TEST(timerPolicies) {
+    UA_Timer timer;
+    UA_Timer_init(&timer);
+    count = 0;
+
+    UA_UInt64 currentId, baseId;
+    UA_Timer_add(&timer, timerCallback, NULL, NULL, 100.0, 0, NULL,
+                 UA_TIMERPOLICY_CURRENTTIME, &currentId);
+    UA_DateTime baseTime = 0;
+    UA_Timer_add(&timer, timerCallback, NULL, NULL, 100.0, 0, &baseTime,
+                 UA_TIMERPOLICY_BASETIME, &baseId);
+    UA_Timer_remove(&timer, currentId);
+    UA_Timer_add(&timer, timerCallback, NULL, NULL, 100.0, 0, NULL,
+                 UA_TIMERPOLICY_CURRENTTIME, &currentId);
+    ck_assert_int_le(UA_Timer_next(&timer), 100 * UA_DATETIME_MSEC);
+
+    /* Both are executed once. CurrentTime restarts the interval from now.
+     * BaseTime stays aligned to the base time. */
+    UA_DateTime next = UA_Timer_process(&timer, 250 * UA_DATETIME_MSEC);
+    ck_assert_uint_eq(count, 2);
+    ck_assert_int_le(next, 300 * UA_DATETIME_MSEC);
+    next = UA_Timer_process(&timer, 300 * UA_DATETIME_MSEC);
+    ck_assert_uint_eq(count, 3);
+    ck_assert_int_le(next, 350 * UA_DATETIME_MSEC);
+    next = UA_Timer_process(&timer, 350 * UA_DATETIME_MSEC);
+    ck_assert_uint_eq(count, 4);
+    ck_assert_int_le(next, 400 * UA_DATETIME_MSEC);
+
+    /* Modify the interval. The next execution is computed from now. */
+    UA_StatusCode retval =
+        UA_Timer_modify(&timer, currentId, 1000.0, 360 * UA_DATETIME_MSEC,
+                        NULL, UA_TIMERPOLICY_CURRENTTIME);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Timer_remove(&timer, baseId);
+    ck_assert_int_le(UA_Timer_next(&timer), 1360 * UA_DATETIME_MSEC);
+    next = UA_Timer_process(&timer, 1000 * UA_DATETIME_MSEC);
+    ck_assert_uint_eq(count, 4);
+    next = UA_Timer_process(&timer, 1360 * UA_DATETIME_MSEC);
+    ck_assert_uint_eq(count, 5);
+    ck_assert_int_le(next, 2360 * UA_DATETIME_MSEC);
+
+    retval = UA_Timer_modify(&timer, baseId, 1000.0, 0, NULL,
+                             UA_TIMERPOLICY_CURRENTTIME);
+    ck_assert_int_eq(retval, UA_STATUSCODE_BADNOTFOUND);
+    UA_Timer_clear(&timer);
+} END_TEST
+
+static UA_Timer selfTimer;
+static UA_UInt64 selfIds[2];
+
+/* Modify the own entry and remove the other entry from within the callback */
+static void
+selfModifyCallback(void *application, void *data) {
+    count++;
+    UA_Timer_modify(&selfTimer, selfIds[0], 50.0, currentTime, NULL,
+                    UA_TIMERPOLICY_CURRENTTIME);
+    UA_Timer_remove(&selfTimer, selfIds[1]);
+}
+
+START_TEST(timerModifyFromCallback) {
+    UA_Timer_init(&selfTimer);
+    count = 0;
+    currentTime = 0;
+    UA_Timer_add(&selfTimer, selfModifyCallback, NULL, NULL, 10.0, 0, NULL,
+                 UA_TIMERPOLICY_CURRENTTIME, &selfIds[0]);
+    UA_DateTime baseTime = 0;
+    UA_Timer_add(&selfTimer, timerCallback, NULL, NULL, 10.0, 0, &baseTime,
+                 UA_TIMERPOLICY_BASETIME, &selfIds[1]);
+
+    /* Both entries are due. The second one is removed before execution. */
+    currentTime = 10 * UA_DATETIME_MSEC;
+    UA_DateTime next = UA_Timer_process(&selfTimer, currentTime);
+    ck_assert_uint_eq(count, 1);
+    ck_assert_int_le(next, 60 * UA_DATETIME_MSEC);
+
+    currentTime = 60 * UA_DATETIME_MSEC;
+    next = UA_Timer_process(&selfTimer, currentTime);
+    ck_assert_uint_eq(count, 2);
+    ck_assert_int_le(next, 110 * UA_DATETIME_MSEC);
+
+    UA_Timer_clear(&selfTimer);
+    currentTime = 0;
+} END_TEST
+
 int main(void) {
     Suite *s  = suite_create("Test Event Timer");
     TCase *tc = tcase_create("test cases");
+    tcase_add_test(tc, timerPolicies);
+    tcase_add_test(tc, timerModifyFromCallback);
+    tcase_add_test(tc, timerOrderedExecution);
+    tcase_add_test(tc, timerExactExecution);
     tcase_add_test(tc, benchmarkTimer);
+    tcase_add_test(tc, benchmarkTimerScaling);
     suite_add_tcase(s, tc);
 
     SRunner *sr = srunner_create(s);
@@ -691,6 +691,53 @@ START_TEST(parseSelfContainingUnionSelfMember) {
         UA_ByteString_clear(&buf);
     } END_TEST
 
+START_TEST(findBuiltinDataTypes) {
+    for(size_t i = 0; i < UA_TYPES_COUNT; i++) {
+        /* The first type with the same typeId is returned */
+        const UA_DataType *expected = &UA_TYPES[i];
+        for(size_t j = 0; j < i; j++) {
+            if(UA_NodeId_equal(&UA_TYPES[j].typeId, &UA_TYPES[i].typeId)) {
+                expected = &UA_TYPES[j];
+                break;
+            }
+        }
+        ck_assert_ptr_eq(UA_findDataType(&UA_TYPES[i].typeId), expected);
+        ck_assert_ptr_eq(UA_findDataTypeWithCustom(&UA_TYPES[i].typeId,
+                                                   &customDataTypes), expected);
+    }
+
+    UA_NodeId unknown = UA_NODEID_NUMERIC(0, 123456);
+    ck_assert_ptr_eq(UA_findDataType(&unknown), NULL);
+    unknown = UA_NODEID_STRING(0, "Int32");
+    ck_assert_ptr_eq(UA_findDataType(&unknown), NULL);
+} END_TEST
+
+START_TEST(findCustomDataTypes) {
+    UA_DataType types[2];
+    types[0] = PointType;
+    types[1] = PointType;
+    types[1].typeId = UA_NODEID_NUMERIC(1, 2);
+    const UA_DataTypeArray arr = {&customDataTypes, 2, types, UA_FALSE};
+
+    /* Found in the chain. The second lookup can use the cache. */
+    UA_NodeId id = UA_NODEID_NUMERIC(1, 2);
+    ck_assert_ptr_eq(UA_findDataTypeWithCustom(&id, &arr), &types[1]);
+    ck_assert_ptr_eq(UA_findDataTypeWithCustom(&id, &arr), &types[1]);
+    ck_assert_ptr_eq(UA_findDataTypeWithCustom(&PointType.typeId, &arr), &types[0]);
+    ck_assert_ptr_eq(UA_findDataTypeWithCustom(&PointType.typeId, &customDataTypes),
+                     &PointType);
+
+    /* The cached type is not returned for a chain that does not contain it */
+    ck_assert_ptr_eq(UA_findDataTypeWithCustom(&id, &customDataTypes), NULL);
+    ck_assert_ptr_eq(UA_findDataTypeWithCustom(&id, NULL), NULL);
+
+    /* Changes of the array are visible immediately */
+    types[1].typeId.namespaceIndex = 2;
+    ck_assert_ptr_eq(UA_findDataTypeWithCustom(&id, &arr), NULL);
+    id.namespaceIndex = 2;
+    ck_assert_ptr_eq(UA_findDataTypeWithCustom(&id, &arr), &types[1]);
+} END_TEST
+
 int main(void) {
     Suite *s  = suite_create("Test Custom DataType Encoding");
     TCase *tc = tcase_create("test cases");
@@ -703,6 +750,8 @@ int main(void) {
     tcase_add_test(tc, parseSelfContainingUnionSelfMember);
     tcase_add_test(tc, parseCustomStructureWithOptionalFieldsWithArrayNotContained);
     tcase_add_test(tc, parseCustomStructureWithOptionalFieldsWithArrayContained);
+    tcase_add_test(tc, findBuiltinDataTypes);
+    tcase_add_test(tc, findCustomDataTypes);
     suite_add_tcase(s, tc);
 
     SRunner *sr = srunner_create(s);
@@ -780,6 +780,116 @@ START_TEST(format_string) {
     ck_assert_uint_ne(res, UA_STATUSCODE_GOOD);
 } END_TEST
 
+START_TEST(arenaAllocate) {
+    UA_Arena arena;
+    memset(&arena, 0, sizeof(UA_Arena));
+
+    /* Allocations are zeroed, aligned and do not overlap */
+    UA_Byte *last = NULL;
+    for(size_t i = 0; i < 1000; i++) {
+        UA_Byte *p = (UA_Byte*)UA_Arena_calloc(&arena, i % 7 + 1, 3);
+        ck_assert(p != NULL);
+        ck_assert_uint_eq((uintptr_t)p % 8, 0);
+        for(size_t j = 0; j < (i % 7 + 1) * 3; j++)
+            ck_assert_uint_eq(p[j], 0);
+        memset(p, 0xff, (i % 7 + 1) * 3);
+        ck_assert(p != last);
+        last = p;
+    }
+
+    /* Large allocations get their own block */
+    void *large = UA_Arena_calloc(&arena, 1, UA_ARENA_MAXKEEP * 2);
+    ck_assert(large != NULL);
+
+    /* Overflow */
+    ck_assert(UA_Arena_calloc(&arena, SIZE_MAX / 2, 4) == NULL);
+
+    /* After the reset one block below the limit is kept */
+    UA_Arena_reset(&arena);
+    ck_assert(arena.blocks != NULL);
+    ck_assert(arena.blocks->next == NULL);
+    ck_assert_uint_le(arena.blocks->size, UA_ARENA_MAXKEEP);
+    ck_assert_uint_eq(arena.used, 0);
+
+    /* The kept block is used again and zeroed */
+    UA_ArenaBlock *kept = arena.blocks;
+    UA_Byte *p = (UA_Byte*)UA_Arena_calloc(&arena, 16, 1);
+    ck_assert(arena.blocks == kept);
+    for(size_t j = 0; j < 16; j++)
+        ck_assert_uint_eq(p[j], 0);
+
+    UA_Arena_clear(&arena);
+    ck_assert(arena.blocks == NULL);
+} END_TEST
+
+START_TEST(arenaDecode) {
+    UA_NamespaceMapping nsMapping;
+    memset(&nsMapping, 0, sizeof(UA_NamespaceMapping));
+    UA_String namespaces[2] = {
+        UA_STRING_STATIC("ns0"),
+        UA_STRING_STATIC("ns1")
+    };
+    UA_UInt16 identity[2] = {0, 1};
+    nsMapping.namespaceUris = namespaces;
+    nsMapping.namespaceUrisSize = 2;
+    nsMapping.remote2local = identity;
+    nsMapping.remote2localSize = 2;
+
+    /* A request with strings, arrays, variants and an ExpandedNodeId with a
+     * NamespaceUri that is resolved during decoding */
+    UA_WriteValue wv[2];
+    UA_Int32 ints[3] = {1, 2, 3};
+    UA_ExpandedNodeId en = UA_EXPANDEDNODEID_STRING(0, "Token");
+    en.namespaceUri = UA_STRING("ns1");
+    for(size_t i = 0; i < 2; i++) {
+        UA_WriteValue_init(&wv[i]);
+        wv[i].nodeId = UA_NODEID_STRING(1, "Variable");
+        wv[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        wv[i].indexRange = UA_STRING("1:2");
+        wv[i].value.hasValue = true;
+    }
+    UA_Variant_setScalar(&wv[0].value.value, &en, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+    UA_Variant_setArray(&wv[1].value.value, ints, 3, &UA_TYPES[UA_TYPES_INT32]);
+    UA_WriteRequest req;
+    UA_WriteRequest_init(&req);
+    req.nodesToWrite = wv;
+    req.nodesToWriteSize = 2;
+
+    UA_ByteString buf = UA_BYTESTRING_NULL;
+    UA_StatusCode res = UA_encodeBinary(&req, &UA_TYPES[UA_TYPES_WRITEREQUEST], &buf, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_Arena arena;
+    memset(&arena, 0, sizeof(UA_Arena));
+    UA_DecodeBinaryOptions opt;
+    memset(&opt, 0, sizeof(UA_DecodeBinaryOptions));
+    opt.namespaceMapping = &nsMapping;
+    opt.callocContext = &arena;
+    opt.calloc = UA_Arena_calloc;
+
+    for(size_t round = 0; round < 3; round++) {
+        UA_WriteRequest out;
+        res = UA_decodeBinary(&buf, &out, &UA_TYPES[UA_TYPES_WRITEREQUEST], &opt);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert(UA_equal(&out.nodesToWrite[1], &wv[1], &UA_TYPES[UA_TYPES_WRITEVALUE]));
+        const UA_ExpandedNodeId *outEn = (const UA_ExpandedNodeId*)
+            out.nodesToWrite[0].value.value.data;
+        ck_assert_uint_eq(outEn->nodeId.namespaceIndex, 1);
+        ck_assert(UA_String_isEmpty(&outEn->namespaceUri));
+        UA_Arena_reset(&arena);
+    }
+
+    /* Decoding errors leave nothing to clean up besides the arena */
+    UA_WriteRequest out;
+    buf.length--;
+    res = UA_decodeBinary(&buf, &out, &UA_TYPES[UA_TYPES_WRITEREQUEST], &opt);
+    ck_assert_uint_ne(res, UA_STATUSCODE_GOOD);
+    buf.length++;
+
+    UA_Arena_clear(&arena);
+    UA_ByteString_clear(&buf);
+} END_TEST
+
 static Suite* testSuite_Utils(void) {
     Suite *s = suite_create("Utils");
     TCase *tc_endpointUrl_split = tcase_create("EndpointUrl_split");
@@ -831,6 +941,11 @@ static Suite* testSuite_Utils(void) {
     tcase_add_test(tc6, format_string);
     suite_add_tcase(s, tc6);
 
+    TCase *tc7 = tcase_create("test arena");
+    tcase_add_test(tc7, arenaAllocate);
+    tcase_add_test(tc7, arenaDecode);
+    suite_add_tcase(s, tc7);
+
     return s;
 }
 
@@ -10,6 +10,8 @@
 
 #include "client/ua_client_internal.h"
 #include "server/ua_server_internal.h"
+#include "server/ua_services.h"
+#include "server/ua_subscription.h"
 #include "test_helpers.h"
 
 #include <stdio.h>
@@ -172,6 +174,92 @@ START_TEST(Client_subscription) {
 }
 END_TEST
 
+/* DataChangeNotifications are retained in their binary encoding and republished
+ * from there */
+START_TEST(Client_subscription_republish) {
+    UA_Client *client = UA_Client_newForUnitTest();
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_CreateSubscriptionRequest request = UA_CreateSubscriptionRequest_default();
+    UA_CreateSubscriptionResponse response = UA_Client_Subscriptions_create(client, request,
+                                                                            NULL, NULL, NULL);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    UA_UInt32 subId = response.subscriptionId;
+
+    UA_MonitoredItemCreateRequest monRequest =
+        UA_MonitoredItemCreateRequest_default(UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE));
+    UA_MonitoredItemCreateResult monResponse =
+        UA_Client_MonitoredItems_createDataChange(client, subId,
+                                                  UA_TIMESTAMPSTORETURN_BOTH,
+                                                  monRequest, NULL, dataChangeHandler, NULL);
+    ck_assert_uint_eq(monResponse.statusCode, UA_STATUSCODE_GOOD);
+
+    /* manually control the server thread */
+    running = false;
+    THREAD_JOIN(server_thread);
+
+    UA_Server_run_iterate(server, true);
+    retval = UA_Client_run_iterate(client, 1);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_fakeSleep((UA_UInt32)publishingInterval + 1);
+
+    notificationReceived = false;
+    UA_Server_run_iterate(server, true);
+    retval = UA_Client_run_iterate(client, 1);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(notificationReceived, true);
+
+    /* The acknowledgement has not been processed by the server yet. Republish
+     * the retained NotificationMessage directly. */
+    lockServer(server);
+    UA_Subscription *sub = getSubscriptionById(server, subId);
+    ck_assert_ptr_ne(sub, NULL);
+    ck_assert_uint_eq(sub->retransmissionQueueSize, 1);
+
+    UA_RepublishRequest repRequest;
+    UA_RepublishRequest_init(&repRequest);
+    repRequest.subscriptionId = subId;
+    repRequest.retransmitSequenceNumber =
+        TAILQ_FIRST(&sub->retransmissionQueue)->message.sequenceNumber;
+    UA_RepublishResponse repResponse;
+    UA_RepublishResponse_init(&repResponse);
+    Service_Republish(server, sub->session, &repRequest, &repResponse);
+    unlockServer(server);
+    ck_assert_uint_eq(repResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(repResponse.notificationMessage.notificationDataSize, 1);
+
+    UA_ExtensionObject *eo = &repResponse.notificationMessage.notificationData[0];
+    ck_assert_int_eq(eo->encoding, UA_EXTENSIONOBJECT_ENCODED_BYTESTRING);
+    ck_assert(UA_NodeId_equal(&eo->content.encoded.typeId,
+                              &UA_TYPES[UA_TYPES_DATACHANGENOTIFICATION].binaryEncodingId));
+
+    UA_DataChangeNotification dcn;
+    retval = UA_decodeBinary(&eo->content.encoded.body, &dcn,
+                             &UA_TYPES[UA_TYPES_DATACHANGENOTIFICATION], NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(dcn.monitoredItemsSize, 1);
+    UA_DataValue *dv = &dcn.monitoredItems[0].value;
+    ck_assert(dv->hasValue);
+    ck_assert(dv->hasServerTimestamp);
+    ck_assert(dv->hasSourceTimestamp);
+    ck_assert(UA_Variant_hasScalarType(&dv->value, &UA_TYPES[UA_TYPES_INT32]));
+    UA_DataChangeNotification_clear(&dcn);
+    UA_RepublishResponse_clear(&repResponse);
+
+    /* run the server in an independent thread again */
+    running = true;
+    THREAD_CREATE(server_thread, serverloop);
+
+    retval = UA_Client_Subscriptions_deleteSingle(client, subId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
 START_TEST(Client_subscription_async) {
     UA_Client *client = UA_Client_newForUnitTest();
     UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
@@ -1649,6 +1737,7 @@ static Suite* testSuite_Client(void) {
     tcase_add_checked_fixture(tc_client, setup, teardown);
     tcase_add_test(tc_client, Client_subscription);
     tcase_add_test(tc_client, Client_subscription_async);
+    tcase_add_test(tc_client, Client_subscription_republish);
     tcase_add_test(tc_client, Client_subscription_statusChange);
     tcase_add_test(tc_client, Client_subscription_timeout);
     tcase_add_test(tc_client, Client_subscription_detach);
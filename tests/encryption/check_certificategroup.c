@@ -9,6 +9,8 @@
 #include <open62541/client.h>
 #include <open62541/client_config_default.h>
 #include <open62541/plugin/certificategroup_default.h>
+#include <open62541/plugin/create_certificate.h>
+#include <open62541/plugin/log_stdout.h>
 #include <open62541/server.h>
 #include <open62541/server_config_default.h>
 
@@ -332,6 +334,57 @@ START_TEST(get_rejectedlist) {
 }
 END_TEST
 
+START_TEST(verify_cached_after_trustlist_change) {
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_CertificateGroup *cg = &config->secureChannelPKI;
+
+    /* Generate a certificate that is valid independent of the current date */
+    UA_ByteString privateKey = UA_BYTESTRING_NULL;
+    UA_ByteString certificate = UA_BYTESTRING_NULL;
+    UA_String subject[2] = {UA_STRING_STATIC("O=SampleOrganization"),
+                            UA_STRING_STATIC("CN=Open62541Client@localhost")};
+    UA_String subjectAltName[2]= {
+        UA_STRING_STATIC("DNS:localhost"),
+        UA_STRING_STATIC("URI:urn:open62541.unconfigured.application")
+    };
+    UA_StatusCode retval =
+        UA_CreateCertificate(UA_Log_Stdout, subject, 2, subjectAltName, 2,
+                             UA_CERTIFICATEFORMAT_DER, NULL, &privateKey, &certificate);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_TrustListDataType trustListTmp;
+    memset(&trustListTmp, 0, sizeof(UA_TrustListDataType));
+    trustListTmp.specifiedLists = UA_TRUSTLISTMASKS_TRUSTEDCERTIFICATES;
+    trustListTmp.trustedCertificates = &certificate;
+    trustListTmp.trustedCertificatesSize = 1;
+
+    retval = cg->setTrustList(cg, &trustListTmp);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Repeated verification returns the same (cached) result */
+    for(size_t i = 0; i < 3; i++) {
+        retval = cg->verifyCertificate(cg, &certificate);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    /* The cached result is not used after the trust list has changed */
+    retval = cg->removeFromTrustList(cg, &trustListTmp);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = cg->verifyCertificate(cg, &certificate);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADCERTIFICATEUNTRUSTED);
+    retval = cg->verifyCertificate(cg, &certificate);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADCERTIFICATEUNTRUSTED);
+
+    retval = cg->addToTrustList(cg, &trustListTmp);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = cg->verifyCertificate(cg, &certificate);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_ByteString_clear(&certificate);
+    UA_ByteString_clear(&privateKey);
+}
+END_TEST
+
 static Suite* testSuite_encryption(void) {
     Suite *s = suite_create("CertificateGroup");
     TCase *tc_encryption_memorystore = tcase_create("CertificateGroup Memorystore");
@@ -342,6 +395,7 @@ static Suite* testSuite_encryption(void) {
     tcase_add_test(tc_encryption_memorystore, add_to_trustlist);
     tcase_add_test(tc_encryption_memorystore, remove_from_trustlist);
     tcase_add_test(tc_encryption_memorystore, get_rejectedlist);
+    tcase_add_test(tc_encryption_memorystore, verify_cached_after_trustlist_change);
 #endif /* UA_ENABLE_ENCRYPTION */
     suite_add_tcase(s,tc_encryption_memorystore);
 
@@ -354,6 +408,7 @@ static Suite* testSuite_encryption(void) {
     tcase_add_test(tc_encryption_filestore, add_to_trustlist);
     tcase_add_test(tc_encryption_filestore, remove_from_trustlist);
     tcase_add_test(tc_encryption_filestore, get_rejectedlist);
+    tcase_add_test(tc_encryption_filestore, verify_cached_after_trustlist_change);
     suite_add_tcase(s,tc_encryption_filestore);
 #endif /* UA_ENABLE_ENCRYPTION */
 #endif /* defined(__linux__) || defined(UA_ARCHITECTURE_WIN32) */
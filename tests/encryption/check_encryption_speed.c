@@ -0,0 +1,176 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Measures the throughput of the symmetric sign-and-encrypt path of the
+ * SecurityPolicies for full-size chunks. The same keys are used for the local
+ * and the remote side, so that every chunk can be decrypted and verified
+ * again. */
+
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/plugin/securitypolicy_default.h>
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdio.h>
+
+#include "certificates.h"
+
+#define CHUNKSIZE 65536 /* Multiple of the AES block size */
+#define CHUNKS 500
+
+typedef UA_StatusCode
+(*PolicyConstructor)(UA_SecurityPolicy *policy, const UA_ByteString localCertificate,
+                     const UA_ByteString localPrivateKey, const UA_Logger *logger);
+
+static UA_StatusCode
+setSymKeys(UA_SecurityPolicy *sp, void *cc, UA_Byte fill) {
+    const UA_SecurityPolicyCryptoModule *crm = &sp->symmetricModule.cryptoModule;
+    UA_Byte buf[256];
+    memset(buf, fill, sizeof(buf));
+    UA_ByteString signingKey = {crm->signatureAlgorithm.getLocalKeyLength(cc), buf};
+    UA_ByteString encryptingKey = {crm->encryptionAlgorithm.getLocalKeyLength(cc), buf};
+    UA_ByteString iv = {crm->encryptionAlgorithm.getRemoteBlockSize(cc), buf};
+    ck_assert_uint_le(signingKey.length, sizeof(buf));
+    ck_assert_uint_le(encryptingKey.length, sizeof(buf));
+
+    const UA_SecurityPolicyChannelModule *cm = &sp->channelModule;
+    UA_StatusCode res = cm->setLocalSymSigningKey(cc, &signingKey);
+    res |= cm->setLocalSymEncryptingKey(cc, &encryptingKey);
+    res |= cm->setLocalSymIv(cc, &iv);
+    res |= cm->setRemoteSymSigningKey(cc, &signingKey);
+    res |= cm->setRemoteSymEncryptingKey(cc, &encryptingKey);
+    res |= cm->setRemoteSymIv(cc, &iv);
+    return res;
+}
+
+static void
+measureThroughput(PolicyConstructor constructor) {
+    UA_ByteString certificate = {CERT_DER_LENGTH, CERT_DER_DATA};
+    UA_ByteString privateKey = {KEY_DER_LENGTH, KEY_DER_DATA};
+
+    UA_SecurityPolicy sp;
+    UA_StatusCode res = constructor(&sp, certificate, privateKey, UA_Log_Stdout);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    void *cc = NULL;
+    res = sp.channelModule.newContext(&sp, &certificate, &cc);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = setSymKeys(&sp, cc, 0x2a);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    const UA_SecurityPolicyCryptoModule *crm = &sp.symmetricModule.cryptoModule;
+    UA_Byte sigBuf[64];
+    UA_ByteString sig = {crm->signatureAlgorithm.getLocalSignatureSize(cc), sigBuf};
+    ck_assert_uint_le(sig.length, sizeof(sigBuf));
+
+    UA_ByteString plain;
+    UA_ByteString chunk;
+    res = UA_ByteString_allocBuffer(&plain, CHUNKSIZE);
+    res |= UA_ByteString_allocBuffer(&chunk, CHUNKSIZE);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < CHUNKSIZE; i++)
+        plain.data[i] = (UA_Byte)(i * 31);
+
+    clock_t sendTime = 0;
+    clock_t receiveTime = 0;
+    for(size_t i = 0; i < CHUNKS; i++) {
+        memcpy(chunk.data, plain.data, CHUNKSIZE);
+        plain.data[i % CHUNKSIZE]++; /* Different content for every chunk */
+
+        clock_t begin = clock();
+        res = crm->signatureAlgorithm.sign(cc, &chunk, &sig);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        res = crm->encryptionAlgorithm.encrypt(cc, &chunk);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        clock_t sent = clock();
+        res = crm->encryptionAlgorithm.decrypt(cc, &chunk);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        res = crm->signatureAlgorithm.verify(cc, &chunk, &sig);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        receiveTime += clock() - sent;
+        sendTime += sent - begin;
+
+        /* The round-trip restores the plaintext */
+        ck_assert_uint_eq(chunk.length, CHUNKSIZE);
+        plain.data[i % CHUNKSIZE]--;
+        ck_assert(memcmp(chunk.data, plain.data, CHUNKSIZE) == 0);
+        plain.data[i % CHUNKSIZE]++;
+    }
+
+    double mb = (double)CHUNKS * CHUNKSIZE / (1024.0 * 1024.0);
+    double sendSec = (double)sendTime / CLOCKS_PER_SEC;
+    double receiveSec = (double)receiveTime / CLOCKS_PER_SEC;
+    printf("%.*s: sign+encrypt %.1f MB/s, decrypt+verify %.1f MB/s\n",
+           (int)sp.policyUri.length, (char*)sp.policyUri.data,
+           sendSec > 0.0 ? mb / sendSec : 0.0,
+           receiveSec > 0.0 ? mb / receiveSec : 0.0);
+
+    /* Tampered content does not verify */
+    chunk.data[0] ^= 0x01;
+    res = crm->signatureAlgorithm.verify(cc, &chunk, &sig);
+    ck_assert_uint_ne(res, UA_STATUSCODE_GOOD);
+    chunk.data[0] ^= 0x01;
+
+    /* The new keys are used after a key change */
+    res = crm->signatureAlgorithm.sign(cc, &chunk, &sig);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = setSymKeys(&sp, cc, 0x17);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = crm->signatureAlgorithm.verify(cc, &chunk, &sig);
+    ck_assert_uint_ne(res, UA_STATUSCODE_GOOD);
+    memcpy(chunk.data, plain.data, CHUNKSIZE);
+    res = crm->encryptionAlgorithm.encrypt(cc, &chunk);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = crm->encryptionAlgorithm.decrypt(cc, &chunk);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(memcmp(chunk.data, plain.data, CHUNKSIZE) == 0);
+
+    UA_ByteString_clear(&plain);
+    UA_ByteString_clear(&chunk);
+    sp.channelModule.deleteContext(cc);
+    sp.clear(&sp);
+}
+
+START_TEST(throughput_basic128rsa15) {
+    measureThroughput(UA_SecurityPolicy_Basic128Rsa15);
+} END_TEST
+
+START_TEST(throughput_basic256) {
+    measureThroughput(UA_SecurityPolicy_Basic256);
+} END_TEST
+
+START_TEST(throughput_basic256sha256) {
+    measureThroughput(UA_SecurityPolicy_Basic256Sha256);
+} END_TEST
+
+START_TEST(throughput_aes128sha256rsaoaep) {
+    measureThroughput(UA_SecurityPolicy_Aes128Sha256RsaOaep);
+} END_TEST
+
+START_TEST(throughput_aes256sha256rsapss) {
+    measureThroughput(UA_SecurityPolicy_Aes256Sha256RsaPss);
+} END_TEST
+
+static Suite *testSuite_encryption_speed(void) {
+    Suite *s = suite_create("Encryption Speed");
+    TCase *tc = tcase_create("Symmetric Throughput");
+    tcase_add_test(tc, throughput_basic128rsa15);
+    tcase_add_test(tc, throughput_basic256);
+    tcase_add_test(tc, throughput_basic256sha256);
+    tcase_add_test(tc, throughput_aes128sha256rsaoaep);
+    tcase_add_test(tc, throughput_aes256sha256rsapss);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_encryption_speed();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
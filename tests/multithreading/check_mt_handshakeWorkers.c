@@ -0,0 +1,141 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/plugin/certificategroup_default.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <check.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+#include "thread_wrapper.h"
+#include "mt_testing.h"
+#include "../encryption/certificates.h"
+
+#define NUMBER_OF_WORKERS 4
+#define ITERATIONS_PER_WORKER 10
+#define NUMBER_OF_CLIENTS 2
+#define ITERATIONS_PER_CLIENT 100
+#define NETWORK_WORKER_THREADS 4
+
+static void setup(void) {
+    tc.running = true;
+
+    UA_ByteString certificate = {CERT_DER_LENGTH, CERT_DER_DATA};
+    UA_ByteString privateKey = {KEY_DER_LENGTH, KEY_DER_DATA};
+
+    /* Set up the EventLoop with worker threads before it is started by the
+     * default server config */
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    config.eventLoop = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    UA_UInt16 workerThreads = NETWORK_WORKER_THREADS;
+    UA_KeyValueMap_setScalar(&config.eventLoop->params,
+                             UA_QUALIFIEDNAME(0, "worker-threads"),
+                             &workerThreads, &UA_TYPES[UA_TYPES_UINT16]);
+    UA_ConnectionManager *tcpCM =
+        UA_ConnectionManager_new_POSIX_TCP(UA_STRING("tcp connection manager"));
+    config.eventLoop->registerEventSource(config.eventLoop, (UA_EventSource *)tcpCM);
+    UA_StatusCode res =
+        UA_ServerConfig_setDefaultWithSecurityPolicies(&config, 4840, &certificate,
+                                                       &privateKey, NULL, 0,
+                                                       NULL, 0, NULL, 0);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_CertificateGroup_AcceptAll(&config.secureChannelPKI);
+    UA_CertificateGroup_AcceptAll(&config.sessionPKI);
+    UA_String_clear(&config.applicationDescription.applicationUri);
+    config.applicationDescription.applicationUri =
+        UA_STRING_ALLOC("urn:unconfigured:application");
+    config.tcpReuseAddr = true;
+    config.concurrentHandshakes = true;
+
+    tc.server = UA_Server_newWithConfig(&config);
+    ck_assert(tc.server != NULL);
+    UA_Server_run_startup(tc.server);
+    THREAD_CREATE(server_thread, serverloop);
+}
+
+static void
+readState(UA_Client *client) {
+    UA_Variant val;
+    UA_Variant_init(&val);
+    UA_NodeId nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE);
+    UA_StatusCode retval = UA_Client_readValueAttribute(client, nodeId, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Variant_clear(&val);
+}
+
+/* Open an encrypted SecureChannel and Session. The handshakes of the workers
+ * run in parallel to the requests of the established clients. */
+static void
+worker_encryptedConnect(void *value) {
+    UA_ByteString certificate = {CERT_DER_LENGTH, CERT_DER_DATA};
+    UA_ByteString privateKey = {KEY_DER_LENGTH, KEY_DER_DATA};
+
+    UA_Client *client = UA_Client_newForUnitTest();
+    ck_assert(client != NULL);
+    UA_ClientConfig *cc = UA_Client_getConfig(client);
+    UA_ClientConfig_setDefaultEncryption(cc, certificate, privateKey,
+                                         NULL, 0, NULL, 0);
+    UA_CertificateGroup_AcceptAll(&cc->certificateVerification);
+    cc->securityMode = UA_MESSAGESECURITYMODE_SIGNANDENCRYPT;
+    cc->securityPolicyUri =
+        UA_STRING_ALLOC("http://opcfoundation.org/UA/SecurityPolicy#Basic256Sha256");
+
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    readState(client);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+
+static void
+client_read(void *value) {
+    ThreadContext tmp = (*(ThreadContext *) value);
+    readState(tc.clients[tmp.index]);
+}
+
+static
+void initTest(void) {
+    for(size_t i = 0; i < tc.numberOfWorkers; i++) {
+        setThreadContext(&tc.workerContext[i], i, ITERATIONS_PER_WORKER,
+                         worker_encryptedConnect);
+    }
+
+    for(size_t i = 0; i < tc.numberofClients; i++) {
+        setThreadContext(&tc.clientContext[i], i, ITERATIONS_PER_CLIENT,
+                         client_read);
+    }
+}
+
+START_TEST(handshakeWorkers) {
+        startMultithreading();
+    }
+END_TEST
+
+static Suite* testSuite_handshakeWorkers(void) {
+    Suite *s = suite_create("Multithreading");
+    TCase *tc_handshakes = tcase_create("Concurrent handshakes");
+    tcase_add_checked_fixture(tc_handshakes, setup, teardown);
+    tcase_add_test(tc_handshakes, handshakeWorkers);
+    suite_add_tcase(s, tc_handshakes);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_handshakeWorkers();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+
+    createThreadContext(NUMBER_OF_WORKERS, NUMBER_OF_CLIENTS, NULL);
+    initTest();
+    srunner_run_all(sr, CK_NORMAL);
+    deleteThreadContext();
+
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
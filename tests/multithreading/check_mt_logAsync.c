@@ -0,0 +1,100 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/plugin/log_stdout.h>
+#include <check.h>
+#include <stdlib.h>
+
+#include "testing_clock.h"
+#include "thread_wrapper.h"
+
+#define NUMBER_OF_THREADS 4
+#define MESSAGES_PER_THREAD 500
+
+static UA_Logger *logger;
+
+THREAD_CALLBACK(logThread) {
+    for(size_t i = 0; i < MESSAGES_PER_THREAD; i++) {
+        UA_String s = UA_STRING("async");
+        UA_LOG_INFO(logger, UA_LOGCATEGORY_USERLAND,
+                    "Message %u of %S", (unsigned)i, s);
+    }
+    return 0;
+}
+
+static void
+logFromThreads(void) {
+    THREAD_HANDLE threads[NUMBER_OF_THREADS];
+    for(size_t i = 0; i < NUMBER_OF_THREADS; i++)
+        THREAD_CREATE(threads[i], logThread);
+    for(size_t i = 0; i < NUMBER_OF_THREADS; i++)
+        THREAD_JOIN(threads[i]);
+}
+
+/* Wait until all messages are either written or dropped */
+static void
+waitForDrain(UA_LogAsyncStatistics *stats) {
+    for(size_t i = 0; i < 1000; i++) {
+        UA_StatusCode res = UA_Log_Stdout_getAsyncStatistics(logger, stats);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        if(stats->written + stats->dropped == NUMBER_OF_THREADS * MESSAGES_PER_THREAD)
+            return;
+        UA_realSleep(10);
+    }
+    ck_abort_msg("Messages were not written");
+}
+
+START_TEST(asyncLogBlock) {
+    logger = UA_Log_Stdout_newAsync(UA_LOGLEVEL_INFO, 8, UA_LOGOVERFLOW_BLOCK);
+    ck_assert_ptr_ne(logger, NULL);
+    logFromThreads();
+    UA_LogAsyncStatistics stats;
+    waitForDrain(&stats);
+    ck_assert_uint_eq(stats.written, NUMBER_OF_THREADS * MESSAGES_PER_THREAD);
+    ck_assert_uint_eq(stats.dropped, 0);
+    logger->clear(logger);
+} END_TEST
+
+START_TEST(asyncLogDrop) {
+    logger = UA_Log_Stdout_newAsync(UA_LOGLEVEL_INFO, 2, UA_LOGOVERFLOW_COUNT);
+    ck_assert_ptr_ne(logger, NULL);
+    logFromThreads();
+    UA_LogAsyncStatistics stats;
+    waitForDrain(&stats);
+    ck_assert_uint_eq(stats.blocked, 0);
+    logger->clear(logger);
+} END_TEST
+
+START_TEST(asyncLogLevel) {
+    logger = UA_Log_Stdout_newAsync(UA_LOGLEVEL_WARNING, 16, UA_LOGOVERFLOW_BLOCK);
+    ck_assert_ptr_ne(logger, NULL);
+    UA_LOG_INFO(logger, UA_LOGCATEGORY_USERLAND, "Filtered");
+    UA_LOG_WARNING(logger, UA_LOGCATEGORY_USERLAND, "Not filtered");
+    logger->clear(logger);
+
+    /* Only the asynchronous logger has statistics */
+    UA_LogAsyncStatistics stats;
+    UA_StatusCode res = UA_Log_Stdout_getAsyncStatistics(UA_Log_Stdout, &stats);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADINVALIDARGUMENT);
+} END_TEST
+
+static Suite* testSuite_logAsync(void) {
+    Suite *s = suite_create("Asynchronous Logger");
+    TCase *tc_log = tcase_create("Core");
+    tcase_add_test(tc_log, asyncLogBlock);
+    tcase_add_test(tc_log, asyncLogDrop);
+    tcase_add_test(tc_log, asyncLogLevel);
+    suite_add_tcase(s, tc_log);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_logAsync();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
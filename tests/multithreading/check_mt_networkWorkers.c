@@ -0,0 +1,154 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <check.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+#include "thread_wrapper.h"
+#include "mt_testing.h"
+
+#define NUMBER_OF_WORKERS 2
+#define ITERATIONS_PER_WORKER 50
+#define NUMBER_OF_CLIENTS 8
+#define ITERATIONS_PER_CLIENT 50
+#define NETWORK_WORKER_THREADS 4
+
+UA_NodeId pumpTypeId = {1, UA_NODEIDTYPE_NUMERIC, {1001}};
+
+static
+void addVariableNode(void) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 myInteger = 42;
+    UA_Variant_setScalar(&attr.value, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+    attr.description = UA_LOCALIZEDTEXT("en-US","Temperature");
+    attr.displayName = UA_LOCALIZEDTEXT("en-US","Temperature");
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_QualifiedName myIntegerName = UA_QUALIFIEDNAME(1, "Temperature");
+    UA_NodeId parentNodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    UA_NodeId parentReferenceNodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+    UA_StatusCode res =
+            UA_Server_addVariableNode(tc.server, pumpTypeId, parentNodeId,
+                                      parentReferenceNodeId, myIntegerName,
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                      attr, NULL, NULL);
+    ck_assert_int_eq(UA_STATUSCODE_GOOD, res);
+}
+
+static void setup(void) {
+    tc.running = true;
+
+    /* Set up the EventLoop with worker threads before it is started by the
+     * default server config */
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    config.eventLoop = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    UA_UInt16 workerThreads = NETWORK_WORKER_THREADS;
+    UA_KeyValueMap_setScalar(&config.eventLoop->params,
+                             UA_QUALIFIEDNAME(0, "worker-threads"),
+                             &workerThreads, &UA_TYPES[UA_TYPES_UINT16]);
+    UA_ConnectionManager *tcpCM =
+        UA_ConnectionManager_new_POSIX_TCP(UA_STRING("tcp connection manager"));
+    config.eventLoop->registerEventSource(config.eventLoop, (UA_EventSource *)tcpCM);
+    UA_ServerConfig_setDefault(&config);
+    config.tcpReuseAddr = true;
+
+    tc.server = UA_Server_newWithConfig(&config);
+    ck_assert(tc.server != NULL);
+    addVariableNode();
+    UA_Server_run_startup(tc.server);
+    THREAD_CREATE(server_thread, serverloop);
+}
+
+static
+void server_writeValueAttribute(void *value) {
+    UA_Int32 myInteger = 42;
+    UA_Variant var;
+    UA_Variant_setScalar(&var, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+    UA_StatusCode ret = UA_Server_writeValue(tc.server, pumpTypeId, var);
+    ck_assert_int_eq(UA_STATUSCODE_GOOD, ret);
+}
+
+static
+void client_readWriteBrowse(void *value) {
+    ThreadContext tmp = (*(ThreadContext *) value);
+    UA_Client *client = tc.clients[tmp.index];
+
+    UA_Variant val;
+    UA_StatusCode retval = UA_Client_readValueAttribute(client, pumpTypeId, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(42, *(UA_Int32 *)val.data);
+
+    /* Write the same value back */
+    retval = UA_Client_writeValueAttribute(client, pumpTypeId, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Variant_clear(&val);
+
+    UA_BrowseRequest bReq;
+    UA_BrowseRequest_init(&bReq);
+    bReq.requestedMaxReferencesPerNode = 0;
+    bReq.nodesToBrowse = UA_BrowseDescription_new();
+    bReq.nodesToBrowseSize = 1;
+    bReq.nodesToBrowse[0].nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    bReq.nodesToBrowse[0].resultMask = UA_BROWSERESULTMASK_ALL;
+    UA_BrowseResponse bResp = UA_Client_Service_browse(client, bReq);
+    ck_assert_uint_eq(bResp.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(bResp.resultsSize, 1);
+    ck_assert_uint_gt(bResp.results[0].referencesSize, 0);
+    UA_BrowseRequest_clear(&bReq);
+    UA_BrowseResponse_clear(&bResp);
+
+    /* Reconnect every few iterations. Connections are closed and opened while
+     * the worker threads process the other connections. */
+    if(tmp.counter % 10 == 9) {
+        UA_Client_disconnect(client);
+        retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+}
+
+static
+void initTest(void) {
+    for(size_t i = 0; i < tc.numberOfWorkers; i++) {
+        setThreadContext(&tc.workerContext[i], i, ITERATIONS_PER_WORKER,
+                         server_writeValueAttribute);
+    }
+
+    for(size_t i = 0; i < tc.numberofClients; i++) {
+        setThreadContext(&tc.clientContext[i], i, ITERATIONS_PER_CLIENT,
+                         client_readWriteBrowse);
+    }
+}
+
+START_TEST(networkWorkers) {
+        startMultithreading();
+    }
+END_TEST
+
+static Suite* testSuite_networkWorkers(void) {
+    Suite *s = suite_create("Multithreading");
+    TCase *tc_workers = tcase_create("EventLoop worker threads");
+    tcase_add_checked_fixture(tc_workers, setup, teardown);
+    tcase_add_test(tc_workers, networkWorkers);
+    suite_add_tcase(s, tc_workers);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_networkWorkers();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+
+    createThreadContext(NUMBER_OF_WORKERS, NUMBER_OF_CLIENTS, NULL);
+    initTest();
+    srunner_run_all(sr, CK_NORMAL);
+    deleteThreadContext();
+
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
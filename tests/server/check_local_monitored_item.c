@@ -120,6 +120,73 @@ START_TEST(Server_LocalMonitoredItem) {
 }
 END_TEST
 
+static UA_UInt32 sharedLastValue[3];
+
+static void
+sharedDataChangeCallback(UA_Server *thisServer, UA_UInt32 monitoredItemId,
+                         void *monitoredItemContext, const UA_NodeId *nodeId,
+                         void *nodeContext, UA_UInt32 attributeId,
+                         const UA_DataValue *value) {
+    ck_assert(value->hasValue);
+    UA_UInt32 *last = (UA_UInt32*)monitoredItemContext;
+    *last = *(UA_UInt32*)value->value.data;
+    callbackCount++;
+}
+
+/* Identical MonitoredItems sample the value once and share it */
+START_TEST(Server_LocalMonitoredItem_shared) {
+    callbackCount = 0;
+
+    UA_MonitoredItemCreateRequest monitorRequest =
+        UA_MonitoredItemCreateRequest_default(outNodeId);
+    monitorRequest.requestedParameters.samplingInterval = (double)100;
+    monitorRequest.monitoringMode = UA_MONITORINGMODE_REPORTING;
+    UA_UInt32 monIds[3];
+    for(size_t i = 0; i < 3; i++) {
+        sharedLastValue[i] = 0;
+        UA_MonitoredItemCreateResult result =
+            UA_Server_createDataChangeMonitoredItem(server, UA_TIMESTAMPSTORETURN_BOTH,
+                                                    monitorRequest, &sharedLastValue[i],
+                                                    sharedDataChangeCallback);
+        ASSERT_STATUSCODE(result.statusCode, UA_STATUSCODE_GOOD);
+        monIds[i] = result.monitoredItemId;
+    }
+
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(callbackCount, 3);
+
+    UA_UInt32 count = 0;
+    UA_Variant val;
+    UA_Variant_setScalar(&val, &count, &UA_TYPES[UA_TYPES_UINT32]);
+    for(size_t i = 0; i < 5; i++) {
+        count++;
+        UA_Server_writeValue(server, outNodeId, val);
+        UA_fakeSleep(100);
+        UA_Server_run_iterate(server, 1);
+        for(size_t j = 0; j < 3; j++)
+            ck_assert_uint_eq(sharedLastValue[j], count);
+    }
+    ck_assert_uint_eq(callbackCount, 18);
+
+    /* Unchanged values are not reported */
+    UA_fakeSleep(100);
+    UA_Server_run_iterate(server, 1);
+    ck_assert_uint_eq(callbackCount, 18);
+
+    /* Remove one MonitoredItem from the share */
+    ASSERT_STATUSCODE(UA_Server_deleteMonitoredItem(server, monIds[1]),
+                      UA_STATUSCODE_GOOD);
+    count++;
+    UA_Server_writeValue(server, outNodeId, val);
+    UA_fakeSleep(100);
+    UA_Server_run_iterate(server, 1);
+    ck_assert_uint_eq(callbackCount, 20);
+    ck_assert_uint_eq(sharedLastValue[0], count);
+    ck_assert_uint_eq(sharedLastValue[1], count - 1);
+    ck_assert_uint_eq(sharedLastValue[2], count);
+}
+END_TEST
+
 static UA_UInt32 staticUInt32 = 1337;
 
 static UA_StatusCode
@@ -328,6 +395,7 @@ static Suite * testSuite_Client(void) {
     TCase *tc_server = tcase_create("Local Monitored Item Basic");
     tcase_add_checked_fixture(tc_server, setup, teardown);
     tcase_add_test(tc_server, Server_LocalMonitoredItem);
+    tcase_add_test(tc_server, Server_LocalMonitoredItem_shared);
     tcase_add_test(tc_server, Server_LocalMonitoredItem_dataSource);
     tcase_add_test(tc_server, Server_LocalMonitoredItem_CustomType);
     suite_add_tcase(s, tc_server);
@@ -13,7 +13,7 @@
 #include <time.h>
 #include "check.h"
 
-#if UA_MULTITHREADING >= 200
+#if UA_MULTITHREADING >= 100 && !defined(_WIN32)
 #include <pthread.h>
 #endif
 
@@ -27,6 +27,14 @@ static void setupHashMap(void) {
     UA_Nodestore_HashMap(&ns);
 }
 
+static void setupHashMapConcurrent(void) {
+    UA_Nodestore_HashMapConcurrent(&ns);
+}
+
+static void setupSwissTable(void) {
+    UA_Nodestore_SwissTable(&ns);
+}
+
 static void teardown(void) {
     ns.clear(ns.context);
 }
@@ -191,6 +199,228 @@ START_TEST(failToFindNonExistentNodeInUA_NodeStoreWithSeveralEntries) {
 }
 END_TEST
 
+START_TEST(insertRemoveWhileResizing) {
+    /* Grow and shrink the table several times */
+    for(UA_UInt32 round = 0; round < 3; round++) {
+        for(UA_UInt32 i = 0; i < 5000; i++) {
+            UA_Node* n = createNode(1, i+1);
+            UA_StatusCode retval = ns.insertNode(ns.context, n, NULL);
+            ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+        }
+        for(UA_UInt32 i = 0; i < 5000; i++) {
+            if(i % 100 == 0)
+                continue;
+            UA_NodeId id = UA_NODEID_NUMERIC(1, i+1);
+            UA_StatusCode retval = ns.removeNode(ns.context, &id);
+            ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+        }
+        for(UA_UInt32 i = 0; i < 5000; i++) {
+            UA_NodeId id = UA_NODEID_NUMERIC(1, i+1);
+            const UA_Node *n = ns.getNode(ns.context, &id, ~(UA_UInt32)0,
+                                          UA_REFERENCETYPESET_ALL,
+                                          UA_BROWSEDIRECTION_BOTH);
+            ck_assert_uint_eq(n != NULL, i % 100 == 0);
+            ns.releaseNode(ns.context, n);
+        }
+        for(UA_UInt32 i = 0; i < 5000; i += 100) {
+            UA_NodeId id = UA_NODEID_NUMERIC(1, i+1);
+            UA_StatusCode retval = ns.removeNode(ns.context, &id);
+            ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+        }
+    }
+
+    zeroCnt = 0;
+    visitCnt = 0;
+    ns.iterate(ns.context, checkZeroVisitor, NULL);
+    ck_assert_int_eq(visitCnt, 0);
+}
+END_TEST
+
+START_TEST(stringNodeIdSharedWithCopy) {
+    UA_Node *n = ns.newNode(ns.context, UA_NODECLASS_VARIABLE);
+    n->head.nodeId = UA_NODEID_STRING_ALLOC(1, "my.node");
+    UA_NodeId addedId;
+    UA_StatusCode retval = ns.insertNode(ns.context, n, &addedId);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Lookup with an independent NodeId */
+    const UA_Node *nr = ns.getNode(ns.context, &addedId, ~(UA_UInt32)0,
+                                   UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    ck_assert_ptr_eq(nr, n);
+    ck_assert_ptr_ne(nr->head.nodeId.identifier.string.data,
+                     addedId.identifier.string.data);
+
+    /* The copy shares the identifier */
+    UA_Node *copy;
+    retval = ns.getNodeCopy(ns.context, &nr->head.nodeId, &copy);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_ptr_eq(copy->head.nodeId.identifier.string.data,
+                     nr->head.nodeId.identifier.string.data);
+    ns.releaseNode(ns.context, nr);
+
+    /* Replace. The identifier remains valid after the original is gone. */
+    retval = ns.replaceNode(ns.context, copy);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    nr = ns.getNode(ns.context, &addedId, ~(UA_UInt32)0,
+                    UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    ck_assert_ptr_eq(nr, copy);
+    ck_assert(UA_NodeId_equal(&nr->head.nodeId, &addedId));
+    ns.releaseNode(ns.context, nr);
+
+    /* A copy that is discarded */
+    retval = ns.getNodeCopy(ns.context, &addedId, &copy);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ns.deleteNode(ns.context, copy);
+
+    retval = ns.removeNode(ns.context, &addedId);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_NodeId_clear(&addedId);
+}
+END_TEST
+
+/****************************/
+/* Concurrent HashMap Cases */
+/****************************/
+
+START_TEST(editNodeIsPublishedOnRelease) {
+    UA_Node* n1 = createNode(0,2253);
+    ns.insertNode(ns.context, n1, NULL);
+    UA_NodeId in1 = UA_NODEID_NUMERIC(0,2253);
+
+    /* The edit node is a private copy */
+    UA_Node *edit = ns.getEditNode(ns.context, &in1, ~(UA_UInt32)0,
+                                   UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    ck_assert_ptr_ne(edit, NULL);
+    ck_assert_ptr_ne(edit, n1);
+    edit->head.writeMask = 42;
+
+    /* Nested edits get the same copy */
+    UA_Node *edit2 = ns.getEditNode(ns.context, &in1, ~(UA_UInt32)0,
+                                    UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    ck_assert_ptr_eq(edit, edit2);
+    ns.releaseNode(ns.context, edit2);
+
+    /* Readers see the original until the last edit user is done */
+    const UA_Node* nr = ns.getNode(ns.context, &in1, ~(UA_UInt32)0,
+                                   UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    ck_assert_ptr_eq(nr, n1);
+    ck_assert_uint_eq(nr->head.writeMask, 0);
+    ns.releaseNode(ns.context, edit);
+
+    /* The old version remains valid for the reader */
+    ck_assert_uint_eq(nr->head.writeMask, 0);
+    ns.releaseNode(ns.context, nr);
+
+    nr = ns.getNode(ns.context, &in1, ~(UA_UInt32)0,
+                    UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    ck_assert_ptr_eq(nr, edit);
+    ck_assert_uint_eq(nr->head.writeMask, 42);
+    ns.releaseNode(ns.context, nr);
+}
+END_TEST
+
+START_TEST(editRemovedNodeIsDiscarded) {
+    UA_Node* n1 = createNode(0,2253);
+    ns.insertNode(ns.context, n1, NULL);
+    UA_NodeId in1 = UA_NODEID_NUMERIC(0,2253);
+    UA_Node *edit = ns.getEditNode(ns.context, &in1, ~(UA_UInt32)0,
+                                   UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    ck_assert_ptr_ne(edit, NULL);
+    UA_StatusCode retval = ns.removeNode(ns.context, &in1);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ns.releaseNode(ns.context, edit);
+    const UA_Node* nr = ns.getNode(ns.context, &in1, ~(UA_UInt32)0,
+                                   UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    ck_assert_ptr_eq(nr, NULL);
+}
+END_TEST
+
+START_TEST(removedNodeRemainsValidForReader) {
+    UA_Node* n1 = createNode(0,2253);
+    ns.insertNode(ns.context, n1, NULL);
+    UA_NodeId in1 = UA_NODEID_NUMERIC(0,2253);
+    const UA_Node* nr = ns.getNode(ns.context, &in1, ~(UA_UInt32)0,
+                                   UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    ck_assert_ptr_eq(nr, n1);
+    ns.removeNode(ns.context, &in1);
+
+    /* Trigger a resize of the hash-map and several grace periods */
+    for(UA_UInt32 i = 0; i < 200; i++) {
+        UA_Node* n = createNode(1,i);
+        ns.insertNode(ns.context, n, NULL);
+    }
+    for(UA_UInt32 i = 0; i < 200; i++) {
+        UA_NodeId id = UA_NODEID_NUMERIC(1, i);
+        ns.removeNode(ns.context, &id);
+    }
+
+    ck_assert(UA_NodeId_equal(&nr->head.nodeId, &in1));
+    ns.releaseNode(ns.context, nr);
+}
+END_TEST
+
+#if UA_MULTITHREADING >= 100 && !defined(_WIN32)
+static volatile UA_Boolean readersRunning;
+static volatile UA_UInt32 readerPasses;
+
+static void *concurrentReaderThread(void *arg) {
+    UA_NodeId id = UA_NODEID_NUMERIC(0, 0);
+    while(readersRunning) {
+        for(UA_UInt32 i = 0; i < 100; i++) {
+            id.identifier.numeric = i + 1;
+            const UA_Node* n = ns.getNode(ns.context, &id, ~(UA_UInt32)0,
+                                          UA_REFERENCETYPESET_ALL,
+                                          UA_BROWSEDIRECTION_BOTH);
+            ck_assert_ptr_ne(n, NULL); /* Never removed */
+            ck_assert_uint_eq(n->head.nodeId.identifier.numeric, i + 1);
+            ns.releaseNode(ns.context, n);
+        }
+        UA_atomic_addUInt32(&readerPasses, 1);
+    }
+    return NULL;
+}
+
+START_TEST(concurrentReadersDuringModification) {
+    for(UA_UInt32 i = 0; i < 100; i++) {
+        UA_Node *n = createNode(0,i+1);
+        ns.insertNode(ns.context, n, NULL);
+    }
+
+    readersRunning = true;
+    readerPasses = 0;
+    pthread_t t[4];
+    for(size_t i = 0; i < 4; i++)
+        pthread_create(&t[i], NULL, concurrentReaderThread, NULL);
+
+    /* Edit the read nodes and add/remove others. This resizes the hash-map.
+     * Continue until the readers were scheduled for some passes. */
+    for(UA_UInt32 round = 0;
+        round < 20 || UA_atomic_loadUInt32(&readerPasses) < 8; round++) {
+        for(UA_UInt32 i = 0; i < 100; i++) {
+            UA_NodeId id = UA_NODEID_NUMERIC(0, i+1);
+            UA_Node *edit = ns.getEditNode(ns.context, &id, ~(UA_UInt32)0,
+                                           UA_REFERENCETYPESET_ALL,
+                                           UA_BROWSEDIRECTION_BOTH);
+            edit->head.writeMask = round;
+            ns.releaseNode(ns.context, edit);
+        }
+        for(UA_UInt32 i = 0; i < 500; i++) {
+            UA_Node *n = createNode(1,i);
+            ns.insertNode(ns.context, n, NULL);
+        }
+        for(UA_UInt32 i = 0; i < 500; i++) {
+            UA_NodeId id = UA_NODEID_NUMERIC(1, i);
+            ns.removeNode(ns.context, &id);
+        }
+    }
+
+    readersRunning = false;
+    for(size_t i = 0; i < 4; i++)
+        pthread_join(t[i], NULL);
+}
+END_TEST
+#endif
+
 /************************************/
 /* Performance Profiling Test Cases */
 /************************************/
@@ -293,6 +523,7 @@ static Suite * namespace_suite (void) {
     tcase_add_test (tc_find_hm, findNodeInExpandedNamespace);
     tcase_add_test (tc_find_hm, failToFindNonExistentNodeInUA_NodeStoreWithSeveralEntries);
     tcase_add_test (tc_find_hm, failToFindNodeInOtherUA_NodeStore);
+    tcase_add_test (tc_find_hm, insertRemoveWhileResizing);
     suite_add_tcase (s, tc_find_hm);
 
     TCase *tc_replace_hm = tcase_create("Replace-HashMap");
@@ -312,6 +543,70 @@ static Suite * namespace_suite (void) {
     tcase_add_test (tc_profile_hm, profileGetDelete);
     suite_add_tcase (s, tc_profile_hm);
 
+    TCase* tc_find_hmc = tcase_create ("Find-HashMapConcurrent");
+    tcase_add_checked_fixture(tc_find_hmc, setupHashMapConcurrent, teardown);
+    tcase_add_test (tc_find_hmc, findNodeInUA_NodeStoreWithSingleEntry);
+    tcase_add_test (tc_find_hmc, findNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_find_hmc, findNodeInExpandedNamespace);
+    tcase_add_test (tc_find_hmc, failToFindNonExistentNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_find_hmc, failToFindNodeInOtherUA_NodeStore);
+    suite_add_tcase (s, tc_find_hmc);
+
+    TCase *tc_replace_hmc = tcase_create("Replace-HashMapConcurrent");
+    tcase_add_checked_fixture(tc_replace_hmc, setupHashMapConcurrent, teardown);
+    tcase_add_test (tc_replace_hmc, replaceExistingNode);
+    tcase_add_test (tc_replace_hmc, replaceOldNode);
+    suite_add_tcase (s, tc_replace_hmc);
+
+    TCase* tc_iterate_hmc = tcase_create ("Iterate-HashMapConcurrent");
+    tcase_add_checked_fixture(tc_iterate_hmc, setupHashMapConcurrent, teardown);
+    tcase_add_test (tc_iterate_hmc, iterateOverUA_NodeStoreShallNotVisitEmptyNodes);
+    tcase_add_test (tc_iterate_hmc, iterateOverExpandedNamespaceShallNotVisitEmptyNodes);
+    suite_add_tcase (s, tc_iterate_hmc);
+
+    TCase* tc_concurrent_hmc = tcase_create ("Concurrent-HashMapConcurrent");
+    tcase_add_checked_fixture(tc_concurrent_hmc, setupHashMapConcurrent, teardown);
+    tcase_add_test (tc_concurrent_hmc, editNodeIsPublishedOnRelease);
+    tcase_add_test (tc_concurrent_hmc, editRemovedNodeIsDiscarded);
+    tcase_add_test (tc_concurrent_hmc, removedNodeRemainsValidForReader);
+#if UA_MULTITHREADING >= 100 && !defined(_WIN32)
+    tcase_add_test (tc_concurrent_hmc, concurrentReadersDuringModification);
+#endif
+    suite_add_tcase (s, tc_concurrent_hmc);
+
+    TCase* tc_profile_hmc = tcase_create ("Profile-HashMapConcurrent");
+    tcase_add_checked_fixture(tc_profile_hmc, setupHashMapConcurrent, teardown);
+    tcase_add_test (tc_profile_hmc, profileGetDelete);
+    suite_add_tcase (s, tc_profile_hmc);
+
+    TCase* tc_find_st = tcase_create ("Find-SwissTable");
+    tcase_add_checked_fixture(tc_find_st, setupSwissTable, teardown);
+    tcase_add_test (tc_find_st, findNodeInUA_NodeStoreWithSingleEntry);
+    tcase_add_test (tc_find_st, findNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_find_st, findNodeInExpandedNamespace);
+    tcase_add_test (tc_find_st, failToFindNonExistentNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_find_st, failToFindNodeInOtherUA_NodeStore);
+    tcase_add_test (tc_find_st, insertRemoveWhileResizing);
+    tcase_add_test (tc_find_st, stringNodeIdSharedWithCopy);
+    suite_add_tcase (s, tc_find_st);
+
+    TCase *tc_replace_st = tcase_create("Replace-SwissTable");
+    tcase_add_checked_fixture(tc_replace_st, setupSwissTable, teardown);
+    tcase_add_test (tc_replace_st, replaceExistingNode);
+    tcase_add_test (tc_replace_st, replaceOldNode);
+    suite_add_tcase (s, tc_replace_st);
+
+    TCase* tc_iterate_st = tcase_create ("Iterate-SwissTable");
+    tcase_add_checked_fixture(tc_iterate_st, setupSwissTable, teardown);
+    tcase_add_test (tc_iterate_st, iterateOverUA_NodeStoreShallNotVisitEmptyNodes);
+    tcase_add_test (tc_iterate_st, iterateOverExpandedNamespaceShallNotVisitEmptyNodes);
+    suite_add_tcase (s, tc_iterate_st);
+
+    TCase* tc_profile_st = tcase_create ("Profile-SwissTable");
+    tcase_add_checked_fixture(tc_profile_st, setupSwissTable, teardown);
+    tcase_add_test (tc_profile_st, profileGetDelete);
+    suite_add_tcase (s, tc_profile_st);
+
     return s;
 }
 
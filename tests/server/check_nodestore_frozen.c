@@ -0,0 +1,436 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+#include <open62541/plugin/nodestore_default.h>
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+
+#define IMAGEPATH "check_nodestore_frozen.img"
+#define CHILDREN 50
+
+static UA_UInt16 nsIndex;
+static UA_Boolean methodCalled;
+
+static UA_StatusCode
+methodCallback(UA_Server *server, const UA_NodeId *sessionId,
+               void *sessionHandle, const UA_NodeId *methodId,
+               void *methodContext, const UA_NodeId *objectId,
+               void *objectContext, size_t inputSize,
+               const UA_Variant *input, size_t outputSize,
+               UA_Variant *output) {
+    methodCalled = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Build an address space in a server with the HashMap Nodestore and write it
+ * to the image file */
+static void
+writeImage(void) {
+    UA_Server *server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    nsIndex = UA_Server_addNamespace(server, "urn:open62541.test.frozen");
+
+    UA_ObjectTypeAttributes otAttr = UA_ObjectTypeAttributes_default;
+    UA_StatusCode res =
+        UA_Server_addObjectTypeNode(server, UA_NODEID_STRING(nsIndex, "FrozenType"),
+                                    UA_NS0ID(BASEOBJECTTYPE), UA_NS0ID(HASSUBTYPE),
+                                    UA_QUALIFIEDNAME(nsIndex, "FrozenType"),
+                                    otAttr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+    oAttr.displayName = UA_LOCALIZEDTEXT("en-US", "Frozen Object");
+    res = UA_Server_addObjectNode(server, UA_NODEID_STRING(nsIndex, "FrozenObject"),
+                                  UA_NS0ID(OBJECTSFOLDER), UA_NS0ID(ORGANIZES),
+                                  UA_QUALIFIEDNAME(nsIndex, "FrozenObject"),
+                                  UA_NODEID_STRING(nsIndex, "FrozenType"),
+                                  oAttr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* Scalar value */
+    UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+    vAttr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_Int32 i = 42;
+    UA_Variant_setScalar(&vAttr.value, &i, &UA_TYPES[UA_TYPES_INT32]);
+    res = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(nsIndex, 1001),
+                                    UA_NODEID_STRING(nsIndex, "FrozenObject"),
+                                    UA_NS0ID(HASCOMPONENT),
+                                    UA_QUALIFIEDNAME(nsIndex, "Int32"),
+                                    UA_NS0ID(BASEDATAVARIABLETYPE),
+                                    vAttr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* Array value with array dimensions */
+    UA_String strings[3] = {UA_STRING_STATIC("a"), UA_STRING_STATIC("bb"),
+                            UA_STRING_STATIC("ccc")};
+    UA_UInt32 dims = 3;
+    vAttr = UA_VariableAttributes_default;
+    vAttr.valueRank = UA_VALUERANK_ONE_DIMENSION;
+    vAttr.arrayDimensions = &dims;
+    vAttr.arrayDimensionsSize = 1;
+    vAttr.dataType = UA_TYPES[UA_TYPES_STRING].typeId;
+    UA_Variant_setArray(&vAttr.value, strings, 3, &UA_TYPES[UA_TYPES_STRING]);
+    vAttr.value.arrayDimensions = &dims;
+    vAttr.value.arrayDimensionsSize = 1;
+    res = UA_Server_addVariableNode(server, UA_NODEID_STRING(nsIndex, "Strings"),
+                                    UA_NODEID_STRING(nsIndex, "FrozenObject"),
+                                    UA_NS0ID(HASCOMPONENT),
+                                    UA_QUALIFIEDNAME(nsIndex, "Strings"),
+                                    UA_NS0ID(BASEDATAVARIABLETYPE),
+                                    vAttr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* ExtensionObject with a structure inside */
+    UA_Range range = {1.0, 2.0};
+    UA_ExtensionObject eo;
+    UA_ExtensionObject_setValue(&eo, &range, &UA_TYPES[UA_TYPES_RANGE]);
+    vAttr = UA_VariableAttributes_default;
+    UA_Variant_setScalar(&vAttr.value, &eo, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+    res = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(nsIndex, 1002),
+                                    UA_NODEID_STRING(nsIndex, "FrozenObject"),
+                                    UA_NS0ID(HASCOMPONENT),
+                                    UA_QUALIFIEDNAME(nsIndex, "Range"),
+                                    UA_NS0ID(BASEDATAVARIABLETYPE),
+                                    vAttr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* Enough children for a reference tree */
+    for(UA_UInt32 j = 0; j < CHILDREN; j++) {
+        char name[32];
+        snprintf(name, sizeof(name), "Child%u", (unsigned)j);
+        res = UA_Server_addObjectNode(server, UA_NODEID_NUMERIC(nsIndex, 2000 + j),
+                                      UA_NODEID_STRING(nsIndex, "FrozenObject"),
+                                      UA_NS0ID(HASCOMPONENT),
+                                      UA_QUALIFIEDNAME(nsIndex, name),
+                                      UA_NS0ID(BASEOBJECTTYPE),
+                                      UA_ObjectAttributes_default, NULL, NULL);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    /* ReferenceType below a namespace zero ReferenceType */
+    UA_ReferenceTypeAttributes rAttr = UA_ReferenceTypeAttributes_default;
+    rAttr.inverseName = UA_LOCALIZEDTEXT("en-US", "FrozenRefOf");
+    res = UA_Server_addReferenceTypeNode(server, UA_NODEID_STRING(nsIndex, "FrozenRef"),
+                                         UA_NS0ID(HIERARCHICALREFERENCES),
+                                         UA_NS0ID(HASSUBTYPE),
+                                         UA_QUALIFIEDNAME(nsIndex, "FrozenRef"),
+                                         rAttr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_ExpandedNodeId target = UA_EXPANDEDNODEID_NUMERIC(nsIndex, 2000);
+    res = UA_Server_addReference(server, UA_NODEID_STRING(nsIndex, "FrozenObject"),
+                                 UA_NODEID_STRING(nsIndex, "FrozenRef"), target, true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+#ifdef UA_ENABLE_METHODCALLS
+    /* The InputArguments are an array of structures */
+    UA_Argument arg;
+    UA_Argument_init(&arg);
+    arg.name = UA_STRING("Input");
+    arg.description = UA_LOCALIZEDTEXT("en-US", "An input");
+    arg.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    arg.valueRank = UA_VALUERANK_SCALAR;
+    UA_MethodAttributes mAttr = UA_MethodAttributes_default;
+    mAttr.executable = true;
+    mAttr.userExecutable = true;
+    res = UA_Server_addMethodNode(server, UA_NODEID_STRING(nsIndex, "FrozenMethod"),
+                                  UA_NODEID_STRING(nsIndex, "FrozenObject"),
+                                  UA_NS0ID(HASCOMPONENT),
+                                  UA_QUALIFIEDNAME(nsIndex, "FrozenMethod"),
+                                  mAttr, methodCallback, 1, &arg, 0, NULL,
+                                  NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+#endif
+
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    res = UA_Nodestore_writeFrozenImage(&config->nodestore, IMAGEPATH);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_Server_delete(server);
+}
+
+static UA_Server *
+newFrozenServer(void) {
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    UA_StatusCode res = UA_Nodestore_Frozen(&config.nodestore, IMAGEPATH, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_ServerConfig_setDefault(&config);
+    config.eventLoop->dateTime_now = UA_DateTime_now_fake;
+    config.eventLoop->dateTime_nowMonotonic = UA_DateTime_now_fake;
+    UA_Server *server = UA_Server_newWithConfig(&config);
+    ck_assert(server != NULL);
+    UA_UInt16 ns = UA_Server_addNamespace(server, "urn:open62541.test.frozen");
+    ck_assert_uint_eq(ns, nsIndex);
+    return server;
+}
+
+static void setup(void) {
+    writeImage();
+}
+
+static void teardown(void) {
+    remove(IMAGEPATH);
+}
+
+static size_t
+countReferences(UA_Server *server, const UA_NodeId nodeId,
+                const UA_NodeId refType, const UA_NodeId *expectedTarget) {
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = nodeId;
+    bd.referenceTypeId = refType;
+    bd.includeSubtypes = true;
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    bd.resultMask = UA_BROWSERESULTMASK_ALL;
+    UA_BrowseResult br = UA_Server_browse(server, 0, &bd);
+    ck_assert_uint_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    size_t count = 0;
+    for(size_t i = 0; i < br.referencesSize; i++) {
+        if(!expectedTarget ||
+           UA_NodeId_equal(&br.references[i].nodeId.nodeId, expectedTarget))
+            count++;
+    }
+    UA_BrowseResult_clear(&br);
+    return count;
+}
+
+START_TEST(readFromImage) {
+    UA_Server *server = newFrozenServer();
+
+    UA_Variant value;
+    UA_StatusCode res =
+        UA_Server_readValue(server, UA_NODEID_NUMERIC(nsIndex, 1001), &value);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_INT32]));
+    ck_assert_int_eq(*(UA_Int32*)value.data, 42);
+    UA_Variant_clear(&value);
+
+    res = UA_Server_readValue(server, UA_NODEID_STRING(nsIndex, "Strings"), &value);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasArrayType(&value, &UA_TYPES[UA_TYPES_STRING]));
+    ck_assert_uint_eq(value.arrayLength, 3);
+    ck_assert_uint_eq(value.arrayDimensionsSize, 1);
+    ck_assert_uint_eq(value.arrayDimensions[0], 3);
+    UA_String ccc = UA_STRING("ccc");
+    ck_assert(UA_String_equal(&((UA_String*)value.data)[2], &ccc));
+    UA_Variant_clear(&value);
+
+    res = UA_Server_readValue(server, UA_NODEID_NUMERIC(nsIndex, 1002), &value);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_RANGE]) ||
+              UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]));
+    const UA_Range *range = (const UA_Range*)value.data;
+    if(value.type == &UA_TYPES[UA_TYPES_EXTENSIONOBJECT])
+        range = (const UA_Range*)((UA_ExtensionObject*)value.data)->content.decoded.data;
+    ck_assert(range->low == 1.0 && range->high == 2.0);
+    UA_Variant_clear(&value);
+
+    UA_LocalizedText dn;
+    res = UA_Server_readDisplayName(server, UA_NODEID_STRING(nsIndex, "FrozenObject"), &dn);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_String text = UA_STRING("Frozen Object");
+    ck_assert(UA_String_equal(&dn.text, &text));
+    UA_LocalizedText_clear(&dn);
+
+    /* The references from namespace zero into the image are restored */
+    UA_NodeId frozenObject = UA_NODEID_STRING(nsIndex, "FrozenObject");
+    ck_assert_uint_eq(countReferences(server, UA_NS0ID(OBJECTSFOLDER),
+                                      UA_NS0ID(ORGANIZES), &frozenObject), 1);
+    UA_NodeId frozenType = UA_NODEID_STRING(nsIndex, "FrozenType");
+    ck_assert_uint_eq(countReferences(server, UA_NS0ID(BASEOBJECTTYPE),
+                                      UA_NS0ID(HASSUBTYPE), &frozenType), 1);
+
+    /* The subtypes of the namespace zero ReferenceTypes are restored */
+    UA_NodeId child = UA_NODEID_NUMERIC(nsIndex, 2000);
+    ck_assert_uint_eq(countReferences(server, frozenObject,
+                                      UA_NODEID_STRING(nsIndex, "FrozenRef"),
+                                      &child), 1);
+    ck_assert_uint_eq(countReferences(server, frozenObject,
+                                      UA_NS0ID(HIERARCHICALREFERENCES),
+                                      &child), 2);
+    ck_assert_uint_eq(countReferences(server, frozenObject,
+                                      UA_NS0ID(HASCOMPONENT), NULL),
+                      CHILDREN + 3 + 1);
+
+    UA_Server_delete(server);
+} END_TEST
+
+START_TEST(modifyImageNodes) {
+    UA_Server *server = newFrozenServer();
+
+    /* Write to a node from the image */
+    UA_Variant value;
+    UA_Int32 i = 43;
+    UA_Variant_setScalar(&value, &i, &UA_TYPES[UA_TYPES_INT32]);
+    UA_StatusCode res =
+        UA_Server_writeValue(server, UA_NODEID_NUMERIC(nsIndex, 1001), value);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_readValue(server, UA_NODEID_NUMERIC(nsIndex, 1001), &value);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(*(UA_Int32*)value.data, 43);
+    UA_Variant_clear(&value);
+
+    /* NodeIds from the image are taken */
+    UA_NodeId frozenObject = UA_NODEID_STRING(nsIndex, "FrozenObject");
+    res = UA_Server_addObjectNode(server, UA_NODEID_NUMERIC(nsIndex, 2001),
+                                  frozenObject, UA_NS0ID(HASCOMPONENT),
+                                  UA_QUALIFIEDNAME(nsIndex, "Duplicate"),
+                                  UA_NS0ID(BASEOBJECTTYPE),
+                                  UA_ObjectAttributes_default, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADNODEIDEXISTS);
+
+    /* Add a node below a node from the image */
+    UA_NodeId newNode;
+    res = UA_Server_addObjectNode(server, UA_NODEID_NUMERIC(nsIndex, 0),
+                                  frozenObject, UA_NS0ID(HASCOMPONENT),
+                                  UA_QUALIFIEDNAME(nsIndex, "New"),
+                                  UA_NS0ID(BASEOBJECTTYPE),
+                                  UA_ObjectAttributes_default, NULL, &newNode);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(countReferences(server, frozenObject, UA_NS0ID(HASCOMPONENT),
+                                      &newNode), 1);
+
+    /* Remove a node from the image */
+    UA_NodeId removed = UA_NODEID_NUMERIC(nsIndex, 2001);
+    res = UA_Server_deleteNode(server, removed, true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_QualifiedName bn;
+    res = UA_Server_readBrowseName(server, removed, &bn);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADNODEIDUNKNOWN);
+    ck_assert_uint_eq(countReferences(server, frozenObject, UA_NS0ID(HASCOMPONENT),
+                                      &removed), 0);
+
+    /* The removed NodeId can be used again */
+    res = UA_Server_addObjectNode(server, removed, frozenObject, UA_NS0ID(HASCOMPONENT),
+                                  UA_QUALIFIEDNAME(nsIndex, "Again"),
+                                  UA_NS0ID(BASEOBJECTTYPE),
+                                  UA_ObjectAttributes_default, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* A new ReferenceType gets an unused index */
+    res = UA_Server_addReferenceTypeNode(server, UA_NODEID_STRING(nsIndex, "RuntimeRef"),
+                                         UA_NS0ID(NONHIERARCHICALREFERENCES),
+                                         UA_NS0ID(HASSUBTYPE),
+                                         UA_QUALIFIEDNAME(nsIndex, "RuntimeRef"),
+                                         UA_ReferenceTypeAttributes_default, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_ExpandedNodeId target = UA_EXPANDEDNODEID_NUMERIC(nsIndex, 2002);
+    res = UA_Server_addReference(server, frozenObject,
+                                 UA_NODEID_STRING(nsIndex, "RuntimeRef"), target, true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(countReferences(server, frozenObject,
+                                      UA_NODEID_STRING(nsIndex, "RuntimeRef"), NULL), 1);
+    ck_assert_uint_eq(countReferences(server, frozenObject,
+                                      UA_NODEID_STRING(nsIndex, "FrozenRef"), NULL), 1);
+
+#ifdef UA_ENABLE_METHODCALLS
+    /* Callbacks are set again after loading the image */
+    UA_NodeId method = UA_NODEID_STRING(nsIndex, "FrozenMethod");
+    res = UA_Server_setMethodNodeCallback(server, method, methodCallback);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_Int32 input = 1;
+    UA_CallMethodRequest req;
+    UA_CallMethodRequest_init(&req);
+    req.objectId = frozenObject;
+    req.methodId = method;
+    req.inputArgumentsSize = 1;
+    req.inputArguments = UA_Variant_new();
+    UA_Variant_setScalarCopy(req.inputArguments, &input, &UA_TYPES[UA_TYPES_INT32]);
+    methodCalled = false;
+    UA_CallMethodResult cr = UA_Server_call(server, &req);
+    ck_assert_uint_eq(cr.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert(methodCalled);
+    UA_CallMethodResult_clear(&cr);
+    UA_Variant_delete(req.inputArguments);
+#endif
+
+    UA_Server_delete(server);
+} END_TEST
+
+static void
+countVisitor(void *visitorCtx, const UA_Node *node) {
+    (*(size_t*)visitorCtx)++;
+}
+
+START_TEST(relocateImage) {
+    /* The second Nodestore cannot use the preferred address of the image */
+    UA_Nodestore ns1, ns2;
+    UA_StatusCode res = UA_Nodestore_Frozen(&ns1, IMAGEPATH, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Nodestore_Frozen(&ns2, IMAGEPATH, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_NodeId id = UA_NODEID_STRING(nsIndex, "Strings");
+    const UA_Node *n1 = ns1.getNode(ns1.context, &id, 0, UA_REFERENCETYPESET_ALL,
+                                    UA_BROWSEDIRECTION_BOTH);
+    const UA_Node *n2 = ns2.getNode(ns2.context, &id, 0, UA_REFERENCETYPESET_ALL,
+                                    UA_BROWSEDIRECTION_BOTH);
+    ck_assert(n1 != NULL && n2 != NULL && n1 != n2);
+    ck_assert(UA_NodeId_equal(&n1->head.nodeId, &id));
+    ck_assert(UA_NodeId_equal(&n2->head.nodeId, &id));
+    const UA_Variant *v1 = &n1->variableNode.valueSource.internal.value.value;
+    const UA_Variant *v2 = &n2->variableNode.valueSource.internal.value.value;
+    ck_assert(UA_equal(v1, v2, &UA_TYPES[UA_TYPES_VARIANT]));
+    ck_assert(v1->type == &UA_TYPES[UA_TYPES_STRING]);
+    ns1.releaseNode(ns1.context, n1);
+    ns2.releaseNode(ns2.context, n2);
+
+    /* Only the nodes outside of namespace zero are in the image */
+    size_t count = 0;
+    ns1.iterate(ns1.context, countVisitor, &count);
+    ck_assert_uint_ge(count, CHILDREN + 6);
+    ck_assert_uint_eq(ns1.removeNode(ns1.context, &id), UA_STATUSCODE_GOOD);
+    size_t count2 = 0;
+    ns1.iterate(ns1.context, countVisitor, &count2);
+    ck_assert_uint_eq(count2, count - 1);
+    ck_assert(ns1.getNode(ns1.context, &id, 0, UA_REFERENCETYPESET_ALL,
+                          UA_BROWSEDIRECTION_BOTH) == NULL);
+
+    ns1.clear(ns1.context);
+    ns2.clear(ns2.context);
+} END_TEST
+
+START_TEST(invalidImage) {
+    UA_Nodestore ns;
+    UA_StatusCode res = UA_Nodestore_Frozen(&ns, "does_not_exist.img", NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADNOTFOUND);
+
+    /* Overwrite the header of the image */
+    FILE *f = fopen(IMAGEPATH, "r+b");
+    ck_assert(f != NULL);
+    char garbage[64];
+    memset(garbage, 0xab, sizeof(garbage));
+    ck_assert_uint_eq(fwrite(garbage, 1, sizeof(garbage), f), sizeof(garbage));
+    fclose(f);
+    res = UA_Nodestore_Frozen(&ns, IMAGEPATH, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADDECODINGERROR);
+} END_TEST
+
+static Suite * testSuite_FrozenNodestore(void) {
+    Suite *s = suite_create("Frozen Nodestore");
+    TCase *tc = tcase_create("Frozen Nodestore");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, readFromImage);
+    tcase_add_test(tc, modifyImageNodes);
+    tcase_add_test(tc, relocateImage);
+    tcase_add_test(tc, invalidImage);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    int number_failed = 0;
+    Suite *s = testSuite_FrozenNodestore();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed += srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
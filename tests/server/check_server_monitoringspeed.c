@@ -83,12 +83,139 @@ START_TEST(monitorIntegerNoChanges) {
 }
 END_TEST
 
+static size_t arrayCallbackCount[2];
+
+static void
+arrayNotificationCallback(UA_Server *s, UA_UInt32 monitoredItemId,
+                          void *monitoredItemContext, const UA_NodeId *nodeId,
+                          void *nodeContext, UA_UInt32 attributeId,
+                          const UA_DataValue *value) {
+    arrayCallbackCount[(uintptr_t)monitoredItemContext]++;
+}
+
+#define ARRAYLENGTH 10000
+
+/* Sample a large array (e.g. a waveform) without and with an absolute deadband */
+START_TEST(monitorDoubleArray) {
+    UA_Server_run_startup(server);
+
+    UA_Double *values = (UA_Double*)UA_Array_new(ARRAYLENGTH, &UA_TYPES[UA_TYPES_DOUBLE]);
+    for(size_t i = 0; i < ARRAYLENGTH; i++)
+        values[i] = (UA_Double)i;
+
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Variant_setArray(&attr.value, values, ARRAYLENGTH, &UA_TYPES[UA_TYPES_DOUBLE]);
+    attr.dataType = UA_TYPES[UA_TYPES_DOUBLE].typeId;
+    attr.valueRank = UA_VALUERANK_ANY;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_NodeId arrayNodeId = UA_NODEID_STRING(1, "the.waveform");
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, arrayNodeId,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "the waveform"),
+                                  UA_NODEID_NULL, attr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_MonitoredItemCreateRequest item;
+    UA_MonitoredItemCreateRequest_init(&item);
+    item.itemToMonitor.nodeId = arrayNodeId;
+    item.itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+    item.monitoringMode = UA_MONITORINGMODE_REPORTING;
+    UA_MonitoredItemCreateResult res =
+        UA_Server_createDataChangeMonitoredItem(server, UA_TIMESTAMPSTORETURN_NEITHER,
+                                                item, (void*)0, arrayNotificationCallback);
+    ck_assert_uint_eq(res.statusCode, UA_STATUSCODE_GOOD);
+    UA_UInt32 monIds[2];
+    monIds[0] = res.monitoredItemId;
+
+    UA_DataChangeFilter filter;
+    UA_DataChangeFilter_init(&filter);
+    filter.trigger = UA_DATACHANGETRIGGER_STATUSVALUE;
+    filter.deadbandType = UA_DEADBANDTYPE_ABSOLUTE;
+    filter.deadbandValue = 0.5;
+    UA_ExtensionObject_setValue(&item.requestedParameters.filter, &filter,
+                                &UA_TYPES[UA_TYPES_DATACHANGEFILTER]);
+    res = UA_Server_createDataChangeMonitoredItem(server, UA_TIMESTAMPSTORETURN_NEITHER,
+                                                  item, (void*)1, arrayNotificationCallback);
+    ck_assert_uint_eq(res.statusCode, UA_STATUSCODE_GOOD);
+    monIds[1] = res.monitoredItemId;
+
+    UA_MonitoredItem *mons[2];
+    for(size_t m = 0; m < 2; m++) {
+        mons[m] = UA_Subscription_getMonitoredItem(server->adminSubscription, monIds[m]);
+        ck_assert_ptr_ne(mons[m], NULL);
+    }
+
+    /* Deliver the initial notifications */
+    UA_Server_run_iterate(server, false);
+    arrayCallbackCount[0] = 0;
+    arrayCallbackCount[1] = 0;
+
+    for(size_t m = 0; m < 2; m++) {
+        clock_t begin = clock();
+        UA_LOCK(&server->serviceMutex);
+        for(int i = 0; i < 1000; i++)
+            UA_MonitoredItem_sample(server, mons[m]);
+        UA_UNLOCK(&server->serviceMutex);
+        clock_t finish = clock();
+        printf("%s: duration was %f s\n", (m == 0) ? "no filter" : "absolute deadband",
+               (double)(finish - begin) / CLOCKS_PER_SEC);
+    }
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(arrayCallbackCount[0], 0);
+    ck_assert_uint_eq(arrayCallbackCount[1], 0);
+
+    /* -0.0 is equal to 0.0 */
+    UA_Variant v;
+    values[0] = -0.0;
+    UA_Variant_setArray(&v, values, ARRAYLENGTH, &UA_TYPES[UA_TYPES_DOUBLE]);
+    retval = UA_Server_writeValue(server, arrayNodeId, v);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_LOCK(&server->serviceMutex);
+    UA_MonitoredItem_sample(server, mons[0]);
+    UA_MonitoredItem_sample(server, mons[1]);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(arrayCallbackCount[0], 0);
+    ck_assert_uint_eq(arrayCallbackCount[1], 0);
+
+    /* A change inside the deadband */
+    values[ARRAYLENGTH - 1] += 0.25;
+    retval = UA_Server_writeValue(server, arrayNodeId, v);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_LOCK(&server->serviceMutex);
+    UA_MonitoredItem_sample(server, mons[0]);
+    UA_MonitoredItem_sample(server, mons[1]);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_Server_run_iterate(server, false); /* Local publish */
+    ck_assert_uint_eq(arrayCallbackCount[0], 1);
+    ck_assert_uint_eq(arrayCallbackCount[1], 0);
+
+    /* A change outside the deadband */
+    values[ARRAYLENGTH - 1] += 0.5;
+    retval = UA_Server_writeValue(server, arrayNodeId, v);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_LOCK(&server->serviceMutex);
+    UA_MonitoredItem_sample(server, mons[0]);
+    UA_MonitoredItem_sample(server, mons[1]);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_Server_run_iterate(server, false); /* Local publish */
+    ck_assert_uint_eq(arrayCallbackCount[0], 2);
+    ck_assert_uint_eq(arrayCallbackCount[1], 1);
+
+    UA_Array_delete(values, ARRAYLENGTH, &UA_TYPES[UA_TYPES_DOUBLE]);
+    UA_Server_run_shutdown(server);
+}
+END_TEST
+
 static Suite * monitoring_speed_suite (void) {
     Suite *s = suite_create ("Monitoring Speed");
 
     TCase* tc_datachange = tcase_create ("DataChange");
     tcase_add_checked_fixture(tc_datachange, setup, teardown);
     tcase_add_test (tc_datachange, monitorIntegerNoChanges);
+    tcase_add_test (tc_datachange, monitorDoubleArray);
     suite_add_tcase (s, tc_datachange);
 
     return s;
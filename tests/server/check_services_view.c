@@ -129,6 +129,77 @@ START_TEST(Service_Browse_WithMaxResults) {
 }
 END_TEST
 
+/* The last target of the ContinuationPoint is deleted between Browse and
+ * BrowseNext. The remaining references are still returned. */
+START_TEST(Service_Browse_ContinuationPointTargetRemoved) {
+    UA_Server *server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+
+    UA_ObjectAttributes oa = UA_ObjectAttributes_default;
+    UA_NodeId folderId = UA_NODEID_NUMERIC(1, 5000);
+    UA_StatusCode res =
+        UA_Server_addObjectNode(server, folderId,
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                UA_QUALIFIEDNAME(1, "Folder"),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                oa, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    const UA_UInt32 children = 10;
+    for(UA_UInt32 i = 0; i < children; i++) {
+        res = UA_Server_addObjectNode(server, UA_NODEID_NUMERIC(1, 5001 + i), folderId,
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                      UA_QUALIFIEDNAME(1, "Child"),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                      oa, NULL, NULL);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = folderId;
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+    bd.resultMask = UA_BROWSERESULTMASK_NONE;
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    UA_BrowseResult br = UA_Server_browse(server, 3, &bd);
+    ck_assert_uint_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(br.referencesSize, 3);
+    ck_assert_uint_ne(br.continuationPoint.length, 0);
+
+    /* Mark the received children */
+    UA_Boolean seen[10] = {false};
+    for(size_t i = 0; i < br.referencesSize; i++)
+        seen[br.references[i].nodeId.nodeId.identifier.numeric - 5001] = true;
+
+    /* Delete the last target */
+    res = UA_Server_deleteNode(server, br.references[2].nodeId.nodeId, true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    size_t total = br.referencesSize;
+    UA_ByteString cp = br.continuationPoint;
+    br.continuationPoint = UA_BYTESTRING_NULL;
+    UA_BrowseResult_clear(&br);
+    while(cp.length > 0) {
+        br = UA_Server_browseNext(server, false, &cp);
+        ck_assert_uint_eq(br.statusCode, UA_STATUSCODE_GOOD);
+        for(size_t i = 0; i < br.referencesSize; i++) {
+            UA_UInt32 child = br.references[i].nodeId.nodeId.identifier.numeric - 5001;
+            ck_assert(!seen[child]);
+            seen[child] = true;
+        }
+        total += br.referencesSize;
+        UA_ByteString_clear(&cp);
+        cp = br.continuationPoint;
+        br.continuationPoint = UA_BYTESTRING_NULL;
+        UA_BrowseResult_clear(&br);
+    }
+    ck_assert_uint_eq(total, children);
+
+    UA_Server_delete(server);
+}
+END_TEST
+
 START_TEST(Service_Browse_WithBrowseName) {
     UA_Server *server = UA_Server_newForUnitTest();
     ck_assert(server != NULL);
@@ -493,6 +564,137 @@ START_TEST(BrowseSimplifiedBrowsePath) {
 }
 END_TEST
 
+static UA_StatusCode
+readRegistered(UA_Server *server, const UA_NodeId *id, UA_Int32 *out) {
+    UA_ReadValueId rvi;
+    UA_ReadValueId_init(&rvi);
+    rvi.nodeId = *id;
+    rvi.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_ReadRequest req;
+    UA_ReadRequest_init(&req);
+    req.nodesToRead = &rvi;
+    req.nodesToReadSize = 1;
+    UA_ReadResponse resp;
+    UA_ReadResponse_init(&resp);
+    lockServer(server);
+    Service_Read(server, &server->adminSession, &req, &resp);
+    unlockServer(server);
+    ck_assert_uint_eq(resp.resultsSize, 1);
+    UA_StatusCode res = resp.results[0].hasStatus ?
+        resp.results[0].status : UA_STATUSCODE_GOOD;
+    if(res == UA_STATUSCODE_GOOD)
+        *out = *(UA_Int32*)resp.results[0].value.data;
+    UA_ReadResponse_clear(&resp);
+    return res;
+}
+
+START_TEST(Service_RegisterNodes_Alias) {
+    UA_Server *server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+
+    UA_NodeId varId = UA_NODEID_STRING(1, "a.rather.long.string.nodeid.for.registering");
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 val = 42;
+    UA_Variant_setScalar(&attr.value, &val, &UA_TYPES[UA_TYPES_INT32]);
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_StatusCode res =
+        UA_Server_addVariableNode(server, varId,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "registered"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* Register an existing and an unknown node */
+    UA_NodeId toRegister[2];
+    toRegister[0] = varId;
+    toRegister[1] = UA_NODEID_STRING(1, "unknown");
+    UA_RegisterNodesRequest req;
+    UA_RegisterNodesRequest_init(&req);
+    req.nodesToRegister = toRegister;
+    req.nodesToRegisterSize = 2;
+    UA_RegisterNodesResponse resp;
+    UA_RegisterNodesResponse_init(&resp);
+    lockServer(server);
+    Service_RegisterNodes(server, &server->adminSession, &req, &resp);
+    unlockServer(server);
+    ck_assert_uint_eq(resp.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(resp.registeredNodeIdsSize, 2);
+    UA_NodeId alias = resp.registeredNodeIds[0];
+    ck_assert_uint_eq(alias.identifierType, UA_NODEIDTYPE_NUMERIC);
+    ck_assert(UA_NodeId_equal(&resp.registeredNodeIds[1], &toRegister[1]));
+
+    /* Read via the alias */
+    UA_Int32 out = 0;
+    ck_assert_uint_eq(readRegistered(server, &alias, &out), UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(out, 42);
+
+    /* Write via the alias and read the original NodeId */
+    UA_WriteValue wv;
+    UA_WriteValue_init(&wv);
+    wv.nodeId = alias;
+    wv.attributeId = UA_ATTRIBUTEID_VALUE;
+    val = 23;
+    UA_Variant_setScalar(&wv.value.value, &val, &UA_TYPES[UA_TYPES_INT32]);
+    wv.value.hasValue = true;
+    UA_WriteRequest wreq;
+    UA_WriteRequest_init(&wreq);
+    wreq.nodesToWrite = &wv;
+    wreq.nodesToWriteSize = 1;
+    UA_WriteResponse wresp;
+    UA_WriteResponse_init(&wresp);
+    lockServer(server);
+    Service_Write(server, &server->adminSession, &wreq, &wresp);
+    unlockServer(server);
+    ck_assert_uint_eq(wresp.resultsSize, 1);
+    ck_assert_uint_eq(wresp.results[0], UA_STATUSCODE_GOOD);
+    UA_WriteResponse_clear(&wresp);
+    ck_assert_uint_eq(readRegistered(server, &varId, &out), UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(out, 23);
+
+    /* The node is removed while registered */
+    res = UA_Server_deleteNode(server, varId, true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(readRegistered(server, &alias, &out),
+                      UA_STATUSCODE_BADNODEIDUNKNOWN);
+
+    /* The alias is no longer valid after unregistering */
+    UA_UnregisterNodesRequest ureq;
+    UA_UnregisterNodesRequest_init(&ureq);
+    ureq.nodesToUnregister = resp.registeredNodeIds;
+    ureq.nodesToUnregisterSize = resp.registeredNodeIdsSize;
+    UA_UnregisterNodesResponse uresp;
+    UA_UnregisterNodesResponse_init(&uresp);
+    lockServer(server);
+    Service_UnregisterNodes(server, &server->adminSession, &ureq, &uresp);
+    unlockServer(server);
+    ck_assert_uint_eq(uresp.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    UA_UnregisterNodesResponse_clear(&uresp);
+    ck_assert_uint_eq(readRegistered(server, &alias, &out),
+                      UA_STATUSCODE_BADNODEIDUNKNOWN);
+
+    /* A new registration reuses the slot with a different alias */
+    toRegister[0] = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE);
+    req.nodesToRegisterSize = 1;
+    UA_RegisterNodesResponse resp2;
+    UA_RegisterNodesResponse_init(&resp2);
+    lockServer(server);
+    Service_RegisterNodes(server, &server->adminSession, &req, &resp2);
+    unlockServer(server);
+    ck_assert_uint_eq(resp2.registeredNodeIdsSize, 1);
+    ck_assert(!UA_NodeId_equal(&resp2.registeredNodeIds[0], &alias));
+    ck_assert_uint_eq(readRegistered(server, &resp2.registeredNodeIds[0], &out),
+                      UA_STATUSCODE_GOOD);
+
+    UA_RegisterNodesResponse_clear(&resp2);
+    UA_RegisterNodesResponse_clear(&resp);
+
+    /* Pinned nodes are released when the server is deleted */
+    UA_Server_delete(server);
+}
+END_TEST
+
 static Suite *testSuite_Service_TranslateBrowsePathsToNodeIds(void) {
     Suite *s = suite_create("Service_TranslateBrowsePathsToNodeIds");
     TCase *tc_browse = tcase_create("Browse Service");
@@ -501,10 +703,15 @@ static Suite *testSuite_Service_TranslateBrowsePathsToNodeIds(void) {
     tcase_add_test(tc_browse, Service_Browse_ClassMask);
     tcase_add_test(tc_browse, Service_Browse_ReferenceTypes);
     tcase_add_test(tc_browse, Service_Browse_WithMaxResults);
+    tcase_add_test(tc_browse, Service_Browse_ContinuationPointTargetRemoved);
     tcase_add_test(tc_browse, Service_Browse_Recursive);
     tcase_add_test(tc_browse, Service_Browse_Localization);
     suite_add_tcase(s, tc_browse);
 
+    TCase *tc_register = tcase_create("RegisterNodes");
+    tcase_add_test(tc_register, Service_RegisterNodes_Alias);
+    suite_add_tcase(s, tc_register);
+
     TCase *tc_translate = tcase_create("TranslateBrowsePathsToNodeIds");
     tcase_add_unchecked_fixture(tc_translate, setup_server, teardown_server);
     tcase_add_test(tc_translate, ServiceTest_TranslateBrowsePathsToNodeIds);
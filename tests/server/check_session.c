@@ -8,6 +8,7 @@
 #include <open62541/server_config_default.h>
 #include <open62541/types.h>
 
+#include "server/ua_server_internal.h"
 #include "server/ua_services.h"
 #include "client/ua_client_internal.h"
 #include "test_helpers.h"
@@ -158,6 +159,63 @@ START_TEST(Session_setSessionAttribute_ShallWork) {
 }
 END_TEST
 
+#define LOOKUP_SESSIONS 100
+
+START_TEST(Session_lookupIndex_ShallWork) {
+    UA_Session *sessions[LOOKUP_SESSIONS];
+    UA_NodeId tokens[LOOKUP_SESSIONS];
+    UA_NodeId ids[LOOKUP_SESSIONS];
+    UA_CreateSessionRequest req;
+    UA_CreateSessionRequest_init(&req);
+
+    lockServer(server);
+    for(size_t i = 0; i < LOOKUP_SESSIONS; i++) {
+        UA_StatusCode res = UA_Server_createSession(server, NULL, &req, &sessions[i]);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        UA_NodeId_copy(&sessions[i]->authenticationToken, &tokens[i]);
+        UA_NodeId_copy(&sessions[i]->sessionId, &ids[i]);
+    }
+
+    /* Every session is found by its token and id */
+    for(size_t i = 0; i < LOOKUP_SESSIONS; i++) {
+        ck_assert_ptr_eq(getSessionByToken(server, &tokens[i]), sessions[i]);
+        ck_assert_ptr_eq(getSessionById(server, &ids[i]), sessions[i]);
+    }
+
+    /* The session id is not a token and vice versa */
+    ck_assert_ptr_eq(getSessionByToken(server, &ids[0]), NULL);
+    ck_assert_ptr_eq(getSessionById(server, &tokens[0]), NULL);
+
+    /* Remove every second session */
+    for(size_t i = 0; i < LOOKUP_SESSIONS; i += 2) {
+        UA_StatusCode res =
+            UA_Server_removeSessionByToken(server, &tokens[i], UA_SHUTDOWNREASON_CLOSE);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    for(size_t i = 0; i < LOOKUP_SESSIONS; i++) {
+        UA_Session *expected = (i % 2 == 0) ? NULL : sessions[i];
+        ck_assert_ptr_eq(getSessionByToken(server, &tokens[i]), expected);
+        ck_assert_ptr_eq(getSessionById(server, &ids[i]), expected);
+    }
+    ck_assert_uint_eq(UA_Server_removeSessionByToken(server, &tokens[0],
+                                                     UA_SHUTDOWNREASON_CLOSE),
+                      UA_STATUSCODE_BADSESSIONIDINVALID);
+
+    /* Remove the remaining sessions */
+    for(size_t i = 1; i < LOOKUP_SESSIONS; i += 2) {
+        UA_StatusCode res =
+            UA_Server_removeSessionByToken(server, &tokens[i], UA_SHUTDOWNREASON_CLOSE);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    unlockServer(server);
+
+    for(size_t i = 0; i < LOOKUP_SESSIONS; i++) {
+        UA_NodeId_clear(&tokens[i]);
+        UA_NodeId_clear(&ids[i]);
+    }
+}
+END_TEST
+
 static Suite* testSuite_Session(void) {
     Suite *s = suite_create("Session");
     TCase *tc_session = tcase_create("Core");
@@ -166,6 +224,7 @@ static Suite* testSuite_Session(void) {
     tcase_add_test(tc_session, Session_init_ShallWork);
     tcase_add_test(tc_session, Session_updateLifetime_ShallWork);
     tcase_add_test(tc_session, Session_setSessionAttribute_ShallWork);
+    tcase_add_test(tc_session, Session_lookupIndex_ShallWork);
     suite_add_tcase(s,tc_session);
     return s;
 }
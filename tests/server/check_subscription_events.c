@@ -390,6 +390,64 @@ START_TEST(generateEvents) {
     UA_DeleteMonitoredItemsResponse_clear(&deleteResponse);
 } END_TEST
 
+/* Transient events are not represented as nodes */
+START_TEST(generateTransientEvents) {
+    UA_MonitoredItemCreateResult createResult = addMonitoredItem(handler_events_simple, true, true);
+    ck_assert_uint_eq(createResult.statusCode, UA_STATUSCODE_GOOD);
+    monitoredItemId = createResult.monitoredItemId;
+
+    UA_UInt16 eventSeverity = 1000;
+    UA_LocalizedText eventMessage = UA_LOCALIZEDTEXT("en-US", "Generated Event");
+    UA_KeyValuePair fields[2];
+    fields[0].key = UA_QUALIFIEDNAME(0, "Severity");
+    UA_Variant_setScalar(&fields[0].value, &eventSeverity, &UA_TYPES[UA_TYPES_UINT16]);
+    fields[1].key = UA_QUALIFIEDNAME(0, "Message");
+    UA_Variant_setScalar(&fields[1].value, &eventMessage, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+    UA_KeyValueMap eventFields = {2, fields};
+
+    /* The second time the emit nodes are taken from the cache */
+    for(size_t i = 0; i < 2; i++) {
+        UA_ByteString eventId = UA_BYTESTRING_NULL;
+        serverMutexLock();
+        UA_StatusCode retval =
+            UA_Server_triggerTransientEvent(server, eventType,
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER),
+                                            &eventFields, &eventId);
+        serverMutexUnlock();
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(eventId.length, 16);
+        UA_ByteString_clear(&eventId);
+
+        notificationReceived = false;
+        sleepUntilAnswer(publishingInterval + 100);
+        retval = UA_Client_run_iterate(client, 0);
+        sleepUntilAnswer(publishingInterval + 100);
+        retval |= UA_Client_run_iterate(client, 0);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(notificationReceived, true);
+    }
+
+    /* The origin must be in the ObjectsFolder */
+    serverMutexLock();
+    UA_StatusCode retval =
+        UA_Server_triggerTransientEvent(server, eventType,
+                                        UA_NODEID_NUMERIC(0, UA_NS0ID_ROOTFOLDER),
+                                        &eventFields, NULL);
+    serverMutexUnlock();
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADINVALIDARGUMENT);
+
+    UA_DeleteMonitoredItemsRequest deleteRequest;
+    UA_DeleteMonitoredItemsRequest_init(&deleteRequest);
+    deleteRequest.subscriptionId = subscriptionId;
+    deleteRequest.monitoredItemIds = &monitoredItemId;
+    deleteRequest.monitoredItemIdsSize = 1;
+    UA_DeleteMonitoredItemsResponse deleteResponse =
+        UA_Client_MonitoredItems_delete(client, deleteRequest);
+    sleepUntilAnswer(publishingInterval + 100);
+    ck_assert_uint_eq(deleteResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    UA_DeleteMonitoredItemsResponse_clear(&deleteResponse);
+} END_TEST
+
 static bool hasBaseModelChangeEventType(void) {
 
     UA_QualifiedName readBrowsename;
@@ -614,6 +672,27 @@ START_TEST(multipleMonitoredItemsOneNode) {
         monitoredItemIdAr[i] = result.monitoredItemId;
     }
 
+    // the monitored items with identical filters share the compiled filter
+    serverMutexLock();
+    lockServer(server);
+    const UA_Node *serverNode =
+        UA_NODESTORE_GET(server, &item.itemToMonitor.nodeId);
+    ck_assert_ptr_ne(serverNode, NULL);
+    size_t sharing = 0;
+    UA_EventFilterProgram *program = NULL;
+    for(UA_MonitoredItem *mon = serverNode->head.monitoredItems; mon;
+        mon = mon->sampling.nodeListNext) {
+        ck_assert_ptr_ne(mon->eventFilter, NULL);
+        if(!program)
+            program = mon->eventFilter;
+        ck_assert_ptr_eq(mon->eventFilter, program);
+        sharing++;
+    }
+    ck_assert_uint_eq(sharing, 3);
+    UA_NODESTORE_RELEASE(server, serverNode);
+    unlockServer(server);
+    serverMutexUnlock();
+
     // delete the three monitored items after another
     UA_DeleteMonitoredItemsRequest deleteRequest;
     UA_DeleteMonitoredItemsRequest_init(&deleteRequest);
@@ -734,7 +813,7 @@ START_TEST(evaluateFilterWhereClause) {
     }
     lockServer(server);
     retval = evaluateWhereClause(server, &server->adminSession,
-                                 &eventNodeId, &contentFilter, &contentFilterResult);
+                                 &eventNodeId, NULL, &contentFilter, &contentFilterResult);
     unlockServer(server);
     ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
     UA_ContentFilterResult_clear(&contentFilterResult);
@@ -768,7 +847,7 @@ START_TEST(evaluateFilterWhereClause) {
     }
     lockServer(server);
     retval = evaluateWhereClause(server, &server->adminSession,
-                                 &eventNodeId, &contentFilter, &contentFilterResult);
+                                 &eventNodeId, NULL, &contentFilter, &contentFilterResult);
     unlockServer(server);
     ck_assert_uint_eq(retval, UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED);
     UA_ContentFilterResult_clear(&contentFilterResult);
@@ -795,7 +874,7 @@ START_TEST(evaluateFilterWhereClause) {
     }
     lockServer(server);
     retval = evaluateWhereClause(server, &server->adminSession,
-                                 &eventNodeId, &contentFilter,
+                                 &eventNodeId, NULL, &contentFilter,
                                  &contentFilterResult);
     unlockServer(server);
     ck_assert_uint_eq(retval, UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED);
@@ -843,7 +922,7 @@ START_TEST(evaluateFilterWhereClause) {
     }
     lockServer(server);
     retval = evaluateWhereClause(server, &server->adminSession,
-                                 &eventNodeId, &contentFilter, &contentFilterResult);
+                                 &eventNodeId, NULL, &contentFilter, &contentFilterResult);
     unlockServer(server);
     ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
     UA_ContentFilterResult_clear(&contentFilterResult);
@@ -873,7 +952,7 @@ START_TEST(evaluateFilterWhereClause) {
     }
     lockServer(server);
     retval = evaluateWhereClause(server, &server->adminSession,
-                                 &eventNodeId, &contentFilter, &contentFilterResult);
+                                 &eventNodeId, NULL, &contentFilter, &contentFilterResult);
     unlockServer(server);
     ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
     UA_ContentFilterResult_clear(&contentFilterResult);
@@ -902,7 +981,7 @@ START_TEST(evaluateFilterWhereClause) {
     }
     lockServer(server);
     retval = evaluateWhereClause(server, &server->adminSession,
-                                 &eventNodeId, &contentFilter, &contentFilterResult);
+                                 &eventNodeId, NULL, &contentFilter, &contentFilterResult);
     unlockServer(server);
     ck_assert_uint_eq(retval, UA_STATUSCODE_BADNOMATCH);
     UA_ContentFilterResult_clear(&contentFilterResult);
@@ -919,6 +998,7 @@ static Suite *testSuite_Client(void) {
     tcase_add_unchecked_fixture(tc_server, setup, teardown);
     tcase_add_test(tc_server, generateEventEmptyFilter);
     tcase_add_test(tc_server, generateEvents);
+    tcase_add_test(tc_server, generateTransientEvents);
     tcase_add_test(tc_server, createAbstractEvent);
     tcase_add_test(tc_server, createAbstractEventWithParent);
     tcase_add_test(tc_server, createNonAbstractEventWithParent);
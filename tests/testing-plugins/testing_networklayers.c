@@ -52,5 +52,6 @@ UA_ConnectionManager testConnectionManagerTCP = {
     testSendWithConnection,
     testCloseConnection,
     testAllocNetworkBuffer,
-    testFreeNetworkBuffer
+    testFreeNetworkBuffer,
+    NULL /* sendWithConnectionVec */
 };
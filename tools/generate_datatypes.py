@@ -137,6 +137,16 @@ def makeCIdentifier(value):
     else:
         return sanitized
 
+# Returns the numeric identifier of a NodeId string or None
+def getNumericIdentifier(nodeId):
+    if not nodeId:
+        return 0
+    if '=' not in nodeId:
+        return int(nodeId)
+    if nodeId.startswith("i="):
+        return int(nodeId[2:])
+    return None
+
 def getNodeidTypeAndId(nodeId):
     if not nodeId:
         return "UA_NODEIDTYPE_NUMERIC, {0}"
@@ -501,6 +511,16 @@ _UA_BEGIN_DECLS
             self.printh(
                 "extern UA_EXPORT UA_DataType UA_" + self.parser.outname.upper() + "[UA_" + self.parser.outname.upper() + "_COUNT];")
 
+            self.printh('''
+/* Indices into the type array, sorted by the numeric identifier of the typeId
+ * and the binaryEncodingId. Types with the same identifier keep their order.
+ * Types with a non-numeric NodeId are not contained. This allows to look up
+ * types with a binary search. */''')
+            for (name, ids) in self.get_sorted_indices():
+                self.printh("#define {}_COUNT {}".format(name, len(ids)))
+                if len(ids) > 0:
+                    self.printh("extern UA_EXPORT const UA_UInt16 {}[{}_COUNT];".format(name, name))
+
             for ns in self.filtered_types:
                 for i, t_name in enumerate(self.filtered_types[ns]):
                     t = self.filtered_types[ns][t_name]
@@ -536,6 +556,24 @@ _UA_END_DECLS
                     self.printd("    " + l)
                 self.printd("")
 
+    def get_sorted_indices(self):
+        outname = "UA_" + self.parser.outname.upper()
+        types = []
+        for ns in self.filtered_types:
+            for t_name in self.filtered_types[ns]:
+                types.append(self.filtered_types[ns][t_name])
+        indices = []
+        for (suffix, attr) in [("_TYPEIDINDEX", "nodeId"),
+                               ("_BINARYENCODINGIDINDEX", "binaryEncodingId")]:
+            keyed = []
+            for i, t in enumerate(types):
+                numeric = getNumericIdentifier(getattr(t, attr))
+                if numeric is not None:
+                    keyed.append((numeric, i))
+            keyed.sort()
+            indices.append((outname + suffix, [i for (_, i) in keyed]))
+        return indices
+
     def print_description_array(self):
         self.printc('''/**********************************
  * Autogenerated -- do not modify *
@@ -563,6 +601,14 @@ _UA_END_DECLS
                     self.printc(self.print_datatype(t, self.namespaceMap) + ",")
             self.printc("};\n")
 
+            for (name, ids) in self.get_sorted_indices():
+                if len(ids) == 0:
+                    continue
+                self.printc("const UA_UInt16 {}[{}_COUNT] = {{".format(name, name))
+                for i in range(0, len(ids), 12):
+                    self.printc("    " + ", ".join(str(x) for x in ids[i:i+12]) + ",")
+                self.printc("};\n")
+
 ###########################################
 # Execute with the command line arguments #
 ###########################################